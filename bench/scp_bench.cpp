@@ -0,0 +1,466 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "core/diagnostics.h"
+#include "core/flat_hash_map.h"
+#include "lexer/lexer.h"
+#include "parser/ll1_parser.h"
+#include "parser/slr_parser.h"
+#ifdef SCP_HAVE_RUNTIME
+#include "runtime/scprt.h"
+#endif
+#include "semant/type_checker.h"
+#include "workload/baseline.h"
+#include "workload/program_generator.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * The inputs of one benchmark family: the test corpus or one synthetic program.
+ */
+struct Workload {
+  /* The name, "corpus" or "synthetic/<statements>" */
+  std::string name_;
+  /* The sources both parsers accept */
+  std::vector<std::string> sources_;
+  /* The ASTs of the sources that also type check */
+  std::vector<std::shared_ptr<scp::core::AST>> asts_;
+  /* The type environments of asts_ */
+  std::vector<std::shared_ptr<scp::core::TypeEnvironment>> environments_;
+  /* Number of statements of sources_ */
+  size_t statements_{0};
+  /* Number of bytes of sources_ */
+  size_t bytes_{0};
+  /* Number of statements of asts_ */
+  size_t checked_statements_{0};
+};
+
+/**
+ * Build a workload, keeping the sources both parsers accept and type checking them ahead of time.
+ * Rejected sources are dropped silently, so every benchmark of the workload runs the same inputs.
+ * @param name The name of the workload.
+ * @param sources The candidate sources.
+ * @return The workload.
+ */
+auto MakeWorkload(std::string name, const std::vector<std::string> &sources) -> Workload {
+  Workload workload;
+  workload.name_ = std::move(name);
+  std::ostringstream discarded;
+  scp::core::DiagnosticCapture capture(discarded);
+  scp::parser::SLRParser slr("bench");
+  scp::parser::LL1Parser ll1("bench");
+  for (const auto &source : sources) {
+    slr.SetInput(source);
+    auto ast = slr.Parse();
+    ll1.SetInput(source);
+    if (!ast || !ll1.Parse()) {
+      continue;
+    }
+    size_t statements = ast->GetRoot()->GetChildren().size();
+    workload.sources_.push_back(source);
+    workload.statements_ += statements;
+    workload.bytes_ += source.size();
+    try {
+      scp::semant::TypeChecker type_checker(ast);
+      workload.environments_.push_back(type_checker.CheckType());
+      workload.asts_.push_back(ast);
+      workload.checked_statements_ += statements;
+    } catch (const std::exception &) {
+      // A program with a type error is still lexed and parsed
+    }
+  }
+  return workload;
+}
+
+/**
+ * Load the programs of test/data/code in name order.
+ * @return The sources.
+ */
+auto LoadCorpus() -> std::vector<std::string> {
+  std::vector<fs::path> paths;
+  for (const auto &entry : fs::directory_iterator(std::string(TEST_DATA_DIR) + "/code")) {
+    if (entry.path().extension() == ".scpl") {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  std::vector<std::string> sources;
+  for (const auto &path : paths) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    sources.push_back(content.str());
+  }
+  return sources;
+}
+
+// Items are statements and bytes are source bytes, so every phase reports statements and bytes per second
+void SetThroughput(benchmark::State &state, size_t statements, size_t bytes) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * statements));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+void BM_LexerConstruct(benchmark::State &state) {
+  for (auto _ : state) {
+    scp::lexer::Lexer lexer;
+    benchmark::DoNotOptimize(lexer);
+  }
+}
+
+void BM_LL1ParserConstruct(benchmark::State &state) {
+  for (auto _ : state) {
+    scp::parser::LL1Parser parser("bench");
+    benchmark::DoNotOptimize(parser);
+  }
+}
+
+// Init alone rebuilds the LL(1) parse table, without the lexer automata of the constructor
+void BM_LL1ParserInit(benchmark::State &state) {
+  scp::parser::LL1Parser parser("bench");
+  for (auto _ : state) {
+    parser.Init();
+  }
+}
+
+// The SLR tables are shared, so this is the lexer plus the parser stack
+void BM_SLRParserConstruct(benchmark::State &state) {
+  scp::parser::SLRParser::GetTables();
+  for (auto _ : state) {
+    scp::parser::SLRParser parser("bench");
+    benchmark::DoNotOptimize(parser);
+  }
+}
+
+// What the first SLR parser of a process pays once
+void BM_SLRParserBuildTables(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(scp::parser::SLRParser::BuildTables());
+  }
+}
+
+void BM_LexerTokenize(benchmark::State &state, const Workload &workload) {
+  scp::lexer::Lexer lexer;
+  for (auto _ : state) {
+    for (const auto &source : workload.sources_) {
+      benchmark::DoNotOptimize(lexer.Tokenize(source));
+    }
+  }
+  SetThroughput(state, workload.statements_, workload.bytes_);
+}
+
+// Both parsers pull tokens from their lexer while parsing, so Parse/LL1 and Parse/SLR compare like with like
+template <class Parser>
+void BM_Parse(benchmark::State &state, const Workload &workload) {
+  Parser parser("bench");
+  std::ostringstream discarded;
+  scp::core::DiagnosticCapture capture(discarded);
+  for (auto _ : state) {
+    for (const auto &source : workload.sources_) {
+      parser.SetInput(source);
+      benchmark::DoNotOptimize(parser.Parse());
+    }
+  }
+  SetThroughput(state, workload.statements_, workload.bytes_);
+}
+
+// The SLR engine alone, on tokens lexed before timing
+void BM_SLRParseLexed(benchmark::State &state, const Workload &workload) {
+  std::vector<std::unique_ptr<scp::parser::SLRParser>> parsers;
+  for (const auto &source : workload.sources_) {
+    parsers.push_back(std::make_unique<scp::parser::SLRParser>("bench"));
+    parsers.back()->SetInput(source);
+    parsers.back()->Lex();
+  }
+  for (auto _ : state) {
+    for (auto &parser : parsers) {
+      benchmark::DoNotOptimize(parser->Parse());
+    }
+  }
+  SetThroughput(state, workload.statements_, workload.bytes_);
+}
+
+void BM_TypeCheck(benchmark::State &state, const Workload &workload) {
+  for (auto _ : state) {
+    for (const auto &ast : workload.asts_) {
+      scp::semant::TypeChecker type_checker(ast);
+      benchmark::DoNotOptimize(type_checker.CheckType());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * workload.checked_statements_));
+}
+
+void BM_GenerateCode(benchmark::State &state, const Workload &workload) {
+  for (auto _ : state) {
+    for (size_t i = 0; i < workload.asts_.size(); i++) {
+      scp::cgen::CodeGenerator code_generator(workload.asts_[i], workload.environments_[i]);
+      benchmark::DoNotOptimize(code_generator.GenerateCode());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * workload.checked_statements_));
+}
+
+// Keys like those of the compiler's tables: variable names, or parser states
+template <class Key>
+auto TableKeys(size_t count) -> std::vector<Key> {
+  std::vector<Key> keys;
+  for (size_t i = 0; i < count; i++) {
+    if constexpr (std::is_same_v<Key, std::string>) {
+      keys.push_back("v" + std::to_string(i));
+    } else {
+      keys.push_back(static_cast<Key>(i));
+    }
+  }
+  return keys;
+}
+
+// Every key of a table of state.range(0) entries, looked up in insertion order
+template <class Map>
+void BM_TableFind(benchmark::State &state) {
+  auto keys = TableKeys<typename Map::key_type>(static_cast<size_t>(state.range(0)));
+  Map map;
+  for (size_t i = 0; i < keys.size(); i++) {
+    map[keys[i]] = static_cast<int>(i);
+  }
+  for (auto _ : state) {
+    for (const auto &key : keys) {
+      benchmark::DoNotOptimize(map.find(key)->second);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+// Building a table of state.range(0) entries from empty, as each compilation does for its symbols
+template <class Map>
+void BM_TableInsert(benchmark::State &state) {
+  auto keys = TableKeys<typename Map::key_type>(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    Map map;
+    for (size_t i = 0; i < keys.size(); i++) {
+      map[keys[i]] = static_cast<int>(i);
+    }
+    benchmark::DoNotOptimize(map);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+/**
+ * Register the comparison of one hash table with its std counterpart.
+ * @param name The name of the table.
+ */
+template <class Map>
+void RegisterTable(const std::string &name) {
+  for (int size : {16, 1024, 65536}) {
+    benchmark::RegisterBenchmark((name + "::find").c_str(), BM_TableFind<Map>)->Arg(size);
+    benchmark::RegisterBenchmark((name + "::insert").c_str(), BM_TableInsert<Map>)->Arg(size);
+  }
+}
+
+#ifdef SCP_HAVE_RUNTIME
+// The byte loops the MIPS runtime runs, one byte per iteration; noinline keeps them from being folded into the loop
+// of the benchmark
+__attribute__((noinline)) auto NaiveStrlen(const char *s) -> size_t {
+  size_t length = 0;
+  while (s[length] != '\0') {
+    // Keeps the compiler from turning the loop into a call of libc's strlen
+    asm("" : "+r"(length));
+    length++;
+  }
+  return length;
+}
+
+__attribute__((noinline)) auto NaiveMemchr(const char *s, char c, size_t n) -> const char * {
+  for (size_t i = 0; i < n; i++) {
+    if (s[i] == c) {
+      return s + i;
+    }
+  }
+  return nullptr;
+}
+
+__attribute__((noinline)) void NaiveConcat(char *out, const char *left, const char *right) {
+  while (*left != '\0') {
+    *out++ = *left++;
+  }
+  while ((*out++ = *right++) != '\0') {
+  }
+}
+
+/**
+ * The instruction set a runtime benchmark runs on, or none for the byte loop.
+ */
+enum class Loop { NAIVE, SCALAR, SSE2, AVX2 };
+
+auto LoopName(Loop loop) -> std::string {
+  switch (loop) {
+    case Loop::NAIVE:
+      return "naive";
+    case Loop::SCALAR:
+      return "scalar";
+    case Loop::SSE2:
+      return "sse2";
+    default:
+      return "avx2";
+  }
+}
+
+// A string of state.range(0) bytes, none of them the byte memchr looks for
+auto RuntimeText(benchmark::State &state) -> std::string {
+  return std::string(static_cast<size_t>(state.range(0)), 'a');
+}
+
+void BM_Strlen(benchmark::State &state, Loop loop) {
+  std::string text = RuntimeText(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(loop == Loop::NAIVE ? NaiveStrlen(text.c_str()) : scprt_strlen(text.c_str()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+void BM_Memchr(benchmark::State &state, Loop loop) {
+  std::string text = RuntimeText(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(loop == Loop::NAIVE ? NaiveMemchr(text.data(), '\n', text.size())
+                                                 : scprt_memchr(text.data(), '\n', text.size()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// Concatenation of two strings of state.range(0) / 2 bytes, which copies them and finds their ends
+void BM_Concat(benchmark::State &state, Loop loop) {
+  std::string half(static_cast<size_t>(state.range(0)) / 2, 'a');
+  std::vector<char> out(half.size() * 2 + 1);
+  for (auto _ : state) {
+    if (loop == Loop::NAIVE) {
+      NaiveConcat(out.data(), half.c_str(), half.c_str());
+    } else {
+      scprt_concat(out.data(), out.size(), half.c_str(), half.c_str());
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * half.size() * 2));
+}
+
+/**
+ * Register the runtime's loops on every instruction set the CPU has, next to the byte loops of the MIPS runtime.
+ */
+void RegisterRuntime() {
+  std::vector<Loop> loops = {Loop::NAIVE, Loop::SCALAR};
+  if (scprt_detect_isa() >= SCPRT_ISA_SSE2) {
+    loops.push_back(Loop::SSE2);
+  }
+  if (scprt_detect_isa() >= SCPRT_ISA_AVX2) {
+    loops.push_back(Loop::AVX2);
+  }
+  for (auto loop : loops) {
+    auto on_loop = [loop](void (*function)(benchmark::State &, Loop)) {
+      return [loop, function](benchmark::State &state) {
+        if (loop != Loop::NAIVE) {
+          scprt_set_isa(static_cast<scprt_isa>(static_cast<int>(loop) - 1));
+        }
+        function(state, loop);
+      };
+    };
+    for (int size : {16, 256, 4096, 65536}) {
+      std::string suffix = "/" + LoopName(loop);
+      benchmark::RegisterBenchmark(("scprt_strlen" + suffix).c_str(), on_loop(BM_Strlen))->Arg(size);
+      benchmark::RegisterBenchmark(("scprt_memchr" + suffix).c_str(), on_loop(BM_Memchr))->Arg(size);
+      benchmark::RegisterBenchmark(("scprt_concat" + suffix).c_str(), on_loop(BM_Concat))->Arg(size);
+    }
+  }
+}
+#endif
+
+/**
+ * Register the per-phase benchmarks of one workload.
+ * @param workload The workload, which must outlive the benchmark run.
+ */
+void RegisterPhases(const Workload &workload) {
+  const std::string &name = workload.name_;
+  benchmark::RegisterBenchmark(("Lexer::Tokenize/" + name).c_str(), BM_LexerTokenize, std::cref(workload));
+  benchmark::RegisterBenchmark(("Parse/LL1/" + name).c_str(), BM_Parse<scp::parser::LL1Parser>, std::cref(workload));
+  benchmark::RegisterBenchmark(("Parse/SLR/" + name).c_str(), BM_Parse<scp::parser::SLRParser>, std::cref(workload));
+  benchmark::RegisterBenchmark(("SLRParser::Parse(lexed)/" + name).c_str(), BM_SLRParseLexed, std::cref(workload));
+  benchmark::RegisterBenchmark(("TypeChecker::CheckType/" + name).c_str(), BM_TypeCheck, std::cref(workload));
+  benchmark::RegisterBenchmark(("CodeGenerator::GenerateCode/" + name).c_str(), BM_GenerateCode, std::cref(workload));
+}
+
+}  // namespace
+
+/**
+ * Main entry point for the benchmarks. Besides the Google Benchmark flags it takes --scp_sizes=<n>,<n>,...,
+ * the statement counts of the synthetic programs (default 1000,10000).
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  std::vector<size_t> sizes = {1000, 10000};
+  std::vector<char *> arguments;
+  for (int i = 0; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--scp_sizes=", 0) == 0) {
+      sizes.clear();
+      std::istringstream list(arg.substr(12));
+      std::string size;
+      while (std::getline(list, size, ',')) {
+        sizes.push_back(std::strtoul(size.c_str(), nullptr, 10));
+      }
+    } else {
+      arguments.push_back(argv[i]);
+    }
+  }
+  int count = static_cast<int>(arguments.size());
+  benchmark::Initialize(&count, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(count, arguments.data())) {
+    return 1;
+  }
+
+  // The workloads outlive the run, the registered benchmarks refer to them
+  std::vector<Workload> workloads;
+  workloads.reserve(sizes.size() + 1);
+  workloads.push_back(MakeWorkload("corpus", LoadCorpus()));
+  for (auto size : sizes) {
+    scp::workload::GeneratorOptions options;
+    options.statements_ = size;
+    workloads.push_back(
+        MakeWorkload("synthetic/" + std::to_string(size), {scp::workload::ProgramGenerator(options).Generate()}));
+  }
+  // scp-baseline compare reads the revision back from the context of --benchmark_out
+  benchmark::AddCustomContext("scp_revision", scp::workload::GetGitRevision());
+  benchmark::RegisterBenchmark("Lexer::Lexer", BM_LexerConstruct);
+  benchmark::RegisterBenchmark("LL1Parser::LL1Parser", BM_LL1ParserConstruct);
+  benchmark::RegisterBenchmark("LL1Parser::Init", BM_LL1ParserInit);
+  benchmark::RegisterBenchmark("SLRParser::SLRParser", BM_SLRParserConstruct);
+  benchmark::RegisterBenchmark("SLRParser::BuildTables", BM_SLRParserBuildTables);
+  RegisterTable<scp::core::FlatHashMap<std::string, int>>("FlatHashMap<string>");
+  RegisterTable<std::unordered_map<std::string, int>>("std::unordered_map<string>");
+  RegisterTable<scp::core::FlatHashMap<int, int>>("FlatHashMap<int>");
+  RegisterTable<std::unordered_map<int, int>>("std::unordered_map<int>");
+#ifdef SCP_HAVE_RUNTIME
+  RegisterRuntime();
+#endif
+  for (const auto &workload : workloads) {
+    RegisterPhases(workload);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "driver/fuzz_check.h"
+
+namespace {
+
+// Read a positive number from the environment, or use the default
+auto GetEnvironmentNumber(const char *name, double fallback) -> double {
+  const char *value = std::getenv(name);
+  if (value == nullptr || *value == '\0') {
+    return fallback;
+  }
+  double number = std::strtod(value, nullptr);
+  return number > 0 ? number : fallback;
+}
+
+}  // namespace
+
+/**
+ * Fuzz entry point for libFuzzer, and for AFL and corpus replay through replay_main.cpp.
+ * Aborts when the parsers disagree. Slow inputs are saved to $SCP_FUZZ_SLOW_DIR (default fuzz-slow) and abort too
+ * when $SCP_FUZZ_ABORT_ON_SLOW is set; $SCP_FUZZ_MAX_US_PER_BYTE sets the threshold.
+ * @param data The input bytes.
+ * @param size The number of bytes.
+ * @return 0, as libFuzzer expects.
+ */
+extern "C" auto LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) -> int {
+  static scp::driver::FuzzCheck check(
+      GetEnvironmentNumber("SCP_FUZZ_MAX_US_PER_BYTE", scp::driver::FuzzCheck::DEFAULT_MAX_SECONDS_PER_BYTE * 1e6) /
+      1e6);
+  static const char *slow_dir = std::getenv("SCP_FUZZ_SLOW_DIR");
+  static const bool abort_on_slow = std::getenv("SCP_FUZZ_ABORT_ON_SLOW") != nullptr;
+
+  std::string source(reinterpret_cast<const char *>(data), size);
+  auto result = check.Run(source);
+  if (!result.mismatch_.empty()) {
+    std::cerr << "Error: Parser mismatch: " << result.mismatch_ << std::endl;
+    std::abort();
+  }
+  if (result.slow_) {
+    auto path = scp::driver::FuzzCheck::SaveInput(slow_dir != nullptr ? slow_dir : "fuzz-slow", source);
+    std::cerr << "Warning: Slow input of " << size << " bytes took " << result.seconds_ * 1e3 << " ms, saved to "
+              << path << std::endl;
+    if (abort_on_slow) {
+      std::abort();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+extern "C" auto LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) -> int;
+
+namespace {
+
+void RunInput(const std::string &input) {
+  LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+}
+
+auto ReadFile(const fs::path &path) -> std::string {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+}  // namespace
+
+/**
+ * Replay driver for the fuzz entry point where libFuzzer is unavailable: runs every file and every file of every
+ * directory given, or stdin without arguments, which is also how AFL runs a target (`afl-fuzz ... -- scp_fuzz @@`).
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code; a finding aborts instead.
+ */
+auto main(int argc, char *argv[]) -> int {
+  if (argc < 2) {
+    RunInput(std::string(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()));
+    return 0;
+  }
+  size_t count = 0;
+  for (int i = 1; i < argc; i++) {
+    fs::path path(argv[i]);
+    std::vector<fs::path> files;
+    if (fs::is_directory(path)) {
+      for (const auto &entry : fs::recursive_directory_iterator(path)) {
+        if (entry.is_regular_file()) {
+          files.push_back(entry.path());
+        }
+      }
+    } else {
+      files.push_back(path);
+    }
+    for (const auto &file : files) {
+      RunInput(ReadFile(file));
+      count++;
+    }
+  }
+  std::cerr << "Replayed " << count << " inputs." << std::endl;
+  return 0;
+}
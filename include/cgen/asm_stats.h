@@ -0,0 +1,66 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "cgen/instruction_buffer.h"
+
+namespace scp::cgen {
+
+/**
+ * Static code-quality numbers for a piece of generated assembly.
+ * Sizes follow SPIM's expansion of pseudo-instructions: `la`, wide `li`, label loads and stores and the
+ * compare-and-branch pseudo-instructions take two machine words. Data bytes include the alignment of `.word`.
+ */
+struct AsmStats {
+  /**
+   * Collect the statistics of an instruction buffer.
+   * @param buffer The generated assembly.
+   * @return The statistics.
+   */
+  static auto Collect(const InstructionBuffer &buffer) -> AsmStats;
+
+  /**
+   * Get the share of instructions that access memory.
+   * @return The share in [0, 1].
+   */
+  auto GetMemoryShare() const -> double;
+
+  /**
+   * Accumulate the statistics of another file, e.g. to total a corpus.
+   * @param other The statistics to add.
+   * @return This object.
+   */
+  auto operator+=(const AsmStats &other) -> AsmStats &;
+
+  /**
+   * Render a human-readable report.
+   * @return The report.
+   */
+  auto Format() const -> std::string;
+
+  /**
+   * Render a side-by-side comparison of two reports, e.g. the same corpus compiled by two compiler builds.
+   * @param before The baseline statistics.
+   * @param after The new statistics.
+   * @return The comparison.
+   */
+  static auto FormatDiff(const AsmStats &before, const AsmStats &after) -> std::string;
+
+  /* Number of instructions as written, pseudo-instructions counted once */
+  int instruction_count_{0};
+  /* Number of loads and stores */
+  int memory_count_{0};
+  /* Number of instructions writing $sp */
+  int stack_adjust_count_{0};
+  /* Size of the text segment in bytes */
+  int text_bytes_{0};
+  /* Size of the data segment in bytes */
+  int data_bytes_{0};
+  /* Opcode to number of occurrences */
+  std::map<std::string, int> opcode_counts_;
+  /* Runtime routine to number of calls */
+  std::map<std::string, int> call_counts_;
+};
+
+}  // namespace scp::cgen
@@ -8,6 +8,24 @@
 
 namespace scp::cgen {
 
+/**
+ * Options controlling code generation.
+ */
+struct CodeGeneratorOptions {
+  /* String representation used by the generated program */
+  StringRuntime string_runtime_{StringRuntime::FLAT};
+  /* Rewrite multiplications by constants with the shifts and adds of the scp-superopt rule table */
+  bool apply_peephole_rules_{true};
+  /* Drop reloads of frame slots that are already held in a register */
+  bool eliminate_redundant_loads_{true};
+  /* Reorder independent instructions inside basic blocks to hide load-use latency */
+  bool schedule_instructions_{false};
+  /* Emit `.set noreorder` code with explicit branch and load delay slots (implies scheduling) */
+  bool fill_delay_slots_{false};
+  /* Type-check and generate code during the parse, without an AST; the output is the same */
+  bool one_pass_{false};
+};
+
 /**
  * This class is responsible for generating code.
  */
@@ -16,8 +34,11 @@ class CodeGenerator {
   /**
    * Constructor for the CodeGenerator.
    * @param ast The abstract syntax tree to generate code from.
+   * @param type_environment The type environment produced by the type checker.
+   * @param options The code generation options.
    */
-  CodeGenerator(std::shared_ptr<core::AST> ast, const std::shared_ptr<core::TypeEnvironment> &type_environment);
+  CodeGenerator(std::shared_ptr<core::AST> ast, const std::shared_ptr<core::TypeEnvironment> &type_environment,
+                CodeGeneratorOptions options = {});
 
   /**
    * Destructor for the CodeGenerator.
@@ -30,13 +51,42 @@ class CodeGenerator {
    */
   auto GenerateCode() const -> std::string;
 
+  /**
+   * Generate the library functions the generated program calls.
+   * @param string_runtime The string representation used by the generated program.
+   * @return The runtime as assembly code.
+   */
+  static auto GenerateRuntime(StringRuntime string_runtime) -> std::string;
+
+  /**
+   * Run the optimizations the options enable over emitted code.
+   * @param code The assembly code.
+   * @param options The code generation options.
+   * @return The optimized assembly code.
+   */
+  static auto Optimize(const std::string &code, const CodeGeneratorOptions &options) -> std::string;
+
  private:
   /**
    * Generate string utility functions.
    * @return The string utility functions as assembly code.
    */
-  auto GenerateStringUtilities() const -> std::string;
+  static auto GenerateStringUtilities() -> std::string;
+
+  /**
+   * Generate rope utility functions, used instead of the flat string utilities.
+   * @return The rope utility functions as assembly code.
+   */
+  static auto GenerateRopeUtilities() -> std::string;
+
+  /**
+   * Generate the newline trimming function shared by both string runtimes.
+   * @return The trim function as assembly code.
+   */
+  static auto GenerateTrimNewline() -> std::string;
 
+  /* The code generation options */
+  CodeGeneratorOptions options_;
   /* The AST to generate code from */
   std::shared_ptr<core::AST> ast_;
   /* Runtime environment for code generation */
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace scp::cgen {
+
+/**
+ * A single line of generated assembly, decoded enough for optimization passes to reason about it.
+ */
+struct Instruction {
+  /**
+   * Enum class for the kind of an assembly line.
+   */
+  enum class Kind { INSTRUCTION, LABEL, DIRECTIVE, BLANK };
+
+  /**
+   * Decode a line of assembly.
+   * @param line The line, without the trailing newline.
+   * @return The decoded line.
+   */
+  static auto Parse(const std::string &line) -> Instruction;
+
+  /**
+   * Build a new instruction, rendered in the code generator's layout.
+   * @param opcode The opcode.
+   * @param operands The operands.
+   * @param comment An optional trailing comment (without '#').
+   * @return The instruction.
+   */
+  static auto Make(const std::string &opcode, std::vector<std::string> operands, const std::string &comment = "")
+      -> Instruction;
+
+  /**
+   * Get the registers written by the instruction.
+   * @return The registers (e.g. "$a0").
+   */
+  auto GetDefinedRegisters() const -> std::vector<std::string>;
+
+  /**
+   * Get the registers read by the instruction.
+   * @return The registers (e.g. "$a0").
+   */
+  auto GetUsedRegisters() const -> std::vector<std::string>;
+
+  /**
+   * Check whether the instruction is a call to a runtime routine.
+   * @return True for jal.
+   */
+  auto IsCall() const -> bool { return kind_ == Kind::INSTRUCTION && opcode_ == "jal"; }
+
+  /**
+   * Check whether the instruction transfers control (branches, jumps and returns, not calls).
+   * @return True if the instruction ends a basic block.
+   */
+  auto IsBranch() const -> bool;
+
+  /**
+   * Check whether the instruction reads memory.
+   * @return True for loads.
+   */
+  auto IsLoad() const -> bool;
+
+  /**
+   * Check whether the instruction writes memory.
+   * @return True for stores.
+   */
+  auto IsStore() const -> bool;
+
+  /**
+   * Check whether the opcode is one the passes understand. Unknown opcodes must be treated as barriers.
+   * @return True if the def/use information is exact.
+   */
+  auto IsKnown() const -> bool;
+
+  /* The kind of line */
+  Kind kind_{Kind::BLANK};
+  /* The opcode, for instructions */
+  std::string opcode_;
+  /* The operands, for instructions */
+  std::vector<std::string> operands_;
+  /* The label name, for labels */
+  std::string label_;
+  /* The line as it will be emitted */
+  std::string text_;
+};
+
+/**
+ * The generated assembly as a list of lines that optimization passes can rewrite.
+ * Lines that are not touched by a pass are emitted exactly as the code generator produced them.
+ */
+class InstructionBuffer {
+ public:
+  /**
+   * Constructor for the InstructionBuffer.
+   * @param assembly The generated assembly code.
+   */
+  explicit InstructionBuffer(const std::string &assembly);
+
+  /**
+   * Destructor for the InstructionBuffer.
+   */
+  ~InstructionBuffer() = default;
+
+  /**
+   * Get the lines of the buffer.
+   * @return The lines.
+   */
+  auto GetInstructions() -> std::vector<Instruction> & { return instructions_; }
+
+  /**
+   * Get the lines of the buffer.
+   * @return The lines.
+   */
+  auto GetInstructions() const -> const std::vector<Instruction> & { return instructions_; }
+
+  /**
+   * Render the buffer back to assembly code.
+   * @return The assembly code.
+   */
+  auto ToString() const -> std::string;
+
+ private:
+  /* The lines of the buffer */
+  std::vector<Instruction> instructions_;
+};
+
+}  // namespace scp::cgen
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "cgen/instruction_buffer.h"
+
+namespace scp::cgen {
+
+/**
+ * List scheduler reordering independent instructions inside basic blocks to hide load-use latency.
+ * Each block is the run of plain instructions between labels, directives, calls, branches and syscalls, split into
+ * regions of at most MAX_REGION_SIZE instructions so straight-line code of any length schedules in linear time. The
+ * dependence graph covers register RAW/WAR/WAW hazards and memory ordering; a simple latency model gives loads
+ * and multiplications two cycles and everything else one. Ready instructions are picked by critical path.
+ *
+ * In no-reorder mode the output starts with `.set noreorder` and is meant for delayed branches and loads
+ * (`spim -delayed_branches -delayed_loads`): every branch, jump and call gets its delay slot filled with an
+ * independent instruction from its block or a `nop`, and a `nop` separates any load from an adjacent use.
+ */
+class InstructionScheduler {
+ public:
+  /* The most instructions scheduled together; the dependence graph of a region is quadratic in its size */
+  static constexpr size_t MAX_REGION_SIZE = 64;
+
+  /**
+   * Constructor for the InstructionScheduler.
+   * @param fill_delay_slots Emit `.set noreorder` code with explicit delay slots.
+   */
+  explicit InstructionScheduler(bool fill_delay_slots = false) : fill_delay_slots_(fill_delay_slots) {}
+
+  /**
+   * Destructor for the InstructionScheduler.
+   */
+  ~InstructionScheduler() = default;
+
+  /**
+   * Run the scheduler over the buffer.
+   * @param buffer The instruction buffer to rewrite in place.
+   */
+  void Run(InstructionBuffer &buffer);
+
+  /**
+   * Get the number of delay slots filled with useful instructions in the last run.
+   * @return The number of filled delay slots.
+   */
+  auto GetFilledDelaySlotCount() const -> int { return filled_delay_slot_count_; }
+
+  /**
+   * Get the number of nops inserted in the last run.
+   * @return The number of nops.
+   */
+  auto GetNopCount() const -> int { return nop_count_; }
+
+ private:
+  /**
+   * Schedule one basic block and append it to the output.
+   * @param block The plain instructions of the block.
+   * @param terminator The branch, jump or call ending the block, or nullptr.
+   * @param output The scheduled instructions.
+   */
+  void ScheduleBlock(const std::vector<Instruction> &block, const Instruction *terminator,
+                     std::vector<Instruction> &output);
+
+  /**
+   * Check whether an instruction may be moved freely inside its block.
+   * @param instruction The instruction.
+   * @return True for loads, stores and arithmetic.
+   */
+  static auto IsSchedulable(const Instruction &instruction) -> bool;
+
+  /**
+   * Check whether an instruction can sit in the delay slot of a terminator.
+   * @param instruction The candidate.
+   * @param terminator The branch, jump or call.
+   * @return True if the candidate is a single machine instruction that the terminator does not depend on.
+   */
+  static auto CanFillDelaySlot(const Instruction &instruction, const Instruction &terminator) -> bool;
+
+  /**
+   * Get the number of cycles before the result of an instruction can be used.
+   * @param instruction The instruction.
+   * @return The latency.
+   */
+  static auto Latency(const Instruction &instruction) -> int;
+
+  /* Emit `.set noreorder` code with explicit delay slots */
+  bool fill_delay_slots_;
+  /* Number of delay slots filled with useful instructions */
+  int filled_delay_slot_count_{0};
+  /* Number of nops inserted */
+  int nop_count_{0};
+};
+
+}  // namespace scp::cgen
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "cgen/object_unit.h"
+#include "cgen/runtime_environment.h"
+#include "core/type.h"
+
+namespace scp::cgen {
+
+/**
+ * Links object units into one program, in the order the units are added, as if their sources had been compiled as
+ * one file. It lays out one frame holding the variables of every unit, gives equal string literals of different
+ * units one label, numbers the read loops of all units apart, emits the runtime once and optimizes the whole text.
+ */
+class Linker {
+ public:
+  /**
+   * Constructor for the Linker.
+   * @param options The code generation options; every unit must be compiled for their string runtime.
+   */
+  explicit Linker(CodeGeneratorOptions options = {});
+
+  /**
+   * Destructor for the Linker.
+   */
+  ~Linker() = default;
+
+  /**
+   * Append a unit to the program.
+   * @param name The name of the unit in error messages, usually its file.
+   * @param unit The unit.
+   * @throws std::runtime_error if the unit does not fit the units before it.
+   */
+  void AddUnit(const std::string &name, ObjectUnit unit);
+
+  /**
+   * Link the units added so far.
+   * @return The assembly of the program.
+   */
+  auto Link() const -> std::string;
+
+  /**
+   * Combine the units added so far into one unit, whose variables are still named, so later units can be linked
+   * after it without relinking the earlier ones apart.
+   * @return The unit, without its key.
+   */
+  auto Merge() const -> ObjectUnit;
+
+  /**
+   * Check a unit against the variables declared before it, as a build does before reusing the unit.
+   * @param unit The unit.
+   * @param declared The variables of the earlier units and their types.
+   * @return Why the unit must be recompiled, or empty if it fits.
+   */
+  static auto FindConflict(const ObjectUnit &unit, const std::unordered_map<std::string, core::Type> &declared)
+      -> std::string;
+
+ private:
+  /**
+   * Rewrite the frame slots, string labels and read loop labels of a unit to those of the program.
+   * @param index The position of the unit.
+   * @param place_slots Whether to replace the named slots by frame offsets, or keep them for a later link.
+   * @return The code of the unit.
+   */
+  auto Relocate(size_t index, bool place_slots) const -> std::string;
+
+  /* The code generation options */
+  CodeGeneratorOptions options_;
+  /* The units in program order */
+  std::vector<ObjectUnit> units_;
+  /* The program's runtime environment, holding every variable and string literal */
+  std::shared_ptr<RuntimeEnvironment> runtime_environment_;
+  /* The variables declared so far and their types */
+  std::unordered_map<std::string, core::Type> declared_;
+  /* Per unit, the program label of each of its string labels */
+  std::vector<std::vector<std::string>> string_labels_;
+  /* Per unit, the number of read loop labels of the units before it */
+  std::vector<int> input_id_bases_;
+};
+
+}  // namespace scp::cgen
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cgen/runtime_environment.h"
+#include "core/type.h"
+
+namespace scp::cgen {
+
+/**
+ * A separately compiled source file: the code of its statements before optimization, with everything that depends
+ * on the other files of the program left for the Linker. Frame slots are written `@name($fp)`, and string labels
+ * `str_<i>` and read loop labels count from 0 within the unit. The unit also records the variables of earlier units
+ * it relied on with their types, so the linker can tell when it was compiled against different ones.
+ */
+struct ObjectUnit {
+  /* The variables and their types, in declaration order */
+  using Symbols = std::vector<std::pair<std::string, core::Type>>;
+
+  /* First line of a serialized unit, naming the format version */
+  static constexpr const char *MAGIC = "SCPUNIT 1";
+
+  /* Identifies the source, compiler and options the unit was built from */
+  std::string key_;
+  /* The string runtime the code calls */
+  StringRuntime string_runtime_{StringRuntime::FLAT};
+  /* Variables of earlier units the unit reads or assigns, with the types it checked them against */
+  Symbols imports_;
+  /* Variables the unit declares */
+  Symbols exports_;
+  /* String literals in the order of their local labels */
+  std::vector<std::string> strings_;
+  /* Number of read loop labels used */
+  int input_ids_{0};
+  /* The code of the statements */
+  std::string text_;
+
+  /**
+   * Serialize the unit.
+   * @return The bytes of a unit file.
+   */
+  auto Serialize() const -> std::string;
+
+  /**
+   * Parse a serialized unit.
+   * @param bytes The bytes of a unit file.
+   * @return The unit.
+   * @throws std::runtime_error if the bytes are not a unit of this format.
+   */
+  static auto Deserialize(const std::string &bytes) -> ObjectUnit;
+};
+
+}  // namespace scp::cgen
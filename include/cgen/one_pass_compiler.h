@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "cgen/object_unit.h"
+#include "cgen/runtime_environment.h"
+#include "core/ast.h"
+#include "core/token.h"
+#include "core/type.h"
+#include "parser/slr_parser.h"
+
+namespace scp::cgen {
+
+/**
+ * Compiles during the parse: the SLR reductions type-check and generate code on the spot with the rules and
+ * templates of core::AST::ASTNode, so no parse tree or AST is built. Each expression symbol carries its type, and
+ * the code of an expression is appended in token order, as an operand is reduced before the operator after it is
+ * shifted; each Statement reduction checks the assignment and appends its code to the body. Frame offsets depend on
+ * the number of variables, so the body refers to a variable by its declaration index until Finish fills in the
+ * offsets, or FinishUnit names the variable for the Linker. The output and diagnostics are those of the multi-pass
+ * pipeline.
+ */
+class OnePassCompiler : public parser::SLRParser::SemanticActions {
+ public:
+  /**
+   * Constructor for the OnePassCompiler.
+   * @param options The code generation options.
+   */
+  explicit OnePassCompiler(CodeGeneratorOptions options = {});
+
+  /**
+   * Destructor for the OnePassCompiler.
+   */
+  ~OnePassCompiler() override = default;
+
+  void Shift(const core::Token &token) override;
+  auto Reduce(const parser::SLRParser::Action &action) -> bool override;
+
+  /**
+   * Declare the variables of the units before this one, when compiling a unit. Call before parsing.
+   * @param symbols The variables and their types, in declaration order.
+   */
+  void Import(const ObjectUnit::Symbols &symbols);
+
+  /**
+   * Finish a successful parse: report the type errors and throw, or return the assembly.
+   * @return The generated assembly.
+   */
+  auto Finish() -> std::string;
+
+  /**
+   * Finish a successful parse of a unit: report the type errors and throw, or return the unit for the Linker.
+   * @return The unit, without its key.
+   */
+  auto FinishUnit() -> ObjectUnit;
+
+ private:
+  /**
+   * The synthesized attribute of a grammar symbol.
+   */
+  struct Attribute {
+    /* The token text, or the value of the AST node the symbol stands for */
+    std::string value_;
+    /* The static type */
+    core::Type type_{core::Type::UNDEFINED};
+    /* The type the code generator dispatches on */
+    core::Type runtime_type_{core::Type::UNDEFINED};
+    /* Whether the symbol stands for no AST node, as a Factor the AST transform does not recognize */
+    bool missing_{false};
+    /* The length of the type diagnostics when the first token of the symbol was shifted */
+    std::streamoff diagnostics_start_{0};
+  };
+
+  /**
+   * Reduce a Factor from a token or a parenthesized Expression.
+   * @param size The length of the right-hand side.
+   */
+  void ReduceFactor(size_t size);
+
+  /**
+   * Reduce `Expression plus Term` or `Term times Factor`.
+   * @param type PLUS or TIMES.
+   */
+  void ReduceBinary(core::ASTNodeType type);
+
+  /**
+   * Reduce `identifier assign Expression semicolon`.
+   */
+  void ReduceStatement();
+
+  /**
+   * Record a node the AST would hold with a child missing, where the type check panics.
+   * @param start The diagnostics length when the node's first token was shifted.
+   */
+  void MarkIncomplete(std::streamoff start);
+
+  /**
+   * Get the placeholder the body holds for the frame offset of a variable.
+   * @param name The variable.
+   * @return The placeholder.
+   */
+  auto GetSlot(const std::string &name) -> std::string;
+
+  /**
+   * Add a variable to both environments.
+   * @param name The variable.
+   * @param type Its type.
+   */
+  void Declare(const std::string &name, core::Type type);
+
+  /**
+   * Record that the unit relies on an imported variable, if the name is one.
+   * @param name The variable.
+   */
+  void NoteImport(const std::string &name);
+
+  /**
+   * Report the type diagnostics and throw if the check failed.
+   */
+  void ReportErrors();
+
+  /**
+   * Replace the placeholders of the body.
+   * @param slots The text of each declaration index.
+   * @return The body.
+   */
+  auto FillSlots(const std::vector<std::string> &slots) const -> std::string;
+
+  /* The code generation options */
+  CodeGeneratorOptions options_;
+  /* The type environment, as built by semant::TypeChecker */
+  std::shared_ptr<core::TypeEnvironment> type_environment_;
+  /* The runtime environment, whose stack allocation of a variable is four times its declaration index */
+  std::shared_ptr<RuntimeEnvironment> runtime_environment_;
+  /* The declared variables by declaration index */
+  std::vector<std::string> declared_;
+  /* The variables of earlier units; imports_ lists those the unit relies on */
+  std::unordered_map<std::string, core::Type> imported_;
+  /* The imported variables used so far, with their types */
+  ObjectUnit::Symbols imports_;
+  /* The variables declared by the source, with their types */
+  ObjectUnit::Symbols exports_;
+  /* The attributes of the symbols on the parser stack */
+  std::vector<Attribute> attributes_;
+  /* The code of the statements reduced so far */
+  std::string body_;
+  /* The code of the expression of the current statement so far, so nesting never copies the code of an operand */
+  std::string expression_code_;
+  /* The type diagnostics, reported only if the whole input parses */
+  std::ostringstream diagnostics_;
+  /* Whether some check failed; no code is generated after that */
+  bool has_bug_{false};
+  /* The earliest diagnostics length of a node with a missing child in the current statement */
+  std::optional<std::streamoff> statement_panic_;
+  /* The diagnostics length where the type check panicked, after which nothing is checked */
+  std::optional<std::streamoff> panic_;
+};
+
+}  // namespace scp::cgen
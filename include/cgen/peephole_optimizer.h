@@ -0,0 +1,44 @@
+#pragma once
+
+#include "cgen/instruction_buffer.h"
+
+namespace scp::cgen {
+
+/**
+ * Pass rewriting multiplications by constants with the rule table scp-superopt generates.
+ * The code generator multiplies by loading the constant into the accumulator, popping the other factor and
+ * multiplying: `li R, C`, instructions that leave R alone, then `mul R, S, R`. When the table has a rule for C, the
+ * `li` goes and the `mul` becomes the rule's shifts and adds, with $in read from S, $out written to R and $tmp
+ * mapped to $t2. Rules using $tmp apply only where $t2 is dead after the `mul`, which the pass checks by scanning
+ * forward to the next definition, use or join point.
+ */
+class PeepholeOptimizer {
+ public:
+  /**
+   * Constructor for the PeepholeOptimizer.
+   */
+  PeepholeOptimizer() = default;
+
+  /**
+   * Destructor for the PeepholeOptimizer.
+   */
+  ~PeepholeOptimizer() = default;
+
+  /**
+   * Run the pass over the buffer.
+   * @param buffer The instruction buffer to rewrite in place.
+   */
+  void Run(InstructionBuffer &buffer);
+
+  /**
+   * Get the number of multiplications rewritten by the last run.
+   * @return The number of rewritten multiplications.
+   */
+  auto GetRewrittenCount() const -> int { return rewritten_count_; }
+
+ private:
+  /* Number of multiplications rewritten */
+  int rewritten_count_{0};
+};
+
+}  // namespace scp::cgen
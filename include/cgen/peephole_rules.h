@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace scp::cgen {
+
+/**
+ * A rewrite of a multiplication by a constant found by scp-superopt, in the registers of the Superoptimizer:
+ * $in is the other factor, $out the product and $tmp a scratch register.
+ */
+struct PeepholeRule {
+  /* The constant multiplied by */
+  int32_t multiplier_;
+  /* The verified sequence replacing `li $out, <multiplier>; mul $out, $in, $out`, as Superoptimizer::Parse reads it */
+  const char *replacement_;
+};
+
+/**
+ * Get the rule table checked in as src/cgen/peephole_rules.cpp, which `scp-superopt --emit` regenerates.
+ * @return The rules, ordered by multiplier.
+ */
+auto GetPeepholeRules() -> const std::vector<PeepholeRule> &;
+
+}  // namespace scp::cgen
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "cgen/instruction_buffer.h"
+
+namespace scp::cgen {
+
+/**
+ * Dataflow pass removing reloads of frame slots whose value is already held in a register.
+ * The pass tracks, along straight-line code, which registers hold which `off($fp)` slot. A reload into a register
+ * that already holds the slot is dropped, and a reload of a slot held by another register becomes a `move`.
+ * Labels are join points and reset the state; calls invalidate every register the calling convention lets the
+ * callee clobber. Frame slots are only ever addressed through $fp, so other stores cannot alias them.
+ */
+class RedundantLoadEliminator {
+ public:
+  /**
+   * Constructor for the RedundantLoadEliminator.
+   */
+  RedundantLoadEliminator() = default;
+
+  /**
+   * Destructor for the RedundantLoadEliminator.
+   */
+  ~RedundantLoadEliminator() = default;
+
+  /**
+   * Run the pass over the buffer.
+   * @param buffer The instruction buffer to rewrite in place.
+   */
+  void Run(InstructionBuffer &buffer);
+
+  /**
+   * Get the number of loads removed by the last run.
+   * @return The number of removed loads.
+   */
+  auto GetRemovedCount() const -> int { return removed_count_; }
+
+  /**
+   * Get the number of loads replaced by register moves in the last run.
+   * @return The number of replaced loads.
+   */
+  auto GetReplacedCount() const -> int { return replaced_count_; }
+
+ private:
+  /**
+   * Forget everything known about a register.
+   * @param reg The register.
+   */
+  void Invalidate(const std::string &reg);
+
+  /**
+   * Forget every register holding a frame slot.
+   * @param slot The frame slot operand, e.g. "4($fp)".
+   */
+  void InvalidateSlot(const std::string &slot);
+
+  /* Register to the frame slot it currently holds */
+  std::unordered_map<std::string, std::string> register_slot_;
+  /* Number of loads removed */
+  int removed_count_{0};
+  /* Number of loads replaced by moves */
+  int replaced_count_{0};
+};
+
+}  // namespace scp::cgen
@@ -2,13 +2,20 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "core/flat_hash_map.h"
 #include "core/type.h"
 
 namespace scp::cgen {
 
+/**
+ * Enum class for the string representation used by the generated program.
+ * FLAT strings are null-terminated byte buffers, ROPE strings are trees of concat/repeat nodes over flat leaves.
+ */
+enum class StringRuntime { FLAT, ROPE };
+
 /**
  * This class represents the runtime environment for code generation.
  * It can be extended to include various runtime configurations and settings.
@@ -24,7 +31,14 @@ class RuntimeEnvironment {
   /**
    * Constructor for the runtime environment.
    */
-  explicit RuntimeEnvironment(const std::shared_ptr<core::TypeEnvironment> &environment);
+  explicit RuntimeEnvironment(const std::shared_ptr<core::TypeEnvironment> &environment,
+                              StringRuntime string_runtime = StringRuntime::FLAT);
+
+  /**
+   * Constructor for a runtime environment that learns its symbols one at a time through AddSymbol.
+   * @param string_runtime The string representation used by the generated program.
+   */
+  explicit RuntimeEnvironment(StringRuntime string_runtime) : string_runtime_(string_runtime) {}
 
   /**
    * Destructor for the runtime environment.
@@ -38,6 +52,13 @@ class RuntimeEnvironment {
    */
   auto GetStackAllocation(const std::string &symbol) -> int;
 
+  /**
+   * Allocate the next stack slot to a symbol, unless it already has one.
+   * @param symbol The name of the symbol.
+   * @param type The type of the symbol.
+   */
+  void AddSymbol(const std::string &symbol, core::Type type);
+
   /**
    * Get the global string data for a given symbol.
    * @param symbol The name of the symbol.
@@ -77,13 +98,33 @@ class RuntimeEnvironment {
    */
   auto GetUniqueInputId() -> int;
 
+  /**
+   * Get the number of input labels handed out by GetUniqueInputId.
+   * @return The number of labels.
+   */
+  auto GetInputIdCount() const -> int { return input_counter_; }
+
+  /**
+   * Get the string constants in the order of their labels.
+   * @return The string literals (with quotes).
+   */
+  auto GetStringConstants() const -> std::vector<std::string>;
+
+  /**
+   * Get the string representation used by the generated program.
+   * @return The string runtime.
+   */
+  auto GetStringRuntime() const -> StringRuntime { return string_runtime_; }
+
  private:
   /* Symbol table mapping variable names to their stack allocations and types */
-  std::unordered_map<std::string, std::pair<int, core::Type>> symbol_table_;
+  core::FlatHashMap<std::string, std::pair<int, core::Type>> symbol_table_;
   /* Global string data table mapping string literals to their labels */
-  std::unordered_map<std::string, std::string> global_string_data_table_;
+  core::FlatHashMap<std::string, std::string> global_string_data_table_;
   /* Counter for unique input IDs */
   int input_counter_{0};
+  /* String representation used by the generated program */
+  StringRuntime string_runtime_;
 };
 
 }  // namespace scp::cgen
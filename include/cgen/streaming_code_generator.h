@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "cgen/code_generator.h"
+#include "cgen/runtime_environment.h"
+#include "core/ast.h"
+#include "core/type.h"
+
+namespace scp::cgen {
+
+/**
+ * Generates code one statement at a time and writes it out as it goes, so the assembly of the whole program is
+ * never held in memory. The body comes first under `main_body`; the frame size is only known at the end, so the
+ * data section and a trailer holding `main`, which sets up the frame and jumps to the body, are written by Finish.
+ */
+class StreamingCodeGenerator {
+ public:
+  /* Number of bytes of generated code collected before they are optimized and written */
+  static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+  /**
+   * Constructor for the StreamingCodeGenerator.
+   * @param output The stream to write the assembly to.
+   * @param options The code generation options.
+   */
+  explicit StreamingCodeGenerator(std::ostream &output, CodeGeneratorOptions options = {});
+
+  /**
+   * Destructor for the StreamingCodeGenerator.
+   */
+  ~StreamingCodeGenerator() = default;
+
+  /**
+   * Generate the code of a statement that passed the type check.
+   * @param statement The ASSIGN node of the statement.
+   * @param type_environment The type environment after checking the statement.
+   */
+  void AddStatement(const std::shared_ptr<core::AST::ASTNode> &statement,
+                    const std::shared_ptr<core::TypeEnvironment> &type_environment);
+
+  /**
+   * Write the remaining body, the program exit, the runtime, the data section and the `main` trailer.
+   */
+  void Finish();
+
+  /**
+   * Get the largest amount of generated code held at once.
+   * @return The number of bytes.
+   */
+  auto GetPeakPendingBytes() const -> size_t { return peak_pending_bytes_; }
+
+ private:
+  /**
+   * Optimize and write the collected code.
+   */
+  void Flush();
+
+  /* The stream to write the assembly to */
+  std::ostream &output_;
+  /* The code generation options */
+  CodeGeneratorOptions options_;
+  /* Runtime environment, gaining a stack slot for every new variable */
+  std::shared_ptr<RuntimeEnvironment> runtime_environment_;
+  /* Generated code not yet written */
+  std::string pending_;
+  /* Largest size of pending_ */
+  size_t peak_pending_bytes_{0};
+};
+
+}  // namespace scp::cgen
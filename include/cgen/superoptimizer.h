@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace scp::cgen {
+
+/**
+ * An instruction of the MIPS subset the code generator emits for arithmetic, over the registers of a
+ * Superoptimizer: $zero, the operand $in, the result $out and the scratch register $tmp.
+ */
+struct MicroInstruction {
+  /**
+   * Enum class for the opcodes. `add` traps on signed overflow, the others wrap around.
+   */
+  enum class Opcode { LI, ADDIU, ADD, ADDU, SUBU, SLL, MUL, MOVE };
+
+  /* The opcode */
+  Opcode opcode_{Opcode::MOVE};
+  /* The register written */
+  int destination_{0};
+  /* The first register read */
+  int first_{0};
+  /* The second register read, for the three-register opcodes */
+  int second_{0};
+  /* The immediate of li, addiu and sll */
+  int32_t immediate_{0};
+};
+
+/* A straight-line sequence of micro instructions */
+using MicroSequence = std::vector<MicroInstruction>;
+
+/**
+ * Options of a superoptimizer search.
+ */
+struct SuperoptimizerOptions {
+  /* The longest sequence enumerated; each instruction more multiplies the search by a few hundred */
+  size_t max_length_{3};
+  /* The immediates li and addiu may take; sll takes every shift from 1 to 31 */
+  std::vector<int32_t> immediates_{1, -1};
+  /* The seed of the random test inputs */
+  uint32_t seed_{1};
+};
+
+/**
+ * Finds the cheapest sequences computing what target sequences compute, by enumerating every sequence up to a length.
+ *
+ * Sequences are run on a few test inputs at once, and sequences leaving the same values behind are enumerated
+ * only once, so the candidates of every target come out of one enumeration. A candidate whose $out agrees with a
+ * target on the test inputs is then verified on all 2^32 values of $in without a solver. Without `add`, a sequence
+ * computes an integer polynomial of $in modulo 2^32, and a polynomial of degree d that is 0 modulo 2^32 at 0, ..., d
+ * is 0 modulo 2^32 everywhere, as its Newton form shows. Two such sequences are therefore equivalent if they agree
+ * at 0 up to the larger of their degrees. Sequences using `add` trap on some inputs and are checked exhaustively.
+ */
+class Superoptimizer {
+ public:
+  /* The registers */
+  static constexpr int ZERO = 0;
+  static constexpr int IN = 1;
+  static constexpr int OUT = 2;
+  static constexpr int TMP = 3;
+  static constexpr int REGISTER_COUNT = 4;
+
+  /* The number of test inputs a candidate must pass before it is verified */
+  static constexpr size_t TEST_COUNT = 16;
+
+  /**
+   * Constructor for the Superoptimizer.
+   * @param options The search options.
+   */
+  explicit Superoptimizer(SuperoptimizerOptions options = {});
+
+  /**
+   * Destructor for the Superoptimizer.
+   */
+  ~Superoptimizer() = default;
+
+  /**
+   * Find, for every target, the cheapest sequence computing the same $out that is cheaper than the target.
+   * @param targets The target sequences.
+   * @return For each target the sequence, or std::nullopt if no sequence up to the maximum length is cheaper.
+   */
+  auto Search(const std::vector<MicroSequence> &targets) -> std::vector<std::optional<MicroSequence>>;
+
+  /**
+   * Get the number of sequences the last search ran.
+   * @return The number of sequences.
+   */
+  auto GetEnumeratedCount() const -> size_t { return enumerated_count_; }
+
+  /**
+   * Get the number of candidates of the last search that passed the test inputs but not the verification.
+   * @return The number of candidates.
+   */
+  auto GetRejectedCount() const -> size_t { return rejected_count_; }
+
+  /**
+   * Parse a sequence, instructions separated by ';' or newlines, e.g. "li $out, 10; mul $out, $in, $out".
+   * @param text The sequence.
+   * @return The sequence.
+   * @throws std::runtime_error on unknown opcodes, registers or operands.
+   */
+  static auto Parse(const std::string &text) -> MicroSequence;
+
+  /**
+   * Render a sequence the way Parse reads it.
+   * @param sequence The sequence.
+   * @return The text.
+   */
+  static auto ToString(const MicroSequence &sequence) -> std::string;
+
+  /**
+   * Build the sequence the code generator emits to multiply by a constant.
+   * @param multiplier The constant.
+   * @return The sequence "li $out, <multiplier>; mul $out, $in, $out".
+   */
+  static auto MultiplyBy(int32_t multiplier) -> MicroSequence;
+
+  /**
+   * Run a sequence. $out and $tmp start out as 0, though sequences Verify accepts never read them before writing.
+   * @param sequence The sequence.
+   * @param in The value of $in.
+   * @return The value of $out, or std::nullopt if an `add` overflows.
+   */
+  static auto Evaluate(const MicroSequence &sequence, uint32_t in) -> std::optional<uint32_t>;
+
+  /**
+   * Get the cost of a sequence in cycles: one per machine instruction SPIM expands it to, li of a constant beyond 16
+   * bits taking two and mul taking mult and mflo plus the cycle the product is late, as the scheduler models it.
+   * @param sequence The sequence.
+   * @return The cost.
+   */
+  static auto GetCost(const MicroSequence &sequence) -> int;
+
+  /**
+   * Check that two sequences leave the same $out, or both trap, for every value of $in, and that neither reads $out
+   * or $tmp before writing it, so whatever the registers held before does not matter.
+   * @param first The first sequence.
+   * @param second The second sequence.
+   * @return Whether they are equivalent.
+   */
+  static auto Verify(const MicroSequence &first, const MicroSequence &second) -> bool;
+
+ private:
+  /* The search options */
+  SuperoptimizerOptions options_;
+  /* The values of $in the candidates are tested on */
+  std::vector<uint32_t> inputs_;
+  /* Sequences run by the last search */
+  size_t enumerated_count_{0};
+  /* Candidates of the last search rejected by the verification */
+  size_t rejected_count_{0};
+};
+
+}  // namespace scp::cgen
@@ -28,6 +28,19 @@ class ErrorMessages {
   static constexpr const char *CANNOT_ASSIGN_TO_INPUT_STREAM = "Type checker: Cannot assign to input stream.";
   static constexpr const char *OUTPUT_STREAM_AS_RIGHT_VALUE = "Type checker: Output stream cannot";
 
+  // Runtime error messages
+  static constexpr const char *ARITHMETIC_OVERFLOW = "Runtime: Arithmetic overflow.";
+  static constexpr const char *STRING_TOO_LONG = "Runtime: String too long.";
+
+  /**
+   * Generate an error message for a number literal that does not fit in a word.
+   * @param literal The literal.
+   * @return A formatted error message.
+   */
+  static auto NumberOutOfRange(const std::string &literal) -> std::string {
+    return "Runtime: Number " + literal + " does not fit in 32 bits.";
+  }
+
   /**
    * Generate an error message for a symbol not in the alphabet with its ASCII value.
    * @param symbol The symbol that is not in the alphabet.
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <fstream>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "cgen/runtime_environment.h"
 #include "core/type.h"
@@ -31,6 +33,24 @@ struct TreeNode {
    */
   explicit TreeNode(std::string v) : val_(std::move(v)) {}
 
+  /**
+   * Destructor for a tree node. Frees the subtrees iteratively, as a statement list nests once per statement.
+   */
+  ~TreeNode() {
+    // Detach the subtrees owned only by this node before they are destroyed, so no destructor recurses
+    std::vector<std::shared_ptr<TreeNode>> pending(std::make_move_iterator(children_.begin()),
+                                                   std::make_move_iterator(children_.end()));
+    children_.clear();
+    while (!pending.empty()) {
+      auto node = std::move(pending.back());
+      pending.pop_back();
+      if (node && node.use_count() == 1) {
+        std::move(node->children_.begin(), node->children_.end(), std::back_inserter(pending));
+        node->children_.clear();
+      }
+    }
+  }
+
   /**
    * Add a child to the tree node.
    * @param child The child node to add.
@@ -56,9 +76,9 @@ class AST {
     explicit ASTNode(ASTNodeType type, std::string value) : value_(std::move(value)), type_(type) {}
 
     /**
-     * Destructor for an AST node.
+     * Destructor for an AST node. Frees the subtrees iteratively, as an expression nests once per operator.
      */
-    ~ASTNode() = default;
+    ~ASTNode();
 
     /**
      * Add a child to the AST node.
@@ -97,6 +117,13 @@ class AST {
      */
     auto GetChildren() const -> const std::list<std::shared_ptr<ASTNode>> & { return children_; }
 
+    /**
+     * Check whether two subtrees have the same shape, node types and values.
+     * @param other The root of the other subtree.
+     * @return True if the subtrees are equal.
+     */
+    auto IsStructurallyEqual(const ASTNode &other) const -> bool;
+
     /**
      * Check type of the AST node.
      * @param environment The current type environment.
@@ -111,6 +138,44 @@ class AST {
      */
     auto GenerateCode(const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) const -> std::string;
 
+    // The rules of TypeCheck for each node type, given the types of the children, so a caller can check a
+    // program without building its AST. Each rule reports an error to the diagnostics and sets has_bug.
+    static auto CheckAssign(const std::string &target, Type value, const std::shared_ptr<TypeEnvironment> &environment,
+                            bool &has_bug) -> Type;
+    static auto CheckIdentifier(const std::string &name, const std::shared_ptr<TypeEnvironment> &environment,
+                                bool &has_bug) -> Type;
+    static auto CheckPlus(Type left, Type right, bool &has_bug) -> Type;
+    static auto CheckTimes(Type left, Type right, bool &has_bug) -> Type;
+
+    // The templates of GenerateCode for each node type, given the code and runtime types of the children. A slot is
+    // the frame offset of a variable as text; the code of an expression leaves its value in $a0.
+    static auto EmitProgram(const std::string &body, const std::shared_ptr<cgen::RuntimeEnvironment> &runtime)
+        -> std::string;
+    static auto EmitAssign(const std::string &target, const std::string &value, const std::string &value_code,
+                           Type value_type, const std::string &slot,
+                           const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string;
+    static auto EmitNumber(const std::string &value) -> std::string;
+    static auto EmitString(const std::string &literal, const std::shared_ptr<cgen::RuntimeEnvironment> &runtime)
+        -> std::string;
+    static auto EmitBinary(ASTNodeType type, const std::string &left_code, Type left_type,
+                           const std::string &right_code, Type right_type,
+                           const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string;
+    // EmitBinary in two parts, to append the code of a chain in place: the push of the left operand, emitted between
+    // the operands, and the operation, emitted after them.
+    static auto EmitPushOperand() -> std::string;
+    static auto EmitOperation(ASTNodeType type, Type left_type, Type right_type,
+                              const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string;
+    static auto EmitIdentifier(const std::string &name, const std::string &slot,
+                               const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string;
+
+    /**
+     * Get the runtime type of a + or * expression, a string if either operand is one.
+     * @param left The runtime type of the left operand.
+     * @param right The runtime type of the right operand.
+     * @return The runtime type of the expression.
+     */
+    static auto GetBinaryRuntimeType(Type left, Type right) -> Type;
+
    private:
     /* The value of the AST node */
     std::string value_;
@@ -118,9 +183,11 @@ class AST {
     ASTNodeType type_;
     /* The children of the AST node */
     std::list<std::shared_ptr<ASTNode>> children_;
+    /* The runtime type of a + or * expression once computed, so code generation of a chain stays linear */
+    mutable Type runtime_type_{Type::UNDEFINED};
 
     /**
-     * Determine the runtime type of an expression for code generation.
+     * Determine the runtime type of an expression for code generation, memoized for + and * expressions.
      * @param runtime The runtime environment.
      * @return The runtime type of the expression.
      */
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ostream>
+
+namespace scp::core {
+
+/**
+ * Get the stream the compiler phases write their diagnostics to.
+ * Each thread has its own sink, std::cerr unless redirected, so concurrent compilations keep their messages apart.
+ * @return The diagnostic stream of the calling thread.
+ */
+auto Diagnostics() -> std::ostream &;
+
+/**
+ * Redirect the diagnostics of the calling thread for the lifetime of the object.
+ */
+class DiagnosticCapture {
+ public:
+  /**
+   * Constructor for the DiagnosticCapture.
+   * @param sink The stream receiving the diagnostics of this thread.
+   */
+  explicit DiagnosticCapture(std::ostream &sink);
+
+  /**
+   * Destructor for the DiagnosticCapture, restoring the previous sink.
+   */
+  ~DiagnosticCapture();
+
+  DiagnosticCapture(const DiagnosticCapture &) = delete;
+  auto operator=(const DiagnosticCapture &) -> DiagnosticCapture & = delete;
+
+ private:
+  /* The sink active before this capture */
+  std::ostream *previous_;
+};
+
+}  // namespace scp::core
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace scp::core {
+
+/**
+ * Hash of strings that also takes string views and string literals, so a table keyed by std::string can be probed
+ * without building a key.
+ */
+struct StringHash {
+  using is_transparent = void;
+  auto operator()(std::string_view value) const -> size_t { return std::hash<std::string_view>{}(value); }
+};
+
+/**
+ * The hash a flat table uses by default: StringHash for strings, std::hash otherwise.
+ */
+template <typename Key>
+struct DefaultFlatHash {
+  using type = std::hash<Key>;
+};
+
+template <>
+struct DefaultFlatHash<std::string> {
+  using type = StringHash;
+};
+
+namespace detail {
+
+/**
+ * Open addressing hash table with Robin Hood linear probing, the storage of FlatHashMap and FlatHashSet.
+ *
+ * Entries live in one array and a 32-bit tag per slot in another: the probe distance of the entry plus one in the
+ * low byte, 0 for an empty slot, and the top 24 bits of the mixed hash above it. A lookup walks the tags of the run
+ * and compares keys only where the whole tag matches, and growing the table places the entries by their tags
+ * without hashing the keys again. An insert keeps each run sorted by probe distance by shifting the richer entries
+ * right by one, and an erase shifts the entries after it back, so no tombstones build up. Inserting and erasing
+ * move entries and invalidate iterators and references.
+ *
+ * The member names follow the standard containers so the tables can stand in for them.
+ *
+ * @tparam Key The key type.
+ * @tparam Entry The stored type, the key itself or a pair holding it first.
+ * @tparam KeyOf Gets the key of an entry.
+ * @tparam Hash The hash, which may take other types than Key if it defines is_transparent.
+ * @tparam Equal The key comparison.
+ */
+template <typename Key, typename Entry, typename KeyOf, typename Hash, typename Equal>
+class FlatTable {
+  static_assert(alignof(Entry) <= alignof(std::max_align_t), "FlatTable does not over-align its entries");
+
+ public:
+  /**
+   * Iterator over the entries, in slot order.
+   */
+  template <bool CONST>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<CONST, const Entry *, Entry *>;
+    using reference = std::conditional_t<CONST, const Entry &, Entry &>;
+    using Table = std::conditional_t<CONST, const FlatTable, FlatTable>;
+
+    Iterator() = default;
+    Iterator(Table *table, size_t index) : table_(table), index_(index) {}
+    // A mutable iterator converts to a constant one
+    template <bool OTHER, typename = std::enable_if_t<CONST && !OTHER>>
+    Iterator(const Iterator<OTHER> &other) : table_(other.table_), index_(other.index_) {}  // NOLINT
+
+    auto operator*() const -> reference { return table_->entries_[index_]; }
+    auto operator->() const -> pointer { return &table_->entries_[index_]; }
+    auto operator++() -> Iterator & {
+      index_ = table_->NextOccupied(index_ + 1);
+      return *this;
+    }
+    auto operator++(int) -> Iterator {
+      Iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+    auto operator==(const Iterator &other) const -> bool { return index_ == other.index_; }
+    auto operator!=(const Iterator &other) const -> bool { return index_ != other.index_; }
+
+   private:
+    template <bool>
+    friend class Iterator;
+
+    /* The table */
+    Table *table_{nullptr};
+    /* The slot, the capacity at the end */
+    size_t index_{0};
+  };
+
+  using key_type = Key;
+  using value_type = Entry;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = Equal;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  FlatTable() = default;
+
+  FlatTable(std::initializer_list<Entry> entries) { insert(entries.begin(), entries.end()); }
+
+  FlatTable(const FlatTable &other) { CopyFrom(other); }
+
+  FlatTable(FlatTable &&other) noexcept { Steal(other); }
+
+  auto operator=(const FlatTable &other) -> FlatTable & {
+    if (this != &other) {
+      Free();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  auto operator=(FlatTable &&other) noexcept -> FlatTable & {
+    if (this != &other) {
+      Free();
+      Steal(other);
+    }
+    return *this;
+  }
+
+  auto operator=(std::initializer_list<Entry> entries) -> FlatTable & {
+    clear();
+    insert(entries.begin(), entries.end());
+    return *this;
+  }
+
+  ~FlatTable() { Free(); }
+
+  auto begin() -> iterator { return {this, NextOccupied(0)}; }
+  auto begin() const -> const_iterator { return {this, NextOccupied(0)}; }
+  auto end() -> iterator { return {this, capacity_}; }
+  auto end() const -> const_iterator { return {this, capacity_}; }
+
+  auto size() const -> size_t { return size_; }
+  auto empty() const -> bool { return size_ == 0; }
+
+  /**
+   * Find the entry of a key.
+   * @param key The key, or a value the hash and comparison take alongside keys.
+   * @return The entry, or end() if there is none.
+   */
+  template <typename K>
+  auto find(const K &key) -> iterator {
+    return {this, FindIndex(key, MixedHashOf(key))};
+  }
+  template <typename K>
+  auto find(const K &key) const -> const_iterator {
+    return {this, FindIndex(key, MixedHashOf(key))};
+  }
+
+  template <typename K>
+  auto count(const K &key) const -> size_t {
+    return contains(key) ? 1 : 0;
+  }
+
+  template <typename K>
+  auto contains(const K &key) const -> bool {
+    return FindIndex(key, MixedHashOf(key)) != capacity_;
+  }
+
+  auto insert(const Entry &entry) -> std::pair<iterator, bool> { return emplace(entry); }
+  auto insert(Entry &&entry) -> std::pair<iterator, bool> { return emplace(std::move(entry)); }
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      emplace(*first);
+    }
+  }
+
+  /**
+   * Build an entry and insert it unless its key is present.
+   * @param args The arguments of the entry constructor.
+   * @return The entry of the key and whether it was inserted.
+   */
+  template <typename... Args>
+  auto emplace(Args &&...args) -> std::pair<iterator, bool> {
+    Entry entry(std::forward<Args>(args)...);
+    uint64_t mixed = MixedHashOf(KeyOf{}(entry));
+    size_t index = FindIndex(KeyOf{}(entry), mixed);
+    if (index != capacity_) {
+      return {{this, index}, false};
+    }
+    return {{this, Insert(std::move(entry), mixed)}, true};
+  }
+
+  /**
+   * Erase the entry of a key.
+   * @param key The key.
+   * @return The number of entries erased.
+   */
+  template <typename K>
+  auto erase(const K &key) -> size_t {
+    size_t index = FindIndex(key, MixedHashOf(key));
+    if (index == capacity_) {
+      return 0;
+    }
+    EraseAt(index);
+    return 1;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (tags_[i] != 0) {
+        entries_[i].~Entry();
+        tags_[i] = 0;
+      }
+    }
+    size_ = 0;
+  }
+
+  /**
+   * Make room for entries without growing again.
+   * @param count The number of entries.
+   */
+  void reserve(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity * MAX_LOAD_NUMERATOR < count * MAX_LOAD_DENOMINATOR) {
+      capacity *= 2;
+    }
+    if (capacity > capacity_) {
+      Rehash(capacity);
+    }
+  }
+
+ protected:
+  // Hash a key and spread the bits over the top ones, which pick the slot; std::hash of an integer is the integer
+  template <typename K>
+  auto MixedHashOf(const K &key) const -> uint64_t {
+    return static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+  }
+
+  auto GetCapacity() const -> size_t { return capacity_; }
+
+  /**
+   * Find the slot of a key.
+   * @param key The key.
+   * @param mixed The mixed hash of the key.
+   * @return The slot, or the capacity if the key is absent.
+   */
+  template <typename K>
+  auto FindIndex(const K &key, uint64_t mixed) const -> size_t {
+    if (capacity_ == 0) {
+      return 0;
+    }
+    size_t index = mixed >> shift_;
+    uint32_t tag = ToTag(mixed);
+    // A run holds its entries by rising distance, so the key is not past a slot closer to its home than it would be
+    while (Distance(tags_[index]) >= Distance(tag)) {
+      if (tags_[index] == tag && equal_(KeyOf{}(entries_[index]), key)) {
+        return index;
+      }
+      index = (index + 1) & (capacity_ - 1);
+      tag++;
+    }
+    return capacity_;
+  }
+
+  /**
+   * Insert an entry whose key is absent, growing the table first if needed.
+   * @param entry The entry.
+   * @param mixed The mixed hash of its key.
+   * @return Its slot.
+   */
+  auto Insert(Entry &&entry, uint64_t mixed) -> size_t {
+    if ((size_ + 1) * MAX_LOAD_DENOMINATOR > capacity_ * MAX_LOAD_NUMERATOR) {
+      Rehash(capacity_ == 0 ? MIN_CAPACITY : capacity_ * 2);
+    }
+    size_t index = Place(entry, mixed);
+    if (index == capacity_) {
+      // A run too long for the distance bytes; spreading the keys over more slots shortens it
+      Rehash(capacity_ * 2);
+      index = Place(entry, mixed);
+      if (index == capacity_) {
+        throw std::length_error("FlatHashMap: too many keys with the same hash");
+      }
+    }
+    return index;
+  }
+
+ private:
+  /* The capacity of a table's first allocation, a power of two */
+  static constexpr size_t MIN_CAPACITY = 16;
+  /* The table grows before more than 7/8 of the slots are full */
+  static constexpr size_t MAX_LOAD_NUMERATOR = 7;
+  static constexpr size_t MAX_LOAD_DENOMINATOR = 8;
+  /* The largest probe distance plus one a tag can record */
+  static constexpr uint32_t MAX_DISTANCE = 255;
+  /* The bits of the mixed hash a tag keeps */
+  static constexpr int FRAGMENT_BITS = 24;
+
+  // The tag of an entry in its home slot
+  static auto ToTag(uint64_t mixed) -> uint32_t {
+    return static_cast<uint32_t>(mixed >> (64 - FRAGMENT_BITS)) << 8 | 1;
+  }
+
+  static auto Distance(uint32_t tag) -> uint32_t { return tag & 0xFF; }
+
+  auto NextOccupied(size_t index) const -> size_t {
+    while (index < capacity_ && tags_[index] == 0) {
+      index++;
+    }
+    return index;
+  }
+
+  /**
+   * Put an entry into the slot its distance earns, shifting the richer entries of the run right by one.
+   * @param entry The entry, moved from unless the run is too long.
+   * @param mixed The mixed hash of its key.
+   * @return Its slot, or the capacity if a distance would not fit in a byte.
+   */
+  auto Place(Entry &entry, uint64_t mixed) -> size_t {
+    size_t mask = capacity_ - 1;
+    size_t index = mixed >> shift_;
+    uint32_t tag = ToTag(mixed);
+    while (Distance(tags_[index]) >= Distance(tag)) {
+      index = (index + 1) & mask;
+      if (Distance(++tag) == MAX_DISTANCE) {
+        return capacity_;
+      }
+    }
+    size_t empty = index;
+    while (tags_[empty] != 0) {
+      if (Distance(tags_[empty]) == MAX_DISTANCE - 1) {
+        return capacity_;
+      }
+      empty = (empty + 1) & mask;
+    }
+
+    if (empty != index) {
+      size_t previous = (empty - 1) & mask;
+      new (&entries_[empty]) Entry(std::move(entries_[previous]));
+      tags_[empty] = tags_[previous] + 1;
+      for (size_t slot = previous; slot != index; slot = previous) {
+        previous = (slot - 1) & mask;
+        entries_[slot] = std::move(entries_[previous]);
+        tags_[slot] = tags_[previous] + 1;
+      }
+      entries_[index] = std::move(entry);
+    } else {
+      new (&entries_[index]) Entry(std::move(entry));
+    }
+    tags_[index] = tag;
+    size_++;
+    return index;
+  }
+
+  void EraseAt(size_t index) {
+    size_t mask = capacity_ - 1;
+    entries_[index].~Entry();
+    // Entries after it move back one slot until one is at its home or the run ends
+    for (size_t next = (index + 1) & mask; Distance(tags_[next]) > 1; next = (next + 1) & mask) {
+      new (&entries_[index]) Entry(std::move(entries_[next]));
+      entries_[next].~Entry();
+      tags_[index] = tags_[next] - 1;
+      index = next;
+    }
+    tags_[index] = 0;
+    size_--;
+  }
+
+  void Allocate(size_t capacity) {
+    capacity_ = capacity;
+    shift_ = 64;
+    for (size_t bits = capacity; bits > 1; bits /= 2) {
+      shift_--;
+    }
+    // One block holds the tags and then the entries; MIN_CAPACITY tags keep the entries aligned
+    tags_ = static_cast<uint32_t *>(::operator new(capacity * (sizeof(uint32_t) + sizeof(Entry))));
+    entries_ = reinterpret_cast<Entry *>(tags_ + capacity);
+    std::fill(tags_, tags_ + capacity, 0);
+  }
+
+  void Rehash(size_t capacity) {
+    Entry *entries = entries_;
+    uint32_t *tags = tags_;
+    size_t old_capacity = capacity_;
+    Allocate(capacity);
+    size_ = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (tags[i] == 0) {
+        continue;
+      }
+      // The fragment of a tag is the top of the mixed hash, which is all a table of up to 2^24 slots indexes by
+      uint64_t mixed = 64 - shift_ <= FRAGMENT_BITS ? static_cast<uint64_t>(tags[i] >> 8) << (64 - FRAGMENT_BITS)
+                                                    : MixedHashOf(KeyOf{}(entries[i]));
+      if (Place(entries[i], mixed) == capacity_) {
+        throw std::length_error("FlatHashMap: too many keys with the same hash");
+      }
+      entries[i].~Entry();
+    }
+    ::operator delete(tags);
+  }
+
+  void CopyFrom(const FlatTable &other) {
+    if (other.capacity_ == 0) {
+      return;
+    }
+    Allocate(other.capacity_);
+    for (size_t i = 0; i < capacity_; i++) {
+      if (other.tags_[i] != 0) {
+        new (&entries_[i]) Entry(other.entries_[i]);
+        tags_[i] = other.tags_[i];
+      }
+    }
+    size_ = other.size_;
+  }
+
+  void Steal(FlatTable &other) {
+    entries_ = std::exchange(other.entries_, nullptr);
+    tags_ = std::exchange(other.tags_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    size_ = std::exchange(other.size_, 0);
+    shift_ = other.shift_;
+  }
+
+  void Free() {
+    if (tags_ == nullptr) {
+      return;
+    }
+    clear();
+    ::operator delete(tags_);
+    tags_ = nullptr;
+    entries_ = nullptr;
+    capacity_ = 0;
+  }
+
+  /* The slots, constructed where the tag is not 0 */
+  Entry *entries_{nullptr};
+  /* The tag of each slot: the top bits of the mixed hash over the probe distance plus one, 0 if the slot is empty */
+  uint32_t *tags_{nullptr};
+  /* The number of slots, 0 or a power of two */
+  size_t capacity_{0};
+  /* The number of entries */
+  size_t size_{0};
+  /* 64 minus the bits of a slot index */
+  int shift_{64};
+  /* The hash */
+  Hash hash_;
+  /* The key comparison */
+  Equal equal_;
+};
+
+/* Gets the key of a map entry */
+struct FirstOf {
+  template <typename Pair>
+  auto operator()(const Pair &pair) const -> const typename Pair::first_type & {
+    return pair.first;
+  }
+};
+
+/* Gets the key of a set entry, the entry itself */
+struct Self {
+  template <typename Key>
+  auto operator()(const Key &key) const -> const Key & {
+    return key;
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Hash map with open addressing, a drop-in for std::unordered_map where nothing holds on to entries across inserts.
+ * Entries are stored inline rather than one allocation each, so a lookup touches one or two cache lines. Maps keyed
+ * by std::string take std::string_view and string literal keys in find, count and erase.
+ *
+ * The entries are std::pair<Key, Value>; the key of an entry must not be changed.
+ */
+template <typename Key, typename Value, typename Hash = typename DefaultFlatHash<Key>::type,
+          typename Equal = std::equal_to<>>
+class FlatHashMap : public detail::FlatTable<Key, std::pair<Key, Value>, detail::FirstOf, Hash, Equal> {
+  using Base = detail::FlatTable<Key, std::pair<Key, Value>, detail::FirstOf, Hash, Equal>;
+
+ public:
+  using mapped_type = Value;
+  using Base::Base;
+  using Base::operator=;
+
+  /**
+   * Get the value of a key, inserting a default value if it is absent.
+   * @param key The key.
+   * @return The value.
+   */
+  template <typename K>
+  auto operator[](K &&key) -> Value & {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+
+  /**
+   * Get the value of a key that must be present.
+   * @param key The key.
+   * @return The value.
+   */
+  template <typename K>
+  auto at(const K &key) -> Value & {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("FlatHashMap::at: key not found");
+    }
+    return it->second;
+  }
+  template <typename K>
+  auto at(const K &key) const -> const Value & {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("FlatHashMap::at: key not found");
+    }
+    return it->second;
+  }
+
+  /**
+   * Insert a value built from arguments unless the key is present, building nothing if it is.
+   * @param key The key.
+   * @param args The arguments of the value constructor.
+   * @return The entry of the key and whether it was inserted.
+   */
+  template <typename K, typename... Args>
+  auto try_emplace(K &&key, Args &&...args) -> std::pair<typename Base::iterator, bool> {
+    uint64_t mixed = this->MixedHashOf(key);
+    size_t index = this->FindIndex(key, mixed);
+    if (index != this->GetCapacity()) {
+      return {{this, index}, false};
+    }
+    std::pair<Key, Value> entry(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    return {{this, this->Insert(std::move(entry), mixed)}, true};
+  }
+};
+
+/**
+ * Hash set with open addressing, a drop-in for std::unordered_set; see FlatHashMap.
+ */
+template <typename Key, typename Hash = typename DefaultFlatHash<Key>::type, typename Equal = std::equal_to<>>
+class FlatHashSet : public detail::FlatTable<Key, Key, detail::Self, Hash, Equal> {
+  using Base = detail::FlatTable<Key, Key, detail::Self, Hash, Equal>;
+
+ public:
+  using Base::Base;
+  using Base::operator=;
+};
+
+}  // namespace scp::core
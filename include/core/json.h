@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace scp::core {
+
+/**
+ * Quote a string as a JSON string literal, escaping quotes, backslashes and control characters.
+ * @param text The string.
+ * @return The literal, including the surrounding quotes.
+ */
+auto JsonQuote(const std::string &text) -> std::string;
+
+/**
+ * A parsed JSON document, for reading back the reports and benchmark results the tools write.
+ */
+class JsonValue {
+ public:
+  /**
+   * The kinds of JSON values.
+   */
+  enum class Kind {
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT,
+  };
+
+  /**
+   * Parse a JSON document.
+   * @param text The document.
+   * @return The root value.
+   * @throws std::runtime_error If the document is not valid JSON.
+   */
+  static auto Parse(const std::string &text) -> JsonValue;
+
+  /**
+   * Get the kind of the value.
+   * @return The kind.
+   */
+  auto GetKind() const -> Kind { return kind_; }
+
+  /**
+   * Get the value of a boolean.
+   * @return The value, false for other kinds.
+   */
+  auto AsBoolean() const -> bool { return boolean_; }
+
+  /**
+   * Get the value of a number.
+   * @return The value, 0 for other kinds.
+   */
+  auto AsNumber() const -> double { return number_; }
+
+  /**
+   * Get the value of a string.
+   * @return The unescaped string, empty for other kinds.
+   */
+  auto AsString() const -> const std::string & { return string_; }
+
+  /**
+   * Get the elements of an array.
+   * @return The elements, empty for other kinds.
+   */
+  auto AsArray() const -> const std::vector<JsonValue> & { return array_; }
+
+  /**
+   * Get the members of an object in document order.
+   * @return The members, empty for other kinds.
+   */
+  auto AsObject() const -> const std::vector<std::pair<std::string, JsonValue>> & { return object_; }
+
+  /**
+   * Find a member of an object.
+   * @param key The key of the member.
+   * @return The first member with that key, or nullptr if there is none or the value is not an object.
+   */
+  auto Find(const std::string &key) const -> const JsonValue *;
+
+ private:
+  /* The kind of the value */
+  Kind kind_{Kind::NULL_VALUE};
+  /* The value of a boolean */
+  bool boolean_{false};
+  /* The value of a number */
+  double number_{0};
+  /* The value of a string */
+  std::string string_;
+  /* The elements of an array */
+  std::vector<JsonValue> array_;
+  /* The members of an object */
+  std::vector<std::pair<std::string, JsonValue>> object_;
+
+  friend class JsonReader;
+};
+
+}  // namespace scp::core
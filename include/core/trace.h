@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace scp::core {
+
+/**
+ * Process-wide recorder of Chrome trace events (the JSON format read by chrome://tracing and Perfetto).
+ * Recording is off until Start; scopes opened while it is off cost one atomic load.
+ */
+class Trace {
+ public:
+  /**
+   * Discard earlier events and start recording.
+   */
+  static void Start();
+
+  /**
+   * Stop recording.
+   */
+  static void Stop();
+
+  /**
+   * Check whether events are being recorded.
+   * @return True while recording.
+   */
+  static auto IsEnabled() -> bool;
+
+  /**
+   * Record a complete event on the calling thread.
+   * @param name The name of the event, a string literal.
+   * @param detail Shown as the "detail" argument of the event if not empty.
+   * @param begin The start of the event.
+   * @param end The end of the event.
+   */
+  static void Record(const char *name, const std::string &detail, std::chrono::steady_clock::time_point begin,
+                     std::chrono::steady_clock::time_point end);
+
+  /**
+   * Render the recorded events as a Chrome trace.
+   * @return The JSON text.
+   */
+  static auto ToJson() -> std::string;
+
+  /**
+   * Write the recorded events to a file.
+   * @param path The path of the file.
+   * @return False if the file cannot be written.
+   */
+  static auto Write(const std::string &path) -> bool;
+};
+
+/**
+ * Record the lifetime of a scope as one trace event. Use it through SCP_TRACE_SCOPE.
+ */
+class TraceScope {
+ public:
+  /**
+   * Constructor for the TraceScope, starting the event if recording.
+   * @param name The name of the event, a string literal.
+   * @param detail Shown as the "detail" argument of the event if not empty.
+   */
+  explicit TraceScope(const char *name, std::string detail = {});
+
+  /**
+   * Destructor for the TraceScope, recording the event.
+   */
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  auto operator=(const TraceScope &) -> TraceScope & = delete;
+
+ private:
+  /* The name of the event, nullptr when not recording */
+  const char *name_;
+  /* The detail argument of the event */
+  std::string detail_;
+  /* The start of the event */
+  std::chrono::steady_clock::time_point begin_;
+};
+
+/**
+ * Record trace events for the lifetime of the object and write them to a file at its end.
+ */
+class TraceSession {
+ public:
+  /**
+   * Constructor for the TraceSession, starting the recording.
+   * @param path The path of the trace file.
+   */
+  explicit TraceSession(std::string path);
+
+  /**
+   * Destructor for the TraceSession, stopping the recording and writing the file.
+   */
+  ~TraceSession();
+
+  TraceSession(const TraceSession &) = delete;
+  auto operator=(const TraceSession &) -> TraceSession & = delete;
+
+ private:
+  /* The path of the trace file */
+  std::string path_;
+};
+
+}  // namespace scp::core
+
+#define SCP_TRACE_CONCAT_INNER(a, b) a##b
+#define SCP_TRACE_CONCAT(a, b) SCP_TRACE_CONCAT_INNER(a, b)
+
+// Trace the enclosing scope; without SCP_ENABLE_TRACING (CMake option of the same name) the macros compile to nothing
+#ifdef SCP_ENABLE_TRACING
+#define SCP_TRACE_SCOPE(name) ::scp::core::TraceScope SCP_TRACE_CONCAT(scp_trace_scope_, __LINE__)(name)
+#define SCP_TRACE_SCOPE_DETAIL(name, detail) \
+  ::scp::core::TraceScope SCP_TRACE_CONCAT(scp_trace_scope_, __LINE__)(name, detail)
+#else
+#define SCP_TRACE_SCOPE(name) static_cast<void>(0)
+#define SCP_TRACE_SCOPE_DETAIL(name, detail) static_cast<void>(0)
+#endif
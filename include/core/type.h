@@ -3,7 +3,9 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace scp::core {
 
@@ -68,7 +70,7 @@ class TypeEnvironment {
     void AddSymbol(const std::string &name, Type type);
 
     /**
-     * Find a symbol in the table.
+     * Find the most recently added symbol of a name in the table, in constant time.
      * @param name The name of the symbol to find.
      * @param symbol The Symbol object to fill if found.
      * @return True if the symbol is found, false otherwise.
@@ -81,9 +83,17 @@ class TypeEnvironment {
      */
     auto PopSymbol() -> std::shared_ptr<Symbol>;
 
+    /**
+     * Get the number of symbols in the table.
+     * @return The number of symbols.
+     */
+    auto GetSize() const -> size_t { return symbol_stack_.size(); }
+
    private:
     // Internal storage for symbols
     std::stack<Symbol> symbol_stack_;
+    // The types each name was added with, the innermost last, so a lookup does not walk the stack
+    std::unordered_map<std::string, std::vector<Type>> symbol_index_;
   };
 
   /**
@@ -110,6 +120,12 @@ class TypeEnvironment {
    */
   auto GetSymbolTable() const -> std::shared_ptr<SymbolTable> { return std::make_shared<SymbolTable>(symbol_table_); }
 
+  /**
+   * Get the number of symbols defined, including the standard streams.
+   * @return The number of symbols.
+   */
+  auto GetSymbolCount() const -> size_t { return symbol_table_.GetSize(); }
+
  private:
   /* The current symbol table */
   SymbolTable symbol_table_;
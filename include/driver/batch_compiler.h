@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "driver/compilation_cache.h"
+#include "driver/compiler.h"
+
+namespace scp::driver {
+
+/**
+ * The outcome of compiling one file of a batch.
+ */
+struct BatchResult {
+  /* The source file */
+  std::string input_;
+  /* The assembly file written */
+  std::string output_;
+  /* Whether the file compiled and its output was written, or the file was empty and nothing was written */
+  bool success_{false};
+  /* Whether the output came from the compilation cache */
+  bool cached_{false};
+  /* The diagnostics of this file alone */
+  std::string diagnostics_;
+};
+
+/**
+ * Compiles many source files concurrently on a work-stealing thread pool.
+ * The files share one Compiler session, so its parsers and lexer automata are built once per worker and reused
+ * for every file, and the per-file setup cost of separate scpc runs disappears. Diagnostics are
+ * captured per file, so messages of concurrent compilations never interleave.
+ */
+class BatchCompiler {
+ public:
+  /**
+   * Constructor for the BatchCompiler.
+   * @param options The code generator options of every file.
+   * @param jobs The number of worker threads.
+   * @param cache The compilation cache, or nullptr to always compile.
+   */
+  BatchCompiler(cgen::CodeGeneratorOptions options, size_t jobs, CompilationCache *cache = nullptr);
+
+  /**
+   * Destructor for the BatchCompiler.
+   */
+  ~BatchCompiler() = default;
+
+  /**
+   * Compile every input.
+   * @param inputs The source files.
+   * @param output_dir The directory for the .s files, or empty to write each next to its source.
+   * @return One result per input, in input order.
+   */
+  auto Compile(const std::vector<std::string> &inputs, const std::string &output_dir) -> std::vector<BatchResult>;
+
+  /**
+   * Read a response file listing one source file per line. Blank lines and lines starting with '#' are skipped.
+   * @param path The response file.
+   * @return The source files.
+   */
+  static auto ReadResponseFile(const std::string &path) -> std::vector<std::string>;
+
+  /**
+   * Get the assembly file a source file compiles to.
+   * @param input The source file.
+   * @param output_dir The output directory, or empty for the source's directory.
+   * @return The path of the .s file.
+   */
+  static auto GetOutputPath(const std::string &input, const std::string &output_dir) -> std::string;
+
+ private:
+  /**
+   * Compile one file.
+   * @param result The result to fill, with input and output already set.
+   */
+  void CompileOne(BatchResult &result);
+
+  /* The code generator options of every file */
+  cgen::CodeGeneratorOptions options_;
+  /* The number of worker threads */
+  size_t jobs_;
+  /* The session shared by the workers */
+  Compiler compiler_;
+};
+
+}  // namespace scp::driver
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "cgen/object_unit.h"
+
+namespace scp::driver {
+
+/**
+ * The compiler state after compiling a source that only grows at its end. The statements compiled so far are kept
+ * as one object unit: its exports are the type environment in frame slot order, its literals the string pool and
+ * its read loop count the label counter. A later compile checks that the source still starts with the same bytes
+ * and compiles only what follows them, see CompileIncremental.
+ */
+struct Checkpoint {
+  /* First line of a serialized checkpoint, naming the format version */
+  static constexpr const char *MAGIC = "SCPCHECKPOINT 1";
+
+  /* The length of the compiled prefix, which ends with the line of its last statement */
+  size_t offset_{0};
+  /* The line number at offset_, so diagnostics of the rest name the lines of the whole source */
+  int line_{1};
+  /* The statements of the prefix; its key identifies the prefix bytes, the compiler and the string runtime */
+  cgen::ObjectUnit unit_;
+
+  /**
+   * Serialize the checkpoint.
+   * @return The bytes of a checkpoint file.
+   */
+  auto Serialize() const -> std::string;
+
+  /**
+   * Parse a serialized checkpoint.
+   * @param bytes The bytes of a checkpoint file.
+   * @return The checkpoint.
+   * @throws std::runtime_error if the bytes are not a checkpoint of this format.
+   */
+  static auto Deserialize(const std::string &bytes) -> Checkpoint;
+};
+
+}  // namespace scp::driver
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+#include "cgen/code_generator.h"
+
+namespace scp::driver {
+
+/**
+ * Hit and miss counters of a cache directory, accumulated over every compiler run that used it.
+ */
+struct CacheStats {
+  /* Number of lookups answered from the cache */
+  uint64_t hits_{0};
+  /* Number of lookups that had to compile */
+  uint64_t misses_{0};
+  /* Number of artifacts stored */
+  uint64_t entries_{0};
+  /* Total size of the stored artifacts in bytes */
+  uint64_t bytes_{0};
+};
+
+/**
+ * Content-addressed store of compiler outputs.
+ * An artifact is keyed by a SHA-256 digest of the source bytes, the compiler identity and the options, so a hit can
+ * skip the whole pipeline. Entries are written to a temporary file and renamed into place, so concurrent compilers
+ * never observe a partial artifact. Reading an entry refreshes its modification time, and when the directory
+ * grows beyond its size limit the least recently used entries are removed. The size of the directory is kept in its
+ * stats file next to the hit and miss counters; a store adds to a running estimate of it and scans the directory
+ * only when the estimate passes the limit or is unknown. Counters and size changes stay in memory until Flush.
+ */
+class CompilationCache {
+ public:
+  /**
+   * Constructor for the CompilationCache.
+   * @param directory The cache directory, created on first store.
+   * @param max_bytes The size limit of the stored artifacts.
+   */
+  explicit CompilationCache(std::filesystem::path directory, uint64_t max_bytes = DEFAULT_MAX_BYTES);
+
+  /**
+   * Destructor for the CompilationCache, flushing the counters.
+   */
+  ~CompilationCache();
+
+  CompilationCache(const CompilationCache &) = delete;
+  auto operator=(const CompilationCache &) -> CompilationCache & = delete;
+
+  /**
+   * Compute the key of a compilation.
+   * @param source The source bytes.
+   * @param compiler The compiler identity, see GetCompilerIdentity.
+   * @param options A canonical rendering of every option that affects the output.
+   * @return The key as 64 hex digits.
+   */
+  static auto MakeKey(const std::string &source, const std::string &compiler, const std::string &options)
+      -> std::string;
+
+  /**
+   * Render every code generator option that affects the output, for use in a key.
+   * @param options The code generator options.
+   * @return The canonical rendering.
+   */
+  static auto DescribeOptions(const cgen::CodeGeneratorOptions &options) -> std::string;
+
+  /**
+   * Identify the running compiler build: its version plus the size and modification time of its executable.
+   * @return The identity.
+   */
+  static auto GetCompilerIdentity() -> std::string;
+
+  /**
+   * Get the default cache directory: $SCP_CACHE_DIR, else $XDG_CACHE_HOME/scp, else $HOME/.cache/scp.
+   * @return The directory, or an empty path if none can be determined.
+   */
+  static auto GetDefaultDirectory() -> std::filesystem::path;
+
+  /**
+   * Look up an artifact and count the hit or miss in memory.
+   * @param key The key of the compilation.
+   * @param artifact The stored artifact, on a hit.
+   * @return True on a hit.
+   */
+  auto Lookup(const std::string &key, std::string &artifact) -> bool;
+
+  /**
+   * Store an artifact atomically, then evict entries beyond the size limit. Safe to call from several threads.
+   * @param key The key of the compilation.
+   * @param artifact The artifact.
+   */
+  void Store(const std::string &key, const std::string &artifact);
+
+  /**
+   * Add the hits, misses and size changes counted since the last flush to the stats file of the directory.
+   */
+  void Flush();
+
+  /**
+   * Get the accumulated statistics of the cache directory, including the counts not yet flushed.
+   * @return The statistics.
+   */
+  auto GetStats() const -> CacheStats;
+
+  /* Default size limit of a cache directory, 64 MiB */
+  static constexpr uint64_t DEFAULT_MAX_BYTES = 64ULL << 20;
+
+ private:
+  /**
+   * Get the path of an entry.
+   * @param key The key.
+   * @return The path, sharded by the first two hex digits.
+   */
+  auto EntryPath(const std::string &key) const -> std::filesystem::path;
+
+  /**
+   * Remove the least recently used entries until the cache fills at most nine tenths of its size limit, so the
+   * next scan is many stores away. Called with mutex_ held.
+   */
+  void Evict();
+
+  /* The cache directory */
+  std::filesystem::path directory_;
+  /* The size limit of the stored artifacts */
+  uint64_t max_bytes_;
+  /* Lookups answered from the cache since the last flush */
+  std::atomic<uint64_t> pending_hits_{0};
+  /* Lookups that missed since the last flush */
+  std::atomic<uint64_t> pending_misses_{0};
+  /* Serializes the size estimate, eviction and flushes between threads of this process */
+  std::mutex mutex_;
+  /* Whether known_bytes_ holds the size of the directory, read from the stats file or scanned */
+  bool size_known_{false};
+  /* Whether known_bytes_ came from a scan, so a flush writes it instead of adding pending_bytes_ to the file */
+  bool size_scanned_{false};
+  /* The size of the directory when it was last read or scanned */
+  uint64_t known_bytes_{0};
+  /* Bytes stored minus bytes evicted since then */
+  int64_t pending_bytes_{0};
+};
+
+}  // namespace scp::driver
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "cgen/code_generator.h"
+#include "cgen/object_unit.h"
+#include "driver/checkpoint.h"
+#include "driver/compilation_cache.h"
+#include "parser/slr_parser.h"
+
+namespace scp::driver {
+
+/* Reported in place of compiling an empty source file; every mode writes no output for it */
+constexpr const char *EMPTY_INPUT_WARNING = "Warning: The input file is empty.";
+
+/**
+ * The outcome of compiling one source.
+ */
+struct CompileResult {
+  /* Whether the source compiled */
+  bool success_{false};
+  /* Whether the output came from the compilation cache */
+  bool cached_{false};
+  /* The number of source bytes a checkpoint spared compiling again */
+  size_t reused_bytes_{0};
+  /* The generated assembly */
+  std::string output_;
+  /* The diagnostics of this source alone */
+  std::string diagnostics_;
+};
+
+/**
+ * Read a source file the way every scpc mode does, line by line with each line ending in a newline, so a file has
+ * the same bytes, and the same cache key, whether it is compiled alone, in a batch or by the server.
+ * @param path The path of the file.
+ * @return The source.
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+auto ReadSource(const std::string &path) -> std::string;
+
+/**
+ * Run the whole pipeline on one source with a reusable parser, capturing its diagnostics.
+ * @param parser The parser to use; its tables are shared, so reusing it only saves building the lexer automata.
+ * @param name The program name, usually the file stem.
+ * @param source The source bytes.
+ * @param options The code generator options.
+ * @param cache The compilation cache, or nullptr to always compile.
+ * @return The result.
+ */
+auto CompileSource(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                   const cgen::CodeGeneratorOptions &options, CompilationCache *cache = nullptr) -> CompileResult;
+
+/**
+ * Compile a source stream statement by statement, writing the assembly as it is generated, so memory depends on the
+ * largest statement rather than on the size of the source. After a type error the remaining statements are still
+ * checked but no more code is generated, so the output is incomplete whenever the compilation fails.
+ * @param parser The parser to use.
+ * @param name The program name, usually the file stem.
+ * @param input The source stream.
+ * @param output The stream to write the assembly to.
+ * @param options The code generator options.
+ * @return The result; its output_ stays empty since the assembly went to output.
+ */
+auto CompileStream(parser::SLRParser &parser, const std::string &name, std::istream &input, std::ostream &output,
+                   const cgen::CodeGeneratorOptions &options) -> CompileResult;
+
+/**
+ * Compile one source file of a program into an object unit for cgen::Linker, capturing its diagnostics.
+ * @param parser The parser to use.
+ * @param name The program name, usually the file stem.
+ * @param source The source bytes.
+ * @param environment The variables declared by the units before this one, in declaration order.
+ * @param options The code generator options; only the string runtime matters before linking.
+ * @param unit Receives the unit on success.
+ * @return The result; its output_ stays empty.
+ */
+auto CompileUnit(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                 const cgen::ObjectUnit::Symbols &environment, const cgen::CodeGeneratorOptions &options,
+                 cgen::ObjectUnit &unit) -> CompileResult;
+
+/**
+ * Get the key of an object unit, identifying its source, the compiler and the options that matter before linking.
+ * @param source The source bytes.
+ * @param options The code generator options.
+ * @return The key.
+ */
+auto GetUnitKey(const std::string &source, const cgen::CodeGeneratorOptions &options) -> std::string;
+
+/**
+ * Compile a source that only grows at its end, resuming from the checkpoint of an earlier compile. If the source
+ * still starts with the checkpointed prefix, only the statements after it are lexed, parsed, checked and turned into
+ * code, then linked after the prefix; otherwise the whole source is compiled. The output and diagnostics equal those
+ * of CompileSource. On success the checkpoint moves to the end of the line of the last statement.
+ * @param parser The parser to use.
+ * @param name The program name, usually the file stem.
+ * @param source The source bytes.
+ * @param options The code generator options.
+ * @param checkpoint The checkpoint of the previous compile, or a default one; updated on success.
+ * @return The result.
+ */
+auto CompileIncremental(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                        const cgen::CodeGeneratorOptions &options, Checkpoint &checkpoint) -> CompileResult;
+
+}  // namespace scp::driver
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "core/ast.h"
+
+namespace scp::driver {
+
+/**
+ * The time and memory spent in one compiler phase.
+ */
+struct PhaseTime {
+  /* The name of the phase */
+  std::string name_;
+  /* Elapsed wall-clock time in seconds */
+  double wall_seconds_{0};
+  /* Processor time in seconds */
+  double cpu_seconds_{0};
+  /* Number of allocations */
+  uint64_t allocations_{0};
+  /* Number of bytes allocated */
+  uint64_t allocated_bytes_{0};
+  /* High-water mark of the live heap bytes, counting what earlier phases still hold */
+  uint64_t peak_bytes_{0};
+};
+
+/**
+ * Sizes of the intermediate and final products of one compilation.
+ */
+struct CompileStats {
+  /* Number of tokens */
+  size_t tokens_{0};
+  /* Number of parse tree nodes */
+  size_t parse_tree_nodes_{0};
+  /* Number of AST nodes */
+  size_t ast_nodes_{0};
+  /* Number of symbols, including the standard streams */
+  size_t symbols_{0};
+  /* Bytes of string literal contents, without the quotes */
+  size_t string_literal_bytes_{0};
+  /* Number of emitted instructions */
+  size_t instructions_{0};
+  /* Size of the data segment in bytes */
+  size_t data_bytes_{0};
+};
+
+/**
+ * Where the time and memory of a compilation went and how large its products were, for --time-report,
+ * --mem-report and --stats.
+ */
+struct CompileReport {
+  /**
+   * Record a phase.
+   * @param phase The time and memory of the phase.
+   */
+  void AddPhase(PhaseTime phase);
+
+  /**
+   * Count the nodes and string literal bytes of an AST into stats_.
+   * @param ast The AST.
+   */
+  void CountAST(const core::AST &ast);
+
+  /**
+   * Render the phase times as a table with a total.
+   * @return The table.
+   */
+  auto FormatTimes() const -> std::string;
+
+  /**
+   * Render the allocations of each phase as a table, followed by the peak resident set size.
+   * @return The table.
+   */
+  auto FormatMemory() const -> std::string;
+
+  /**
+   * Render the statistics, one per line.
+   * @return The statistics.
+   */
+  auto FormatStats() const -> std::string;
+
+  /**
+   * Render the report as one JSON object with a "phases" array, "peak_rss_bytes" and a "stats" object.
+   * @param times Whether to include the phase times.
+   * @param memory Whether to include the phase allocations and the peak resident set size.
+   * @param stats Whether to include the statistics.
+   * @return The JSON text.
+   */
+  auto FormatJson(bool times, bool memory, bool stats) const -> std::string;
+
+  /* The phases in the order they ran */
+  std::vector<PhaseTime> phases_;
+  /* The statistics */
+  CompileStats stats_;
+  /* Peak resident set size of the process in bytes, 0 if not measured */
+  uint64_t peak_rss_bytes_{0};
+};
+
+/**
+ * Measure a phase from construction until Stop or destruction and record it in a report, and as a trace event
+ * while a trace is recorded. Phases must not overlap, as each one restarts the process-wide high-water mark of the
+ * heap.
+ */
+class PhaseTimer {
+ public:
+  /**
+   * Constructor for the PhaseTimer, starting the clocks.
+   * @param report The report to record into, or nullptr to only trace.
+   * @param name The name of the phase, a string literal.
+   */
+  PhaseTimer(CompileReport *report, const char *name);
+
+  /**
+   * Destructor for the PhaseTimer, recording the phase unless Stop already did.
+   */
+  ~PhaseTimer() { Stop(); }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  auto operator=(const PhaseTimer &) -> PhaseTimer & = delete;
+
+  /**
+   * Stop the clocks and record the phase. Later calls do nothing.
+   */
+  void Stop();
+
+ private:
+  /* The report, may be nullptr */
+  CompileReport *report_;
+  /* The name of the phase */
+  const char *name_;
+  /* Whether a trace was being recorded at the start */
+  bool tracing_;
+  /* Whether Stop has run */
+  bool stopped_{false};
+  /* Wall-clock time at the start */
+  std::chrono::steady_clock::time_point wall_start_;
+  /* Processor time at the start */
+  std::clock_t cpu_start_;
+  /* Allocation count at the start */
+  uint64_t allocations_start_{0};
+  /* Allocated bytes at the start */
+  uint64_t allocated_bytes_start_{0};
+};
+
+}  // namespace scp::driver
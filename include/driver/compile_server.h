@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "driver/compilation_cache.h"
+#include "driver/compile.h"
+#include "driver/compiler.h"
+
+namespace scp::driver {
+
+/**
+ * A compile request sent to the server.
+ */
+struct CompileRequest {
+  /* The program name, usually the file stem */
+  std::string name_;
+  /* A source file the server reads itself, used when the source bytes are empty */
+  std::string path_;
+  /* The source bytes */
+  std::string source_;
+  /* The code generator options */
+  cgen::CodeGeneratorOptions options_;
+};
+
+/**
+ * Long-running compiler answering requests over a Unix domain socket.
+ * Each connection carries length-prefixed request and response frames and may send any number of requests.
+ * The accepting thread polls every connection and answers shutdown requests itself; only the compilation of a
+ * request goes to the thread pool, so idle connections hold no worker. The workers share one Compiler session,
+ * which keeps its parsers, and with them the lexer automata, warm across requests, so a request costs only the
+ * compilation itself.
+ */
+class CompileServer {
+ public:
+  /**
+   * Constructor for the CompileServer.
+   * @param socket_path The path of the socket to listen on.
+   * @param jobs The number of worker threads.
+   * @param cache The compilation cache, or nullptr to always compile.
+   */
+  CompileServer(std::string socket_path, size_t jobs, CompilationCache *cache = nullptr);
+
+  /**
+   * Destructor for the CompileServer, closing and removing the socket.
+   */
+  ~CompileServer();
+
+  CompileServer(const CompileServer &) = delete;
+  auto operator=(const CompileServer &) -> CompileServer & = delete;
+
+  /**
+   * Bind and listen on the socket. Fails if another server already answers on it.
+   * @param error The reason of a failure.
+   * @return True on success.
+   */
+  auto Start(std::string &error) -> bool;
+
+  /**
+   * Serve connections until a shutdown request arrives or Stop is called.
+   */
+  void Serve();
+
+  /**
+   * Ask Serve to return, from any thread.
+   */
+  void Stop() { stopping_ = true; }
+
+  /**
+   * Get the number of compile requests answered.
+   * @return The number of requests.
+   */
+  auto GetRequestCount() const -> size_t { return request_count_.load(); }
+
+  /**
+   * Get the default socket path: $SCP_SERVER_SOCKET, else scp-server.sock in $XDG_RUNTIME_DIR, else server.sock in
+   * the directory /tmp/scp-<uid>, which is created with mode 0700 and rejected if another user owns or can write it.
+   * @return The path, or an empty path if the directory in /tmp is rejected.
+   */
+  static auto GetDefaultSocketPath() -> std::string;
+
+ private:
+  /**
+   * Compile one request, on a worker.
+   * @param request The fields of a compile frame.
+   * @return The fields of the response frame.
+   */
+  auto Answer(const std::vector<std::string> &request) -> std::vector<std::string>;
+
+  /* The path of the socket */
+  std::string socket_path_;
+  /* The number of worker threads */
+  size_t jobs_;
+  /* The session of the workers */
+  Compiler compiler_;
+  /* The listening socket, -1 before Start */
+  int listen_fd_{-1};
+  /* Whether Serve should return */
+  std::atomic<bool> stopping_{false};
+  /* Number of compile requests answered */
+  std::atomic<size_t> request_count_{0};
+};
+
+/**
+ * Front end sending requests to a running CompileServer.
+ */
+class CompileClient {
+ public:
+  /* How long a request waits for the server to accept, read or answer it before giving up */
+  static constexpr int DEFAULT_TIMEOUT_MS = 10000;
+
+  /**
+   * Compile through the server.
+   * @param socket_path The path of the server socket.
+   * @param request The request.
+   * @param result The result, on success.
+   * @param timeout_ms The send and receive timeout.
+   * @return False if no server answers in time or the server runs as another user, so the caller can compile
+   * in-process instead.
+   */
+  static auto Compile(const std::string &socket_path, const CompileRequest &request, CompileResult &result,
+                      int timeout_ms = DEFAULT_TIMEOUT_MS) -> bool;
+
+  /**
+   * Ask the server to shut down.
+   * @param socket_path The path of the server socket.
+   * @param timeout_ms The send and receive timeout.
+   * @return False if no server answers in time.
+   */
+  static auto Shutdown(const std::string &socket_path, int timeout_ms = DEFAULT_TIMEOUT_MS) -> bool;
+};
+
+}  // namespace scp::driver
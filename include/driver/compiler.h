@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "driver/compilation_cache.h"
+#include "driver/compile.h"
+#include "parser/slr_parser.h"
+
+namespace scp::driver {
+
+/**
+ * A compiler session for embedding SCP as a library. Compile may be called concurrently from any number of
+ * threads. The SLR tables are built once per process and shared; each parser, with the lexer automata it owns,
+ * is built once per concurrent caller and returned to an idle pool after every compilation, so a session that
+ * serves many requests pays only for the compilations themselves.
+ */
+class Compiler {
+ public:
+  /* The code generator options of one compilation */
+  using Options = cgen::CodeGeneratorOptions;
+  /* The outcome of one compilation */
+  using Result = CompileResult;
+
+  /**
+   * Constructor for the Compiler.
+   * @param cache The compilation cache, or nullptr to always compile; must be safe to share between threads
+   * and outlive the session.
+   */
+  explicit Compiler(CompilationCache *cache = nullptr);
+
+  /**
+   * Destructor for the Compiler.
+   */
+  ~Compiler() = default;
+
+  Compiler(const Compiler &) = delete;
+  auto operator=(const Compiler &) -> Compiler & = delete;
+
+  /**
+   * Run the whole pipeline on one source, capturing its diagnostics into the result.
+   * @param source The source bytes.
+   * @param options The code generator options.
+   * @param name The program name used in diagnostics and the generated code.
+   * @return The result.
+   */
+  auto Compile(std::string_view source, const Options &options = Options(), const std::string &name = "program")
+      -> Result;
+
+  /**
+   * Get the number of parsers waiting in the idle pool, at most the largest number of concurrent compilations.
+   * @return The number of idle parsers.
+   */
+  auto GetIdleParserCount() const -> size_t;
+
+ private:
+  /**
+   * Take an idle parser, building one if the pool is empty.
+   * @return The parser.
+   */
+  auto AcquireParser() -> std::unique_ptr<parser::SLRParser>;
+
+  /**
+   * Return a parser to the idle pool.
+   * @param parser The parser.
+   */
+  void ReleaseParser(std::unique_ptr<parser::SLRParser> parser);
+
+  /* The compilation cache, may be nullptr */
+  CompilationCache *cache_;
+  /* Guards idle_parsers_ */
+  mutable std::mutex mutex_;
+  /* Parsers not in use by any compilation */
+  std::vector<std::unique_ptr<parser::SLRParser>> idle_parsers_;
+};
+
+}  // namespace scp::driver
+
+namespace scp {
+
+/* The compiler session of the public embedding API */
+using Compiler = driver::Compiler;
+
+}  // namespace scp
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "lexer/lexer.h"
+#include "parser/ll1_parser.h"
+#include "parser/slr_parser.h"
+
+namespace scp::driver {
+
+/**
+ * How far an input got through the pipeline.
+ */
+enum class FuzzStage {
+  LEX_ERROR,
+  PARSE_ERROR,
+  TYPE_ERROR,
+  COMPILED,
+};
+
+/**
+ * The outcome of checking one input.
+ */
+struct FuzzResult {
+  /* How far the input got */
+  FuzzStage stage_{FuzzStage::LEX_ERROR};
+  /* How the two parsers disagree, empty if they agree */
+  std::string mismatch_;
+  /* Wall-clock time of the whole pipeline in seconds */
+  double seconds_{0};
+  /* Whether the input took longer per byte than the threshold */
+  bool slow_{false};
+};
+
+/**
+ * Runs arbitrary bytes through the lexer, both parsers, the type checker and the code generator, for fuzzers and
+ * their regression corpus. Both parsers must accept the same inputs and build structurally equal ASTs from them.
+ * Inputs whose compile time per byte exceeds a threshold are flagged as slow, to catch superlinear paths.
+ * The lexer and parsers are built once and reused, so their construction does not count against an input.
+ */
+class FuzzCheck {
+ public:
+  /* Default slow input threshold: 1 millisecond per byte, far above the linear cost of a debug build */
+  static constexpr double DEFAULT_MAX_SECONDS_PER_BYTE = 1e-3;
+  /* Default size below which inputs are never slow, as fixed costs dominate them */
+  static constexpr size_t DEFAULT_MIN_SLOW_BYTES = 256;
+
+  /**
+   * Constructor for the FuzzCheck.
+   * @param max_seconds_per_byte The slow input threshold.
+   * @param min_slow_bytes The size below which inputs are never flagged as slow.
+   */
+  explicit FuzzCheck(double max_seconds_per_byte = DEFAULT_MAX_SECONDS_PER_BYTE,
+                     size_t min_slow_bytes = DEFAULT_MIN_SLOW_BYTES);
+
+  /**
+   * Check one input. Diagnostics of the compiler are discarded.
+   * @param source The input bytes.
+   * @return The outcome.
+   */
+  auto Run(const std::string &source) -> FuzzResult;
+
+  /**
+   * Save an input under a name derived from its contents, so saving it again changes nothing.
+   * @param directory The directory, created if missing.
+   * @param source The input bytes.
+   * @return The path of the file, empty if it cannot be written.
+   */
+  static auto SaveInput(const std::string &directory, const std::string &source) -> std::string;
+
+ private:
+  /* The slow input threshold in seconds per byte */
+  double max_seconds_per_byte_;
+  /* The size below which inputs are never slow */
+  size_t min_slow_bytes_;
+  /* The lexer */
+  lexer::Lexer lexer_;
+  /* The LL(1) parser */
+  parser::LL1Parser ll1_parser_;
+  /* The SLR parser */
+  parser::SLRParser slr_parser_;
+};
+
+}  // namespace scp::driver
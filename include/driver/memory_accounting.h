@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace scp::driver {
+
+/**
+ * Counters of the global allocator.
+ * Linking the scp_memory_accounting target replaces the global operator new and delete with counting versions that
+ * keep the size of each block in a small header, so every allocation of the program, including each token, tree node
+ * and AST node behind a shared_ptr, is accounted for. The counters are process-wide and updated atomically, which
+ * costs every allocation a header and contended read-modify-writes, so only the measurement tools link the target
+ * and scpc does so only when configured with SCP_ENABLE_MEMORY_ACCOUNTING. Without it the counters stay at 0.
+ */
+class MemoryAccounting {
+ public:
+  /**
+   * Check whether the counting allocator is linked into the program.
+   * @return True if the allocation counters are kept.
+   */
+  static auto IsEnabled() -> bool;
+
+  /**
+   * Get the number of allocations so far.
+   * @return The number of allocations.
+   */
+  static auto GetAllocationCount() -> uint64_t;
+
+  /**
+   * Get the number of bytes requested so far.
+   * @return The number of bytes.
+   */
+  static auto GetAllocatedBytes() -> uint64_t;
+
+  /**
+   * Get the number of bytes currently allocated.
+   * @return The number of bytes.
+   */
+  static auto GetLiveBytes() -> uint64_t;
+
+  /**
+   * Get the high-water mark of the live bytes since the last ResetPeak.
+   * @return The number of bytes.
+   */
+  static auto GetPeakBytes() -> uint64_t;
+
+  /**
+   * Restart the high-water mark from the current live bytes, e.g. at the start of a phase.
+   */
+  static void ResetPeak();
+
+  /**
+   * Get the peak resident set size of the process.
+   * @return The number of bytes, or 0 if unknown.
+   */
+  static auto GetPeakRss() -> uint64_t;
+
+  /**
+   * Mark the counting allocator as linked; called by it during static initialization.
+   */
+  static void Enable();
+
+  /**
+   * Count an allocation; called by the counting allocator.
+   * @param size The number of bytes requested.
+   */
+  static void RecordAllocation(size_t size);
+
+  /**
+   * Count a deallocation; called by the counting allocator.
+   * @param size The number of bytes of the block.
+   */
+  static void RecordDeallocation(size_t size);
+};
+
+}  // namespace scp::driver
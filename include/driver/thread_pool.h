@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scp::driver {
+
+/**
+ * Fixed-size thread pool with one task deque per worker.
+ * A worker pops its own newest task first and, when its deque runs dry, steals the oldest task of another worker,
+ * so uneven task sizes (one huge source file among many small ones) still keep every worker busy. Tasks receive
+ * the index of the worker running them, which lets callers keep per-worker state such as a reusable parser.
+ */
+class ThreadPool {
+ public:
+  /**
+   * A unit of work, called with the index of the worker running it. Tasks must not throw.
+   */
+  using Task = std::function<void(size_t)>;
+
+  /**
+   * Constructor for the ThreadPool.
+   * @param thread_count The number of workers, at least one.
+   */
+  explicit ThreadPool(size_t thread_count);
+
+  /**
+   * Destructor for the ThreadPool, finishing queued tasks and joining the workers.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+  /**
+   * Queue a task. Tasks submitted from a worker go to that worker's deque, others are spread round robin.
+   * @param task The task.
+   */
+  void Submit(Task task);
+
+  /**
+   * Block until every submitted task has finished.
+   */
+  void Wait();
+
+  /**
+   * Get the number of workers.
+   * @return The number of workers.
+   */
+  auto GetThreadCount() const -> size_t { return threads_.size(); }
+
+  /**
+   * Get the number of tasks a worker took from another worker's deque.
+   * @return The number of stolen tasks.
+   */
+  auto GetStolenCount() const -> size_t { return stolen_count_.load(); }
+
+ private:
+  /**
+   * The deque of one worker.
+   */
+  struct Queue {
+    /* Guards the tasks */
+    std::mutex mutex_;
+    /* The queued tasks, the owner works at the back and thieves at the front */
+    std::deque<Task> tasks_;
+  };
+
+  /**
+   * The loop run by each worker.
+   * @param index The index of the worker.
+   */
+  void WorkerLoop(size_t index);
+
+  /**
+   * Take a task from the worker's own deque, or steal one from another worker.
+   * @param index The index of the worker.
+   * @param task The task taken.
+   * @return True if a task was taken.
+   */
+  auto TryTake(size_t index, Task &task) -> bool;
+
+  /* One deque per worker */
+  std::vector<std::unique_ptr<Queue>> queues_;
+  /* The workers */
+  std::vector<std::thread> threads_;
+  /* Guards the counters below */
+  std::mutex mutex_;
+  /* Signalled when a task is queued or the pool stops */
+  std::condition_variable work_available_;
+  /* Signalled when the last pending task finishes */
+  std::condition_variable all_done_;
+  /* Number of queued tasks not yet claimed by a worker */
+  size_t queued_count_{0};
+  /* Number of submitted tasks not yet finished */
+  size_t pending_count_{0};
+  /* Whether the pool is shutting down */
+  bool stopping_{false};
+  /* Next deque for tasks submitted from outside the pool */
+  std::atomic<size_t> next_queue_{0};
+  /* Number of stolen tasks */
+  std::atomic<size_t> stolen_count_{0};
+};
+
+}  // namespace scp::driver
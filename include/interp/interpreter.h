@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/ast.h"
+#include "core/type.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+
+namespace scp::interp {
+
+/**
+ * The value of a variable or expression.
+ */
+struct Value {
+  /* NUMBER or STRING, or the stream type of a variable holding a stream */
+  core::Type type_{core::Type::UNDEFINED};
+  /* The number, a 32-bit word as in the generated code */
+  int32_t number_{0};
+  /* The string, without its quotes and with its escapes decoded */
+  std::string string_;
+};
+
+/**
+ * The time spent on one statement.
+ */
+struct StatementTiming {
+  /* Time to type-check the statement */
+  std::chrono::nanoseconds check_{0};
+  /* Time to run the statement */
+  std::chrono::nanoseconds run_{0};
+};
+
+/**
+ * Runs programs statement by statement in process, with the semantics of the generated code under SPIM. The type
+ * environment and the variables persist across calls to Execute, so each statement is checked and run once, against
+ * what the statements before it declared. A variable keeps its slot, and a string variable its buffer, from the
+ * statement declaring it on. Reads from stdin take a line from the input stream like the read syscalls, and stdout
+ * writes to the output stream.
+ */
+class Interpreter {
+ public:
+  /* The longest line a string read keeps, as the generated code reads into a 256-byte buffer */
+  static constexpr size_t MAX_INPUT_LENGTH = 255;
+  /* The longest string a statement may build */
+  static constexpr size_t MAX_STRING_LENGTH = 16 * 1024 * 1024;
+
+  /**
+   * Constructor for the Interpreter.
+   * @param input The stream stdin reads from.
+   * @param output The stream stdout writes to.
+   */
+  Interpreter(std::istream &input, std::ostream &output);
+
+  /**
+   * Destructor for the Interpreter.
+   */
+  ~Interpreter() = default;
+
+  /**
+   * Parse statements and check and run each in turn, stopping at the first that fails. Errors go to the diagnostics.
+   * @param source The statements.
+   * @param timings Receives the time spent on each statement that was run, or nullptr.
+   * @return True if every statement ran.
+   */
+  auto Execute(const std::string &source, std::vector<StatementTiming> *timings = nullptr) -> bool;
+
+  /**
+   * Type-check one statement against the statements run before it.
+   * @param statement The ASSIGN node.
+   * @return True if the statement is well typed.
+   * @throws std::runtime_error if the statement is malformed.
+   */
+  auto Check(const std::shared_ptr<core::AST::ASTNode> &statement) -> bool;
+
+  /**
+   * Run one checked statement.
+   * @param statement The ASSIGN node.
+   * @throws std::runtime_error on an error the generated code would trap on, leaving the variables unchanged.
+   */
+  void Run(const std::shared_ptr<core::AST::ASTNode> &statement);
+
+  /**
+   * Get the variables assigned so far.
+   * @return The names and values, in declaration order.
+   */
+  auto GetVariables() const -> std::vector<std::pair<std::string, Value>>;
+
+  /**
+   * End the line of the output, if the statements run so far left one unfinished.
+   */
+  void FinishLine();
+
+ private:
+  /**
+   * Evaluate an expression, with an explicit stack of operands so deeply nested expressions cannot overflow the call
+   * stack.
+   * @param node The expression.
+   * @param result Receives the value; passed in so the buffers of intermediate strings are reused.
+   */
+  void Evaluate(const core::AST::ASTNode &node, Value &result);
+
+  /**
+   * Get the value of a number, string or identifier.
+   * @param node The operand.
+   * @param result Receives the value.
+   */
+  void Load(const core::AST::ASTNode &node, Value &result);
+
+  /**
+   * Apply a + or * to the values of its operands.
+   * @param type PLUS or TIMES.
+   * @param result The left operand, which receives the value.
+   * @param right The right operand.
+   */
+  static void Combine(core::ASTNodeType type, Value &result, const Value &right);
+
+  /**
+   * Read a line the way the read string syscall does, without the line break.
+   * @return The line.
+   */
+  auto ReadString() -> std::string;
+
+  /**
+   * Read a line the way the read integer syscall does.
+   * @return The number, 0 if the line holds none.
+   */
+  auto ReadNumber() -> int32_t;
+
+  /**
+   * Write to the output.
+   * @param text The text.
+   */
+  void Print(const std::string &text);
+
+  /* The stream stdin reads from */
+  std::istream &input_;
+  /* The stream stdout writes to */
+  std::ostream &output_;
+  /* The parser, whose tables are built once */
+  parser::SLRParser parser_{"repl"};
+  /* The type checker holding the type environment of every statement run */
+  semant::TypeChecker type_checker_;
+  /* The slot of each variable */
+  std::unordered_map<std::string, size_t> slots_;
+  /* The variables by slot, in declaration order */
+  std::vector<std::pair<std::string, Value>> variables_;
+  /* The value of the statement being run, whose buffer is swapped with the variable's */
+  Value result_;
+  /* The operands of the expression being evaluated, kept so their string buffers are reused */
+  std::vector<Value> operands_;
+  /* The line number the next input starts at, so diagnostics count the lines of the whole session */
+  int line_{1};
+  /* Whether the output ends a line */
+  bool at_line_start_{true};
+};
+
+}  // namespace scp::interp
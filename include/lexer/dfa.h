@@ -2,10 +2,9 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "core/flat_hash_map.h"
 #include "core/token.h"
 
 namespace scp::lexer {
@@ -65,7 +64,7 @@ class DeterministicFiniteAutomata {
    * Check if the DFA is in an accepted state.
    * @return True if the current state is a final state, false otherwise.
    */
-  auto IsAccepted() const -> bool { return final_states_.find(current_state_) != final_states_.end(); }
+  auto IsAccepted() const -> bool { return final_states_.contains(current_state_); }
 
   /**
    * Get the token class associated with the DFA.
@@ -83,7 +82,7 @@ class DeterministicFiniteAutomata {
   /* The token class associated with the DFA */
   core::TokenType token_class_;
   /* The set of final states for the DFA */
-  std::unordered_set<int> final_states_;
+  core::FlatHashSet<int> final_states_;
   /* The initial state of the DFA */
   const int initial_state_ = 0;
   /* The current state of the DFA */
@@ -99,7 +98,7 @@ class DeterministicFiniteAutomata {
   /* The transition table for the DFA */
   std::vector<std::vector<int>> states_transition_;
   /* The alphabet of the DFA */
-  std::unordered_map<char, int> alphabet_;
+  core::FlatHashMap<char, int> alphabet_;
 
   // Released or Building
   /* Whether the DFA is released or still being built */
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <istream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -15,6 +16,9 @@ namespace scp::lexer {
  */
 class Lexer {
  public:
+  /* Number of bytes read from an input stream at a time */
+  static constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
   /**
    * Constructor for the Lexer.
    */
@@ -28,8 +32,16 @@ class Lexer {
   /**
    * Set the input string for the lexer.
    * @param input The input string to tokenize.
+   * @param first_line The line number of the first line, when the input continues a larger source.
+   */
+  void SetInput(const std::string &input, int first_line = 1);
+
+  /**
+   * Read the input from a stream as it is tokenized, so only the current chunk and token are held in memory.
+   * The stream must outlive the lexer's use of it, and Reset cannot rewind it.
+   * @param stream The stream to tokenize.
    */
-  void SetInput(const std::string &input);
+  void SetInputStream(std::istream &stream);
 
   /**
    * Get the next token from the input stream.
@@ -65,6 +77,10 @@ class Lexer {
   int current_line_{1};
   /* Current column number (1-based) */
   int current_column_{1};
+  /* The line number the input starts at */
+  int first_line_{1};
+  /* The stream input_ is read from, or nullptr when the whole input was set at once */
+  std::istream *stream_{nullptr};
 
   /* DFA for all tokens */
   std::unique_ptr<DeterministicFiniteAutomata> number_dfa_;
@@ -101,6 +117,12 @@ class Lexer {
   void SetupSemicolonDFA();   // (^\;$)
   void SetupStringDFA();      // (^\\".*\\"$)
 
+  /**
+   * Append the next chunk of the input stream to input_.
+   * @return False if there is no stream or it is exhausted.
+   */
+  auto ReadChunk() -> bool;
+
   /**
    * Skip whitespace characters at the current position.
    */
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/token.h"
+
+namespace scp::lexer {
+
+/**
+ * A lock-free single-producer/single-consumer ring of tokens, connecting a lexer thread to a parser. The producer
+ * pushes tokens and then an end marker; the consumer waits for them in order. Waiting threads spin briefly and then
+ * yield, so the ring also works when both threads share one core.
+ */
+class TokenRing {
+ public:
+  /* Number of slots, a power of two */
+  static constexpr size_t CAPACITY = 4096;
+
+  /**
+   * Constructor for the TokenRing.
+   */
+  TokenRing();
+
+  /**
+   * Destructor for the TokenRing.
+   */
+  ~TokenRing() = default;
+
+  TokenRing(const TokenRing &) = delete;
+  auto operator=(const TokenRing &) -> TokenRing & = delete;
+
+  /**
+   * Empty the ring for a new producer. Neither thread may use the ring meanwhile.
+   */
+  void Reset();
+
+  /**
+   * Append a token, waiting while the ring is full. Producer only.
+   * @param token The token.
+   * @return False if the consumer cancelled, in which case the producer should stop.
+   */
+  auto Push(core::Token &&token) -> bool;
+
+  /**
+   * Append the end marker. Producer only.
+   * @param diagnostics The diagnostics of a lexer that failed, empty if the input ended.
+   */
+  void Close(std::string diagnostics);
+
+  /**
+   * Wait for the next entry. Consumer only.
+   * @return The next token, or std::nullopt for the end marker.
+   */
+  auto Front() -> const std::optional<core::Token> &;
+
+  /**
+   * Wait for the next entry and remove it, unless it is the end marker. Consumer only.
+   * @return The token, or std::nullopt for the end marker.
+   */
+  auto Pop() -> std::optional<core::Token>;
+
+  /**
+   * Get the diagnostics passed to Close. Consumer only, after Front returned the end marker.
+   * @return The diagnostics, empty unless the lexer failed.
+   */
+  auto GetDiagnostics() const -> const std::string & { return diagnostics_; }
+
+  /**
+   * Tell the producer to stop, so it does not wait for room the consumer will never make.
+   */
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+ private:
+  /**
+   * Spin, then yield, until a condition holds.
+   * @param ready The condition.
+   */
+  template <typename Condition>
+  static void WaitUntil(const Condition &ready);
+
+  /**
+   * Wait for the next entry.
+   * @return Its slot.
+   */
+  auto WaitFront() -> std::optional<core::Token> &;
+
+  /* The entries; std::nullopt marks the end */
+  std::vector<std::optional<core::Token>> slots_;
+  /* Number of entries consumed, written by the consumer */
+  alignas(64) std::atomic<size_t> head_{0};
+  /* Number of entries produced, written by the producer */
+  alignas(64) std::atomic<size_t> tail_{0};
+  /* Set by the consumer to stop the producer */
+  alignas(64) std::atomic<bool> cancelled_{false};
+  /* The diagnostics of a failed lexer, published by the end marker */
+  std::string diagnostics_;
+};
+
+}  // namespace scp::lexer
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ast.h"
+#include "core/token.h"
+#include "core/type.h"
+#include "lexer/lexer.h"
+#include "parser/slr_parser.h"
+
+namespace scp::lsp {
+
+/**
+ * A diagnostic of a document, with 1-based positions like core::Token.
+ */
+struct Diagnostic {
+  /* The line of the first character */
+  int line_{1};
+  /* The column of the first character */
+  int column_{1};
+  /* The line of the character after the last */
+  int end_line_{1};
+  /* The column of the character after the last */
+  int end_column_{1};
+  /* The message, without the position the lexer and parser put in it */
+  std::string message_;
+};
+
+/**
+ * A token of a document and the type it has where it stands.
+ */
+struct Symbol {
+  /* The token, at its position in the document */
+  core::Token token_;
+  /* The type of the variable or literal, UNDEFINED for other tokens and undeclared variables */
+  core::Type type_{core::Type::UNDEFINED};
+};
+
+/**
+ * The semantic model of an open source file: its text cut into statements, each with its tokens, AST, diagnostics
+ * and the types of its tokens, and for every variable the statements assigning and reading it.
+ *
+ * Statements are the unit of every update. An edit re-lexes and re-parses the statements it touches, going on only
+ * until the lexer meets an old statement boundary again, and shifts the positions of the statements after them. A
+ * statement depends on the rest of the document only through the variables it names, and a variable is declared
+ * by the first statement assigning it a defined type, so the type check then revisits just the new statements and,
+ * in source order, the later statements naming a variable whose declaration changed on the way.
+ */
+class Document {
+ public:
+  /**
+   * Constructor for the Document.
+   * @param text The text of the document.
+   */
+  explicit Document(std::string text = "");
+
+  /**
+   * Destructor for the Document.
+   */
+  ~Document() = default;
+
+  Document(const Document &) = delete;
+  auto operator=(const Document &) -> Document & = delete;
+
+  /**
+   * Replace the whole text and rebuild the model.
+   * @param text The new text.
+   */
+  void SetText(std::string text);
+
+  /**
+   * Replace a range of the text and update the model.
+   * @param offset The byte offset of the range.
+   * @param length The length of the range in bytes.
+   * @param text The text replacing it.
+   */
+  void Replace(size_t offset, size_t length, const std::string &text);
+
+  /**
+   * Get the text.
+   * @return The text.
+   */
+  auto GetText() const -> const std::string & { return text_; }
+
+  /**
+   * Get the byte offset of a position, clamped to the end of its line and of the text.
+   * @param line The 1-based line.
+   * @param column The 1-based column, counting bytes.
+   * @return The offset.
+   */
+  auto GetOffset(int line, int column) const -> size_t;
+
+  /**
+   * Get the diagnostics of every statement, in source order.
+   * @return The diagnostics.
+   */
+  auto GetDiagnostics() const -> std::vector<Diagnostic>;
+
+  /**
+   * Find the token at a position and its type.
+   * @param line The 1-based line.
+   * @param column The 1-based column.
+   * @return The symbol, or std::nullopt if no token covers the position.
+   */
+  auto GetSymbol(int line, int column) const -> std::optional<Symbol>;
+
+  /**
+   * Find the declaration of the variable at a position.
+   * @param line The 1-based line.
+   * @param column The 1-based column.
+   * @return The target token of the statement declaring the variable, or std::nullopt if the position holds no
+   *         declared variable.
+   */
+  auto GetDefinition(int line, int column) const -> std::optional<core::Token>;
+
+  /**
+   * Get the number of statements.
+   * @return The number of statements.
+   */
+  auto GetStatementCount() const -> size_t { return statements_.size(); }
+
+  /**
+   * Get the number of statements the last update lexed and parsed.
+   * @return The number of statements.
+   */
+  auto GetParsedCount() const -> size_t { return parsed_count_; }
+
+  /**
+   * Get the number of statements the last update type-checked.
+   * @return The number of statements.
+   */
+  auto GetCheckedCount() const -> size_t { return checked_count_; }
+
+ private:
+  /**
+   * Where a statement lies: from the end of the previous statement through its semicolon, or the text after the last
+   * semicolon. The spans of all statements are kept apart from the statements, so an edit shifts them in one pass
+   * over contiguous memory.
+   */
+  struct Span {
+    /* The byte offset of the start */
+    size_t begin_{0};
+    /* The byte offset after the end */
+    size_t end_{0};
+    /* The line of the start */
+    int line_{1};
+    /* The column of the start */
+    int column_{1};
+  };
+
+  /**
+   * A statement. Token and diagnostic positions are relative to the start of its span, the line counting from 1 and
+   * the column counting from 1 on its first line, so they survive edits before it.
+   */
+  struct Statement {
+    /* Orders the statement; keys leave gaps, so statements an edit inserts renumber no others */
+    uint64_t key_{0};
+    /* The tokens, at relative positions */
+    std::vector<core::Token> tokens_;
+    /* The ASSIGN node, or nullptr if the statement does not parse */
+    std::shared_ptr<core::AST::ASTNode> ast_;
+    /* The assigned variable, empty if the statement does not parse */
+    std::string target_;
+    /* The variables the value reads */
+    std::vector<std::string> reads_;
+    /* The lexer and parser diagnostics, at relative positions */
+    std::vector<Diagnostic> parse_diagnostics_;
+    /* The type check diagnostics, which cover the whole statement */
+    std::vector<std::string> type_diagnostics_;
+    /* The type of each token */
+    std::vector<core::Type> types_;
+    /* The type the statement declares its target with, UNDEFINED if it declares nothing */
+    core::Type declared_{core::Type::UNDEFINED};
+  };
+
+  /**
+   * Orders statements by their position in the document.
+   */
+  struct ByKey {
+    auto operator()(const Statement *left, const Statement *right) const -> bool { return left->key_ < right->key_; }
+  };
+
+  /* Statements ordered by position */
+  using StatementSet = std::set<Statement *, ByKey>;
+
+  /* The distance between the keys of neighboring statements when keys are assigned afresh */
+  static constexpr uint64_t KEY_GAP = uint64_t{1} << 32;
+
+  /**
+   * Lex part of the text into statements.
+   * @param begin The byte offset to start at, the start of a statement.
+   * @param end The byte offset to stop at.
+   * @param line The line of begin.
+   * @param column The column of begin.
+   * @param statements Receives the statements.
+   * @param spans Receives their spans.
+   * @return True if the last statement ends with a semicolon at end, so the statements after end start there.
+   */
+  auto Split(size_t begin, size_t end, int line, int column, std::vector<std::unique_ptr<Statement>> &statements,
+             std::vector<Span> &spans) -> bool;
+
+  /**
+   * Parse a statement split from the text and note the variables it names.
+   * @param statement The statement.
+   * @param span Its span.
+   */
+  void Parse(Statement &statement, const Span &span);
+
+  /**
+   * Type-check a statement against the declarations before it.
+   * @param statement The statement.
+   */
+  void Check(Statement &statement);
+
+  /**
+   * Check statements and, in source order, the later statements naming a variable whose declaration changes.
+   * @param dirty The statements to check.
+   */
+  void Propagate(StatementSet dirty);
+
+  /**
+   * Add or remove a statement from the statements naming each variable and the statements with diagnostics.
+   * @param statement The statement.
+   * @param add Whether to add or remove it.
+   */
+  void Index(Statement &statement, bool add);
+
+  /**
+   * Give statements keys between those of their neighbors, or give every statement a new key if there is no room.
+   * @param first The index of the first statement.
+   * @param count The number of statements.
+   */
+  void AssignKeys(size_t first, size_t count);
+
+  /**
+   * Find the statement declaring a variable before a position.
+   * @param name The variable.
+   * @param key The key of the position.
+   * @return The declaring statement, or nullptr if the variable is undeclared there or is a stream.
+   */
+  auto FindDeclaration(const std::string &name, uint64_t key) const -> const Statement *;
+
+  /**
+   * Get the type of a variable before a position.
+   * @param name The variable.
+   * @param key The key of the position.
+   * @return The type, UNDEFINED if the variable is undeclared there.
+   */
+  auto GetTypeBefore(const std::string &name, uint64_t key) const -> core::Type;
+
+  /**
+   * Find the index of a statement.
+   * @param statement The statement.
+   * @return The index.
+   */
+  auto IndexOf(const Statement &statement) const -> size_t;
+
+  /**
+   * Find the statement holding a position.
+   * @param line The 1-based line.
+   * @param column The 1-based column.
+   * @return The index of the last statement starting at or before the position, or the statement count if none does.
+   */
+  auto FindStatement(int line, int column) const -> size_t;
+
+  /**
+   * Find the token of a statement covering a position.
+   * @param index The index of the statement.
+   * @param line The 1-based line.
+   * @param column The 1-based column.
+   * @return The index of the token, or the token count if none covers the position.
+   */
+  auto FindToken(size_t index, int line, int column) const -> size_t;
+
+  /**
+   * Get a token of a statement at its position in the document.
+   * @param span The span of the statement.
+   * @param token The token, at its relative position.
+   * @return The token at its position in the document.
+   */
+  static auto ToDocument(const Span &span, const core::Token &token) -> core::Token;
+
+  /**
+   * Get the column of a byte offset.
+   * @param offset The offset.
+   * @return The 1-based column.
+   */
+  auto GetColumn(size_t offset) const -> int;
+
+  /* The text */
+  std::string text_;
+  /* The statements in source order */
+  std::vector<std::unique_ptr<Statement>> statements_;
+  /* The span of each statement */
+  std::vector<Span> spans_;
+  /* The statements assigning each variable */
+  std::unordered_map<std::string, StatementSet> assigners_;
+  /* The statements reading each variable */
+  std::unordered_map<std::string, StatementSet> readers_;
+  /* The statements with diagnostics */
+  StatementSet diagnosed_;
+  /* The lexer splitting the text, whose automata are built once */
+  lexer::Lexer lexer_;
+  /* The parser of single statements, whose tables are shared */
+  parser::SLRParser parser_{"lsp"};
+  /* The number of statements the last update parsed */
+  size_t parsed_count_{0};
+  /* The number of statements the last update checked */
+  size_t checked_count_{0};
+};
+
+}  // namespace scp::lsp
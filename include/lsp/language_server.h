@@ -0,0 +1,100 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "core/json.h"
+#include "lsp/document.h"
+
+namespace scp::lsp {
+
+/**
+ * Language Server Protocol server speaking JSON-RPC with Content-Length framed messages. Each open document keeps a
+ * Document, updated in place by incremental didChange notifications, and every change publishes the diagnostics of
+ * the document. Hover gives the type of the variable or literal under the cursor, and go-to-definition the target
+ * of the statement declaring the variable. Positions count bytes, which is UTF-16 code units for the ASCII source.
+ */
+class LanguageServer {
+ public:
+  /**
+   * Constructor for the LanguageServer.
+   * @param input The stream the client writes to.
+   * @param output The stream the client reads.
+   */
+  LanguageServer(std::istream &input, std::ostream &output);
+
+  /**
+   * Destructor for the LanguageServer.
+   */
+  ~LanguageServer() = default;
+
+  /**
+   * Answer messages until the exit notification or the end of the input.
+   * @return The exit code: 0 if the client asked for a shutdown first, 1 otherwise.
+   */
+  auto Serve() -> int;
+
+  /**
+   * Answer one message.
+   * @param message The JSON-RPC request or notification.
+   * @return False after the exit notification.
+   */
+  auto Handle(const core::JsonValue &message) -> bool;
+
+ private:
+  /**
+   * Read the content of the next message. A malformed Content-Length header is answered with a parse error and
+   * its message skipped.
+   * @param content Receives the content.
+   * @return False at the end of the input.
+   */
+  auto Read(std::string &content) -> bool;
+
+  /**
+   * Write a message with its header.
+   * @param content The JSON content.
+   */
+  void Send(const std::string &content);
+
+  /**
+   * Answer a request.
+   * @param id The JSON text of the request id.
+   * @param result The JSON text of the result.
+   */
+  void Reply(const std::string &id, const std::string &result);
+
+  /**
+   * Answer a request with an error.
+   * @param id The JSON text of the request id.
+   * @param code The JSON-RPC error code.
+   * @param message The error message.
+   */
+  void ReplyError(const std::string &id, int code, const std::string &message);
+
+  /**
+   * Send the diagnostics of a document.
+   * @param uri The document.
+   */
+  void Publish(const std::string &uri);
+
+  /**
+   * Find the document a request names.
+   * @param params The params of the request.
+   * @return The document, or nullptr if it is not open.
+   */
+  auto FindDocument(const core::JsonValue *params) const -> const Document *;
+
+  /* The stream the client writes to */
+  std::istream &input_;
+  /* The stream the client reads */
+  std::ostream &output_;
+  /* The open documents by URI */
+  std::unordered_map<std::string, std::unique_ptr<Document>> documents_;
+  /* Whether the client asked for a shutdown */
+  bool shutdown_{false};
+};
+
+}  // namespace scp::lsp
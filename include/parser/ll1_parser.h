@@ -3,12 +3,11 @@
 #include <memory>
 #include <stack>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "core/ast.h"
+#include "core/flat_hash_map.h"
 #include "lexer/lexer.h"
 
 namespace scp::parser {
@@ -82,11 +81,11 @@ class LL1Parser {
   /* The name of the program being parsed. */
   std::string program_name_;
   /* The root of the parse tree */
-  std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> parse_table_;
+  core::FlatHashMap<std::string, core::FlatHashMap<std::string, std::vector<std::string>>> parse_table_;
   /* The set of terminal symbols */
-  std::unordered_set<std::string> terminals_;
+  core::FlatHashSet<std::string> terminals_;
   /* The set of non-terminal symbols */
-  std::unordered_set<std::string> symbols_;
+  core::FlatHashSet<std::string> symbols_;
   /* The parsing stack */
   std::stack<std::pair<std::string, std::shared_ptr<core::TreeNode>>> parse_stack_;
   /* The lexer for tokenizing the input */
@@ -100,12 +99,6 @@ class LL1Parser {
   auto TransformProgram(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformStatement(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformExpression(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
-  auto TransformExpressionPrime(const std::shared_ptr<core::TreeNode> &parse_node,
-                                std::shared_ptr<core::AST::ASTNode> left_operand)
-      -> std::shared_ptr<core::AST::ASTNode>;
-  auto TransformTerm(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
-  auto TransformTermPrime(const std::shared_ptr<core::TreeNode> &parse_node,
-                          std::shared_ptr<core::AST::ASTNode> left_operand) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformFactor(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
 
   /**
@@ -1,16 +1,20 @@
 #pragma once
 
+#include <functional>
+#include <istream>
 #include <memory>
+#include <optional>
 #include <stack>
 #include <string>
+#include <thread>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "core/ast.h"
+#include "core/flat_hash_map.h"
 #include "lexer/lexer.h"
+#include "lexer/token_ring.h"
 
 namespace scp::parser {
 
@@ -50,33 +54,143 @@ class SLRParser {
     std::string lhs_;
   };
 
+  /**
+   * The parsing tables. They never change once built, so every parser instance and thread shares one copy.
+   */
+  struct Tables {
+    /* terminal symbols */
+    core::FlatHashSet<std::string> terminals_;
+    /* all symbols */
+    core::FlatHashSet<std::string> symbols_;
+    /* The action table for the SLR parser */
+    core::FlatHashMap<int, core::FlatHashMap<std::string, Action>> action_table_;
+    /* Goto Table of dfa */
+    core::FlatHashMap<int, core::FlatHashMap<std::string, int>> goto_table_;
+  };
+
+  /**
+   * Receives each statement of a streamed parse; returning false stops the parse.
+   */
+  using StatementCallback = std::function<bool(const std::shared_ptr<core::AST::ASTNode> &)>;
+
+  /**
+   * Semantic actions run by ParseWithActions in place of building the parse tree. They keep their own attribute
+   * stack, one entry per grammar symbol: Shift pushes one for a token and Reduce replaces the entries of the
+   * right-hand side with one for the left-hand side. A reduced Statement is not kept on the parser stack, so its
+   * Reduce pops its four entries and pushes none, and StatementList and Program reductions hold no entries.
+   */
+  class SemanticActions {
+   public:
+    virtual ~SemanticActions() = default;
+
+    /**
+     * Called when a token is shifted.
+     * @param token The token.
+     */
+    virtual void Shift(const core::Token &token) = 0;
+
+    /**
+     * Called when a production is reduced.
+     * @param action The REDUCE action, naming the production.
+     * @return False to stop the parse.
+     */
+    virtual auto Reduce(const Action &action) -> bool = 0;
+  };
+
   /**
    * Constructor for the SLRParser.
    * @param program_name The name of the program being parsed.
    */
-  explicit SLRParser(std::string program_name) : program_name_(std::move(program_name)) { Init(); }
+  explicit SLRParser(std::string program_name) : program_name_(std::move(program_name)), tables_(GetTables()) {
+    Init();
+  }
 
   /**
    * Destructor for the SLRParser.
    */
   ~SLRParser() = default;
 
+  SLRParser(const SLRParser &) = delete;
+  auto operator=(const SLRParser &) -> SLRParser & = delete;
+
   /**
-   * Initialize the SLR parser. Main effort is to build the action and goto tables.
+   * Initialize the SLR parser stack. The action and goto tables are shared, see GetTables.
    */
   void Init();
 
+  /**
+   * Get the shared parsing tables, building them on first use.
+   * @return The tables.
+   */
+  static auto GetTables() -> const Tables &;
+
+  /**
+   * Build the action and goto tables. GetTables builds them once; this is public so benchmarks can measure it.
+   * @return The tables.
+   */
+  static auto BuildTables() -> Tables;
+
+  /**
+   * Set the name of the program being parsed, so one parser can be reused for several programs.
+   * @param program_name The name of the program.
+   */
+  void SetProgramName(std::string program_name) { program_name_ = std::move(program_name); }
+
   /**
    * Parse the input and produce an AST.
    * @return A shared pointer to the root AST node.
    */
   auto Parse() -> std::shared_ptr<core::AST>;
 
+  /**
+   * Parse a stream and hand each statement to a callback as soon as it is reduced, in source order, without
+   * keeping the source, the parse tree or the AST of the whole program.
+   * @param input The source stream, read in chunks.
+   * @param on_statement Called with the ASSIGN node of every statement.
+   * @return True if the whole input parsed and no callback stopped the parse.
+   */
+  auto ParseStatements(std::istream &input, const StatementCallback &on_statement) -> bool;
+
+  /**
+   * Parse the input set by SetInput or Lex, running semantic actions on every shift and reduce instead of building
+   * the parse tree and the AST.
+   * @param actions The semantic actions.
+   * @return True if the whole input parsed and no action stopped the parse.
+   */
+  auto ParseWithActions(SemanticActions &actions) -> bool;
+
   /**
    * Set the input for the parser.
    * @param input The input string to parse.
+   * @param first_line The line number of the first line, when the input continues a larger source.
    */
-  void SetInput(const std::string &input);
+  void SetInput(const std::string &input, int first_line = 1);
+
+  /**
+   * Run the lexer on its own thread during a parse, handing tokens to the parser through a TokenRing, so lexing
+   * overlaps parsing. Has no effect on input already tokenized by Lex.
+   * @param pipelined Whether to lex on a separate thread.
+   */
+  void SetPipelined(bool pipelined) { pipelined_ = pipelined; }
+
+  /**
+   * Tokenize the whole input ahead of Parse, so lexing and parsing can be measured apart.
+   * Without it, Parse pulls tokens from the lexer as it goes.
+   * @return False if the input holds a character that starts no token.
+   */
+  auto Lex() -> bool;
+
+  /**
+   * Get the number of tokens of the last Lex or Parse.
+   * @return The number of tokens.
+   */
+  auto GetTokenCount() const -> size_t { return lexed_ ? tokens_.size() : streamed_token_count_; }
+
+  /**
+   * Get the number of parse tree nodes built by the last Parse.
+   * @return The number of nodes.
+   */
+  auto GetParseTreeNodeCount() const -> size_t { return parse_tree_node_count_; }
 
   /**
    * Build the AST from the parse tree.
@@ -95,18 +209,78 @@ class SLRParser {
  private:
   /* The name of the program being parsed. */
   std::string program_name_;
-  /* terminal symbols */
-  std::unordered_set<std::string> terminals_;
-  /* all symbols */
-  std::unordered_set<std::string> symbols_;
+  /* The shared parsing tables */
+  const Tables &tables_;
   /* SLR parsing stack */
   std::stack<std::tuple<std::string, std::shared_ptr<core::TreeNode>, int>> slr_stack_;
   /* lexer for tokenization */
   lexer::Lexer lexer_;
-  /* The action table for the SLR parser */
-  std::unordered_map<int, std::unordered_map<std::string, Action>> action_table_;
-  /* Goto Table of dfa */
-  std::unordered_map<int, std::unordered_map<std::string, int>> goto_table_;
+  /* The tokens of the input, when lexed ahead by Lex */
+  std::vector<core::Token> tokens_;
+  /* Whether Parse reads tokens_ instead of the lexer */
+  bool lexed_{false};
+  /* The position of Parse in tokens_ */
+  size_t next_token_{0};
+  /* Number of tokens the last Parse pulled from the lexer */
+  size_t streamed_token_count_{0};
+  /* Number of parse tree nodes built by the last Parse */
+  size_t parse_tree_node_count_{0};
+  /* The callback of ParseStatements while it runs, nullptr otherwise */
+  const StatementCallback *on_statement_{nullptr};
+  /* The semantic actions of ParseWithActions while it runs, nullptr otherwise */
+  SemanticActions *actions_{nullptr};
+  /* Whether a parse lexes on lexer_thread_ */
+  bool pipelined_{false};
+  /* The tokens from lexer_thread_, allocated by the first pipelined parse */
+  std::unique_ptr<lexer::TokenRing> token_ring_;
+  /* The thread running lexer_ during a pipelined parse */
+  std::thread lexer_thread_;
+
+  /**
+   * Run the parsing loop over the tokens set up by Parse, ParseStatements or ParseWithActions, with the lexer on its
+   * own thread when pipelined.
+   * @return The AST, or nullptr on error.
+   */
+  auto RunParser() -> std::shared_ptr<core::AST>;
+
+  /**
+   * The parsing loop of RunParser.
+   * @return The AST, or nullptr on error.
+   */
+  auto ParseTokens() -> std::shared_ptr<core::AST>;
+
+  /**
+   * Tokenize the input into token_ring_; runs on lexer_thread_.
+   */
+  void LexIntoRing();
+
+  /**
+   * Pop the right-hand side of a production and push its left-hand side, or hand a Statement to on_statement_.
+   * With semantic actions, no parse tree node is built and the actions see the reduction instead.
+   * @param action The REDUCE action.
+   * @return False on a missing goto entry or when the callback stops the parse.
+   */
+  auto Reduce(const Action &action) -> bool;
+
+  /**
+   * Push a reduced symbol with the state of the goto table.
+   * @param symbol The left-hand side of the reduced production.
+   * @param node Its parse tree node, nullptr under semantic actions.
+   * @return False on a missing goto entry.
+   */
+  auto PushGoto(const std::string &symbol, std::shared_ptr<core::TreeNode> node) -> bool;
+
+  /**
+   * Check whether Parse has tokens left, from tokens_ or the lexer.
+   * @return True if a token follows.
+   */
+  auto HasNextToken() const -> bool;
+
+  /**
+   * Get the next token for Parse, from tokens_ or the lexer.
+   * @return The token, or std::nullopt if the lexer found none.
+   */
+  auto NextToken() -> std::optional<core::Token>;
 
   /**
    * Convert token type to parser terminal string.
@@ -123,7 +297,6 @@ class SLRParser {
   auto TransformProgram(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformStatement(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformExpression(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
-  auto TransformTerm(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
   auto TransformFactor(const std::shared_ptr<core::TreeNode> &parse_node) -> std::shared_ptr<core::AST::ASTNode>;
 
   /**
@@ -140,7 +313,7 @@ class SLRParser {
    * @param terminals The set of terminal symbols.
    * @return True if the symbol is a terminal, false otherwise.
    */
-  auto IsTerminal(const std::string &symbol, const std::unordered_set<std::string> &terminals) -> bool;
+  auto IsTerminal(const std::string &symbol, const core::FlatHashSet<std::string> &terminals) -> bool;
 };
 
 }  // namespace scp::parser
@@ -0,0 +1,206 @@
+#pragma once
+
+/*
+ * libscprt, the string and I/O runtime of native backends: what CodeGenerator::GenerateStringUtilities prints as
+ * MIPS, as functions with a C ABI. The library depends on no libc, so generated code links it alone; it talks to the
+ * kernel through raw system calls and needs only the compiler's freestanding headers. Strings are null-terminated
+ * like the MIPS runtime's, numbers are 32-bit words, and results go to buffers the caller owns.
+ *
+ * The byte loops, strlen, memchr and memcpy, run on SSE2 or AVX2 where the CPU has them. The first call picks the
+ * widest instruction set the CPU and the kernel support; scprt_set_isa overrides the choice.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The instruction sets of the byte loops */
+enum scprt_isa {
+  SCPRT_ISA_SCALAR = 0,
+  SCPRT_ISA_SSE2 = 1,
+  SCPRT_ISA_AVX2 = 2,
+};
+
+/* The size of the buffers of scprt_reader and scprt_writer */
+#define SCPRT_BUFFER_SIZE 4096
+
+/* The room scprt_format_int needs, for "-2147483648" and the terminator */
+#define SCPRT_INT_CHARS 12
+
+/**
+ * Get the widest instruction set the CPU and the kernel support.
+ * @return The instruction set.
+ */
+enum scprt_isa scprt_detect_isa(void);
+
+/**
+ * Get the instruction set the byte loops run on.
+ * @return The instruction set.
+ */
+enum scprt_isa scprt_get_isa(void);
+
+/**
+ * Make the byte loops run on an instruction set, for tests and benchmarks. Not safe while other threads call into
+ * the runtime.
+ * @param isa The instruction set.
+ * @return 1 if the CPU supports it and it is in use, 0 if it is not and the choice is unchanged.
+ */
+int scprt_set_isa(enum scprt_isa isa);
+
+/**
+ * Get the length of a string.
+ * @param s The string.
+ * @return The number of bytes before the terminator.
+ */
+size_t scprt_strlen(const char *s);
+
+/**
+ * Find the first occurrence of a byte.
+ * @param s The bytes.
+ * @param c The byte, converted to unsigned char.
+ * @param n The number of bytes.
+ * @return The address of the byte, or NULL if the n bytes do not hold it.
+ */
+const void *scprt_memchr(const void *s, int c, size_t n);
+
+/**
+ * Copy bytes between buffers that do not overlap, or that are the same buffer.
+ * @param dst The destination.
+ * @param src The source.
+ * @param n The number of bytes.
+ * @return dst.
+ */
+void *scprt_memcpy(void *dst, const void *src, size_t n);
+
+/**
+ * Concatenate two strings, like string_concat. The result is cut to fit the buffer.
+ * @param out The buffer receiving the result, which may be left itself but must not otherwise overlap the strings.
+ * @param capacity The size of the buffer, at least 1.
+ * @param left The first string.
+ * @param right The second string.
+ * @return The length of the result.
+ */
+size_t scprt_concat(char *out, size_t capacity, const char *left, const char *right);
+
+/**
+ * Repeat a string, like string_repeat; a count below 1 gives the empty string. The result is cut to fit the buffer.
+ * @param out The buffer receiving the result, which may be s itself but must not otherwise overlap it.
+ * @param capacity The size of the buffer, at least 1.
+ * @param s The string.
+ * @param count The number of copies.
+ * @return The length of the result.
+ */
+size_t scprt_repeat(char *out, size_t capacity, const char *s, int32_t count);
+
+/**
+ * Cut a string at its first line break, like string_trim_newline.
+ * @param s The string, of n bytes and with room for a terminator after them.
+ * @param n Its length.
+ * @return The length of the result.
+ */
+size_t scprt_trim_newline(char *s, size_t n);
+
+/**
+ * Parse a number like the read integer syscall: blanks are skipped, a sign is optional, the digits run until the
+ * first other byte and wrap around modulo 2^32, and no digit reads as 0.
+ * @param s The text.
+ * @param n Its length.
+ * @return The number.
+ */
+int32_t scprt_parse_int(const char *s, size_t n);
+
+/**
+ * Format a number in decimal.
+ * @param value The number.
+ * @param out The buffer, of SCPRT_INT_CHARS bytes; it receives the digits and a terminator.
+ * @return The number of digits and sign bytes.
+ */
+size_t scprt_format_int(int32_t value, char *out);
+
+/**
+ * A buffered reader of a file descriptor. Initialize it with scprt_reader_init; its fields are private.
+ */
+struct scprt_reader {
+  int fd_;
+  int eof_;
+  size_t begin_;
+  size_t end_;
+  char buffer_[SCPRT_BUFFER_SIZE];
+};
+
+/**
+ * Initialize a reader.
+ * @param reader The reader.
+ * @param fd The file descriptor to read, 0 for stdin.
+ */
+void scprt_reader_init(struct scprt_reader *reader, int fd);
+
+/**
+ * Read a line like the read string syscall followed by string_trim_newline: at most capacity - 1 bytes, stopping
+ * after a newline, cut at the first line break. The rest of a longer line is left for the next read.
+ * @param reader The reader.
+ * @param out The buffer receiving the line and a terminator.
+ * @param capacity The size of the buffer, at least 1.
+ * @return The length of the line.
+ */
+size_t scprt_read_line(struct scprt_reader *reader, char *out, size_t capacity);
+
+/**
+ * Read a line, of any length, and parse it like scprt_parse_int.
+ * @param reader The reader.
+ * @return The number, 0 at the end of the input.
+ */
+int32_t scprt_read_int(struct scprt_reader *reader);
+
+/**
+ * A buffered writer to a file descriptor. Initialize it with scprt_writer_init; its fields are private.
+ */
+struct scprt_writer {
+  int fd_;
+  int error_;
+  size_t size_;
+  char buffer_[SCPRT_BUFFER_SIZE];
+};
+
+/**
+ * Initialize a writer.
+ * @param writer The writer.
+ * @param fd The file descriptor to write, 1 for stdout.
+ */
+void scprt_writer_init(struct scprt_writer *writer, int fd);
+
+/**
+ * Write bytes. Writes at least as large as the buffer go to the file descriptor directly.
+ * @param writer The writer.
+ * @param data The bytes.
+ * @param n The number of bytes.
+ */
+void scprt_write(struct scprt_writer *writer, const char *data, size_t n);
+
+/**
+ * Write a string.
+ * @param writer The writer.
+ * @param s The string.
+ */
+void scprt_write_str(struct scprt_writer *writer, const char *s);
+
+/**
+ * Write a number in decimal.
+ * @param writer The writer.
+ * @param value The number.
+ */
+void scprt_write_int(struct scprt_writer *writer, int32_t value);
+
+/**
+ * Write out the buffered bytes.
+ * @param writer The writer.
+ * @return 0, or -1 if a write to the file descriptor has failed since the writer was initialized.
+ */
+int scprt_flush(struct scprt_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
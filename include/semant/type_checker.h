@@ -15,8 +15,9 @@ class TypeChecker {
  public:
   /**
    * Constructor for the TypeChecker.
+   * @param ast The AST to check, or nullptr to check statements one at a time with CheckStatement.
    */
-  explicit TypeChecker(std::shared_ptr<core::AST> ast);
+  explicit TypeChecker(std::shared_ptr<core::AST> ast = nullptr);
 
   /**
    * Default destructor for the TypeChecker.
@@ -28,6 +29,19 @@ class TypeChecker {
    */
   auto CheckType() -> std::shared_ptr<core::TypeEnvironment>;
 
+  /**
+   * Check one statement against the symbols of the statements checked before it, adding the symbol it declares.
+   * @param statement The ASSIGN node of the statement.
+   * @return False if the statement has a type error, which is reported to the diagnostics.
+   */
+  auto CheckStatement(const std::shared_ptr<core::AST::ASTNode> &statement) -> bool;
+
+  /**
+   * Get the type environment built so far.
+   * @return The type environment.
+   */
+  auto GetTypeEnvironment() const -> const std::shared_ptr<core::TypeEnvironment> & { return type_environment_; }
+
  private:
   /* The type environment for the type checker. */
   std::shared_ptr<core::TypeEnvironment> type_environment_;
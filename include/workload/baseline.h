@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace scp::workload {
+
+/**
+ * The repeated measurements of one benchmark metric, where lower values are better.
+ */
+struct BenchmarkSeries {
+  /* The name, such as "heavy_test/codegen/wall_ms" */
+  std::string name_;
+  /* The unit, such as "ms", "bytes" or "instructions" */
+  std::string unit_;
+  /* One value per run */
+  std::vector<double> samples_;
+};
+
+/**
+ * The results of one benchmark run, stamped with the revision that was measured.
+ */
+struct BenchmarkBaseline {
+  /**
+   * Render the baseline as JSON, readable by FromJson.
+   * @return The JSON text.
+   */
+  auto ToJson() const -> std::string;
+
+  /**
+   * Read a baseline written by ToJson, or the --benchmark_out JSON of a Google Benchmark target.
+   * Google Benchmark results need --benchmark_repetitions; every repetition becomes one sample of the
+   * "<name>/real_time" and "<name>/cpu_time" series, and aggregates are ignored.
+   * @param text The JSON text.
+   * @return The baseline.
+   * @throws std::runtime_error If the text is not JSON or in neither format.
+   */
+  static auto FromJson(const std::string &text) -> BenchmarkBaseline;
+
+  /**
+   * Find a series by name.
+   * @param name The name.
+   * @return The series, or nullptr if there is none.
+   */
+  auto Find(const std::string &name) const -> const BenchmarkSeries *;
+
+  /* The git revision of the measured tree, with a "-dirty" suffix for uncommitted changes, empty if unknown */
+  std::string revision_;
+  /* What was measured with which options, free-form */
+  std::string description_;
+  /* The series in the order they were recorded */
+  std::vector<BenchmarkSeries> series_;
+};
+
+/**
+ * How one metric changed between two baselines, with a confidence interval from Welch's t-test.
+ */
+struct BenchmarkChange {
+  /* The name of the series */
+  std::string name_;
+  /* The unit of the series */
+  std::string unit_;
+  /* Mean of the base samples */
+  double base_mean_{0};
+  /* Mean of the candidate samples */
+  double candidate_mean_{0};
+  /* Relative change of the mean, 0.1 when the candidate is 10% higher */
+  double change_{0};
+  /* Lower bound of the confidence interval of the relative change */
+  double change_low_{0};
+  /* Upper bound of the confidence interval of the relative change */
+  double change_high_{0};
+  /* Whether the interval excludes zero */
+  bool significant_{false};
+  /* Whether the change is significant, an increase and at least the threshold */
+  bool regression_{false};
+  /* Whether the change is significant, a decrease and at least the threshold */
+  bool improvement_{false};
+};
+
+/**
+ * Compare the series two baselines have in common. A series with fewer than two samples on either side has no
+ * confidence interval and is never significant; series without variance, such as instruction counts, are
+ * significant whenever their means differ.
+ * @param base The baseline to compare against.
+ * @param candidate The new results.
+ * @param confidence The confidence level of the intervals, such as 0.95.
+ * @param threshold The smallest relative change reported as a regression or improvement, such as 0.02.
+ * @return One change per common series, in the order of the candidate.
+ */
+auto CompareBaselines(const BenchmarkBaseline &base, const BenchmarkBaseline &candidate, double confidence,
+                      double threshold) -> std::vector<BenchmarkChange>;
+
+/**
+ * Get a quantile of Student's t distribution.
+ * @param probability The cumulative probability, in (0, 1).
+ * @param degrees_of_freedom The degrees of freedom, positive and not necessarily whole.
+ * @return The value t with P(T <= t) = probability.
+ */
+auto StudentTQuantile(double probability, double degrees_of_freedom) -> double;
+
+/**
+ * Get the git revision of a working tree, marked "-dirty" when tracked files have uncommitted changes.
+ * @param directory The working tree; empty for the source tree this build came from.
+ * @return The revision, empty if git or the repository is unavailable.
+ */
+auto GetGitRevision(const std::string &directory = "") -> std::string;
+
+}  // namespace scp::workload
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace scp::workload {
+
+/**
+ * Knobs of the generated programs.
+ */
+struct GeneratorOptions {
+  /* Seed of the generator; equal options always give the same program */
+  uint64_t seed_{1};
+  /* Number of statements */
+  size_t statements_{1000};
+  /* Maximum nesting of parenthesized subexpressions */
+  size_t max_depth_{2};
+  /* Maximum number of operands joined by + or * in one expression */
+  size_t max_chain_{4};
+  /* Share of expressions that are strings rather than numbers, in [0, 1] */
+  double string_share_{0.3};
+  /* Maximum length of a string literal, and of the digits of a number literal (at most 9) */
+  size_t max_literal_length_{8};
+  /* Share of statements reading a variable from stdin, in [0, 1] */
+  double stdin_share_{0.0};
+  /* Share of statements printing to stdout, in [0, 1] */
+  double output_share_{0.1};
+  /* Share of assignments defining a new variable rather than reassigning one, in [0, 1] */
+  double new_variable_share_{0.5};
+};
+
+/**
+ * Set a knob from its command line spelling, shared by the tools that generate programs.
+ * Knobs: seed, statements, depth, chain, string-share, literal-length, stdin-share, output-share, new-variable-share.
+ * @param options The options to change.
+ * @param name The name of the knob.
+ * @param value The value.
+ * @return False if there is no such knob or the value is malformed.
+ */
+auto SetGeneratorOption(GeneratorOptions &options, const std::string &name, const std::string &value) -> bool;
+
+/**
+ * Deterministic generator of valid SCP programs.
+ * Every program type checks. The generator evaluates what it emits, so numbers stay far from overflow and strings
+ * stay short, and a generated program also runs without traps under the rope string runtime when given input for
+ * its stdin reads. The flat runtime shares one concatenation buffer, so nested concatenations do not run there.
+ */
+class ProgramGenerator {
+ public:
+  /**
+   * Constructor for the ProgramGenerator.
+   * @param options The knobs of the program.
+   */
+  explicit ProgramGenerator(GeneratorOptions options);
+
+  /**
+   * Generate the program, one statement per line.
+   * @return The source.
+   */
+  auto Generate() -> std::string;
+
+  /**
+   * Generate the program into a stream, for programs too large to hold twice.
+   * @param out The stream.
+   */
+  void Generate(std::ostream &out);
+
+ private:
+  /**
+   * A variable of the generated program.
+   */
+  struct Variable {
+    /* The name */
+    std::string name_;
+    /* Whether the variable holds a string */
+    bool is_string_;
+    /* The number it holds, or the upper bound of the length of the string */
+    int64_t value_;
+  };
+
+  /**
+   * An expression with what it evaluates to.
+   */
+  struct Expression {
+    /* The source text */
+    std::string text_;
+    /* The number it evaluates to, or the upper bound of the length of the string */
+    int64_t value_;
+  };
+
+  /**
+   * Get the next pseudo-random number (SplitMix64, identical on every platform).
+   * @return The number.
+   */
+  auto Next() -> uint64_t;
+
+  /**
+   * Get a pseudo-random number in [low, high].
+   * @return The number.
+   */
+  auto Uniform(uint64_t low, uint64_t high) -> uint64_t;
+
+  /**
+   * Draw an event of the given probability.
+   * @param probability The probability in [0, 1].
+   * @return True if the event happens.
+   */
+  auto Chance(double probability) -> bool;
+
+  /**
+   * Pick a random variable of a type.
+   * @param is_string Whether a string variable is wanted.
+   * @return The variable, or nullptr if none exists.
+   */
+  auto PickVariable(bool is_string) -> Variable *;
+
+  /**
+   * Generate one statement.
+   * @return The statement, with its semicolon.
+   */
+  auto GenerateStatement() -> std::string;
+
+  /**
+   * Generate a number expression.
+   * @param depth The remaining nesting depth.
+   * @return The expression.
+   */
+  auto GenerateNumber(size_t depth) -> Expression;
+
+  /**
+   * Generate an operand of a number expression.
+   * @param depth The remaining nesting depth.
+   * @return The operand.
+   */
+  auto GenerateNumberFactor(size_t depth) -> Expression;
+
+  /**
+   * Generate a string expression.
+   * @param depth The remaining nesting depth.
+   * @return The expression.
+   */
+  auto GenerateString(size_t depth) -> Expression;
+
+  /**
+   * Generate an operand of a string expression.
+   * @param depth The remaining nesting depth.
+   * @return The operand.
+   */
+  auto GenerateStringFactor(size_t depth) -> Expression;
+
+  /* The knobs */
+  GeneratorOptions options_;
+  /* The state of the random number generator */
+  uint64_t state_;
+  /* The variables defined so far */
+  std::vector<Variable> variables_;
+  /* Indices of the number variables in variables_ */
+  std::vector<size_t> number_variables_;
+  /* Indices of the string variables in variables_ */
+  std::vector<size_t> string_variables_;
+};
+
+}  // namespace scp::workload
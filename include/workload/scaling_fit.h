@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+namespace scp::workload {
+
+/**
+ * A power law y = coefficient * n^exponent.
+ */
+struct PowerLaw {
+  /* The growth exponent: 1 is linear, 2 quadratic */
+  double exponent_{0};
+  /* The constant factor */
+  double coefficient_{0};
+};
+
+/**
+ * Fit a power law to measurements by least squares on their logarithms.
+ * Measurements with a non-positive size or value are skipped, as they have no logarithm.
+ * @param sizes The input sizes.
+ * @param values The measured values, one per size.
+ * @return The fitted law; exponent 0 if fewer than two distinct sizes remain.
+ */
+auto FitPowerLaw(const std::vector<double> &sizes, const std::vector<double> &values) -> PowerLaw;
+
+}  // namespace scp::workload
@@ -0,0 +1,159 @@
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgen/asm_stats.h"
+#include "cgen/instruction_buffer.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * Print the usage information for the asm-stats program.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " <path>..." << std::endl;
+  std::cout << "       " << programName << " --diff <before> <after>" << std::endl;
+  std::cout << "  path: A generated .s file, or a directory searched recursively for .s files" << std::endl;
+  std::cout << "  --diff: Compare two files or two directories, e.g. the corpus compiled by two compiler builds"
+            << std::endl;
+  std::cout << "          Directory entries are matched by relative path" << std::endl;
+}
+
+/**
+ * Collect the statistics of every assembly file below a path.
+ * @param path A .s file or a directory.
+ * @return Relative file name to statistics.
+ */
+auto CollectPath(const fs::path &path) -> std::map<std::string, scp::cgen::AsmStats> {
+  std::vector<fs::path> files;
+  if (fs::is_directory(path)) {
+    for (const auto &entry : fs::recursive_directory_iterator(path)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".s") {
+        files.push_back(entry.path());
+      }
+    }
+  } else if (fs::exists(path)) {
+    files.push_back(path);
+  } else {
+    throw std::runtime_error("Cannot open path: " + path.string());
+  }
+
+  std::map<std::string, scp::cgen::AsmStats> stats;
+  for (const auto &file : files) {
+    std::ifstream input(file);
+    if (!input.is_open()) {
+      throw std::runtime_error("Cannot open file: " + file.string());
+    }
+    std::stringstream content;
+    content << input.rdbuf();
+    std::string name = fs::is_directory(path) ? fs::relative(file, path).string() : file.filename().string();
+    stats[name] = scp::cgen::AsmStats::Collect(scp::cgen::InstructionBuffer(content.str()));
+  }
+  return stats;
+}
+
+/**
+ * Print a per-file summary followed by the corpus totals.
+ * @param paths The files and directories to report on.
+ */
+void Report(const std::vector<std::string> &paths) {
+  scp::cgen::AsmStats total;
+  int file_count = 0;
+  for (const auto &path : paths) {
+    for (const auto &[name, stats] : CollectPath(path)) {
+      std::cout << std::left << std::setw(48) << name << std::right << std::setw(8) << stats.instruction_count_
+                << " instrs" << std::setw(8) << stats.text_bytes_ << " text" << std::setw(8) << stats.data_bytes_
+                << " data" << std::setw(7) << std::fixed << std::setprecision(1) << stats.GetMemoryShare() * 100
+                << "% mem" << std::endl;
+      total += stats;
+      file_count++;
+    }
+  }
+  std::cout << std::endl << "total over " << file_count << " file(s):" << std::endl << total.Format();
+}
+
+/**
+ * Print the per-file text size changes and the corpus-wide comparison.
+ * @param before The baseline file or directory.
+ * @param after The new file or directory.
+ */
+void Diff(const std::string &before, const std::string &after) {
+  auto before_stats = CollectPath(before);
+  auto after_stats = CollectPath(after);
+  if (!fs::is_directory(before) && !fs::is_directory(after) && before_stats.size() == 1 && after_stats.size() == 1) {
+    std::cout << scp::cgen::AsmStats::FormatDiff(before_stats.begin()->second, after_stats.begin()->second);
+    return;
+  }
+
+  std::set<std::string> names;
+  for (const auto &entry : before_stats) {
+    names.insert(entry.first);
+  }
+  for (const auto &entry : after_stats) {
+    names.insert(entry.first);
+  }
+
+  // Only files present on both sides take part in the totals, so the numbers compare like with like
+  scp::cgen::AsmStats before_total;
+  scp::cgen::AsmStats after_total;
+  int changed = 0;
+  for (const auto &name : names) {
+    auto lhs = before_stats.find(name);
+    auto rhs = after_stats.find(name);
+    if (lhs == before_stats.end() || rhs == after_stats.end()) {
+      std::cout << std::left << std::setw(48) << name << (lhs == before_stats.end() ? "only after" : "only before")
+                << std::endl;
+      continue;
+    }
+    before_total += lhs->second;
+    after_total += rhs->second;
+    if (lhs->second.text_bytes_ != rhs->second.text_bytes_ || lhs->second.data_bytes_ != rhs->second.data_bytes_) {
+      std::cout << std::left << std::setw(48) << name << std::right << " text " << std::setw(6)
+                << lhs->second.text_bytes_ << " -> " << std::setw(6) << rhs->second.text_bytes_ << "   data "
+                << std::setw(6) << lhs->second.data_bytes_ << " -> " << std::setw(6) << rhs->second.data_bytes_
+                << std::endl;
+      changed++;
+    }
+  }
+  std::cout << std::endl << changed << " file(s) changed size" << std::endl;
+  std::cout << scp::cgen::AsmStats::FormatDiff(before_total, after_total);
+}
+
+/**
+ * Main entry point for the asm-stats program.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  if (argc < 2) {
+    std::cerr << "Error: Invalid number of arguments." << std::endl;
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  try {
+    std::string first = argv[1];
+    if (first == "--diff") {
+      if (argc != 4) {
+        std::cerr << "Error: --diff expects two paths." << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      Diff(argv[2], argv[3]);
+      return 0;
+    }
+    Report(std::vector<std::string>(argv + 1, argv + argc));
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+}
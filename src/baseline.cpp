@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cgen/asm_stats.h"
+#include "cgen/code_generator.h"
+#include "cgen/instruction_buffer.h"
+#include "driver/compile_report.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+#include "workload/baseline.h"
+#include "workload/program_generator.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The timed phases, in the order they run
+const std::vector<std::string> PHASES = {"lex", "parse", "typecheck", "codegen"};
+
+/**
+ * A program to measure.
+ */
+struct Workload {
+  /* The series prefix, the file stem or "synthetic/<statements>" */
+  std::string name_;
+  /* The program */
+  std::string source_;
+};
+
+/**
+ * Compile a program once and append one sample to each of its series.
+ * @param workload The program.
+ * @param options The code generator options.
+ * @param baseline The baseline to append to; the series are created on the first call.
+ */
+void MeasureOnce(const Workload &workload, const scp::cgen::CodeGeneratorOptions &options,
+                 scp::workload::BenchmarkBaseline &baseline) {
+  scp::driver::CompileReport report;
+  std::string code;
+  {
+    scp::driver::PhaseTimer lex_timer(&report, "lex");
+    scp::parser::SLRParser parser(workload.name_);
+    parser.SetInput(workload.source_);
+    if (!parser.Lex()) {
+      throw std::runtime_error("Failed to tokenize " + workload.name_);
+    }
+    lex_timer.Stop();
+
+    scp::driver::PhaseTimer parse_timer(&report, "parse");
+    auto ast = parser.Parse();
+    if (!ast) {
+      throw std::runtime_error("Failed to parse " + workload.name_);
+    }
+    parse_timer.Stop();
+
+    scp::driver::PhaseTimer check_timer(&report, "typecheck");
+    scp::semant::TypeChecker type_checker(ast);
+    auto type_environment = type_checker.CheckType();
+    check_timer.Stop();
+
+    scp::driver::PhaseTimer codegen_timer(&report, "codegen");
+    scp::cgen::CodeGenerator code_generator(ast, type_environment, options);
+    code = code_generator.GenerateCode();
+    codegen_timer.Stop();
+  }
+  auto stats = scp::cgen::AsmStats::Collect(scp::cgen::InstructionBuffer(code));
+
+  std::vector<std::pair<std::string, double>> values;
+  std::vector<std::string> units;
+  double total = 0;
+  uint64_t allocated_bytes = 0;
+  uint64_t peak_bytes = 0;
+  for (const auto &phase : report.phases_) {
+    values.emplace_back(phase.name_ + "/wall_ms", phase.wall_seconds_ * 1e3);
+    units.emplace_back("ms");
+    total += phase.wall_seconds_ * 1e3;
+    allocated_bytes += phase.allocated_bytes_;
+    peak_bytes = std::max(peak_bytes, phase.peak_bytes_);
+  }
+  values.emplace_back("total/wall_ms", total);
+  values.emplace_back("allocated_bytes", static_cast<double>(allocated_bytes));
+  values.emplace_back("peak_heap_bytes", static_cast<double>(peak_bytes));
+  values.emplace_back("instructions", stats.instruction_count_);
+  values.emplace_back("text_bytes", stats.text_bytes_);
+  units.insert(units.end(), {"ms", "bytes", "bytes", "instructions", "bytes"});
+
+  for (size_t i = 0; i < values.size(); i++) {
+    std::string name = workload.name_ + "/" + values[i].first;
+    auto it = std::find_if(baseline.series_.begin(), baseline.series_.end(),
+                           [&name](const auto &series) { return series.name_ == name; });
+    if (it == baseline.series_.end()) {
+      baseline.series_.push_back({name, units[i], {}});
+      it = baseline.series_.end() - 1;
+    }
+    it->samples_.push_back(values[i].second);
+  }
+}
+
+/**
+ * Collect the programs of the inputs, expanding directories to their .scpl files in name order.
+ * @param inputs The files and directories.
+ * @param workloads The list to append to.
+ * @return False if an input cannot be read.
+ */
+auto LoadInputs(const std::vector<std::string> &inputs, std::vector<Workload> &workloads) -> bool {
+  for (const auto &input : inputs) {
+    std::vector<fs::path> paths;
+    if (fs::is_directory(input)) {
+      for (const auto &entry : fs::directory_iterator(input)) {
+        if (entry.path().extension() == ".scpl") {
+          paths.push_back(entry.path());
+        }
+      }
+      std::sort(paths.begin(), paths.end());
+    } else {
+      paths.emplace_back(input);
+    }
+    for (const auto &path : paths) {
+      std::ifstream file(path);
+      if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file: " << path.string() << std::endl;
+        return false;
+      }
+      std::stringstream content;
+      content << file.rdbuf();
+      workloads.push_back({path.stem().string(), content.str()});
+    }
+  }
+  return true;
+}
+
+/**
+ * Read a baseline file.
+ * @param path The path.
+ * @return The baseline.
+ */
+auto ReadBaseline(const std::string &path) -> scp::workload::BenchmarkBaseline {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Cannot open file: " + path);
+  }
+  std::stringstream content;
+  content << file.rdbuf();
+  try {
+    return scp::workload::BenchmarkBaseline::FromJson(content.str());
+  } catch (const std::exception &e) {
+    throw std::runtime_error(path + ": " + e.what());
+  }
+}
+
+/**
+ * Print the usage information for the baseline tool.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " record [options] <file|directory>..." << std::endl;
+  std::cout << "       " << programName << " compare [options] <base.json> <candidate.json>" << std::endl;
+  std::cout << "  record: Compile every program repeatedly and write the time of each phase, the allocated and"
+            << std::endl;
+  std::cout << "  peak heap bytes and the emitted instructions as JSON, stamped with the git revision" << std::endl;
+  std::cout << "    --repeat <N>: Measured compilations per program, after one warm-up (default 10)" << std::endl;
+  std::cout << "    --generate <N>: Also measure a generated program of N statements, may be repeated" << std::endl;
+  std::cout << "    -O0/-O1/-O2: Optimization level of the code generator" << std::endl;
+  std::cout << "    --revision <rev>: Record this revision instead of asking git" << std::endl;
+  std::cout << "    -o <file>: Write the JSON to a file instead of stdout" << std::endl;
+  std::cout << "  compare: Report the series whose mean changed significantly (Welch's t-test) and exit 1 if"
+            << std::endl;
+  std::cout << "  any got worse; also reads the --benchmark_out JSON of Google Benchmark targets such as scp_bench,"
+            << std::endl;
+  std::cout << "  run with --benchmark_repetitions=<N>" << std::endl;
+  std::cout << "    --confidence <p>: Confidence level of the intervals (default 0.95)" << std::endl;
+  std::cout << "    --threshold <r>: Smallest relative change that counts (default 0.02)" << std::endl;
+  std::cout << "    --all: Also print the series that did not change" << std::endl;
+}
+
+/**
+ * Record a baseline.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments, the mode at index 1.
+ * @return Exit status code.
+ */
+auto Record(int argc, char *argv[]) -> int {
+  size_t repeat = 10;
+  std::vector<size_t> generated;
+  std::vector<std::string> inputs;
+  std::string output_file;
+  std::string revision;
+  bool has_revision = false;
+  std::string level = "-O0";
+  scp::cgen::CodeGeneratorOptions options;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--repeat" && has_value) {
+      repeat = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--generate" && has_value) {
+      generated.push_back(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--revision" && has_value) {
+      revision = argv[++i];
+      has_revision = true;
+    } else if (arg == "-o" && has_value) {
+      output_file = argv[++i];
+    } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+      level = arg;
+      options.apply_peephole_rules_ = arg != "-O0";
+      options.eliminate_redundant_loads_ = arg != "-O0";
+      options.schedule_instructions_ = arg == "-O2";
+    } else if (arg.rfind('-', 0) == 0) {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (repeat == 0 || (inputs.empty() && generated.empty())) {
+    std::cerr << "Error: record needs inputs or --generate, and a positive --repeat." << std::endl;
+    return 1;
+  }
+
+  std::vector<Workload> workloads;
+  if (!LoadInputs(inputs, workloads)) {
+    return 1;
+  }
+  for (auto statements : generated) {
+    scp::workload::GeneratorOptions generator_options;
+    generator_options.statements_ = statements;
+    workloads.push_back({"synthetic/" + std::to_string(statements),
+                         scp::workload::ProgramGenerator(generator_options).Generate()});
+  }
+
+  scp::workload::BenchmarkBaseline baseline;
+  baseline.revision_ = has_revision ? revision : scp::workload::GetGitRevision();
+  baseline.description_ = "scp-baseline record " + level + " --repeat " + std::to_string(repeat);
+  try {
+    for (const auto &workload : workloads) {
+      // The warm-up run pays for the shared SLR tables and faults in the allocator's pages
+      scp::workload::BenchmarkBaseline warm_up;
+      MeasureOnce(workload, options, warm_up);
+      for (size_t run = 0; run < repeat; run++) {
+        MeasureOnce(workload, options, baseline);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (output_file.empty()) {
+    std::cout << baseline.ToJson();
+    return 0;
+  }
+  std::ofstream output(output_file);
+  output << baseline.ToJson();
+  if (!output.good()) {
+    std::cerr << "Error: Cannot write output file: " << output_file << std::endl;
+    return 1;
+  }
+  std::cerr << "Recorded " << baseline.series_.size() << " series of " << workloads.size() << " programs at revision "
+            << (baseline.revision_.empty() ? "unknown" : baseline.revision_) << " to " << output_file << std::endl;
+  return 0;
+}
+
+/**
+ * Compare two baselines.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments, the mode at index 1.
+ * @return Exit status code: 1 if a series regressed.
+ */
+auto Compare(int argc, char *argv[]) -> int {
+  double confidence = 0.95;
+  double threshold = 0.02;
+  bool all = false;
+  std::vector<std::string> files;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--confidence" && has_value) {
+      confidence = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--threshold" && has_value) {
+      threshold = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--all") {
+      all = true;
+    } else if (arg.rfind('-', 0) == 0) {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.size() != 2 || confidence <= 0 || confidence >= 1 || threshold < 0) {
+    std::cerr << "Error: compare needs two files, 0 < --confidence < 1 and --threshold >= 0." << std::endl;
+    return 1;
+  }
+
+  scp::workload::BenchmarkBaseline base;
+  scp::workload::BenchmarkBaseline candidate;
+  try {
+    base = ReadBaseline(files[0]);
+    candidate = ReadBaseline(files[1]);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  auto changes = scp::workload::CompareBaselines(base, candidate, confidence, threshold);
+
+  auto describe = [](const scp::workload::BenchmarkBaseline &baseline) {
+    return (baseline.revision_.empty() ? std::string("unknown revision") : baseline.revision_) +
+           (baseline.description_.empty() ? "" : " (" + baseline.description_ + ")");
+  };
+  std::cout << "base:      " << describe(base) << std::endl;
+  std::cout << "candidate: " << describe(candidate) << std::endl;
+
+  size_t width = 6;
+  for (const auto &change : changes) {
+    width = std::max(width, change.name_.size());
+  }
+  std::cout << std::left << std::setw(static_cast<int>(width) + 2) << "series" << std::right << std::setw(14) << "base"
+            << std::setw(14) << "candidate" << std::setw(10) << "change" << std::setw(22) << "interval" << "  verdict"
+            << std::endl;
+
+  size_t regressions = 0;
+  size_t improvements = 0;
+  size_t undecided = 0;
+  std::cout << std::fixed;
+  for (const auto &change : changes) {
+    regressions += change.regression_ ? 1 : 0;
+    improvements += change.improvement_ ? 1 : 0;
+    const auto *base_series = base.Find(change.name_);
+    const auto *candidate_series = candidate.Find(change.name_);
+    bool sampled = base_series->samples_.size() >= 2 && candidate_series->samples_.size() >= 2;
+    undecided += sampled ? 0 : 1;
+    if (!all && !change.regression_ && !change.improvement_) {
+      continue;
+    }
+    std::ostringstream interval;
+    interval << std::fixed << std::setprecision(1) << "[" << change.change_low_ * 100 << "%, "
+             << change.change_high_ * 100 << "%]";
+    const char *verdict = change.regression_     ? "REGRESSION"
+                          : change.improvement_  ? "improvement"
+                          : !sampled             ? "too few samples"
+                          : change.significant_  ? "below threshold"
+                                                 : "unchanged";
+    std::cout << std::left << std::setw(static_cast<int>(width) + 2) << change.name_ << std::right
+              << std::setprecision(3) << std::setw(14) << change.base_mean_ << std::setw(14)
+              << change.candidate_mean_ << std::setprecision(1) << std::setw(9) << change.change_ * 100 << "%"
+              << std::setw(22) << interval.str() << "  " << verdict << std::endl;
+  }
+
+  std::cout << regressions << " regressions, " << improvements << " improvements in " << changes.size()
+            << " common series at " << std::setprecision(0) << confidence * 100 << "% confidence" << std::endl;
+  if (undecided > 0) {
+    std::cerr << "Warning: " << undecided << " series have fewer than two samples on a side and cannot be judged;"
+              << " record more repetitions." << std::endl;
+  }
+  return regressions == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+/**
+ * Main entry point for the baseline tool.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "record") {
+    return Record(argc, argv);
+  }
+  if (mode == "compare") {
+    return Compare(argc, argv);
+  }
+  PrintUsage(argv[0]);
+  return mode == "-h" || mode == "--help" ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#include "cgen/asm_stats.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+
+namespace scp::cgen {
+
+namespace {
+
+// Check whether an operand is a plain immediate, e.g. "-4" or "0x10"
+auto IsImmediate(const std::string &operand) -> bool {
+  return !operand.empty() && (std::isdigit(static_cast<unsigned char>(operand[0])) != 0 || operand[0] == '-');
+}
+
+// Number of machine words SPIM assembles an instruction into
+auto MachineWords(const Instruction &instruction) -> int {
+  const auto &opcode = instruction.opcode_;
+  const auto &operands = instruction.operands_;
+  if (opcode == "la") {
+    return 2;
+  }
+  if (opcode == "li" && operands.size() == 2) {
+    long value = std::strtol(operands[1].c_str(), nullptr, 0);
+    return value < -32768 || value > 65535 ? 2 : 1;
+  }
+  if ((instruction.IsLoad() || instruction.IsStore()) && operands.size() == 2 &&
+      operands[1].find('(') == std::string::npos) {
+    return 2;  // lui $at plus the access
+  }
+  if (opcode == "blt" || opcode == "ble" || opcode == "bgt" || opcode == "bge" || opcode == "bltu" ||
+      opcode == "bleu" || opcode == "bgtu" || opcode == "bgeu") {
+    return 2;  // slt plus a branch
+  }
+  if (operands.size() == 3 && (((opcode == "beq" || opcode == "bne") && IsImmediate(operands[1])) ||
+                                (opcode == "mul" && IsImmediate(operands[2])))) {
+    return 2;  // the immediate is first loaded into $at
+  }
+  return 1;
+}
+
+// Size in bytes of a quoted string literal, escapes counted once
+auto LiteralBytes(const std::string &literal) -> int {
+  int bytes = 0;
+  for (size_t i = 1; i < literal.size() && literal[i] != '"'; ++i) {
+    if (literal[i] == '\\') {
+      ++i;
+    }
+    bytes++;
+  }
+  return bytes;
+}
+
+// Size in bytes of a data directive line, given the bytes emitted so far for alignment
+auto DataBytes(const Instruction &line, int offset) -> int {
+  std::string body = line.text_;
+  if (!line.label_.empty()) {
+    body = body.substr(body.find(':') + 1);
+  }
+  std::istringstream stream(body);
+  std::string directive;
+  stream >> directive;
+  std::string rest;
+  std::getline(stream, rest);
+  auto begin = rest.find_first_not_of(" \t");
+  rest = begin == std::string::npos ? "" : rest.substr(begin);
+
+  if (directive == ".asciiz" || directive == ".ascii") {
+    return LiteralBytes(rest) + (directive == ".asciiz" ? 1 : 0);
+  }
+  if (directive == ".space") {
+    return std::atoi(rest.c_str());
+  }
+  int size = directive == ".word" ? 4 : directive == ".half" ? 2 : directive == ".byte" ? 1 : 0;
+  if (size == 0) {
+    return 0;
+  }
+  int count = 1;
+  for (char c : rest.substr(0, rest.find('#'))) {
+    count += c == ',' ? 1 : 0;
+  }
+  int padding = (size - offset % size) % size;
+  return padding + count * size;
+}
+
+// One row of a comparison table
+void DiffRow(std::ostream &out, const std::string &name, double before, double after, int precision = 0) {
+  out << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(precision)
+      << std::setw(10) << before << std::setw(10) << after << std::showpos << std::setw(10) << after - before
+      << std::noshowpos;
+  if (before != 0 && precision == 0) {
+    out << std::setw(9) << std::setprecision(1) << std::showpos << (after - before) * 100.0 / before << "%"
+        << std::noshowpos;
+  }
+  out << "\n";
+}
+
+}  // namespace
+
+auto AsmStats::Collect(const InstructionBuffer &buffer) -> AsmStats {
+  AsmStats stats;
+  bool in_data = false;
+  for (const auto &line : buffer.GetInstructions()) {
+    if (line.kind_ == Instruction::Kind::DIRECTIVE) {
+      std::istringstream stream(line.label_.empty() ? line.text_ : line.text_.substr(line.text_.find(':') + 1));
+      std::string directive;
+      stream >> directive;
+      if (directive == ".data") {
+        in_data = true;
+      } else if (directive == ".text") {
+        in_data = false;
+      } else if (in_data) {
+        stats.data_bytes_ += DataBytes(line, stats.data_bytes_);
+      }
+      continue;
+    }
+    if (line.kind_ != Instruction::Kind::INSTRUCTION) {
+      continue;
+    }
+
+    stats.instruction_count_++;
+    stats.text_bytes_ += 4 * MachineWords(line);
+    stats.opcode_counts_[line.opcode_]++;
+    if (line.IsLoad() || line.IsStore()) {
+      stats.memory_count_++;
+    }
+    for (const auto &reg : line.GetDefinedRegisters()) {
+      if (reg == "$sp") {
+        stats.stack_adjust_count_++;
+      }
+    }
+    if (line.IsCall() && !line.operands_.empty()) {
+      stats.call_counts_[line.operands_[0]]++;
+    }
+  }
+  return stats;
+}
+
+auto AsmStats::GetMemoryShare() const -> double {
+  return instruction_count_ == 0 ? 0.0 : static_cast<double>(memory_count_) / instruction_count_;
+}
+
+auto AsmStats::operator+=(const AsmStats &other) -> AsmStats & {
+  instruction_count_ += other.instruction_count_;
+  memory_count_ += other.memory_count_;
+  stack_adjust_count_ += other.stack_adjust_count_;
+  text_bytes_ += other.text_bytes_;
+  data_bytes_ += other.data_bytes_;
+  for (const auto &[opcode, count] : other.opcode_counts_) {
+    opcode_counts_[opcode] += count;
+  }
+  for (const auto &[routine, count] : other.call_counts_) {
+    call_counts_[routine] += count;
+  }
+  return *this;
+}
+
+auto AsmStats::Format() const -> std::string {
+  std::stringstream out;
+  out << std::left << std::setw(22) << "instructions" << instruction_count_ << "\n";
+  out << std::setw(22) << "text bytes" << text_bytes_ << "\n";
+  out << std::setw(22) << "data bytes" << data_bytes_ << "\n";
+  out << std::setw(22) << "memory operations" << memory_count_ << " (" << std::fixed << std::setprecision(1)
+      << GetMemoryShare() * 100 << "%)\n";
+  out << std::setw(22) << "stack adjustments" << stack_adjust_count_ << "\n";
+  out << "instruction mix:\n";
+  for (const auto &[opcode, count] : opcode_counts_) {
+    out << "  " << std::setw(20) << opcode << count << "\n";
+  }
+  out << "runtime calls:\n";
+  for (const auto &[routine, count] : call_counts_) {
+    out << "  " << std::setw(20) << routine << count << "\n";
+  }
+  return out.str();
+}
+
+auto AsmStats::FormatDiff(const AsmStats &before, const AsmStats &after) -> std::string {
+  std::stringstream out;
+  out << "  " << std::left << std::setw(24) << "metric" << std::right << std::setw(10) << "before" << std::setw(10)
+      << "after" << std::setw(10) << "delta" << "\n";
+  DiffRow(out, "instructions", before.instruction_count_, after.instruction_count_);
+  DiffRow(out, "text bytes", before.text_bytes_, after.text_bytes_);
+  DiffRow(out, "data bytes", before.data_bytes_, after.data_bytes_);
+  DiffRow(out, "memory operations", before.memory_count_, after.memory_count_);
+  DiffRow(out, "memory share (%)", before.GetMemoryShare() * 100, after.GetMemoryShare() * 100, 1);
+  DiffRow(out, "stack adjustments", before.stack_adjust_count_, after.stack_adjust_count_);
+
+  // Rows for every opcode or routine present on either side
+  auto rows = [&out](const std::string &prefix, const std::map<std::string, int> &lhs,
+                     const std::map<std::string, int> &rhs) {
+    std::set<std::string> keys;
+    for (const auto &entry : lhs) {
+      keys.insert(entry.first);
+    }
+    for (const auto &entry : rhs) {
+      keys.insert(entry.first);
+    }
+    for (const auto &key : keys) {
+      auto lhs_it = lhs.find(key);
+      auto rhs_it = rhs.find(key);
+      DiffRow(out, prefix + key, lhs_it == lhs.end() ? 0 : lhs_it->second, rhs_it == rhs.end() ? 0 : rhs_it->second);
+    }
+  };
+  rows("op ", before.opcode_counts_, after.opcode_counts_);
+  rows("call ", before.call_counts_, after.call_counts_);
+  return out.str();
+}
+
+}  // namespace scp::cgen
@@ -6,30 +6,64 @@
 #include <string>
 #include <utility>
 
+#include "cgen/instruction_buffer.h"
+#include "cgen/instruction_scheduler.h"
+#include "cgen/peephole_optimizer.h"
+#include "cgen/redundant_load_eliminator.h"
+#include "core/trace.h"
 #include "core/type.h"
 
 namespace scp::cgen {
 
 CodeGenerator::CodeGenerator(std::shared_ptr<core::AST> ast,
-                             const std::shared_ptr<core::TypeEnvironment> &type_environment)
-    : ast_(std::move(ast)) {
-  runtime_environment_ = std::make_shared<RuntimeEnvironment>(type_environment);
+                             const std::shared_ptr<core::TypeEnvironment> &type_environment,
+                             CodeGeneratorOptions options)
+    : options_(options), ast_(std::move(ast)) {
+  runtime_environment_ = std::make_shared<RuntimeEnvironment>(type_environment, options_.string_runtime_);
 }
 
 auto CodeGenerator::GenerateCode() const -> std::string {
+  SCP_TRACE_SCOPE("GenerateCode");
   std::stringstream code;
 
   // Generate main program code
   code << ast_->GetRoot()->GenerateCode(runtime_environment_);
 
   // Add string processing utility functions
-  code << std::endl << "# String utility functions" << std::endl;
-  code << GenerateStringUtilities();
+  {
+    SCP_TRACE_SCOPE("EmitRuntime");
+    code << GenerateRuntime(options_.string_runtime_);
+  }
+  return Optimize(code.str(), options_);
+}
 
-  return code.str();
+auto CodeGenerator::GenerateRuntime(StringRuntime string_runtime) -> std::string {
+  std::string header = "\n# String utility functions\n";
+  return header + (string_runtime == StringRuntime::ROPE ? GenerateRopeUtilities() : GenerateStringUtilities());
+}
+
+auto CodeGenerator::Optimize(const std::string &code, const CodeGeneratorOptions &options) -> std::string {
+  if (!options.apply_peephole_rules_ && !options.eliminate_redundant_loads_ && !options.schedule_instructions_ &&
+      !options.fill_delay_slots_) {
+    return code;
+  }
+
+  // Optimize the emitted instructions
+  SCP_TRACE_SCOPE("Optimize");
+  InstructionBuffer buffer(code);
+  if (options.apply_peephole_rules_) {
+    PeepholeOptimizer().Run(buffer);
+  }
+  if (options.eliminate_redundant_loads_) {
+    RedundantLoadEliminator().Run(buffer);
+  }
+  if (options.schedule_instructions_ || options.fill_delay_slots_) {
+    InstructionScheduler(options.fill_delay_slots_).Run(buffer);
+  }
+  return buffer.ToString();
 }
 
-auto CodeGenerator::GenerateStringUtilities() const -> std::string {
+auto CodeGenerator::GenerateStringUtilities() -> std::string {
   std::stringstream code;
 
   // String processing utility functions (defined only in .text section)
@@ -94,6 +128,125 @@ auto CodeGenerator::GenerateStringUtilities() const -> std::string {
   code << "    jr $ra               # return" << std::endl;
   code << std::endl;
 
+  code << GenerateTrimNewline();
+
+  return code.str();
+}
+
+auto CodeGenerator::GenerateRopeUtilities() -> std::string {
+  std::stringstream code;
+
+  // Rope utility functions (defined only in .text section)
+  code << std::endl << ".text" << std::endl;
+
+  // Rope node layout (12 bytes): tag, a, b
+  //   tag 0 = leaf:   a = flat string address
+  //   tag 1 = concat: a = left rope, b = right rope
+  //   tag 2 = repeat: a = rope, b = repeat count
+
+  // Rope concatenation function
+  code << "rope_concat:" << std::endl;
+  code << "    # $a0 = second rope, $a1 = first rope" << std::endl;
+  code << "    # result in $a0" << std::endl;
+  code << "    move $t0, $a1        # left child" << std::endl;
+  code << "    move $t1, $a0        # right child" << std::endl;
+  code << "    li $t2, 1            # concat tag" << std::endl;
+  code << "    j rope_new_node" << std::endl;
+  code << std::endl;
+
+  // Rope repeat function
+  code << "rope_repeat:" << std::endl;
+  code << "    # $a1 = rope, $a2 = repeat count" << std::endl;
+  code << "    # result in $a0" << std::endl;
+  code << "    move $t0, $a1        # repeated child" << std::endl;
+  code << "    move $t1, $a2        # repeat count" << std::endl;
+  code << "    li $t2, 2            # repeat tag" << std::endl;
+  code << "    j rope_new_node" << std::endl;
+  code << std::endl;
+
+  // Rope leaf function, wraps a flat string
+  code << "rope_leaf:" << std::endl;
+  code << "    # $a0 = flat string address" << std::endl;
+  code << "    # result in $a0" << std::endl;
+  code << "    move $t0, $a0        # flat string" << std::endl;
+  code << "    move $t1, $zero" << std::endl;
+  code << "    li $t2, 0            # leaf tag" << std::endl;
+  code << std::endl;
+
+  // Bump allocation of a node from the rope arena
+  code << "rope_new_node:" << std::endl;
+  code << "    # $t0, $t1 = node fields, $t2 = tag" << std::endl;
+  code << "    lw $t3, rope_arena_ptr # next free node" << std::endl;
+  code << "    lw $t4, rope_arena_end # end of current chunk" << std::endl;
+  code << "    addiu $t5, $t3, 12   # bump past the new node" << std::endl;
+  code << "    sltu $t6, $t4, $t5   # does the node overflow the chunk?" << std::endl;
+  code << "    beq $t6, $zero, rope_node_fits" << std::endl;
+  code << "    li $v0, 9            # sbrk a new chunk" << std::endl;
+  code << "    li $a0, 4096" << std::endl;
+  code << "    syscall" << std::endl;
+  code << "    move $t3, $v0" << std::endl;
+  code << "    addiu $t4, $v0, 4096" << std::endl;
+  code << "    sw $t4, rope_arena_end" << std::endl;
+  code << "    addiu $t5, $t3, 12" << std::endl;
+  code << std::endl;
+  code << "rope_node_fits:" << std::endl;
+  code << "    sw $t5, rope_arena_ptr" << std::endl;
+  code << "    sw $t2, 0($t3)       # tag" << std::endl;
+  code << "    sw $t0, 4($t3)       # first field" << std::endl;
+  code << "    sw $t1, 8($t3)       # second field" << std::endl;
+  code << "    move $a0, $t3        # return the node" << std::endl;
+  code << "    jr $ra               # return" << std::endl;
+  code << std::endl;
+
+  // Rope print function, walks the rope and prints the leaves without flattening
+  code << "rope_print:" << std::endl;
+  code << "    # $a0 = rope to print" << std::endl;
+  code << "    addiu $sp, $sp, -12" << std::endl;
+  code << "    sw $ra, 0($sp)" << std::endl;
+  code << "    sw $s0, 4($sp)" << std::endl;
+  code << "    sw $s1, 8($sp)" << std::endl;
+  code << "    move $s0, $a0        # current node" << std::endl;
+  code << "    lw $t0, 0($s0)       # node tag" << std::endl;
+  code << "    beq $t0, $zero, rope_print_leaf" << std::endl;
+  code << "    li $t1, 1" << std::endl;
+  code << "    beq $t0, $t1, rope_print_concat" << std::endl;
+  code << "    lw $s1, 8($s0)       # repeat counter" << std::endl;
+  code << std::endl;
+  code << "rope_print_repeat:" << std::endl;
+  code << "    blez $s1, rope_print_done # if counter is exhausted, done" << std::endl;
+  code << "    lw $a0, 4($s0)       # repeated child" << std::endl;
+  code << "    jal rope_print" << std::endl;
+  code << "    addiu $s1, $s1, -1   # decrement counter" << std::endl;
+  code << "    j rope_print_repeat" << std::endl;
+  code << std::endl;
+  code << "rope_print_concat:" << std::endl;
+  code << "    lw $a0, 4($s0)       # left child" << std::endl;
+  code << "    jal rope_print" << std::endl;
+  code << "    lw $a0, 8($s0)       # right child" << std::endl;
+  code << "    jal rope_print" << std::endl;
+  code << "    j rope_print_done" << std::endl;
+  code << std::endl;
+  code << "rope_print_leaf:" << std::endl;
+  code << "    lw $a0, 4($s0)       # flat string" << std::endl;
+  code << "    li $v0, 4            # print string syscall" << std::endl;
+  code << "    syscall" << std::endl;
+  code << std::endl;
+  code << "rope_print_done:" << std::endl;
+  code << "    lw $ra, 0($sp)" << std::endl;
+  code << "    lw $s0, 4($sp)" << std::endl;
+  code << "    lw $s1, 8($sp)" << std::endl;
+  code << "    addiu $sp, $sp, 12" << std::endl;
+  code << "    jr $ra               # return" << std::endl;
+  code << std::endl;
+
+  code << GenerateTrimNewline();
+
+  return code.str();
+}
+
+auto CodeGenerator::GenerateTrimNewline() -> std::string {
+  std::stringstream code;
+
   // String trim newline function
   code << "string_trim_newline:" << std::endl;
   code << "    # Trim trailing newline from string at address in $a0" << std::endl;
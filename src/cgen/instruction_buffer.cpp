@@ -0,0 +1,219 @@
+#include "cgen/instruction_buffer.h"
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace scp::cgen {
+
+namespace {
+
+// Opcodes whose first operand is written and remaining register operands are read
+auto ArithmeticOpcodes() -> const std::unordered_set<std::string> & {
+  static const std::unordered_set<std::string> opcodes = {"li",   "la",  "move", "add", "addu", "addi", "addiu",
+                                                          "sub",  "subu", "mul", "sll", "srl", "sra",  "slt",
+                                                          "sltu", "and", "or",  "xor", "nor"};
+  return opcodes;
+}
+
+// Opcodes which read all register operands and transfer control
+auto BranchOpcodes() -> const std::unordered_set<std::string> & {
+  static const std::unordered_set<std::string> opcodes = {"beq",  "bne",  "blt",  "ble",  "bgt", "bge", "blez",
+                                                          "bgtz", "bltz", "bgez", "beqz", "bnez", "j",  "jr"};
+  return opcodes;
+}
+
+// Extract the base register of a memory operand such as "4($fp)", empty for label operands
+auto BaseRegister(const std::string &operand) -> std::string {
+  auto open = operand.find('(');
+  auto close = operand.find(')');
+  if (open == std::string::npos || close == std::string::npos || close < open) {
+    return "";
+  }
+  return operand.substr(open + 1, close - open - 1);
+}
+
+auto IsRegister(const std::string &operand) -> bool { return !operand.empty() && operand[0] == '$'; }
+
+auto Trim(const std::string &str) -> std::string {
+  auto begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  auto end = str.find_last_not_of(" \t\r");
+  return str.substr(begin, end - begin + 1);
+}
+
+}  // namespace
+
+auto Instruction::Parse(const std::string &line) -> Instruction {
+  Instruction instruction;
+  instruction.text_ = line;
+
+  std::string body = Trim(line);
+  if (body.empty() || body[0] == '#') {
+    instruction.kind_ = Kind::BLANK;
+    return instruction;
+  }
+  if (body[0] == '.') {
+    instruction.kind_ = Kind::DIRECTIVE;
+    return instruction;
+  }
+
+  // A leading identifier followed by ':' is a label, possibly with data on the same line
+  auto colon = body.find(':');
+  auto space = body.find_first_of(" \t");
+  if (colon != std::string::npos && (space == std::string::npos || colon < space)) {
+    std::string rest = Trim(body.substr(colon + 1));
+    instruction.label_ = body.substr(0, colon);
+    instruction.kind_ = rest.empty() || rest[0] == '#' ? Kind::LABEL : Kind::DIRECTIVE;
+    return instruction;
+  }
+
+  instruction.kind_ = Kind::INSTRUCTION;
+  instruction.opcode_ = body.substr(0, space);
+  if (space == std::string::npos) {
+    return instruction;
+  }
+
+  // Split the operands on commas, stopping at a comment outside of string literals
+  std::string current;
+  bool in_string = false;
+  for (size_t i = space; i < body.size(); ++i) {
+    char c = body[i];
+    if (in_string) {
+      current += c;
+      if (c == '\\' && i + 1 < body.size()) {
+        current += body[++i];
+      } else if (c == '"') {
+        in_string = false;
+      }
+    } else if (c == '"') {
+      in_string = true;
+      current += c;
+    } else if (c == '#') {
+      break;
+    } else if (c == ',') {
+      instruction.operands_.push_back(Trim(current));
+      current.clear();
+    } else {
+      current += c;
+    }
+  }
+  if (!Trim(current).empty()) {
+    instruction.operands_.push_back(Trim(current));
+  }
+  return instruction;
+}
+
+auto Instruction::Make(const std::string &opcode, std::vector<std::string> operands, const std::string &comment)
+    -> Instruction {
+  Instruction instruction;
+  instruction.kind_ = Kind::INSTRUCTION;
+  instruction.opcode_ = opcode;
+  instruction.operands_ = std::move(operands);
+
+  std::stringstream text;
+  text << "    " << opcode;
+  for (size_t i = 0; i < instruction.operands_.size(); ++i) {
+    text << (i == 0 ? " " : ", ") << instruction.operands_[i];
+  }
+  if (!comment.empty()) {
+    text << " # " << comment;
+  }
+  instruction.text_ = text.str();
+  return instruction;
+}
+
+auto Instruction::GetDefinedRegisters() const -> std::vector<std::string> {
+  if (kind_ != Kind::INSTRUCTION) {
+    return {};
+  }
+  if (opcode_ == "jal") {
+    return {"$ra"};
+  }
+  if (opcode_ == "syscall") {
+    return {"$v0"};
+  }
+  if ((ArithmeticOpcodes().count(opcode_) != 0U || opcode_ == "lw" || opcode_ == "lb" || opcode_ == "lbu") &&
+      !operands_.empty() && IsRegister(operands_[0])) {
+    return {operands_[0]};
+  }
+  return {};
+}
+
+auto Instruction::GetUsedRegisters() const -> std::vector<std::string> {
+  std::vector<std::string> used;
+  if (kind_ != Kind::INSTRUCTION) {
+    return used;
+  }
+  if (opcode_ == "syscall") {
+    return {"$v0", "$a0", "$a1"};
+  }
+  if (IsLoad() || IsStore()) {
+    if (IsStore() && !operands_.empty()) {
+      used.push_back(operands_[0]);
+    }
+    if (operands_.size() > 1) {
+      std::string base = BaseRegister(operands_[1]);
+      if (!base.empty()) {
+        used.push_back(base);
+      }
+    }
+    return used;
+  }
+  // Arithmetic reads everything after the destination, branches read every register operand
+  size_t first = ArithmeticOpcodes().count(opcode_) != 0U ? 1 : 0;
+  for (size_t i = first; i < operands_.size(); ++i) {
+    if (IsRegister(operands_[i])) {
+      used.push_back(operands_[i]);
+    }
+  }
+  return used;
+}
+
+auto Instruction::IsBranch() const -> bool {
+  return kind_ == Kind::INSTRUCTION && BranchOpcodes().count(opcode_) != 0U;
+}
+
+auto Instruction::IsLoad() const -> bool {
+  return kind_ == Kind::INSTRUCTION && (opcode_ == "lw" || opcode_ == "lb" || opcode_ == "lbu");
+}
+
+auto Instruction::IsStore() const -> bool {
+  return kind_ == Kind::INSTRUCTION && (opcode_ == "sw" || opcode_ == "sb");
+}
+
+auto Instruction::IsKnown() const -> bool {
+  return kind_ != Kind::INSTRUCTION || ArithmeticOpcodes().count(opcode_) != 0U ||
+         BranchOpcodes().count(opcode_) != 0U || IsLoad() || IsStore() || opcode_ == "jal" || opcode_ == "syscall" ||
+         opcode_ == "nop";
+}
+
+InstructionBuffer::InstructionBuffer(const std::string &assembly) {
+  size_t start = 0;
+  while (true) {
+    auto end = assembly.find('\n', start);
+    if (end == std::string::npos) {
+      instructions_.push_back(Instruction::Parse(assembly.substr(start)));
+      break;
+    }
+    instructions_.push_back(Instruction::Parse(assembly.substr(start, end - start)));
+    start = end + 1;
+  }
+}
+
+auto InstructionBuffer::ToString() const -> std::string {
+  std::string assembly;
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    if (i != 0) {
+      assembly += '\n';
+    }
+    assembly += instructions_[i].text_;
+  }
+  return assembly;
+}
+
+}  // namespace scp::cgen
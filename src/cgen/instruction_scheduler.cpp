@@ -0,0 +1,256 @@
+#include "cgen/instruction_scheduler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace scp::cgen {
+
+namespace {
+
+// Split a memory operand such as "4($fp)" into offset and base, returns false for label operands
+auto DecodeAddress(const Instruction &instruction, int &offset, std::string &base) -> bool {
+  if (instruction.operands_.size() < 2) {
+    return false;
+  }
+  const std::string &operand = instruction.operands_[1];
+  auto open = operand.find('(');
+  if (open == std::string::npos || operand.back() != ')') {
+    return false;
+  }
+  offset = open == 0 ? 0 : std::atoi(operand.substr(0, open).c_str());
+  base = operand.substr(open + 1, operand.size() - open - 2);
+  return true;
+}
+
+// Two memory operations may touch the same bytes, unless they are word accesses at different offsets of the same
+// base register. A redefinition of the base in between is already ordered through the register dependences.
+auto MayAlias(const Instruction &first, const Instruction &second) -> bool {
+  int first_offset = 0;
+  int second_offset = 0;
+  std::string first_base;
+  std::string second_base;
+  if (!DecodeAddress(first, first_offset, first_base) || !DecodeAddress(second, second_offset, second_base)) {
+    return true;
+  }
+  bool words = (first.opcode_ == "lw" || first.opcode_ == "sw") && (second.opcode_ == "lw" || second.opcode_ == "sw");
+  return !words || first_base != second_base || first_offset == second_offset;
+}
+
+auto Intersects(const std::vector<std::string> &lhs, const std::vector<std::string> &rhs) -> bool {
+  return std::any_of(lhs.begin(), lhs.end(),
+                     [&rhs](const std::string &reg) { return std::find(rhs.begin(), rhs.end(), reg) != rhs.end(); });
+}
+
+}  // namespace
+
+void InstructionScheduler::Run(InstructionBuffer &buffer) {
+  filled_delay_slot_count_ = 0;
+  nop_count_ = 0;
+
+  std::vector<Instruction> output;
+  if (fill_delay_slots_) {
+    output.push_back(Instruction::Parse(".set noreorder"));
+  }
+
+  std::vector<Instruction> block;
+  for (const auto &instruction : buffer.GetInstructions()) {
+    if (IsSchedulable(instruction)) {
+      if (block.size() == MAX_REGION_SIZE) {
+        ScheduleBlock(block, nullptr, output);
+        block.clear();
+      }
+      block.push_back(instruction);
+      continue;
+    }
+    if (instruction.IsBranch() || instruction.IsCall()) {
+      ScheduleBlock(block, &instruction, output);
+      block.clear();
+      continue;
+    }
+    // Labels, directives, syscalls and anything unknown close the block and stay in place
+    ScheduleBlock(block, nullptr, output);
+    block.clear();
+    output.push_back(instruction);
+  }
+  ScheduleBlock(block, nullptr, output);
+
+  buffer.GetInstructions() = std::move(output);
+}
+
+void InstructionScheduler::ScheduleBlock(const std::vector<Instruction> &block, const Instruction *terminator,
+                                         std::vector<Instruction> &output) {
+  size_t size = block.size();
+
+  // Build the dependence graph: successors with the latency each edge imposes
+  std::vector<std::vector<std::pair<size_t, int>>> successors(size);
+  std::vector<int> predecessor_count(size, 0);
+  std::vector<std::vector<std::string>> used(size);
+  std::vector<std::vector<std::string>> defined(size);
+  for (size_t k = 0; k < size; ++k) {
+    used[k] = block[k].GetUsedRegisters();
+    defined[k] = block[k].GetDefinedRegisters();
+  }
+  for (size_t j = 0; j < size; ++j) {
+    for (size_t i = 0; i < j; ++i) {
+      int latency = -1;
+      if (Intersects(defined[i], used[j])) {
+        latency = Latency(block[i]);  // read after write
+      } else if (Intersects(used[i], defined[j]) || Intersects(defined[i], defined[j])) {
+        latency = 1;  // write after read, write after write
+      } else if ((block[i].IsStore() || block[j].IsStore()) && (block[i].IsLoad() || block[i].IsStore()) &&
+                 (block[j].IsLoad() || block[j].IsStore()) && MayAlias(block[i], block[j])) {
+        latency = 1;  // memory order
+      }
+      if (latency >= 0) {
+        successors[i].emplace_back(j, latency);
+        predecessor_count[j]++;
+      }
+    }
+  }
+
+  // Cycles an instruction must precede the terminator by, so the terminator sees its result
+  std::vector<int> terminator_latency(size, 0);
+  if (terminator != nullptr) {
+    auto terminator_used = terminator->GetUsedRegisters();
+    auto terminator_defined = terminator->GetDefinedRegisters();
+    for (size_t i = 0; i < size; ++i) {
+      if (Intersects(defined[i], terminator_used)) {
+        terminator_latency[i] = Latency(block[i]);
+      } else if (Intersects(used[i], terminator_defined)) {
+        terminator_latency[i] = 1;
+      }
+    }
+  }
+
+  // Priority is the latency-weighted longest path to the end of the block
+  std::vector<int> priority(size, 0);
+  for (size_t k = size; k-- > 0;) {
+    priority[k] = std::max(Latency(block[k]), terminator_latency[k]);
+    for (const auto &[successor, latency] : successors[k]) {
+      priority[k] = std::max(priority[k], latency + priority[successor]);
+    }
+  }
+
+  // Pick the delay slot filler: the latest instruction nothing else in the block depends on
+  size_t delay_slot = size;
+  if (fill_delay_slots_ && terminator != nullptr) {
+    for (size_t k = size; k-- > 0;) {
+      if (successors[k].empty() && CanFillDelaySlot(block[k], *terminator)) {
+        delay_slot = k;
+        break;
+      }
+    }
+  }
+
+  // List scheduling, one instruction per cycle
+  std::vector<int> earliest(size, 0);
+  std::vector<bool> scheduled(size, false);
+  size_t remaining = size - (delay_slot < size ? 1 : 0);
+  int cycle = 0;
+  int terminator_earliest = 0;
+  bool last_is_load = false;
+  while (remaining > 0) {
+    size_t best = size;
+    size_t first_available = size;
+    for (size_t k = 0; k < size; ++k) {
+      if (scheduled[k] || k == delay_slot || predecessor_count[k] != 0) {
+        continue;
+      }
+      if (first_available == size || earliest[k] < earliest[first_available]) {
+        first_available = k;
+      }
+      if (earliest[k] <= cycle && (best == size || priority[k] > priority[best])) {
+        best = k;
+      }
+    }
+    if (best == size) {
+      if (fill_delay_slots_) {
+        // Nothing is ready: the hardware will not interlock, so wait explicitly
+        output.push_back(Instruction::Make("nop", {}));
+        nop_count_++;
+        last_is_load = false;
+        cycle++;
+        continue;
+      }
+      best = first_available;
+      cycle = earliest[best];
+    }
+
+    scheduled[best] = true;
+    remaining--;
+    output.push_back(block[best]);
+    last_is_load = block[best].IsLoad();
+    for (const auto &[successor, latency] : successors[best]) {
+      earliest[successor] = std::max(earliest[successor], cycle + latency);
+      predecessor_count[successor]--;
+    }
+    terminator_earliest = std::max(terminator_earliest, cycle + terminator_latency[best]);
+    cycle++;
+  }
+
+  if (terminator == nullptr) {
+    // The next block may use the result of a trailing load right away
+    if (fill_delay_slots_ && last_is_load) {
+      output.push_back(Instruction::Make("nop", {}));
+      nop_count_++;
+    }
+    return;
+  }
+
+  if (fill_delay_slots_) {
+    for (; cycle < terminator_earliest; ++cycle) {
+      output.push_back(Instruction::Make("nop", {}));
+      nop_count_++;
+    }
+  }
+  output.push_back(*terminator);
+  if (!fill_delay_slots_) {
+    return;
+  }
+  if (delay_slot < size) {
+    output.push_back(block[delay_slot]);
+    filled_delay_slot_count_++;
+  } else {
+    output.push_back(Instruction::Make("nop", {}));
+    nop_count_++;
+  }
+}
+
+auto InstructionScheduler::IsSchedulable(const Instruction &instruction) -> bool {
+  return instruction.kind_ == Instruction::Kind::INSTRUCTION && instruction.IsKnown() && !instruction.IsBranch() &&
+         !instruction.IsCall() && instruction.opcode_ != "syscall";
+}
+
+auto InstructionScheduler::CanFillDelaySlot(const Instruction &instruction, const Instruction &terminator) -> bool {
+  // The target of the transfer may use the slot's result immediately, so no loads
+  if (instruction.IsLoad() || instruction.opcode_ == "la" || instruction.opcode_ == "mul") {
+    return false;
+  }
+  // Pseudo-instructions expanding to several machine instructions cannot sit in a slot
+  for (const auto &operand : instruction.operands_) {
+    bool is_label = !operand.empty() && operand[0] != '$' && operand.find('(') == std::string::npos &&
+                    (std::isalpha(static_cast<unsigned char>(operand[0])) != 0 || operand[0] == '_');
+    if (is_label) {
+      return false;
+    }
+  }
+  if (instruction.opcode_ == "li" && instruction.operands_.size() == 2) {
+    long value = std::strtol(instruction.operands_[1].c_str(), nullptr, 0);
+    if (value < -32768 || value > 65535) {
+      return false;
+    }
+  }
+  // The terminator evaluates its operands before the slot runs, and jal sets $ra before it
+  return !Intersects(instruction.GetDefinedRegisters(), terminator.GetUsedRegisters()) &&
+         !Intersects(instruction.GetDefinedRegisters(), terminator.GetDefinedRegisters()) &&
+         !Intersects(instruction.GetUsedRegisters(), terminator.GetDefinedRegisters());
+}
+
+auto InstructionScheduler::Latency(const Instruction &instruction) -> int {
+  return instruction.IsLoad() || instruction.opcode_ == "mul" ? 2 : 1;
+}
+
+}  // namespace scp::cgen
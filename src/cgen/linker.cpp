@@ -0,0 +1,160 @@
+#include "cgen/linker.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "core/ast.h"
+#include "core/trace.h"
+
+namespace scp::cgen {
+
+namespace {
+
+/* Stems of the read loop labels, numbered per read */
+constexpr const char *INPUT_LABEL_STEMS[] = {"len_scan_assign", "len_done_assign", "copy_loop_assign",
+                                             "copy_done_assign", "len_scan_ident",  "len_done_ident",
+                                             "copy_loop_ident",  "copy_done_ident"};
+
+auto IsIdentifierChar(char c) -> bool { return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_'; }
+
+// Split a label into a stem and the number ending it, returning false if it does not end in digits
+auto SplitNumber(const std::string &label, std::string &stem, int &number) -> bool {
+  size_t digits = label.size();
+  while (digits > 0 && std::isdigit(static_cast<unsigned char>(label[digits - 1])) != 0) {
+    digits--;
+  }
+  if (digits == label.size() || digits == 0) {
+    return false;
+  }
+  stem = label.substr(0, digits);
+  number = std::stoi(label.substr(digits));
+  return true;
+}
+
+}  // namespace
+
+Linker::Linker(CodeGeneratorOptions options)
+    : options_(options), runtime_environment_(std::make_shared<RuntimeEnvironment>(options_.string_runtime_)) {
+  runtime_environment_->AddSymbol("stdin", core::Type::IN_STREAM);
+  runtime_environment_->AddSymbol("stdout", core::Type::OUT_STREAM);
+  declared_.emplace("stdin", core::Type::IN_STREAM);
+  declared_.emplace("stdout", core::Type::OUT_STREAM);
+}
+
+auto Linker::FindConflict(const ObjectUnit &unit, const std::unordered_map<std::string, core::Type> &declared)
+    -> std::string {
+  for (const auto &[name, type] : unit.imports_) {
+    auto it = declared.find(name);
+    if (it == declared.end()) {
+      return "it uses '" + name + "', which no earlier unit declares";
+    }
+    if (it->second != type) {
+      return "it uses '" + name + "' as " + core::TypeToString(type) + ", but it is declared as " +
+             core::TypeToString(it->second);
+    }
+  }
+  for (const auto &[name, type] : unit.exports_) {
+    if (declared.find(name) != declared.end()) {
+      return "it declares '" + name + "', which an earlier unit declares";
+    }
+  }
+  return "";
+}
+
+void Linker::AddUnit(const std::string &name, ObjectUnit unit) {
+  if (unit.string_runtime_ != options_.string_runtime_) {
+    throw std::runtime_error("Unit " + name + " was compiled for a different string runtime.");
+  }
+  std::string conflict = FindConflict(unit, declared_);
+  if (!conflict.empty()) {
+    throw std::runtime_error("Unit " + name + " must be recompiled: " + conflict + ".");
+  }
+
+  for (const auto &[symbol, type] : unit.exports_) {
+    declared_.emplace(symbol, type);
+    runtime_environment_->AddSymbol(symbol, type);
+  }
+  // Adding the literals in unit order gives them the labels and data section of a single compilation
+  std::vector<std::string> labels;
+  labels.reserve(unit.strings_.size());
+  for (const auto &literal : unit.strings_) {
+    labels.push_back(runtime_environment_->AddStringConstant(literal));
+  }
+  string_labels_.push_back(std::move(labels));
+  input_id_bases_.push_back(units_.empty() ? 0 : input_id_bases_.back() + units_.back().input_ids_);
+  units_.push_back(std::move(unit));
+}
+
+auto Linker::Relocate(size_t index, bool place_slots) const -> std::string {
+  const auto &text = units_[index].text_;
+  int frame_slots = runtime_environment_->GetStackSize();
+  std::string code;
+  code.reserve(text.size());
+  for (size_t i = 0; i < text.size();) {
+    // A word is a slot or a label: an identifier not preceded by one or by the '$' of a register
+    bool is_slot = text[i] == '@';
+    bool is_label = IsIdentifierChar(text[i]) && (i == 0 || (!IsIdentifierChar(text[i - 1]) && text[i - 1] != '$'));
+    if (!is_slot && !is_label) {
+      code += text[i++];
+      continue;
+    }
+    size_t end = i + 1;
+    while (end < text.size() && IsIdentifierChar(text[end])) {
+      end++;
+    }
+    std::string word = text.substr(i, end - i);
+    i = end;
+
+    std::string stem;
+    int number = 0;
+    bool is_rope_leaf = word.size() > 5 && word.compare(word.size() - 5, 5, "_rope") == 0;
+    if (is_slot && !place_slots) {
+      code += word;
+    } else if (is_slot) {
+      // The multi-pass runtime environment gives the last declared variable offset 0
+      int slot = runtime_environment_->GetStackAllocation(word.substr(1)) / 4;
+      code += std::to_string((frame_slots - 1 - slot) * 4);
+    } else if (SplitNumber(is_rope_leaf ? word.substr(0, word.size() - 5) : word, stem, number) && stem == "str_") {
+      code += string_labels_[index].at(number) + (is_rope_leaf ? "_rope" : "");
+    } else if (!is_rope_leaf && SplitNumber(word, stem, number) &&
+               std::find(std::begin(INPUT_LABEL_STEMS), std::end(INPUT_LABEL_STEMS), stem) !=
+                   std::end(INPUT_LABEL_STEMS)) {
+      code += stem + std::to_string(number + input_id_bases_[index]);
+    } else {
+      code += word;
+    }
+  }
+  return code;
+}
+
+auto Linker::Link() const -> std::string {
+  SCP_TRACE_SCOPE("Link");
+  std::string body;
+  for (size_t i = 0; i < units_.size(); i++) {
+    body += Relocate(i, true);
+  }
+  std::string code = core::AST::ASTNode::EmitProgram(body, runtime_environment_);
+  code += CodeGenerator::GenerateRuntime(options_.string_runtime_);
+  return CodeGenerator::Optimize(code, options_);
+}
+
+auto Linker::Merge() const -> ObjectUnit {
+  SCP_TRACE_SCOPE("Merge");
+  ObjectUnit merged;
+  merged.string_runtime_ = options_.string_runtime_;
+  // Every import is an export of an earlier unit, so the merged unit imports nothing
+  for (size_t i = 0; i < units_.size(); i++) {
+    merged.exports_.insert(merged.exports_.end(), units_[i].exports_.begin(), units_[i].exports_.end());
+    merged.input_ids_ += units_[i].input_ids_;
+    merged.text_ += Relocate(i, false);
+  }
+  merged.strings_ = runtime_environment_->GetStringConstants();
+  return merged;
+}
+
+}  // namespace scp::cgen
@@ -0,0 +1,109 @@
+#include "cgen/object_unit.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace scp::cgen {
+
+namespace {
+
+auto ParseType(const std::string &text) -> core::Type {
+  for (auto type : {core::Type::STRING, core::Type::NUMBER, core::Type::IN_STREAM, core::Type::OUT_STREAM}) {
+    if (core::TypeToString(type) == text) {
+      return type;
+    }
+  }
+  throw std::runtime_error("Malformed unit: unknown type '" + text + "'.");
+}
+
+void WriteSymbols(std::ostringstream &out, const char *section, const ObjectUnit::Symbols &symbols) {
+  out << section << " " << symbols.size() << "\n";
+  for (const auto &[name, type] : symbols) {
+    out << name << " " << core::TypeToString(type) << "\n";
+  }
+}
+
+// Read `<section> <count>`, checking the section name
+auto ReadCount(std::istringstream &in, const std::string &section) -> size_t {
+  std::string name;
+  size_t count = 0;
+  if (!(in >> name >> count) || name != section) {
+    throw std::runtime_error("Malformed unit: expected the " + section + " section.");
+  }
+  in.ignore(1);  // The newline
+  return count;
+}
+
+void ReadSymbols(std::istringstream &in, const std::string &section, ObjectUnit::Symbols &symbols) {
+  size_t count = ReadCount(in, section);
+  for (size_t i = 0; i < count; i++) {
+    std::string line;
+    std::getline(in, line);
+    auto space = line.find(' ');
+    if (space == std::string::npos) {
+      throw std::runtime_error("Malformed unit: bad symbol '" + line + "'.");
+    }
+    symbols.emplace_back(line.substr(0, space), ParseType(line.substr(space + 1)));
+  }
+}
+
+// Read exactly length bytes
+auto ReadBytes(std::istringstream &in, size_t length) -> std::string {
+  std::string bytes(length, '\0');
+  if (!in.read(bytes.data(), static_cast<std::streamsize>(length))) {
+    throw std::runtime_error("Malformed unit: truncated.");
+  }
+  return bytes;
+}
+
+}  // namespace
+
+auto ObjectUnit::Serialize() const -> std::string {
+  std::ostringstream out;
+  out << MAGIC << "\n";
+  out << "key " << key_ << "\n";
+  out << "runtime " << (string_runtime_ == StringRuntime::ROPE ? "rope" : "flat") << "\n";
+  out << "inputs " << input_ids_ << "\n";
+  WriteSymbols(out, "imports", imports_);
+  WriteSymbols(out, "exports", exports_);
+  out << "strings " << strings_.size() << "\n";
+  for (const auto &literal : strings_) {
+    out << literal.size() << " " << literal << "\n";
+  }
+  out << "text " << text_.size() << "\n" << text_;
+  return out.str();
+}
+
+auto ObjectUnit::Deserialize(const std::string &bytes) -> ObjectUnit {
+  std::istringstream in(bytes);
+  std::string line;
+  if (!std::getline(in, line) || line != MAGIC) {
+    throw std::runtime_error("Not a unit file of this compiler version.");
+  }
+  ObjectUnit unit;
+  std::string field;
+  std::string runtime;
+  if (!(in >> field >> unit.key_) || field != "key" || !(in >> field >> runtime) || field != "runtime" ||
+      (runtime != "flat" && runtime != "rope")) {
+    throw std::runtime_error("Malformed unit: bad header.");
+  }
+  unit.string_runtime_ = runtime == "rope" ? StringRuntime::ROPE : StringRuntime::FLAT;
+  unit.input_ids_ = static_cast<int>(ReadCount(in, "inputs"));
+  ReadSymbols(in, "imports", unit.imports_);
+  ReadSymbols(in, "exports", unit.exports_);
+  size_t strings = ReadCount(in, "strings");
+  for (size_t i = 0; i < strings; i++) {
+    size_t length = 0;
+    if (!(in >> length)) {
+      throw std::runtime_error("Malformed unit: bad string literal.");
+    }
+    in.ignore(1);  // The space
+    unit.strings_.push_back(ReadBytes(in, length));
+    in.ignore(1);  // The newline
+  }
+  unit.text_ = ReadBytes(in, ReadCount(in, "text"));
+  return unit;
+}
+
+}  // namespace scp::cgen
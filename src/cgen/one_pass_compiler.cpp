@@ -0,0 +1,257 @@
+#include "cgen/one_pass_compiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "constant/error_messages.h"
+#include "core/diagnostics.h"
+#include "core/trace.h"
+
+namespace scp::cgen {
+
+namespace {
+
+/* Delimiters of a declaration index in the body, standing for the frame offset of the variable */
+constexpr char SLOT_BEGIN = '\x01';
+constexpr char SLOT_END = '\x02';
+
+}  // namespace
+
+OnePassCompiler::OnePassCompiler(CodeGeneratorOptions options)
+    : options_(options),
+      type_environment_(std::make_shared<core::TypeEnvironment>()),
+      runtime_environment_(std::make_shared<RuntimeEnvironment>(options_.string_runtime_)) {
+  // Declared in the order of semant::TypeChecker, which decides their frame offsets
+  Declare("stdin", core::Type::IN_STREAM);
+  Declare("stdout", core::Type::OUT_STREAM);
+}
+
+void OnePassCompiler::Import(const ObjectUnit::Symbols &symbols) {
+  for (const auto &[name, type] : symbols) {
+    Declare(name, type);
+    imported_.emplace(name, type);
+  }
+}
+
+void OnePassCompiler::Declare(const std::string &name, core::Type type) {
+  type_environment_->AddSymbol(name, type);
+  runtime_environment_->AddSymbol(name, type);
+  declared_.push_back(name);
+}
+
+void OnePassCompiler::NoteImport(const std::string &name) {
+  auto it = imported_.find(name);
+  if (it != imported_.end()) {
+    imports_.emplace_back(name, it->second);
+    imported_.erase(it);  // Recorded once
+  }
+}
+
+void OnePassCompiler::Shift(const core::Token &token) {
+  Attribute attribute;
+  attribute.value_ = token.GetValue();
+  attribute.diagnostics_start_ = diagnostics_.tellp();
+  attributes_.push_back(std::move(attribute));
+  // The left operand is complete when its operator is shifted
+  if ((token.GetType() == core::TokenType::PLUS || token.GetType() == core::TokenType::TIMES) && !has_bug_ &&
+      !panic_ && !statement_panic_) {
+    expression_code_ += core::AST::ASTNode::EmitPushOperand();
+  }
+}
+
+auto OnePassCompiler::Reduce(const parser::SLRParser::Action &action) -> bool {
+  // Expression -> Term and Term -> Factor pass the attribute on; StatementList and Program hold none
+  if (action.lhs_ == "Factor") {
+    ReduceFactor(action.rhs_.size());
+  } else if ((action.lhs_ == "Expression" || action.lhs_ == "Term") && action.rhs_.size() == 3) {
+    ReduceBinary(action.lhs_ == "Expression" ? core::ASTNodeType::PLUS : core::ASTNodeType::TIMES);
+  } else if (action.lhs_ == "Statement") {
+    ReduceStatement();
+  }
+  return true;
+}
+
+void OnePassCompiler::ReduceFactor(size_t size) {
+  if (size == 3) {
+    // Factor -> left_paren Expression right_paren
+    attributes_.pop_back();
+    Attribute expression = std::move(attributes_.back());
+    attributes_.pop_back();
+    expression.diagnostics_start_ = attributes_.back().diagnostics_start_;
+    attributes_.back() = std::move(expression);
+    return;
+  }
+
+  // Factor -> identifier | number | string, classified by its first character like the AST transform
+  Attribute &factor = attributes_.back();
+  if (std::isdigit(factor.value_[0]) != 0) {
+    factor.type_ = factor.runtime_type_ = core::Type::NUMBER;
+  } else if (factor.value_[0] == '"') {
+    factor.type_ = factor.runtime_type_ = core::Type::STRING;
+  } else if (std::isalpha(factor.value_[0]) != 0) {
+    if (panic_ || statement_panic_) {
+      return;
+    }
+    core::DiagnosticCapture capture(diagnostics_);
+    NoteImport(factor.value_);
+    factor.type_ = core::AST::ASTNode::CheckIdentifier(factor.value_, type_environment_, has_bug_);
+    factor.runtime_type_ = factor.type_;
+    // A read from stdin is emitted where it is used, as an assignment to a variable emits its own read
+    if (!has_bug_ && factor.value_ != "stdin") {
+      expression_code_ +=
+          core::AST::ASTNode::EmitIdentifier(factor.value_, GetSlot(factor.value_), runtime_environment_);
+    }
+    return;
+  } else {
+    factor.missing_ = true;
+    return;
+  }
+  if (!has_bug_ && !panic_ && !statement_panic_) {
+    expression_code_ += factor.type_ == core::Type::NUMBER
+                            ? core::AST::ASTNode::EmitNumber(factor.value_)
+                            : core::AST::ASTNode::EmitString(factor.value_, runtime_environment_);
+  }
+}
+
+void OnePassCompiler::ReduceBinary(core::ASTNodeType type) {
+  Attribute right = std::move(attributes_.back());
+  attributes_.pop_back();
+  attributes_.pop_back();
+  Attribute &left = attributes_.back();
+  if (left.missing_ || right.missing_) {
+    MarkIncomplete(left.diagnostics_start_);
+  }
+  if (panic_ || statement_panic_) {
+    left.missing_ = false;
+    return;
+  }
+
+  core::DiagnosticCapture capture(diagnostics_);
+  left.type_ = type == core::ASTNodeType::PLUS ? core::AST::ASTNode::CheckPlus(left.type_, right.type_, has_bug_)
+                                               : core::AST::ASTNode::CheckTimes(left.type_, right.type_, has_bug_);
+  if (!has_bug_) {
+    expression_code_ +=
+        core::AST::ASTNode::EmitOperation(type, left.runtime_type_, right.runtime_type_, runtime_environment_);
+  }
+  left.runtime_type_ = core::AST::ASTNode::GetBinaryRuntimeType(left.runtime_type_, right.runtime_type_);
+  left.value_ = type == core::ASTNodeType::PLUS ? "+" : "*";
+}
+
+void OnePassCompiler::ReduceStatement() {
+  std::string value_code = std::move(expression_code_);
+  expression_code_.clear();
+  attributes_.pop_back();
+  Attribute value = std::move(attributes_.back());
+  attributes_.pop_back();
+  attributes_.pop_back();
+  Attribute target = std::move(attributes_.back());
+  attributes_.pop_back();
+  if (value.missing_) {
+    MarkIncomplete(target.diagnostics_start_);
+  }
+  if (statement_panic_) {
+    // The type check stops at the first node missing a child, in the order it visits the nodes
+    panic_ = statement_panic_;
+    statement_panic_.reset();
+  }
+  if (panic_) {
+    return;
+  }
+
+  core::DiagnosticCapture capture(diagnostics_);
+  NoteImport(target.value_);
+  bool is_new = type_environment_->GetType(target.value_) == core::Type::UNDEFINED;
+  core::AST::ASTNode::CheckAssign(target.value_, value.type_, type_environment_, has_bug_);
+  if (is_new && type_environment_->GetType(target.value_) != core::Type::UNDEFINED) {
+    core::Type type = type_environment_->GetType(target.value_);
+    runtime_environment_->AddSymbol(target.value_, type);
+    declared_.push_back(target.value_);
+    exports_.emplace_back(target.value_, type);
+  }
+  if (has_bug_) {
+    return;
+  }
+
+  bool is_output = target.value_ == "stdout";
+  if (is_output && value.value_ == "stdin") {
+    value_code = core::AST::ASTNode::EmitIdentifier(value.value_, "", runtime_environment_);
+  } else if (!is_output && value.value_ == "stdin") {
+    value_code.clear();
+  }
+  std::string slot = is_output ? "" : GetSlot(target.value_);
+  body_ += core::AST::ASTNode::EmitAssign(target.value_, value.value_, value_code,
+                                          is_output ? value.runtime_type_ : core::Type::UNDEFINED, slot,
+                                          runtime_environment_);
+}
+
+void OnePassCompiler::MarkIncomplete(std::streamoff start) {
+  statement_panic_ = statement_panic_ ? std::min(*statement_panic_, start) : start;
+}
+
+auto OnePassCompiler::GetSlot(const std::string &name) -> std::string {
+  return SLOT_BEGIN + std::to_string(runtime_environment_->GetStackAllocation(name) / 4) + SLOT_END;
+}
+
+auto OnePassCompiler::FillSlots(const std::vector<std::string> &slots) const -> std::string {
+  std::string body;
+  body.reserve(body_.size());
+  size_t position = 0;
+  size_t begin;
+  while ((begin = body_.find(SLOT_BEGIN, position)) != std::string::npos) {
+    size_t end = body_.find(SLOT_END, begin);
+    body.append(body_, position, begin - position);
+    body += slots[std::stoi(body_.substr(begin + 1, end - begin - 1))];
+    position = end + 1;
+  }
+  body.append(body_, position, std::string::npos);
+  return body;
+}
+
+void OnePassCompiler::ReportErrors() {
+  if (panic_) {
+    core::Diagnostics() << diagnostics_.str().substr(0, *panic_);
+    throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
+  }
+  core::Diagnostics() << diagnostics_.str();
+  if (has_bug_) {
+    throw std::runtime_error(constant::ErrorMessages::TYPE_CHECK_FAILED);
+  }
+}
+
+auto OnePassCompiler::Finish() -> std::string {
+  SCP_TRACE_SCOPE("FinishOnePass");
+  ReportErrors();
+  // The multi-pass runtime environment gives the last declared variable offset 0
+  std::vector<std::string> offsets;
+  offsets.reserve(declared_.size());
+  for (size_t index = 0; index < declared_.size(); index++) {
+    offsets.push_back(std::to_string((declared_.size() - 1 - index) * 4));
+  }
+  std::string code = core::AST::ASTNode::EmitProgram(FillSlots(offsets), runtime_environment_);
+  code += CodeGenerator::GenerateRuntime(options_.string_runtime_);
+  return CodeGenerator::Optimize(code, options_);
+}
+
+auto OnePassCompiler::FinishUnit() -> ObjectUnit {
+  SCP_TRACE_SCOPE("FinishUnit");
+  ReportErrors();
+  std::vector<std::string> names;
+  names.reserve(declared_.size());
+  for (const auto &name : declared_) {
+    names.push_back("@" + name);
+  }
+  ObjectUnit unit;
+  unit.string_runtime_ = options_.string_runtime_;
+  unit.imports_ = imports_;
+  unit.exports_ = exports_;
+  unit.strings_ = runtime_environment_->GetStringConstants();
+  unit.input_ids_ = runtime_environment_->GetInputIdCount();
+  unit.text_ = FillSlots(names);
+  return unit;
+}
+
+}  // namespace scp::cgen
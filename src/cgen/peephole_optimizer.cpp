@@ -0,0 +1,188 @@
+#include "cgen/peephole_optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cgen/peephole_rules.h"
+#include "cgen/superoptimizer.h"
+#include "core/flat_hash_map.h"
+
+namespace scp::cgen {
+
+namespace {
+
+/* The register rules use for $tmp */
+constexpr const char *SCRATCH = "$t2";
+
+/* The opcodes by name, indexed like MicroInstruction::Opcode */
+constexpr const char *OPCODE_NAMES[] = {"li", "addiu", "add", "addu", "subu", "sll", "mul", "move"};
+
+// The rule table, parsed once
+auto GetRuleSequences() -> const core::FlatHashMap<int32_t, MicroSequence> & {
+  static const auto *sequences = [] {
+    auto *table = new core::FlatHashMap<int32_t, MicroSequence>();
+    for (const auto &rule : GetPeepholeRules()) {
+      (*table)[rule.multiplier_] = Superoptimizer::Parse(rule.replacement_);
+    }
+    return table;
+  }();
+  return *sequences;
+}
+
+// The value of an li operand as the 32-bit word it loads
+auto ParseConstant(const std::string &operand) -> std::optional<int32_t> {
+  size_t end = 0;
+  long long value = 0;
+  try {
+    value = std::stoll(operand, &end, 0);
+  } catch (const std::exception &) {
+    return std::nullopt;
+  }
+  if (end != operand.size() || value < std::numeric_limits<int32_t>::min() ||
+      value > std::numeric_limits<uint32_t>::max()) {
+    return std::nullopt;
+  }
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+auto UsesScratch(const MicroSequence &sequence) -> bool {
+  return std::any_of(sequence.begin(), sequence.end(), [](const MicroInstruction &instruction) {
+    return instruction.destination_ == Superoptimizer::TMP || instruction.first_ == Superoptimizer::TMP ||
+           instruction.second_ == Superoptimizer::TMP;
+  });
+}
+
+auto Mentions(const std::vector<std::string> &registers, const std::string &reg) -> bool {
+  return std::find(registers.begin(), registers.end(), reg) != registers.end();
+}
+
+// Check whether $t2 may be read after an instruction, conservatively at join points and branches
+auto IsScratchLive(const std::vector<Instruction> &instructions, size_t after) -> bool {
+  bool exits = false;
+  for (size_t i = after + 1; i < instructions.size(); i++) {
+    const auto &instruction = instructions[i];
+    if (instruction.kind_ == Instruction::Kind::BLANK) {
+      continue;
+    }
+    if (instruction.kind_ != Instruction::Kind::INSTRUCTION || !instruction.IsKnown() || instruction.IsBranch() ||
+        Mentions(instruction.GetUsedRegisters(), SCRATCH)) {
+      return true;
+    }
+    // A runtime routine takes no argument in $t2 and may clobber it, and the exit syscall ends the program
+    if (instruction.IsCall() || Mentions(instruction.GetDefinedRegisters(), SCRATCH) ||
+        (instruction.opcode_ == "syscall" && exits)) {
+      return false;
+    }
+    if (Mentions(instruction.GetDefinedRegisters(), "$v0")) {
+      exits = instruction.opcode_ == "li" && instruction.operands_.size() == 2 && instruction.operands_[1] == "10";
+    }
+  }
+  return true;
+}
+
+/**
+ * Render a rule in the registers of the code.
+ * @param sequence The rule.
+ * @param in The register of the other factor.
+ * @param out The register of the product.
+ * @param comment The comment of the first instruction.
+ * @return The instructions.
+ */
+auto Instantiate(const MicroSequence &sequence, const std::string &in, const std::string &out,
+                 const std::string &comment) -> std::vector<Instruction> {
+  const std::string registers[] = {"$zero", in, out, SCRATCH};
+  std::vector<Instruction> instructions;
+  for (const auto &instruction : sequence) {
+    const std::string opcode = OPCODE_NAMES[static_cast<size_t>(instruction.opcode_)];
+    std::vector<std::string> operands = {registers[instruction.destination_]};
+    if (instruction.opcode_ != MicroInstruction::Opcode::LI) {
+      operands.push_back(registers[instruction.first_]);
+    }
+    if (opcode == "add" || opcode == "addu" || opcode == "subu" || opcode == "mul") {
+      operands.push_back(registers[instruction.second_]);
+    }
+    if (opcode == "li" || opcode == "addiu" || opcode == "sll") {
+      operands.push_back(std::to_string(instruction.immediate_));
+    }
+    instructions.push_back(Instruction::Make(opcode, std::move(operands), instructions.empty() ? comment : ""));
+  }
+  return instructions;
+}
+
+}  // namespace
+
+void PeepholeOptimizer::Run(InstructionBuffer &buffer) {
+  rewritten_count_ = 0;
+  const auto &rules = GetRuleSequences();
+  auto &instructions = buffer.GetInstructions();
+
+  // The li each rewritten mul absorbs, and the instructions replacing the mul
+  std::vector<bool> removed(instructions.size(), false);
+  core::FlatHashMap<size_t, std::vector<Instruction>> replacements;
+
+  for (size_t i = 0; i < instructions.size(); i++) {
+    const auto &load = instructions[i];
+    if (load.kind_ != Instruction::Kind::INSTRUCTION || load.opcode_ != "li" || load.operands_.size() != 2) {
+      continue;
+    }
+    const std::string &product = load.operands_[0];
+    auto constant = ParseConstant(load.operands_[1]);
+    auto rule = constant ? rules.find(*constant) : rules.end();
+    if (rule == rules.end() || product == "$zero") {
+      continue;
+    }
+
+    // Find the mul, across instructions that leave the constant alone
+    for (size_t j = i + 1; j < instructions.size(); j++) {
+      const auto &instruction = instructions[j];
+      if (instruction.kind_ == Instruction::Kind::BLANK) {
+        continue;
+      }
+      if (instruction.kind_ != Instruction::Kind::INSTRUCTION || !instruction.IsKnown() || instruction.IsBranch() ||
+          instruction.IsCall()) {
+        break;
+      }
+      const auto &operands = instruction.operands_;
+      if (instruction.opcode_ == "mul" && operands.size() == 3 && operands[0] == product &&
+          (operands[1] == product) != (operands[2] == product)) {
+        const std::string &factor = operands[1] == product ? operands[2] : operands[1];
+        bool scratch = UsesScratch(rule->second);
+        if (factor == "$zero" ||
+            (scratch && (product == SCRATCH || factor == SCRATCH || IsScratchLive(instructions, j)))) {
+          break;
+        }
+        removed[i] = true;
+        replacements[j] = Instantiate(rule->second, factor, product, "x * " + load.operands_[1]);
+        rewritten_count_++;
+        break;
+      }
+      if (Mentions(instruction.GetUsedRegisters(), product) || Mentions(instruction.GetDefinedRegisters(), product)) {
+        break;
+      }
+    }
+  }
+
+  if (rewritten_count_ == 0) {
+    return;
+  }
+  std::vector<Instruction> optimized;
+  optimized.reserve(instructions.size());
+  for (size_t i = 0; i < instructions.size(); i++) {
+    auto replacement = replacements.find(i);
+    if (replacement != replacements.end()) {
+      for (auto &instruction : replacement->second) {
+        optimized.push_back(std::move(instruction));
+      }
+    } else if (!removed[i]) {
+      optimized.push_back(std::move(instructions[i]));
+    }
+  }
+  instructions = std::move(optimized);
+}
+
+}  // namespace scp::cgen
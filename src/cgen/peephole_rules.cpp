@@ -0,0 +1,193 @@
+// Generated by scp-superopt --emit; do not edit. Every rule is verified on all 2^32 inputs.
+#include "cgen/peephole_rules.h"
+
+namespace scp::cgen {
+
+auto GetPeepholeRules() -> const std::vector<PeepholeRule> & {
+  static const std::vector<PeepholeRule> RULES = {
+      {-64, "sll $out, $in, 6; subu $out, $zero, $out"},
+      {-63, "sll $out, $in, 6; subu $out, $in, $out"},
+      {-62, "sll $out, $in, 1; sll $tmp, $in, 6; subu $out, $out, $tmp"},
+      {-60, "sll $out, $in, 2; sll $tmp, $in, 6; subu $out, $out, $tmp"},
+      {-56, "sll $out, $in, 3; subu $out, $in, $out; sll $out, $out, 3"},
+      {-48, "sll $out, $in, 2; subu $out, $in, $out; sll $out, $out, 4"},
+      {-33, "sll $out, $in, 5; addu $out, $in, $out; subu $out, $zero, $out"},
+      {-32, "sll $out, $in, 5; subu $out, $zero, $out"},
+      {-31, "sll $out, $in, 5; subu $out, $in, $out"},
+      {-30, "sll $out, $in, 1; sll $tmp, $in, 5; subu $out, $out, $tmp"},
+      {-28, "sll $out, $in, 2; sll $tmp, $in, 5; subu $out, $out, $tmp"},
+      {-24, "sll $out, $in, 2; subu $out, $in, $out; sll $out, $out, 3"},
+      {-17, "sll $out, $in, 4; addu $out, $in, $out; subu $out, $zero, $out"},
+      {-16, "sll $out, $in, 4; subu $out, $zero, $out"},
+      {-15, "sll $out, $in, 4; subu $out, $in, $out"},
+      {-14, "sll $out, $in, 1; sll $tmp, $in, 4; subu $out, $out, $tmp"},
+      {-12, "sll $out, $in, 2; subu $out, $in, $out; sll $out, $out, 2"},
+      {-9, "sll $out, $in, 3; addu $out, $in, $out; subu $out, $zero, $out"},
+      {-8, "sll $out, $in, 3; subu $out, $zero, $out"},
+      {-7, "sll $out, $in, 3; subu $out, $in, $out"},
+      {-6, "sll $out, $in, 1; sll $tmp, $in, 3; subu $out, $out, $tmp"},
+      {-5, "sll $out, $in, 2; addu $out, $in, $out; subu $out, $zero, $out"},
+      {-4, "sll $out, $in, 2; subu $out, $zero, $out"},
+      {-3, "sll $out, $in, 2; subu $out, $in, $out"},
+      {-2, "sll $out, $in, 1; subu $out, $zero, $out"},
+      {-1, "subu $out, $zero, $in"},
+      {0, "move $out, $zero"},
+      {1, "move $out, $in"},
+      {2, "sll $out, $in, 1"},
+      {3, "sll $out, $in, 1; addu $out, $in, $out"},
+      {4, "sll $out, $in, 2"},
+      {5, "sll $out, $in, 2; addu $out, $in, $out"},
+      {6, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 1"},
+      {7, "sll $out, $in, 3; subu $out, $out, $in"},
+      {8, "sll $out, $in, 3"},
+      {9, "sll $out, $in, 3; addu $out, $in, $out"},
+      {10, "sll $out, $in, 1; sll $tmp, $in, 3; addu $out, $out, $tmp"},
+      {12, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 2"},
+      {14, "sll $out, $in, 1; sll $tmp, $in, 4; subu $out, $tmp, $out"},
+      {15, "sll $out, $in, 4; subu $out, $out, $in"},
+      {16, "sll $out, $in, 4"},
+      {17, "sll $out, $in, 4; addu $out, $in, $out"},
+      {18, "sll $out, $in, 1; sll $tmp, $in, 4; addu $out, $out, $tmp"},
+      {20, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 2"},
+      {24, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 3"},
+      {28, "sll $out, $in, 2; sll $tmp, $in, 5; subu $out, $tmp, $out"},
+      {30, "sll $out, $in, 1; sll $tmp, $in, 5; subu $out, $tmp, $out"},
+      {31, "sll $out, $in, 5; subu $out, $out, $in"},
+      {32, "sll $out, $in, 5"},
+      {33, "sll $out, $in, 5; addu $out, $in, $out"},
+      {34, "sll $out, $in, 1; sll $tmp, $in, 5; addu $out, $out, $tmp"},
+      {36, "sll $out, $in, 2; sll $tmp, $in, 5; addu $out, $out, $tmp"},
+      {40, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 3"},
+      {48, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 4"},
+      {56, "sll $out, $in, 3; subu $out, $out, $in; sll $out, $out, 3"},
+      {60, "sll $out, $in, 2; sll $tmp, $in, 6; subu $out, $tmp, $out"},
+      {62, "sll $out, $in, 1; sll $tmp, $in, 6; subu $out, $tmp, $out"},
+      {63, "sll $out, $in, 6; subu $out, $out, $in"},
+      {64, "sll $out, $in, 6"},
+      {65, "sll $out, $in, 6; addu $out, $in, $out"},
+      {66, "sll $out, $in, 1; sll $tmp, $in, 6; addu $out, $out, $tmp"},
+      {68, "sll $out, $in, 2; sll $tmp, $in, 6; addu $out, $out, $tmp"},
+      {72, "sll $out, $in, 3; addu $out, $in, $out; sll $out, $out, 3"},
+      {80, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 4"},
+      {96, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 5"},
+      {112, "sll $out, $in, 3; subu $out, $out, $in; sll $out, $out, 4"},
+      {120, "sll $out, $in, 3; sll $tmp, $in, 7; subu $out, $tmp, $out"},
+      {124, "sll $out, $in, 2; sll $tmp, $in, 7; subu $out, $tmp, $out"},
+      {126, "sll $out, $in, 1; sll $tmp, $in, 7; subu $out, $tmp, $out"},
+      {127, "sll $out, $in, 7; subu $out, $out, $in"},
+      {128, "sll $out, $in, 7"},
+      {129, "sll $out, $in, 7; addu $out, $in, $out"},
+      {130, "sll $out, $in, 1; sll $tmp, $in, 7; addu $out, $out, $tmp"},
+      {132, "sll $out, $in, 2; sll $tmp, $in, 7; addu $out, $out, $tmp"},
+      {136, "sll $out, $in, 3; sll $tmp, $in, 7; addu $out, $out, $tmp"},
+      {144, "sll $out, $in, 3; addu $out, $in, $out; sll $out, $out, 4"},
+      {160, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 5"},
+      {192, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 6"},
+      {224, "sll $out, $in, 3; subu $out, $out, $in; sll $out, $out, 5"},
+      {240, "sll $out, $in, 4; subu $out, $out, $in; sll $out, $out, 4"},
+      {248, "sll $out, $in, 3; sll $tmp, $in, 8; subu $out, $tmp, $out"},
+      {252, "sll $out, $in, 2; sll $tmp, $in, 8; subu $out, $tmp, $out"},
+      {254, "sll $out, $in, 1; sll $tmp, $in, 8; subu $out, $tmp, $out"},
+      {255, "sll $out, $in, 8; subu $out, $out, $in"},
+      {256, "sll $out, $in, 8"},
+      {257, "sll $out, $in, 8; addu $out, $in, $out"},
+      {258, "sll $out, $in, 1; sll $tmp, $in, 8; addu $out, $out, $tmp"},
+      {260, "sll $out, $in, 2; sll $tmp, $in, 8; addu $out, $out, $tmp"},
+      {264, "sll $out, $in, 3; sll $tmp, $in, 8; addu $out, $out, $tmp"},
+      {272, "sll $out, $in, 4; addu $out, $in, $out; sll $out, $out, 4"},
+      {288, "sll $out, $in, 3; addu $out, $in, $out; sll $out, $out, 5"},
+      {320, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 6"},
+      {384, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 7"},
+      {448, "sll $out, $in, 3; subu $out, $out, $in; sll $out, $out, 6"},
+      {480, "sll $out, $in, 4; subu $out, $out, $in; sll $out, $out, 5"},
+      {496, "sll $out, $in, 4; sll $tmp, $in, 9; subu $out, $tmp, $out"},
+      {504, "sll $out, $in, 3; sll $tmp, $in, 9; subu $out, $tmp, $out"},
+      {508, "sll $out, $in, 2; sll $tmp, $in, 9; subu $out, $tmp, $out"},
+      {510, "sll $out, $in, 1; sll $tmp, $in, 9; subu $out, $tmp, $out"},
+      {511, "sll $out, $in, 9; subu $out, $out, $in"},
+      {512, "sll $out, $in, 9"},
+      {513, "sll $out, $in, 9; addu $out, $in, $out"},
+      {514, "sll $out, $in, 1; sll $tmp, $in, 9; addu $out, $out, $tmp"},
+      {516, "sll $out, $in, 2; sll $tmp, $in, 9; addu $out, $out, $tmp"},
+      {520, "sll $out, $in, 3; sll $tmp, $in, 9; addu $out, $out, $tmp"},
+      {528, "sll $out, $in, 4; sll $tmp, $in, 9; addu $out, $out, $tmp"},
+      {544, "sll $out, $in, 4; addu $out, $in, $out; sll $out, $out, 5"},
+      {576, "sll $out, $in, 3; addu $out, $in, $out; sll $out, $out, 6"},
+      {640, "sll $out, $in, 2; addu $out, $in, $out; sll $out, $out, 7"},
+      {768, "sll $out, $in, 1; addu $out, $in, $out; sll $out, $out, 8"},
+      {896, "sll $out, $in, 3; subu $out, $out, $in; sll $out, $out, 7"},
+      {960, "sll $out, $in, 4; subu $out, $out, $in; sll $out, $out, 6"},
+      {992, "sll $out, $in, 5; subu $out, $out, $in; sll $out, $out, 5"},
+      {1008, "sll $out, $in, 4; sll $tmp, $in, 10; subu $out, $tmp, $out"},
+      {1016, "sll $out, $in, 3; sll $tmp, $in, 10; subu $out, $tmp, $out"},
+      {1020, "sll $out, $in, 2; sll $tmp, $in, 10; subu $out, $tmp, $out"},
+      {1022, "sll $out, $in, 1; sll $tmp, $in, 10; subu $out, $tmp, $out"},
+      {1023, "sll $out, $in, 10; subu $out, $out, $in"},
+      {1024, "sll $out, $in, 10"},
+      {1025, "sll $out, $in, 10; addu $out, $in, $out"},
+      {2047, "sll $out, $in, 11; subu $out, $out, $in"},
+      {2048, "sll $out, $in, 11"},
+      {2049, "sll $out, $in, 11; addu $out, $in, $out"},
+      {4095, "sll $out, $in, 12; subu $out, $out, $in"},
+      {4096, "sll $out, $in, 12"},
+      {4097, "sll $out, $in, 12; addu $out, $in, $out"},
+      {8191, "sll $out, $in, 13; subu $out, $out, $in"},
+      {8192, "sll $out, $in, 13"},
+      {8193, "sll $out, $in, 13; addu $out, $in, $out"},
+      {16383, "sll $out, $in, 14; subu $out, $out, $in"},
+      {16384, "sll $out, $in, 14"},
+      {16385, "sll $out, $in, 14; addu $out, $in, $out"},
+      {32767, "sll $out, $in, 15; subu $out, $out, $in"},
+      {32768, "sll $out, $in, 15"},
+      {32769, "sll $out, $in, 15; addu $out, $in, $out"},
+      {65535, "sll $out, $in, 16; subu $out, $out, $in"},
+      {65536, "sll $out, $in, 16"},
+      {65537, "sll $out, $in, 16; addu $out, $in, $out"},
+      {131071, "sll $out, $in, 17; subu $out, $out, $in"},
+      {131072, "sll $out, $in, 17"},
+      {131073, "sll $out, $in, 17; addu $out, $in, $out"},
+      {262143, "sll $out, $in, 18; subu $out, $out, $in"},
+      {262144, "sll $out, $in, 18"},
+      {262145, "sll $out, $in, 18; addu $out, $in, $out"},
+      {524287, "sll $out, $in, 19; subu $out, $out, $in"},
+      {524288, "sll $out, $in, 19"},
+      {524289, "sll $out, $in, 19; addu $out, $in, $out"},
+      {1048575, "sll $out, $in, 20; subu $out, $out, $in"},
+      {1048576, "sll $out, $in, 20"},
+      {1048577, "sll $out, $in, 20; addu $out, $in, $out"},
+      {2097151, "sll $out, $in, 21; subu $out, $out, $in"},
+      {2097152, "sll $out, $in, 21"},
+      {2097153, "sll $out, $in, 21; addu $out, $in, $out"},
+      {4194303, "sll $out, $in, 22; subu $out, $out, $in"},
+      {4194304, "sll $out, $in, 22"},
+      {4194305, "sll $out, $in, 22; addu $out, $in, $out"},
+      {8388607, "sll $out, $in, 23; subu $out, $out, $in"},
+      {8388608, "sll $out, $in, 23"},
+      {8388609, "sll $out, $in, 23; addu $out, $in, $out"},
+      {16777215, "sll $out, $in, 24; subu $out, $out, $in"},
+      {16777216, "sll $out, $in, 24"},
+      {16777217, "sll $out, $in, 24; addu $out, $in, $out"},
+      {33554431, "sll $out, $in, 25; subu $out, $out, $in"},
+      {33554432, "sll $out, $in, 25"},
+      {33554433, "sll $out, $in, 25; addu $out, $in, $out"},
+      {67108863, "sll $out, $in, 26; subu $out, $out, $in"},
+      {67108864, "sll $out, $in, 26"},
+      {67108865, "sll $out, $in, 26; addu $out, $in, $out"},
+      {134217727, "sll $out, $in, 27; subu $out, $out, $in"},
+      {134217728, "sll $out, $in, 27"},
+      {134217729, "sll $out, $in, 27; addu $out, $in, $out"},
+      {268435455, "sll $out, $in, 28; subu $out, $out, $in"},
+      {268435456, "sll $out, $in, 28"},
+      {268435457, "sll $out, $in, 28; addu $out, $in, $out"},
+      {536870911, "sll $out, $in, 29; subu $out, $out, $in"},
+      {536870912, "sll $out, $in, 29"},
+      {536870913, "sll $out, $in, 29; addu $out, $in, $out"},
+      {1073741823, "sll $out, $in, 30; subu $out, $out, $in"},
+      {1073741824, "sll $out, $in, 30"},
+      {1073741825, "sll $out, $in, 30; addu $out, $in, $out"},
+      {2147483647, "sll $out, $in, 31; subu $out, $out, $in"},
+  };
+  return RULES;
+}
+
+}  // namespace scp::cgen
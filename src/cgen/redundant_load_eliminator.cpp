@@ -0,0 +1,122 @@
+#include "cgen/redundant_load_eliminator.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace scp::cgen {
+
+namespace {
+
+// Registers a runtime routine may clobber under the MIPS calling convention
+auto IsCallerSaved(const std::string &reg) -> bool {
+  return reg == "$at" || reg == "$ra" || (reg.size() == 3 && (reg[1] == 'v' || reg[1] == 'a' || reg[1] == 't'));
+}
+
+// Check whether an operand names a frame slot, e.g. "4($fp)"
+auto IsFrameSlot(const std::string &operand) -> bool {
+  return operand.size() > 5 && operand.compare(operand.size() - 5, 5, "($fp)") == 0;
+}
+
+}  // namespace
+
+void RedundantLoadEliminator::Run(InstructionBuffer &buffer) {
+  register_slot_.clear();
+  removed_count_ = 0;
+  replaced_count_ = 0;
+
+  std::vector<Instruction> optimized;
+  optimized.reserve(buffer.GetInstructions().size());
+
+  for (auto &instruction : buffer.GetInstructions()) {
+    if (instruction.kind_ == Instruction::Kind::LABEL || instruction.kind_ == Instruction::Kind::DIRECTIVE) {
+      // Control may reach a label from anywhere
+      register_slot_.clear();
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+    if (instruction.kind_ != Instruction::Kind::INSTRUCTION) {
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+    if (!instruction.IsKnown()) {
+      register_slot_.clear();
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+
+    const auto &operands = instruction.operands_;
+    if (instruction.opcode_ == "lw" && operands.size() == 2 && IsFrameSlot(operands[1]) && operands[0] != "$fp") {
+      const std::string &reg = operands[0];
+      const std::string &slot = operands[1];
+      auto held = register_slot_.find(reg);
+      if (held != register_slot_.end() && held->second == slot) {
+        // The register already holds the slot
+        removed_count_++;
+        continue;
+      }
+      std::string source;
+      for (const auto &[other, other_slot] : register_slot_) {
+        if (other_slot == slot) {
+          source = other;
+          break;
+        }
+      }
+      Invalidate(reg);
+      register_slot_[reg] = slot;
+      if (!source.empty()) {
+        replaced_count_++;
+        optimized.push_back(Instruction::Make("move", {reg, source}));
+        continue;
+      }
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+
+    if (instruction.opcode_ == "sw" && operands.size() == 2 && IsFrameSlot(operands[1])) {
+      InvalidateSlot(operands[1]);
+      if (operands[0] != "$zero") {
+        register_slot_[operands[0]] = operands[1];
+      }
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+
+    if (instruction.opcode_ == "move" && operands.size() == 2) {
+      // The destination now holds whatever the source holds
+      auto held = register_slot_.find(operands[1]);
+      std::string slot = held != register_slot_.end() ? held->second : "";
+      Invalidate(operands[0]);
+      if (!slot.empty()) {
+        register_slot_[operands[0]] = slot;
+      }
+      optimized.push_back(std::move(instruction));
+      continue;
+    }
+
+    if (instruction.IsCall()) {
+      for (auto it = register_slot_.begin(); it != register_slot_.end();) {
+        it = IsCallerSaved(it->first) ? register_slot_.erase(it) : std::next(it);
+      }
+    }
+    for (const auto &reg : instruction.GetDefinedRegisters()) {
+      Invalidate(reg);
+      if (reg == "$fp") {
+        register_slot_.clear();  // The frame moved
+      }
+    }
+    optimized.push_back(std::move(instruction));
+  }
+
+  buffer.GetInstructions() = std::move(optimized);
+}
+
+void RedundantLoadEliminator::Invalidate(const std::string &reg) { register_slot_.erase(reg); }
+
+void RedundantLoadEliminator::InvalidateSlot(const std::string &slot) {
+  for (auto it = register_slot_.begin(); it != register_slot_.end();) {
+    it = it->second == slot ? register_slot_.erase(it) : std::next(it);
+  }
+}
+
+}  // namespace scp::cgen
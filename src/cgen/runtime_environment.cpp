@@ -5,12 +5,16 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "core/trace.h"
 #include "core/type.h"
 
 namespace scp::cgen {
 
-RuntimeEnvironment::RuntimeEnvironment(const std::shared_ptr<core::TypeEnvironment> &environment) {
+RuntimeEnvironment::RuntimeEnvironment(const std::shared_ptr<core::TypeEnvironment> &environment,
+                                       StringRuntime string_runtime)
+    : string_runtime_(string_runtime) {
   auto symbol_table = environment->GetSymbolTable();
   int allocated_offset = 0;
   while (auto symbol = symbol_table->PopSymbol()) {
@@ -28,6 +32,11 @@ auto RuntimeEnvironment::GetStackAllocation(const std::string &symbol) -> int {
   throw std::runtime_error("Symbol not found: " + symbol);
 }
 
+void RuntimeEnvironment::AddSymbol(const std::string &symbol, core::Type type) {
+  int offset = static_cast<int>(symbol_table_.size()) * 4;
+  symbol_table_.emplace(symbol, std::make_pair(offset, type));
+}
+
 auto RuntimeEnvironment::GetGlobalStringData(const std::string &symbol) -> std::string {
   auto it = global_string_data_table_.find(symbol);
   if (it != global_string_data_table_.end()) {
@@ -48,13 +57,30 @@ auto RuntimeEnvironment::GetType(const std::string &symbol) -> core::Type {
 }
 
 auto RuntimeEnvironment::GenerateDataSection() const -> std::string {
+  SCP_TRACE_SCOPE("EmitDataSection");
   std::stringstream code;
 
   code << ".data" << std::endl;
 
-  // Add string constants
-  for (const auto &pair : global_string_data_table_) {
-    code << pair.second << ": .asciiz " << pair.first << std::endl;
+  // Add string constants in label order, so the output does not depend on the layout of the table
+  std::vector<std::string> literals = GetStringConstants();
+  for (size_t i = 0; i < literals.size(); i++) {
+    code << "str_" << i << ": .asciiz " << literals[i] << std::endl;
+  }
+
+  if (string_runtime_ == StringRuntime::ROPE) {
+    // Every string constant is also wrapped in a rope leaf node: {tag = 0, flat address, unused}
+    code << std::endl << "# Rope leaves for string constants" << std::endl;
+    for (size_t i = 0; i < literals.size(); i++) {
+      code << "str_" << i << "_rope: .word 0, str_" << i << ", 0" << std::endl;
+    }
+
+    // Rope nodes are bump-allocated from sbrk'd chunks
+    code << std::endl << "# Buffers for string operations" << std::endl;
+    code << "input_buffer: .space 256" << std::endl;
+    code << "rope_arena_ptr: .word 0" << std::endl;
+    code << "rope_arena_end: .word 0" << std::endl;
+    return code.str();
   }
 
   // Always add buffers needed for string processing (even if current program doesn't use them)
@@ -81,4 +107,12 @@ auto RuntimeEnvironment::GetStackSize() const -> int { return symbol_table_.size
 
 auto RuntimeEnvironment::GetUniqueInputId() -> int { return ++input_counter_; }
 
+auto RuntimeEnvironment::GetStringConstants() const -> std::vector<std::string> {
+  std::vector<std::string> literals(global_string_data_table_.size());
+  for (const auto &[literal, label] : global_string_data_table_) {
+    literals[std::stoul(label.substr(4))] = literal;  // Labels are str_<index>
+  }
+  return literals;
+}
+
 }  // namespace scp::cgen
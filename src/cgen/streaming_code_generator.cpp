@@ -0,0 +1,66 @@
+#include "cgen/streaming_code_generator.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "core/trace.h"
+#include "core/type.h"
+
+namespace scp::cgen {
+
+StreamingCodeGenerator::StreamingCodeGenerator(std::ostream &output, CodeGeneratorOptions options)
+    : output_(output),
+      options_(options),
+      runtime_environment_(std::make_shared<RuntimeEnvironment>(options_.string_runtime_)) {
+  // The type checker declares both streams, so they have slots in the batch frame as well
+  runtime_environment_->AddSymbol("stdin", core::Type::IN_STREAM);
+  runtime_environment_->AddSymbol("stdout", core::Type::OUT_STREAM);
+  pending_ = ".text\nmain_body:\n";
+}
+
+void StreamingCodeGenerator::AddStatement(const std::shared_ptr<core::AST::ASTNode> &statement,
+                                          const std::shared_ptr<core::TypeEnvironment> &type_environment) {
+  const auto &target = statement->GetChildren().front()->GetValue();
+  runtime_environment_->AddSymbol(target, type_environment->GetType(target));
+  pending_ += statement->GenerateCode(runtime_environment_);
+  peak_pending_bytes_ = std::max(peak_pending_bytes_, pending_.size());
+  if (pending_.size() >= FLUSH_BYTES) {
+    Flush();
+  }
+}
+
+void StreamingCodeGenerator::Finish() {
+  SCP_TRACE_SCOPE("FinishStream");
+  int frame_bytes = runtime_environment_->GetStackSize() * 4;
+  std::stringstream code;
+
+  // Restore stack and exit
+  code << "    addiu $sp, $sp, " << frame_bytes << std::endl;
+  code << "    li $v0, 10" << std::endl << "    syscall" << std::endl;
+  code << CodeGenerator::GenerateRuntime(options_.string_runtime_);
+  pending_ += code.str();
+  peak_pending_bytes_ = std::max(peak_pending_bytes_, pending_.size());
+  Flush();
+
+  output_ << std::endl << runtime_environment_->GenerateDataSection() << std::endl;
+
+  // The entry point allocates the frame, whose size is only known now, and enters the body
+  output_ << ".text" << std::endl << ".globl main" << std::endl << "main:" << std::endl;
+  output_ << "    addiu $sp, $sp, -" << frame_bytes << std::endl;
+  output_ << "    move $fp, $sp" << std::endl;
+  output_ << "    j main_body" << std::endl;
+  if (options_.fill_delay_slots_) {
+    output_ << "    nop" << std::endl;  // The trailer is not scheduled, so its delay slot stays empty
+  }
+}
+
+void StreamingCodeGenerator::Flush() {
+  SCP_TRACE_SCOPE("FlushStream");
+  output_ << CodeGenerator::Optimize(pending_, options_);
+  pending_.clear();
+}
+
+}  // namespace scp::cgen
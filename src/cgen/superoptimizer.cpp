@@ -0,0 +1,489 @@
+#include "cgen/superoptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cgen/instruction_buffer.h"
+#include "core/flat_hash_map.h"
+
+namespace scp::cgen {
+
+namespace {
+
+using Opcode = MicroInstruction::Opcode;
+
+/* The registers by name, indexed like Superoptimizer::ZERO, IN, OUT and TMP */
+constexpr std::array<const char *, Superoptimizer::REGISTER_COUNT> REGISTER_NAMES = {"$zero", "$in", "$out", "$tmp"};
+
+/* The opcodes by name, indexed like MicroInstruction::Opcode */
+constexpr std::array<const char *, 8> OPCODE_NAMES = {"li", "addiu", "add", "addu", "subu", "sll", "mul", "move"};
+
+/* The highest degree the verification tracks; sequences of a few instructions stay far below it */
+constexpr int MAX_DEGREE = 64;
+
+auto FitsInt16(int32_t value) -> bool { return value >= -32768 && value <= 32767; }
+
+/**
+ * Run one instruction on register values.
+ * @param instruction The instruction.
+ * @param registers The registers, updated in place.
+ * @return False if the instruction traps.
+ */
+auto Step(const MicroInstruction &instruction, std::array<uint32_t, Superoptimizer::REGISTER_COUNT> &registers)
+    -> bool {
+  uint32_t first = registers[instruction.first_];
+  uint32_t second = registers[instruction.second_];
+  auto immediate = static_cast<uint32_t>(instruction.immediate_);
+  uint32_t result = 0;
+  switch (instruction.opcode_) {
+    case Opcode::LI:
+      result = immediate;
+      break;
+    case Opcode::ADDIU:
+      result = first + immediate;
+      break;
+    case Opcode::ADD: {
+      int64_t sum = int64_t{static_cast<int32_t>(first)} + static_cast<int32_t>(second);
+      if (sum < std::numeric_limits<int32_t>::min() || sum > std::numeric_limits<int32_t>::max()) {
+        return false;
+      }
+      result = first + second;
+      break;
+    }
+    case Opcode::ADDU:
+      result = first + second;
+      break;
+    case Opcode::SUBU:
+      result = first - second;
+      break;
+    case Opcode::SLL:
+      result = first << (immediate & 31);
+      break;
+    case Opcode::MUL:
+      result = first * second;
+      break;
+    case Opcode::MOVE:
+      result = first;
+      break;
+  }
+  if (instruction.destination_ != Superoptimizer::ZERO) {
+    registers[instruction.destination_] = result;
+  }
+  return true;
+}
+
+/**
+ * Get the registers an instruction reads.
+ * @param instruction The instruction.
+ * @return The number of registers read, 0, 1 or 2, which are first_ and then second_.
+ */
+auto ReadCount(const MicroInstruction &instruction) -> int {
+  switch (instruction.opcode_) {
+    case Opcode::LI:
+      return 0;
+    case Opcode::ADDIU:
+    case Opcode::SLL:
+    case Opcode::MOVE:
+      return 1;
+    default:
+      return 2;
+  }
+}
+
+/**
+ * Check that a sequence writes $out and reads $out and $tmp only after writing them.
+ * @param sequence The sequence.
+ * @return Whether it does.
+ */
+auto IsWellFormed(const MicroSequence &sequence) -> bool {
+  std::array<bool, Superoptimizer::REGISTER_COUNT> defined = {true, true, false, false};
+  for (const auto &instruction : sequence) {
+    int reads = ReadCount(instruction);
+    if ((reads >= 1 && !defined[instruction.first_]) || (reads == 2 && !defined[instruction.second_])) {
+      return false;
+    }
+    defined[instruction.destination_] = true;
+  }
+  return defined[Superoptimizer::OUT];
+}
+
+/**
+ * Get the degree of the polynomial of $in a sequence leaves in $out, for sequences without `add`.
+ * @param sequence The sequence.
+ * @return The degree, capped at MAX_DEGREE.
+ */
+auto GetDegree(const MicroSequence &sequence) -> int {
+  std::array<int, Superoptimizer::REGISTER_COUNT> degrees = {0, 1, 0, 0};
+  for (const auto &instruction : sequence) {
+    int first = degrees[instruction.first_];
+    int second = degrees[instruction.second_];
+    int degree = 0;
+    switch (instruction.opcode_) {
+      case Opcode::LI:
+        degree = 0;
+        break;
+      case Opcode::ADD:
+      case Opcode::ADDU:
+      case Opcode::SUBU:
+        degree = std::max(first, second);
+        break;
+      case Opcode::MUL:
+        degree = std::min(first + second, MAX_DEGREE);
+        break;
+      default:
+        degree = first;
+        break;
+    }
+    if (instruction.destination_ != Superoptimizer::ZERO) {
+      degrees[instruction.destination_] = degree;
+    }
+  }
+  return degrees[Superoptimizer::OUT];
+}
+
+auto HasAdd(const MicroSequence &sequence) -> bool {
+  return std::any_of(sequence.begin(), sequence.end(),
+                     [](const MicroInstruction &instruction) { return instruction.opcode_ == Opcode::ADD; });
+}
+
+auto ParseRegister(const std::string &operand) -> int {
+  for (size_t i = 0; i < REGISTER_NAMES.size(); i++) {
+    if (operand == REGISTER_NAMES[i]) {
+      return static_cast<int>(i);
+    }
+  }
+  throw std::runtime_error("Unknown register " + operand + ", expected $zero, $in, $out or $tmp");
+}
+
+auto ParseImmediate(const std::string &operand) -> int32_t {
+  size_t end = 0;
+  long long value = 0;
+  try {
+    value = std::stoll(operand, &end, 0);
+  } catch (const std::exception &) {
+    end = 0;
+  }
+  if (end != operand.size() || value < std::numeric_limits<int32_t>::min() ||
+      value > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Invalid immediate " + operand);
+  }
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+/**
+ * The register values a sequence leaves on every test input, keyed for finding sequences that compute the same.
+ */
+struct State {
+  /* The values of $out and $tmp on each test input */
+  std::array<std::array<uint32_t, Superoptimizer::TEST_COUNT>, 2> values_{};
+  /* The test inputs on which the sequence trapped */
+  uint32_t trapped_{0};
+  /* Whether $out and $tmp are written, bits 0 and 1 */
+  uint32_t defined_{0};
+  /* The cost of the sequence */
+  int cost_{0};
+  /* The sequence */
+  MicroSequence sequence_;
+};
+
+// FNV-1a over the words the hash covers
+auto HashWords(uint64_t hash, const uint32_t *words, size_t count) -> uint64_t {
+  for (size_t i = 0; i < count; i++) {
+    hash = (hash ^ words[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// The hash of what a state leaves in $out, which candidates and targets share when they agree
+auto HashOut(const State &state) -> uint64_t {
+  uint64_t hash = HashWords(0xcbf29ce484222325ULL, &state.trapped_, 1);
+  return HashWords(hash, state.values_[0].data(), state.values_[0].size());
+}
+
+// The hash of everything a state leaves behind, which sequences enumerated once share
+auto HashState(const State &state) -> uint64_t {
+  uint64_t hash = HashWords(HashOut(state), &state.defined_, 1);
+  return HashWords(hash, state.values_[1].data(), state.values_[1].size());
+}
+
+}  // namespace
+
+Superoptimizer::Superoptimizer(SuperoptimizerOptions options) : options_(std::move(options)) {
+  // Edge cases of the arithmetic first, the rest random
+  inputs_ = {0, 1, 2, 3, 0xffffffffU, 0x80000000U, 0x7fffffffU, 0x40000000U, 0xc0000000U, 0x55555555U};
+  std::mt19937 random(options_.seed_);
+  while (inputs_.size() < TEST_COUNT) {
+    inputs_.push_back(static_cast<uint32_t>(random()));
+  }
+}
+
+auto Superoptimizer::Search(const std::vector<MicroSequence> &targets) -> std::vector<std::optional<MicroSequence>> {
+  enumerated_count_ = 0;
+  rejected_count_ = 0;
+  std::vector<std::optional<MicroSequence>> best(targets.size());
+  std::vector<int> best_costs(targets.size());
+  std::vector<State> target_states(targets.size());
+  core::FlatHashMap<uint64_t, std::vector<size_t>> targets_by_out;
+  for (size_t i = 0; i < targets.size(); i++) {
+    best_costs[i] = GetCost(targets[i]);
+    for (size_t lane = 0; lane < TEST_COUNT; lane++) {
+      auto out = Evaluate(targets[i], inputs_[lane]);
+      target_states[i].values_[0][lane] = out.value_or(0);
+      target_states[i].trapped_ |= out ? 0U : 1U << lane;
+    }
+    targets_by_out[HashOut(target_states[i])].push_back(i);
+  }
+
+  // Run one more instruction on every state, on all test inputs at once
+  auto extend = [this](const State &state, const MicroInstruction &instruction) {
+    State next = state;
+    next.sequence_.push_back(instruction);
+    next.cost_ += GetCost({instruction});
+    int slot = instruction.destination_ - OUT;
+    next.defined_ |= 1U << slot;
+    for (size_t lane = 0; lane < TEST_COUNT; lane++) {
+      std::array<uint32_t, REGISTER_COUNT> registers = {0, inputs_[lane], state.values_[0][lane],
+                                                        state.values_[1][lane]};
+      if (!Step(instruction, registers)) {
+        next.trapped_ |= 1U << lane;
+      }
+      next.values_[slot][lane] = (next.trapped_ >> lane & 1U) != 0 ? 0 : registers[instruction.destination_];
+    }
+    return next;
+  };
+
+  std::vector<State> frontier(1);
+  for (size_t length = 1; length <= options_.max_length_; length++) {
+    bool last = length == options_.max_length_;
+    std::vector<State> next_frontier;
+    core::FlatHashMap<uint64_t, size_t> seen;
+    for (const auto &state : frontier) {
+      // Every instruction writing $out or $tmp from registers that hold values
+      std::vector<int> sources = {ZERO, IN};
+      for (int reg : {OUT, TMP}) {
+        if ((state.defined_ >> (reg - OUT) & 1U) != 0) {
+          sources.push_back(reg);
+        }
+      }
+      std::vector<MicroInstruction> instructions;
+      for (int destination : {OUT, TMP}) {
+        for (int32_t immediate : options_.immediates_) {
+          instructions.push_back({Opcode::LI, destination, ZERO, ZERO, immediate});
+        }
+        for (int source : sources) {
+          if (source == ZERO) {
+            instructions.push_back({Opcode::MOVE, destination, ZERO, ZERO, 0});
+            continue;
+          }
+          if (source != destination) {
+            instructions.push_back({Opcode::MOVE, destination, source, ZERO, 0});
+          }
+          for (int32_t immediate : options_.immediates_) {
+            instructions.push_back({Opcode::ADDIU, destination, source, ZERO, immediate});
+          }
+          for (int32_t shift = 1; shift < 32; shift++) {
+            instructions.push_back({Opcode::SLL, destination, source, ZERO, shift});
+          }
+          for (int second : sources) {
+            // Sources in either order for subu, which also negates by subtracting from $zero
+            if (second != ZERO && second != source) {
+              instructions.push_back({Opcode::SUBU, destination, source, second, 0});
+            }
+            if (second != ZERO && second >= source) {
+              for (auto opcode : {Opcode::ADD, Opcode::ADDU, Opcode::MUL}) {
+                instructions.push_back({opcode, destination, source, second, 0});
+              }
+            }
+          }
+        }
+        for (int second : sources) {
+          if (second != ZERO) {
+            instructions.push_back({Opcode::SUBU, destination, ZERO, second, 0});
+          }
+        }
+      }
+
+      for (const auto &instruction : instructions) {
+        enumerated_count_++;
+        State next = extend(state, instruction);
+        auto matches = (next.defined_ & 1U) != 0 ? targets_by_out.find(HashOut(next)) : targets_by_out.end();
+        if (matches != targets_by_out.end()) {
+          for (size_t i : matches->second) {
+            if (next.cost_ >= best_costs[i] || next.trapped_ != target_states[i].trapped_ ||
+                next.values_[0] != target_states[i].values_[0]) {
+              continue;
+            }
+            if (Verify(next.sequence_, targets[i])) {
+              best[i] = next.sequence_;
+              best_costs[i] = next.cost_;
+            } else {
+              rejected_count_++;
+            }
+          }
+        }
+        if (!last) {
+          auto [it, inserted] = seen.try_emplace(HashState(next), next_frontier.size());
+          if (inserted) {
+            next_frontier.push_back(std::move(next));
+          } else if (next.cost_ < next_frontier[it->second].cost_) {
+            next_frontier[it->second] = std::move(next);
+          }
+        }
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  return best;
+}
+
+auto Superoptimizer::Parse(const std::string &text) -> MicroSequence {
+  MicroSequence sequence;
+  std::string line;
+  std::istringstream lines(text);
+  while (std::getline(lines, line, ';')) {
+    std::istringstream pieces(line);
+    std::string piece;
+    while (std::getline(pieces, piece)) {
+      auto parsed = Instruction::Parse(piece);
+      if (parsed.kind_ == Instruction::Kind::BLANK) {
+        continue;
+      }
+      auto name = std::find(OPCODE_NAMES.begin(), OPCODE_NAMES.end(), parsed.opcode_);
+      if (parsed.kind_ != Instruction::Kind::INSTRUCTION || name == OPCODE_NAMES.end()) {
+        throw std::runtime_error("Unknown instruction: " + piece);
+      }
+      MicroInstruction instruction;
+      instruction.opcode_ = static_cast<Opcode>(name - OPCODE_NAMES.begin());
+      int reads = ReadCount(instruction);
+      bool has_immediate = instruction.opcode_ == Opcode::LI || instruction.opcode_ == Opcode::ADDIU ||
+                           instruction.opcode_ == Opcode::SLL;
+      const auto &operands = parsed.operands_;
+      if (operands.size() != static_cast<size_t>(1 + reads + (has_immediate ? 1 : 0))) {
+        throw std::runtime_error("Wrong number of operands: " + piece);
+      }
+      instruction.destination_ = ParseRegister(operands[0]);
+      instruction.first_ = reads >= 1 ? ParseRegister(operands[1]) : ZERO;
+      instruction.second_ = reads == 2 ? ParseRegister(operands[2]) : ZERO;
+      if (has_immediate) {
+        instruction.immediate_ = ParseImmediate(operands.back());
+        if (instruction.opcode_ == Opcode::SLL && (instruction.immediate_ < 0 || instruction.immediate_ > 31)) {
+          throw std::runtime_error("Shift out of range: " + piece);
+        }
+      }
+      if (instruction.destination_ == IN) {
+        throw std::runtime_error("$in is read-only: " + piece);
+      }
+      sequence.push_back(instruction);
+    }
+  }
+  return sequence;
+}
+
+auto Superoptimizer::ToString(const MicroSequence &sequence) -> std::string {
+  std::string text;
+  for (const auto &instruction : sequence) {
+    if (!text.empty()) {
+      text += "; ";
+    }
+    text += OPCODE_NAMES[static_cast<size_t>(instruction.opcode_)];
+    text += std::string(" ") + REGISTER_NAMES[instruction.destination_];
+    int reads = ReadCount(instruction);
+    if (reads >= 1) {
+      text += std::string(", ") + REGISTER_NAMES[instruction.first_];
+    }
+    if (reads == 2) {
+      text += std::string(", ") + REGISTER_NAMES[instruction.second_];
+    }
+    if (instruction.opcode_ == Opcode::LI || instruction.opcode_ == Opcode::ADDIU ||
+        instruction.opcode_ == Opcode::SLL) {
+      text += ", " + std::to_string(instruction.immediate_);
+    }
+  }
+  return text;
+}
+
+auto Superoptimizer::MultiplyBy(int32_t multiplier) -> MicroSequence {
+  return {{Opcode::LI, OUT, ZERO, ZERO, multiplier}, {Opcode::MUL, OUT, IN, OUT, 0}};
+}
+
+auto Superoptimizer::Evaluate(const MicroSequence &sequence, uint32_t in) -> std::optional<uint32_t> {
+  std::array<uint32_t, REGISTER_COUNT> registers = {0, in, 0, 0};
+  for (const auto &instruction : sequence) {
+    if (!Step(instruction, registers)) {
+      return std::nullopt;
+    }
+  }
+  return registers[OUT];
+}
+
+auto Superoptimizer::GetCost(const MicroSequence &sequence) -> int {
+  int cost = 0;
+  for (const auto &instruction : sequence) {
+    switch (instruction.opcode_) {
+      case Opcode::LI:
+        // li expands to one ori or addiu for 16-bit constants, to lui and ori otherwise
+        cost += FitsInt16(instruction.immediate_) ||
+                        (instruction.immediate_ >= 0 && instruction.immediate_ <= 0xffff)
+                    ? 1
+                    : 2;
+        break;
+      case Opcode::ADDIU:
+        // A wide addiu goes through $at: lui, ori and addu
+        cost += FitsInt16(instruction.immediate_) ? 1 : 3;
+        break;
+      case Opcode::MUL:
+        cost += 3;
+        break;
+      default:
+        cost += 1;
+        break;
+    }
+  }
+  return cost;
+}
+
+auto Superoptimizer::Verify(const MicroSequence &first, const MicroSequence &second) -> bool {
+  if (!IsWellFormed(first) || !IsWellFormed(second)) {
+    return false;
+  }
+  if (!HasAdd(first) && !HasAdd(second)) {
+    // Polynomials of degree at most d agreeing at 0, ..., d agree everywhere
+    int degree = std::max(GetDegree(first), GetDegree(second));
+    for (int in = 0; in <= degree; in++) {
+      if (Evaluate(first, static_cast<uint32_t>(in)) != Evaluate(second, static_cast<uint32_t>(in))) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // Traps are no polynomial; inputs spread evenly and around the overflow boundaries settle most cases before the
+  // exhaustive pass
+  for (uint32_t offset = 0; offset < 1U << 16; offset++) {
+    uint32_t spread = offset * 0x9e3779b9U;
+    if (Evaluate(first, spread) != Evaluate(second, spread)) {
+      return false;
+    }
+    for (uint32_t base : {0U, 0x40000000U, 0x80000000U, 0xc0000000U}) {
+      if (Evaluate(first, base + offset) != Evaluate(second, base + offset) ||
+          Evaluate(first, base - offset) != Evaluate(second, base - offset)) {
+        return false;
+      }
+    }
+  }
+  uint32_t in = 0;
+  do {
+    if (Evaluate(first, in) != Evaluate(second, in)) {
+      return false;
+    }
+  } while (++in != 0);
+  return true;
+}
+
+}  // namespace scp::cgen
@@ -2,21 +2,25 @@
 
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <stack>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "cgen/runtime_environment.h"
 #include "constant/error_messages.h"
+#include "core/diagnostics.h"
+#include "core/flat_hash_map.h"
 #include "core/type.h"
 
 namespace scp::core {
 
 // Helper function to convert string to ASTNodeType
 auto StringToASTNodeType(const std::string &type_str) -> ASTNodeType {
-  static const std::unordered_map<std::string, ASTNodeType> type_map = {
+  static const FlatHashMap<std::string, ASTNodeType> type_map = {
       {"ROOT", ASTNodeType::ROOT},    {"IDENTIFIER", ASTNodeType::IDENTIFIER}, {"NUMBER", ASTNodeType::NUMBER},
       {"PLUS", ASTNodeType::PLUS},    {"TIMES", ASTNodeType::TIMES},           {"ASSIGN", ASTNodeType::ASSIGN},
       {"STRING", ASTNodeType::STRING}};
@@ -109,334 +113,486 @@ AST::AST(std::ifstream &file) : name_("ast_from_file"), root_(nullptr) {
   }
 }
 
-auto AST::ASTNode::TypeCheck(const std::shared_ptr<TypeEnvironment> &environment, bool &has_bug) const -> Type {
-  switch (type_) {
-    case ASTNodeType::ROOT:
-      for (auto &child : children_) {
-        child->TypeCheck(environment, has_bug);
-      }
-      return Type::UNDEFINED;  // Root node does not have a type
-    case ASTNodeType::ASSIGN: {
-      if (children_.size() != 2) {
-        throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
-      }
-      auto child1 = children_.front();
-      auto child2 = children_.back();
-      Type type1 = environment->GetType(child1->value_);
-      Type type2 = child2->TypeCheck(environment, has_bug);
-      if (type2 == Type::IN_STREAM) {
-        type2 = Type::STRING;
-      }
-      if (type1 == Type::IN_STREAM) {
-        has_bug = true;
-        std::cerr << constant::ErrorMessages::CANNOT_ASSIGN_TO_INPUT_STREAM << std::endl;
-        return Type::UNDEFINED;  // Return UNDEFINED if trying to assign to an input stream
-      }
-      if (type1 == Type::UNDEFINED) {
-        environment->AddSymbol(child1->value_, type2);
-        return type2;
-      }
-      if (type2 == Type::OUT_STREAM) {
-        has_bug = true;
-        std::cerr << constant::ErrorMessages::OUTPUT_STREAM_AS_RIGHT_VALUE << std::endl;
-        return Type::UNDEFINED;  // Return UNDEFINED if trying to assign to an output stream
-      }
-      if (type1 == type2) {
-        return type1;
-      }
-      if (type1 == Type::OUT_STREAM) {
-        return Type::OUT_STREAM;  // If the left-hand side is an output stream, return it
-      }
-      has_bug = true;
-      std::cerr << constant::ErrorMessages::TypeCannotAssign(child1->GetValue(), TypeToString(type1),
-                                                             TypeToString(type2))
-                << std::endl;
-      return type1;  // Return the type of the left-hand side
-    }
-    case ASTNodeType::IDENTIFIER: {
-      Type type = environment->GetType(value_);
-      if (type == Type::UNDEFINED) {
-        has_bug = true;
-        std::cerr << constant::ErrorMessages::UseVariableBeforeDeclaration(value_) << std::endl;
-        return Type::UNDEFINED;  // Return UNDEFINED if the variable is not found
-      }
-      return type;
+AST::ASTNode::~ASTNode() {
+  // Detach the subtrees owned only by this node before they are destroyed, so no destructor recurses
+  std::vector<std::shared_ptr<ASTNode>> pending(std::make_move_iterator(children_.begin()),
+                                                std::make_move_iterator(children_.end()));
+  children_.clear();
+  while (!pending.empty()) {
+    auto node = std::move(pending.back());
+    pending.pop_back();
+    if (node && node.use_count() == 1) {
+      std::move(node->children_.begin(), node->children_.end(), std::back_inserter(pending));
+      node->children_.clear();
     }
-    case ASTNodeType::TIMES: {
-      if (children_.size() != 2) {
-        throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
-      }
-      auto child1 = children_.front();
-      auto child2 = children_.back();
-      Type type1 = child1->TypeCheck(environment, has_bug);
-      Type type2 = child2->TypeCheck(environment, has_bug);
-      if (type1 == Type::NUMBER && type2 == Type::NUMBER) {
-        return Type::NUMBER;
-      }
-      if (type1 == Type::NUMBER && type2 == Type::STRING) {
-        return Type::STRING;
-      }
-      if (type1 == Type::STRING && type2 == Type::NUMBER) {
-        return Type::STRING;
-      }
-      has_bug = true;
-      std::cerr << constant::ErrorMessages::TypeCannotTime(TypeToString(type1), TypeToString(type2)) << std::endl;
-      return Type::UNDEFINED;  // Return UNDEFINED if the types do not match
+  }
+}
+
+auto AST::ASTNode::TypeCheck(const std::shared_ptr<TypeEnvironment> &environment, bool &has_bug) const -> Type {
+  // A post-order walk with explicit stacks of the nodes to visit and of the types of the children visited, so
+  // deeply nested expressions cannot overflow the call stack. A node is visited again once its children are checked.
+  std::vector<std::pair<const ASTNode *, bool>> pending = {{this, false}};
+  std::vector<Type> types;
+  while (!pending.empty()) {
+    auto [node, checked] = pending.back();
+    pending.pop_back();
+    const auto &children = node->children_;
+    switch (node->type_) {
+      case ASTNodeType::ROOT:
+        if (!checked) {
+          pending.emplace_back(node, true);
+          for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            pending.emplace_back(child->get(), false);
+          }
+        } else {
+          types.resize(types.size() - children.size());
+          types.push_back(Type::UNDEFINED);  // Root node does not have a type
+        }
+        break;
+      case ASTNodeType::ASSIGN:
+        if (children.size() != 2) {
+          throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
+        }
+        if (!checked) {
+          pending.emplace_back(node, true);
+          pending.emplace_back(children.back().get(), false);
+        } else {
+          types.back() = CheckAssign(children.front()->value_, types.back(), environment, has_bug);
+        }
+        break;
+      case ASTNodeType::IDENTIFIER:
+        types.push_back(CheckIdentifier(node->value_, environment, has_bug));
+        break;
+      case ASTNodeType::TIMES:
+      case ASTNodeType::PLUS:
+        if (children.size() != 2) {
+          throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
+        }
+        if (!checked) {
+          pending.emplace_back(node, true);
+          pending.emplace_back(children.back().get(), false);
+          pending.emplace_back(children.front().get(), false);
+        } else {
+          Type right = types.back();
+          types.pop_back();
+          types.back() = node->type_ == ASTNodeType::PLUS ? CheckPlus(types.back(), right, has_bug)
+                                                          : CheckTimes(types.back(), right, has_bug);
+        }
+        break;
+      case ASTNodeType::NUMBER:
+        types.push_back(Type::NUMBER);
+        break;
+      case ASTNodeType::STRING:
+        types.push_back(Type::STRING);
+        break;
     }
-    case ASTNodeType::PLUS: {
-      if (children_.size() != 2) {
-        throw std::runtime_error(constant::ErrorMessages::Panic("Invalid number of children for AST node"));
-      }
-      auto child1 = children_.front();
-      auto child2 = children_.back();
-      Type type1 = child1->TypeCheck(environment, has_bug);
-      Type type2 = child2->TypeCheck(environment, has_bug);
-      if (type1 == Type::NUMBER && type2 == Type::NUMBER) {
-        return Type::NUMBER;
+  }
+  return types.back();
+}
+
+auto AST::ASTNode::CheckAssign(const std::string &target, Type value,
+                               const std::shared_ptr<TypeEnvironment> &environment, bool &has_bug) -> Type {
+  Type target_type = environment->GetType(target);
+  if (value == Type::IN_STREAM) {
+    value = Type::STRING;
+  }
+  if (target_type == Type::IN_STREAM) {
+    has_bug = true;
+    Diagnostics() << constant::ErrorMessages::CANNOT_ASSIGN_TO_INPUT_STREAM << std::endl;
+    return Type::UNDEFINED;  // Return UNDEFINED if trying to assign to an input stream
+  }
+  if (target_type == Type::UNDEFINED) {
+    environment->AddSymbol(target, value);
+    return value;
+  }
+  if (value == Type::OUT_STREAM) {
+    has_bug = true;
+    Diagnostics() << constant::ErrorMessages::OUTPUT_STREAM_AS_RIGHT_VALUE << std::endl;
+    return Type::UNDEFINED;  // Return UNDEFINED if trying to assign to an output stream
+  }
+  if (target_type == value) {
+    return target_type;
+  }
+  if (target_type == Type::OUT_STREAM) {
+    return Type::OUT_STREAM;  // If the left-hand side is an output stream, return it
+  }
+  has_bug = true;
+  Diagnostics() << constant::ErrorMessages::TypeCannotAssign(target, TypeToString(target_type), TypeToString(value))
+                << std::endl;
+  return target_type;  // Return the type of the left-hand side
+}
+
+auto AST::ASTNode::CheckIdentifier(const std::string &name, const std::shared_ptr<TypeEnvironment> &environment,
+                                   bool &has_bug) -> Type {
+  Type type = environment->GetType(name);
+  if (type == Type::UNDEFINED) {
+    has_bug = true;
+    Diagnostics() << constant::ErrorMessages::UseVariableBeforeDeclaration(name) << std::endl;
+    return Type::UNDEFINED;  // Return UNDEFINED if the variable is not found
+  }
+  return type;
+}
+
+auto AST::ASTNode::CheckTimes(Type left, Type right, bool &has_bug) -> Type {
+  if (left == Type::NUMBER && right == Type::NUMBER) {
+    return Type::NUMBER;
+  }
+  if (left == Type::NUMBER && right == Type::STRING) {
+    return Type::STRING;
+  }
+  if (left == Type::STRING && right == Type::NUMBER) {
+    return Type::STRING;
+  }
+  has_bug = true;
+  Diagnostics() << constant::ErrorMessages::TypeCannotTime(TypeToString(left), TypeToString(right)) << std::endl;
+  return Type::UNDEFINED;  // Return UNDEFINED if the types do not match
+}
+
+auto AST::ASTNode::CheckPlus(Type left, Type right, bool &has_bug) -> Type {
+  if (left == Type::NUMBER && right == Type::NUMBER) {
+    return Type::NUMBER;
+  }
+  if (left == Type::STRING && right == Type::STRING) {
+    return Type::STRING;
+  }
+  has_bug = true;
+  Diagnostics() << constant::ErrorMessages::TypeCannotAdd(TypeToString(left), TypeToString(right)) << std::endl;
+  return Type::UNDEFINED;  // Return UNDEFINED if the types do not match
+}
+
+auto AST::ASTNode::GenerateCode(const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) const -> std::string {
+  // The code of a node surrounds the code of its children, so it is appended to one string by a walk with an explicit
+  // stack: nested expressions neither overflow the call stack nor copy the code of their operands at every level.
+  // A node is visited once per stage, before, between and after its children.
+  struct Visit {
+    /* The node */
+    const ASTNode *node_;
+    /* The children visited so far */
+    int stage_;
+    /* Where the code of the node starts */
+    size_t start_;
+  };
+  std::string code;
+  std::vector<Visit> pending = {{this, 0, 0}};
+  while (!pending.empty()) {
+    Visit visit = pending.back();
+    pending.pop_back();
+    const ASTNode &node = *visit.node_;
+    const auto &children = node.children_;
+    switch (node.type_) {
+      case ASTNodeType::ROOT:
+        // First generate all code to collect string constants
+        if (visit.stage_ == 0) {
+          pending.push_back({&node, 1, code.size()});
+          for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            pending.push_back({child->get(), 0, 0});
+          }
+        } else {
+          std::string body = code.substr(visit.start_);
+          code.resize(visit.start_);
+          code += EmitProgram(body, runtime);
+        }
+        break;
+      case ASTNodeType::ASSIGN: {
+        const auto &target = children.front()->GetValue();
+        const auto &value = children.back();
+        bool is_output = target == "stdout";
+        // A read from stdin into a variable is emitted by the assignment, as it depends on the variable's type
+        if (visit.stage_ == 0 && (is_output || value->GetValue() != "stdin")) {
+          pending.push_back({&node, 1, 0});
+          pending.push_back({value.get(), 0, 0});
+          break;
+        }
+        std::string slot = is_output ? "" : std::to_string(runtime->GetStackAllocation(target));
+        Type value_type = is_output ? value->GetRuntimeType(runtime) : Type::UNDEFINED;
+        code += EmitAssign(target, value->GetValue(), "", value_type, slot, runtime);
+        break;
       }
-      if (type1 == Type::STRING && type2 == Type::STRING) {
-        return Type::STRING;
+      case ASTNodeType::NUMBER:
+        code += EmitNumber(node.value_);
+        break;
+      case ASTNodeType::STRING:
+        code += EmitString(node.value_, runtime);
+        break;
+      case ASTNodeType::PLUS:
+      case ASTNodeType::TIMES:
+        if (visit.stage_ < 2) {
+          if (visit.stage_ == 1) {
+            code += EmitPushOperand();
+          }
+          pending.push_back({&node, visit.stage_ + 1, 0});
+          pending.push_back({(visit.stage_ == 0 ? children.front() : children.back()).get(), 0, 0});
+        } else {
+          code += EmitOperation(node.type_, children.front()->GetRuntimeType(runtime),
+                                children.back()->GetRuntimeType(runtime), runtime);
+        }
+        break;
+      case ASTNodeType::IDENTIFIER: {
+        std::string slot = node.value_ == "stdin" ? "" : std::to_string(runtime->GetStackAllocation(node.value_));
+        code += EmitIdentifier(node.value_, slot, runtime);
+        break;
       }
-      has_bug = true;
-      std::cerr << constant::ErrorMessages::TypeCannotAdd(TypeToString(type1), TypeToString(type2)) << std::endl;
-      return Type::UNDEFINED;  // Return UNDEFINED if the types do not match
     }
-    case ASTNodeType::NUMBER:
-      return Type::NUMBER;
-    case ASTNodeType::STRING:
-      return Type::STRING;
   }
+  return code;
 }
 
-auto AST::ASTNode::GenerateCode(const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) const -> std::string {
+auto AST::ASTNode::GetBinaryRuntimeType(Type left, Type right) -> Type {
+  return left == Type::STRING || right == Type::STRING ? Type::STRING : Type::NUMBER;
+}
+
+auto AST::ASTNode::EmitProgram(const std::string &body, const std::shared_ptr<cgen::RuntimeEnvironment> &runtime)
+    -> std::string {
   std::stringstream code;
-  switch (type_) {
-    case ASTNodeType::ROOT: {
-      // First generate all code to collect string constants
-      std::stringstream temp_code;
-      for (const auto &child : children_) {
-        temp_code << child->GenerateCode(runtime);
-      }
 
-      // Generate data section
-      std::string data_section = runtime->GenerateDataSection();
-      if (!data_section.empty()) {
-        code << data_section << std::endl;
-      }
+  // Generate data section
+  std::string data_section = runtime->GenerateDataSection();
+  if (!data_section.empty()) {
+    code << data_section << std::endl;
+  }
 
-      code << ".text" << std::endl << ".globl main" << std::endl << "main:" << std::endl;
+  code << ".text" << std::endl << ".globl main" << std::endl << "main:" << std::endl;
 
-      // Initialize stack and frame pointer
-      int stack_size = runtime->GetStackSize();
-      if (stack_size > 0) {
-        code << "    addiu $sp, $sp, -" << (stack_size * 4) << std::endl;  // Allocate stack space for variables
-        code << "    move $fp, $sp" << std::endl;                          // Set frame pointer
-      }
+  // Initialize stack and frame pointer
+  int stack_size = runtime->GetStackSize();
+  if (stack_size > 0) {
+    code << "    addiu $sp, $sp, -" << (stack_size * 4) << std::endl;  // Allocate stack space for variables
+    code << "    move $fp, $sp" << std::endl;                          // Set frame pointer
+  }
 
-      code << temp_code.str();
+  code << body;
 
-      // Restore stack and exit
-      if (stack_size > 0) {
-        code << "    addiu $sp, $sp, " << (stack_size * 4) << std::endl;  // Restore stack pointer
-      }
-      // Add program exit code
-      code << "    li $v0, 10" << std::endl << "    syscall" << std::endl;
-      break;
+  // Restore stack and exit
+  if (stack_size > 0) {
+    code << "    addiu $sp, $sp, " << (stack_size * 4) << std::endl;  // Restore stack pointer
+  }
+  // Add program exit code
+  code << "    li $v0, 10" << std::endl << "    syscall" << std::endl;
+  return code.str();
+}
+
+auto AST::ASTNode::EmitAssign(const std::string &target, const std::string &value, const std::string &value_code,
+                              Type value_type, const std::string &slot,
+                              const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string {
+  std::stringstream code;
+  // Special handling for stdout output
+  if (target == "stdout") {
+    code << value_code;
+    // Check if it's a string type
+    if (value_type == Type::STRING && runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+      // Walk the rope and print its leaves
+      code << "    jal rope_print" << std::endl;
+    } else if (value_type == Type::STRING) {
+      // Print string system call
+      code << "    li $v0, 4" << std::endl;
+      code << "    syscall" << std::endl;
+    } else {
+      // Print integer system call
+      code << "    li $v0, 1" << std::endl;
+      code << "    syscall" << std::endl;
     }
-    case ASTNodeType::ASSIGN: {
-      auto child1 = children_.front();
-      auto child2 = children_.back();
-
-      // Special handling for stdout output
-      if (child1->GetValue() == "stdout") {
-        code << child2->GenerateCode(runtime);
-        // Check if it's a string type
-        Type expr_type = child2->GetRuntimeType(runtime);
-        if (expr_type == Type::STRING) {
-          // Print string system call
-          code << "    li $v0, 4" << std::endl;
-          code << "    syscall" << std::endl;
-        } else {
-          // Print integer system call
-          code << "    li $v0, 1" << std::endl;
-          code << "    syscall" << std::endl;
-        }
-      } else if (child2->GetValue() == "stdin") {
-        // Read from stdin and assign to variable
-        Type var_type = runtime->GetType(child1->GetValue());
-        if (var_type == Type::STRING) {
-          // Generate unique labels for this input operation
-          int input_id = runtime->GetUniqueInputId();
-
-          // Read string into temporary buffer
-          code << "    li $v0, 8" << std::endl;             // read string syscall
-          code << "    la $a0, input_buffer" << std::endl;  // temporary buffer address
-          code << "    li $a1, 256" << std::endl;           // max length
-          code << "    syscall" << std::endl;
-
-          // Calculate length of input string
-          code << "    la $t0, input_buffer" << std::endl;
-          code << "    move $t1, $t0" << std::endl;
-          code << "len_scan_assign" << input_id << ":" << std::endl;
-          code << "    lb $t2, 0($t1)" << std::endl;
-          code << "    beq $t2, $zero, len_done_assign" << input_id << std::endl;
-          code << "    addiu $t1, $t1, 1" << std::endl;
-          code << "    j len_scan_assign" << input_id << std::endl;
-          code << "len_done_assign" << input_id << ":" << std::endl;
-          code << "    subu $t3, $t1, $t0" << std::endl;  // length in $t3
-
-          // Allocate heap memory for string (length + 1 for null terminator)
-          code << "    addiu $a0, $t3, 1" << std::endl;  // length + 1
-          code << "    li $v0, 9" << std::endl;          // sbrk syscall to allocate memory
-          code << "    syscall" << std::endl;
-          code << "    move $t4, $v0" << std::endl;  // heap address in $t4
-
-          // Copy string from input_buffer to heap
-          code << "    move $t5, $t0" << std::endl;  // source pointer
-          code << "copy_loop_assign" << input_id << ":" << std::endl;
-          code << "    lb $t6, 0($t5)" << std::endl;
-          code << "    sb $t6, 0($t4)" << std::endl;
-          code << "    beq $t6, $zero, copy_done_assign" << input_id << std::endl;
-          code << "    addiu $t5, $t5, 1" << std::endl;
-          code << "    addiu $t4, $t4, 1" << std::endl;
-          code << "    j copy_loop_assign" << input_id << std::endl;
-          code << "copy_done_assign" << input_id << ":" << std::endl;
-
-          // Trim newline from heap-allocated string
-          code << "    subu $a0, $t4, $t3" << std::endl;       // reset to start of heap string
-          code << "    jal string_trim_newline" << std::endl;  // Call trim newline function
-          code << "    subu $a0, $t4, $t3" << std::endl;       // reload heap string address into $a0
-        } else {
-          // Read integer
-          code << "    li $v0, 5" << std::endl;  // read integer syscall
-          code << "    syscall" << std::endl;
-          code << "    move $a0, $v0" << std::endl;
-        }
-        code << "    sw $a0, " << runtime->GetStackAllocation(child1->GetValue()) << "($fp)" << std::endl;
-      } else {
-        // Normal assignment
-        code << child2->GenerateCode(runtime);
-        code << "    sw $a0, " << runtime->GetStackAllocation(child1->GetValue()) << "($fp)" << std::endl;
+    return code.str();
+  }
+  if (value == "stdin") {
+    // Read from stdin and assign to variable
+    Type var_type = runtime->GetType(target);
+    if (var_type == Type::STRING) {
+      // Generate unique labels for this input operation
+      int input_id = runtime->GetUniqueInputId();
+
+      // Read string into temporary buffer
+      code << "    li $v0, 8" << std::endl;             // read string syscall
+      code << "    la $a0, input_buffer" << std::endl;  // temporary buffer address
+      code << "    li $a1, 256" << std::endl;           // max length
+      code << "    syscall" << std::endl;
+
+      // Calculate length of input string
+      code << "    la $t0, input_buffer" << std::endl;
+      code << "    move $t1, $t0" << std::endl;
+      code << "len_scan_assign" << input_id << ":" << std::endl;
+      code << "    lb $t2, 0($t1)" << std::endl;
+      code << "    beq $t2, $zero, len_done_assign" << input_id << std::endl;
+      code << "    addiu $t1, $t1, 1" << std::endl;
+      code << "    j len_scan_assign" << input_id << std::endl;
+      code << "len_done_assign" << input_id << ":" << std::endl;
+      code << "    subu $t3, $t1, $t0" << std::endl;  // length in $t3
+
+      // Allocate heap memory for string (length + 1 for null terminator)
+      code << "    addiu $a0, $t3, 1" << std::endl;  // length + 1
+      code << "    li $v0, 9" << std::endl;          // sbrk syscall to allocate memory
+      code << "    syscall" << std::endl;
+      code << "    move $t4, $v0" << std::endl;  // heap address in $t4
+
+      // Copy string from input_buffer to heap
+      code << "    move $t5, $t0" << std::endl;  // source pointer
+      code << "copy_loop_assign" << input_id << ":" << std::endl;
+      code << "    lb $t6, 0($t5)" << std::endl;
+      code << "    sb $t6, 0($t4)" << std::endl;
+      code << "    beq $t6, $zero, copy_done_assign" << input_id << std::endl;
+      code << "    addiu $t5, $t5, 1" << std::endl;
+      code << "    addiu $t4, $t4, 1" << std::endl;
+      code << "    j copy_loop_assign" << input_id << std::endl;
+      code << "copy_done_assign" << input_id << ":" << std::endl;
+
+      // Trim newline from heap-allocated string
+      code << "    subu $a0, $t4, $t3" << std::endl;       // reset to start of heap string
+      code << "    jal string_trim_newline" << std::endl;  // Call trim newline function
+      code << "    subu $a0, $t4, $t3" << std::endl;       // reload heap string address into $a0
+      if (runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+        code << "    jal rope_leaf" << std::endl;  // Wrap the input in a rope leaf
       }
-      break;
+    } else {
+      // Read integer
+      code << "    li $v0, 5" << std::endl;  // read integer syscall
+      code << "    syscall" << std::endl;
+      code << "    move $a0, $v0" << std::endl;
     }
-    case ASTNodeType::NUMBER:
-      code << "    li $a0, " << value_ << std::endl;
-      break;
-    case ASTNodeType::STRING: {
-      std::string label = runtime->AddStringConstant(value_);
-      code << "    la $a0, " << label << std::endl;
-      break;
+  } else {
+    // Normal assignment
+    code << value_code;
+  }
+  code << "    sw $a0, " << slot << "($fp)" << std::endl;
+  return code.str();
+}
+
+auto AST::ASTNode::EmitNumber(const std::string &value) -> std::string { return "    li $a0, " + value + "\n"; }
+
+auto AST::ASTNode::EmitString(const std::string &literal, const std::shared_ptr<cgen::RuntimeEnvironment> &runtime)
+    -> std::string {
+  std::string label = runtime->AddStringConstant(literal);
+  if (runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+    label += "_rope";  // Rope leaf wrapping the constant
+  }
+  return "    la $a0, " + label + "\n";
+}
+
+auto AST::ASTNode::EmitBinary(ASTNodeType type, const std::string &left_code, Type left_type,
+                              const std::string &right_code, Type right_type,
+                              const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string {
+  return left_code + EmitPushOperand() + right_code + EmitOperation(type, left_type, right_type, runtime);
+}
+
+auto AST::ASTNode::EmitPushOperand() -> std::string {
+  // Push left operand onto stack (make space first, then store)
+  return "    addiu $sp, $sp, -4\n    sw $a0, 0($sp)\n";
+}
+
+auto AST::ASTNode::EmitOperation(ASTNodeType type, Type left_type, Type right_type,
+                                 const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string {
+  std::stringstream code;
+  if (type == ASTNodeType::PLUS && (left_type == Type::STRING || right_type == Type::STRING)) {
+    // String concatenation - call string concatenation function
+    code << "    lw $a1, 0($sp)" << std::endl;  // First string address
+    if (runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+      code << "    jal rope_concat" << std::endl;  // Build a concat node in O(1)
+    } else {
+      code << "    jal string_concat" << std::endl;  // Call concatenation function
     }
-    case ASTNodeType::PLUS: {
-      auto left_child = children_.front();
-      auto right_child = children_.back();
-
-      code << left_child->GenerateCode(runtime);
-      // Push left operand onto stack (make space first, then store)
-      code << "    addiu $sp, $sp, -4" << std::endl;
-      code << "    sw $a0, 0($sp)" << std::endl;
-      code << right_child->GenerateCode(runtime);
-
-      // Check if it's string concatenation
-      Type left_type = left_child->GetRuntimeType(runtime);
-      Type right_type = right_child->GetRuntimeType(runtime);
-
-      if (left_type == Type::STRING || right_type == Type::STRING) {
-        // String concatenation - call string concatenation function
-        code << "    lw $a1, 0($sp)" << std::endl;     // First string address
-        code << "    jal string_concat" << std::endl;  // Call concatenation function
-      } else {
-        // Numeric addition
-        code << "    lw $t1, 0($sp)" << std::endl;
-        code << "    add $a0, $t1, $a0" << std::endl;
-      }
-      code << "    addiu $sp, $sp, 4" << std::endl;
-      break;
+  } else if (type == ASTNodeType::PLUS) {
+    // Numeric addition
+    code << "    lw $t1, 0($sp)" << std::endl;
+    code << "    add $a0, $t1, $a0" << std::endl;
+  } else if (left_type == Type::STRING) {
+    // String repetition - call string repetition function
+    code << "    lw $a1, 0($sp)" << std::endl;  // String address
+    code << "    move $a2, $a0" << std::endl;   // Repetition count
+    if (runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+      code << "    jal rope_repeat" << std::endl;  // Build a repeat node in O(1)
+    } else {
+      code << "    jal string_repeat" << std::endl;  // Call repetition function
     }
-    case ASTNodeType::TIMES: {
-      auto left_child = children_.front();
-      auto right_child = children_.back();
-
-      code << left_child->GenerateCode(runtime);
-      // Push left operand onto stack (make space first, then store)
-      code << "    addiu $sp, $sp, -4" << std::endl;
-      code << "    sw $a0, 0($sp)" << std::endl;
-      code << right_child->GenerateCode(runtime);
-
-      // Check if it's string repetition
-      Type left_type = left_child->GetRuntimeType(runtime);
-
-      if (left_type == Type::STRING) {
-        // String repetition - call string repetition function
-        code << "    lw $a1, 0($sp)" << std::endl;     // String address
-        code << "    move $a2, $a0" << std::endl;      // Repetition count
-        code << "    jal string_repeat" << std::endl;  // Call repetition function
-      } else {
-        // Numeric multiplication
-        code << "    lw $t1, 0($sp)" << std::endl;
-        code << "    mul $a0, $t1, $a0" << std::endl;
-      }
-      code << "    addiu $sp, $sp, 4" << std::endl;
-      break;
+  } else {
+    // Numeric multiplication
+    code << "    lw $t1, 0($sp)" << std::endl;
+    code << "    mul $a0, $t1, $a0" << std::endl;
+  }
+  code << "    addiu $sp, $sp, 4" << std::endl;
+  return code.str();
+}
+
+auto AST::ASTNode::EmitIdentifier(const std::string &name, const std::string &slot,
+                                  const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) -> std::string {
+  if (name != "stdin") {
+    return "    lw $a0, " + slot + "($fp)\n";
+  }
+  std::stringstream code;
+  // Read from stdin
+  if (runtime->GetType(name) == core::Type::STRING) {
+    // Generate unique labels for this input operation
+    int input_id = runtime->GetUniqueInputId();
+
+    // Read string into temporary buffer
+    code << "    li $v0, 8" << std::endl;  // read string
+    code << "    la $a0, input_buffer" << std::endl;
+    code << "    li $a1, 256" << std::endl;
+    code << "    syscall" << std::endl;
+
+    // Calculate length of input string
+    code << "    la $t0, input_buffer" << std::endl;
+    code << "    move $t1, $t0" << std::endl;
+    code << "len_scan_ident" << input_id << ":" << std::endl;
+    code << "    lb $t2, 0($t1)" << std::endl;
+    code << "    beq $t2, $zero, len_done_ident" << input_id << std::endl;
+    code << "    addiu $t1, $t1, 1" << std::endl;
+    code << "    j len_scan_ident" << input_id << std::endl;
+    code << "len_done_ident" << input_id << ":" << std::endl;
+    code << "    subu $t3, $t1, $t0" << std::endl;  // length in $t3
+
+    // Allocate heap memory for string (length + 1 for null terminator)
+    code << "    addiu $a0, $t3, 1" << std::endl;  // length + 1
+    code << "    li $v0, 9" << std::endl;          // sbrk syscall to allocate memory
+    code << "    syscall" << std::endl;
+    code << "    move $t4, $v0" << std::endl;  // heap address in $t4
+
+    // Copy string from input_buffer to heap
+    code << "    move $t5, $t0" << std::endl;  // source pointer
+    code << "copy_loop_ident" << input_id << ":" << std::endl;
+    code << "    lb $t6, 0($t5)" << std::endl;
+    code << "    sb $t6, 0($t4)" << std::endl;
+    code << "    beq $t6, $zero, copy_done_ident" << input_id << std::endl;
+    code << "    addiu $t5, $t5, 1" << std::endl;
+    code << "    addiu $t4, $t4, 1" << std::endl;
+    code << "    j copy_loop_ident" << input_id << std::endl;
+    code << "copy_done_ident" << input_id << ":" << std::endl;
+
+    // Trim newline from heap-allocated string
+    code << "    subu $a0, $t4, $t3" << std::endl;       // reset to start of heap string
+    code << "    jal string_trim_newline" << std::endl;  // Call trim newline function
+    code << "    subu $a0, $t4, $t3" << std::endl;       // reload heap string address into $a0
+    if (runtime->GetStringRuntime() == cgen::StringRuntime::ROPE) {
+      code << "    jal rope_leaf" << std::endl;  // Wrap the input in a rope leaf
     }
-    case ASTNodeType::IDENTIFIER: {
-      if (value_ == "stdin") {
-        // Read from stdin
-        if (runtime->GetType(value_) == core::Type::STRING) {
-          // Generate unique labels for this input operation
-          int input_id = runtime->GetUniqueInputId();
-
-          // Read string into temporary buffer
-          code << "    li $v0, 8" << std::endl;  // read string
-          code << "    la $a0, input_buffer" << std::endl;
-          code << "    li $a1, 256" << std::endl;
-          code << "    syscall" << std::endl;
-
-          // Calculate length of input string
-          code << "    la $t0, input_buffer" << std::endl;
-          code << "    move $t1, $t0" << std::endl;
-          code << "len_scan_ident" << input_id << ":" << std::endl;
-          code << "    lb $t2, 0($t1)" << std::endl;
-          code << "    beq $t2, $zero, len_done_ident" << input_id << std::endl;
-          code << "    addiu $t1, $t1, 1" << std::endl;
-          code << "    j len_scan_ident" << input_id << std::endl;
-          code << "len_done_ident" << input_id << ":" << std::endl;
-          code << "    subu $t3, $t1, $t0" << std::endl;  // length in $t3
-
-          // Allocate heap memory for string (length + 1 for null terminator)
-          code << "    addiu $a0, $t3, 1" << std::endl;  // length + 1
-          code << "    li $v0, 9" << std::endl;          // sbrk syscall to allocate memory
-          code << "    syscall" << std::endl;
-          code << "    move $t4, $v0" << std::endl;  // heap address in $t4
-
-          // Copy string from input_buffer to heap
-          code << "    move $t5, $t0" << std::endl;  // source pointer
-          code << "copy_loop_ident" << input_id << ":" << std::endl;
-          code << "    lb $t6, 0($t5)" << std::endl;
-          code << "    sb $t6, 0($t4)" << std::endl;
-          code << "    beq $t6, $zero, copy_done_ident" << input_id << std::endl;
-          code << "    addiu $t5, $t5, 1" << std::endl;
-          code << "    addiu $t4, $t4, 1" << std::endl;
-          code << "    j copy_loop_ident" << input_id << std::endl;
-          code << "copy_done_ident" << input_id << ":" << std::endl;
-
-          // Trim newline from heap-allocated string
-          code << "    subu $a0, $t4, $t3" << std::endl;       // reset to start of heap string
-          code << "    jal string_trim_newline" << std::endl;  // Call trim newline function
-          code << "    subu $a0, $t4, $t3" << std::endl;       // reload heap string address into $a0
-        } else {
-          code << "    li $v0, 5" << std::endl;  // read integer
-          code << "    syscall" << std::endl;
-          code << "    move $a0, $v0" << std::endl;
+  } else {
+    code << "    li $v0, 5" << std::endl;  // read integer
+    code << "    syscall" << std::endl;
+    code << "    move $a0, $v0" << std::endl;
+  }
+  return code.str();
+}
+
+auto AST::ASTNode::IsStructurallyEqual(const ASTNode &other) const -> bool {
+  // An explicit stack, so comparing deeply nested expressions cannot overflow the call stack
+  std::vector<std::pair<const ASTNode *, const ASTNode *>> pending = {{this, &other}};
+  while (!pending.empty()) {
+    auto [left, right] = pending.back();
+    pending.pop_back();
+    if (left->type_ != right->type_ || left->value_ != right->value_ ||
+        left->children_.size() != right->children_.size()) {
+      return false;
+    }
+    auto right_child = right->children_.begin();
+    for (const auto &left_child : left->children_) {
+      if (!left_child || !*right_child) {
+        if (left_child != *right_child) {
+          return false;
         }
       } else {
-        code << "    lw $a0, " << runtime->GetStackAllocation(value_) << "($fp)" << std::endl;
+        pending.emplace_back(left_child.get(), right_child->get());
       }
-      break;
+      ++right_child;
     }
   }
-  return code.str();
+  return true;
 }
 
 auto AST::ASTNode::GetRuntimeType(const std::shared_ptr<cgen::RuntimeEnvironment> &runtime) const -> Type {
@@ -452,27 +608,40 @@ auto AST::ASTNode::GetRuntimeType(const std::shared_ptr<cgen::RuntimeEnvironment
         return Type::UNDEFINED;
       }
     case ASTNodeType::PLUS:
-    case ASTNodeType::TIMES: {
-      if (!children_.empty()) {
-        auto first_child_type = children_.front()->GetRuntimeType(runtime);
-        // If the first operand is a string, the entire expression is string type
-        if (first_child_type == Type::STRING) {
-          return Type::STRING;
-        }
-        // Otherwise check the second operand
-        if (children_.size() > 1) {
-          auto second_child_type = children_.back()->GetRuntimeType(runtime);
-          if (second_child_type == Type::STRING) {
-            return Type::STRING;
-          }
-        }
-        return Type::NUMBER;
-      }
-      return Type::UNDEFINED;
-    }
+    case ASTNodeType::TIMES:
+      break;
     default:
       return Type::UNDEFINED;
   }
+
+  // Resolve the + and * operands not yet resolved first, innermost first, with an explicit stack rather than recursion
+  auto is_unresolved = [](const std::shared_ptr<ASTNode> &node) {
+    return (node->type_ == ASTNodeType::PLUS || node->type_ == ASTNodeType::TIMES) &&
+           node->runtime_type_ == Type::UNDEFINED && !node->children_.empty();
+  };
+  std::vector<const ASTNode *> pending;
+  if (runtime_type_ == Type::UNDEFINED && !children_.empty()) {
+    pending.push_back(this);
+  }
+  while (!pending.empty()) {
+    const ASTNode *node = pending.back();
+    size_t unresolved = pending.size();
+    for (const auto &child : node->children_) {
+      if (is_unresolved(child)) {
+        pending.push_back(child.get());
+      }
+    }
+    if (pending.size() > unresolved) {
+      continue;
+    }
+    pending.pop_back();
+    // If the first operand is a string, the entire expression is string type, otherwise check the second operand
+    const auto &children = node->children_;
+    node->runtime_type_ = GetBinaryRuntimeType(
+        children.front()->GetRuntimeType(runtime),
+        children.size() > 1 ? children.back()->GetRuntimeType(runtime) : Type::UNDEFINED);
+  }
+  return runtime_type_;
 }
 
 }  // namespace scp::core
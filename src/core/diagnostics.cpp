@@ -0,0 +1,19 @@
+#include "core/diagnostics.h"
+
+#include <iostream>
+
+namespace scp::core {
+
+namespace {
+
+thread_local std::ostream *diagnostic_sink = nullptr;
+
+}  // namespace
+
+auto Diagnostics() -> std::ostream & { return diagnostic_sink != nullptr ? *diagnostic_sink : std::cerr; }
+
+DiagnosticCapture::DiagnosticCapture(std::ostream &sink) : previous_(diagnostic_sink) { diagnostic_sink = &sink; }
+
+DiagnosticCapture::~DiagnosticCapture() { diagnostic_sink = previous_; }
+
+}  // namespace scp::core
@@ -0,0 +1,244 @@
+#include "core/json.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace scp::core {
+
+auto JsonQuote(const std::string &text) -> std::string {
+  std::string quoted = "\"";
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        quoted += "\\\"";
+        break;
+      case '\\':
+        quoted += "\\\\";
+        break;
+      case '\n':
+        quoted += "\\n";
+        break;
+      case '\r':
+        quoted += "\\r";
+        break;
+      case '\t':
+        quoted += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escape[7];
+          std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned char>(c));
+          quoted += escape;
+        } else {
+          quoted += c;
+        }
+    }
+  }
+  return quoted + "\"";
+}
+
+/**
+ * Recursive descent reader of one JSON document.
+ */
+class JsonReader {
+ public:
+  /* Deepest nesting of arrays and objects, bounding the recursion */
+  static constexpr size_t MAX_DEPTH = 256;
+
+  /**
+   * Constructor for the JsonReader.
+   * @param text The document, which must outlive the reader.
+   */
+  explicit JsonReader(const std::string &text) : text_(text) {}
+
+  /**
+   * Read the whole document.
+   * @return The root value.
+   */
+  auto ReadDocument() -> JsonValue {
+    auto value = ReadValue(0);
+    SkipWhitespace();
+    if (position_ != text_.size()) {
+      Fail("unexpected trailing characters");
+    }
+    return value;
+  }
+
+ private:
+  /* The document */
+  const std::string &text_;
+  /* The position of the next character */
+  size_t position_{0};
+
+  [[noreturn]] void Fail(const std::string &reason) const {
+    throw std::runtime_error("JSON: " + reason + " at offset " + std::to_string(position_));
+  }
+
+  void SkipWhitespace() {
+    while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_])) != 0) {
+      position_++;
+    }
+  }
+
+  // Consume the next non-blank character if it is the expected one
+  auto Accept(char expected) -> bool {
+    SkipWhitespace();
+    if (position_ < text_.size() && text_[position_] == expected) {
+      position_++;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char expected) {
+    if (!Accept(expected)) {
+      Fail(std::string("expected '") + expected + "'");
+    }
+  }
+
+  // Consume a keyword such as true, the first character of which was already checked
+  void ExpectKeyword(const char *keyword) {
+    std::string word(keyword);
+    if (text_.compare(position_, word.size(), word) != 0) {
+      Fail("invalid literal");
+    }
+    position_ += word.size();
+  }
+
+  auto ReadValue(size_t depth) -> JsonValue {
+    if (depth > MAX_DEPTH) {
+      Fail("nesting too deep");
+    }
+    SkipWhitespace();
+    if (position_ >= text_.size()) {
+      Fail("unexpected end of document");
+    }
+    JsonValue value;
+    char c = text_[position_];
+    if (c == '{') {
+      position_++;
+      value.kind_ = JsonValue::Kind::OBJECT;
+      if (Accept('}')) {
+        return value;
+      }
+      do {
+        SkipWhitespace();
+        if (position_ >= text_.size() || text_[position_] != '"') {
+          Fail("expected a member name");
+        }
+        std::string key = ReadString();
+        Expect(':');
+        value.object_.emplace_back(std::move(key), ReadValue(depth + 1));
+      } while (Accept(','));
+      Expect('}');
+    } else if (c == '[') {
+      position_++;
+      value.kind_ = JsonValue::Kind::ARRAY;
+      if (Accept(']')) {
+        return value;
+      }
+      do {
+        value.array_.push_back(ReadValue(depth + 1));
+      } while (Accept(','));
+      Expect(']');
+    } else if (c == '"') {
+      value.kind_ = JsonValue::Kind::STRING;
+      value.string_ = ReadString();
+    } else if (c == 't' || c == 'f') {
+      ExpectKeyword(c == 't' ? "true" : "false");
+      value.kind_ = JsonValue::Kind::BOOLEAN;
+      value.boolean_ = c == 't';
+    } else if (c == 'n') {
+      ExpectKeyword("null");
+    } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)) != 0) {
+      const char *begin = text_.c_str() + position_;
+      char *end = nullptr;
+      value.kind_ = JsonValue::Kind::NUMBER;
+      value.number_ = std::strtod(begin, &end);
+      if (end == begin) {
+        Fail("invalid number");
+      }
+      position_ += static_cast<size_t>(end - begin);
+    } else {
+      Fail(std::string("unexpected character '") + c + "'");
+    }
+    return value;
+  }
+
+  // Read a string literal starting at its opening quote, decoding \u escapes to UTF-8
+  auto ReadString() -> std::string {
+    position_++;
+    std::string result;
+    while (position_ < text_.size() && text_[position_] != '"') {
+      char c = text_[position_++];
+      if (c != '\\') {
+        result += c;
+        continue;
+      }
+      if (position_ >= text_.size()) {
+        break;
+      }
+      char escape = text_[position_++];
+      switch (escape) {
+        case 'n':
+          result += '\n';
+          break;
+        case 'r':
+          result += '\r';
+          break;
+        case 't':
+          result += '\t';
+          break;
+        case 'b':
+          result += '\b';
+          break;
+        case 'f':
+          result += '\f';
+          break;
+        case 'u': {
+          if (position_ + 4 > text_.size()) {
+            Fail("truncated escape");
+          }
+          auto code = static_cast<unsigned>(std::strtoul(text_.substr(position_, 4).c_str(), nullptr, 16));
+          position_ += 4;
+          if (code < 0x80) {
+            result += static_cast<char>(code);
+          } else if (code < 0x800) {
+            result += static_cast<char>(0xC0 | (code >> 6));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+          } else {
+            result += static_cast<char>(0xE0 | (code >> 12));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+          }
+          break;
+        }
+        default:
+          result += escape;  // \" \\ and \/
+      }
+    }
+    if (position_ >= text_.size()) {
+      Fail("unterminated string");
+    }
+    position_++;
+    return result;
+  }
+};
+
+auto JsonValue::Parse(const std::string &text) -> JsonValue { return JsonReader(text).ReadDocument(); }
+
+auto JsonValue::Find(const std::string &key) const -> const JsonValue * {
+  for (const auto &[name, value] : object_) {
+    if (name == key) {
+      return &value;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace scp::core
@@ -0,0 +1,126 @@
+#include "core/trace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/diagnostics.h"
+#include "core/json.h"
+
+namespace scp::core {
+
+namespace {
+
+struct Event {
+  const char *name_;
+  std::string detail_;
+  std::chrono::steady_clock::time_point begin_;
+  std::chrono::steady_clock::time_point end_;
+  uint32_t thread_;
+};
+
+struct Recorder {
+  std::atomic<bool> enabled_{false};
+  std::mutex mutex_;
+  std::chrono::steady_clock::time_point origin_;
+  std::vector<Event> events_;
+};
+
+auto GetRecorder() -> Recorder & {
+  static Recorder recorder;
+  return recorder;
+}
+
+// Small sequential thread ids read better in a trace viewer than native ones
+auto GetThreadId() -> uint32_t {
+  static std::atomic<uint32_t> next_id{1};
+  thread_local uint32_t id = next_id++;
+  return id;
+}
+
+auto Micros(std::chrono::steady_clock::duration duration) -> double {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+}  // namespace
+
+void Trace::Start() {
+  auto &recorder = GetRecorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex_);
+  recorder.events_.clear();
+  recorder.origin_ = std::chrono::steady_clock::now();
+  recorder.enabled_ = true;
+}
+
+void Trace::Stop() { GetRecorder().enabled_ = false; }
+
+auto Trace::IsEnabled() -> bool { return GetRecorder().enabled_.load(std::memory_order_relaxed); }
+
+void Trace::Record(const char *name, const std::string &detail, std::chrono::steady_clock::time_point begin,
+                   std::chrono::steady_clock::time_point end) {
+  uint32_t thread = GetThreadId();
+  auto &recorder = GetRecorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex_);
+  recorder.events_.push_back({name, detail, begin, end, thread});
+}
+
+auto Trace::ToJson() -> std::string {
+  auto &recorder = GetRecorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex_);
+  std::stringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (size_t i = 0; i < recorder.events_.size(); ++i) {
+    const auto &event = recorder.events_[i];
+    out << (i == 0 ? "\n" : ",\n") << "{\"name\": " << JsonQuote(event.name_)
+        << ", \"cat\": \"scp\", \"ph\": \"X\", \"ts\": " << Micros(event.begin_ - recorder.origin_)
+        << ", \"dur\": " << Micros(event.end_ - event.begin_) << ", \"pid\": 1, \"tid\": " << event.thread_;
+    if (!event.detail_.empty()) {
+      out << ", \"args\": {\"detail\": " << JsonQuote(event.detail_) << "}";
+    }
+    out << "}";
+  }
+  out << "\n]}\n";
+  return out.str();
+}
+
+auto Trace::Write(const std::string &path) -> bool {
+  std::ofstream output(path);
+  if (!output.is_open()) {
+    return false;
+  }
+  output << ToJson();
+  return output.good();
+}
+
+TraceScope::TraceScope(const char *name, std::string detail) : name_(nullptr) {
+  if (Trace::IsEnabled()) {
+    name_ = name;
+    detail_ = std::move(detail);
+    begin_ = std::chrono::steady_clock::now();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (name_ != nullptr) {
+    Trace::Record(name_, detail_, begin_, std::chrono::steady_clock::now());
+  }
+}
+
+TraceSession::TraceSession(std::string path) : path_(std::move(path)) { Trace::Start(); }
+
+TraceSession::~TraceSession() {
+  Trace::Stop();
+  if (!Trace::Write(path_)) {
+    Diagnostics() << "Warning: Cannot write trace file: " << path_ << std::endl;
+  }
+}
+
+}  // namespace scp::core
@@ -3,23 +3,23 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace scp::core {
 
-void TypeEnvironment::SymbolTable::AddSymbol(const std::string &name, Type type) { symbol_stack_.push({name, type}); }
+void TypeEnvironment::SymbolTable::AddSymbol(const std::string &name, Type type) {
+  symbol_stack_.push({name, type});
+  symbol_index_[name].push_back(type);
+}
 
 auto TypeEnvironment::SymbolTable::FindSymbolByName(const std::string &name, Symbol &symbol) const -> bool {
-  std::stack<Symbol> temp_stack = symbol_stack_;
-
-  while (!temp_stack.empty()) {
-    if (temp_stack.top().name_ == name) {
-      symbol = temp_stack.top();
-      return true;
-    }
-    temp_stack.pop();
+  auto it = symbol_index_.find(name);
+  if (it == symbol_index_.end()) {
+    return false;
   }
-
-  return false;
+  symbol = {name, it->second.back()};
+  return true;
 }
 
 auto TypeToString(Type type) -> std::string {
@@ -55,6 +55,11 @@ auto TypeEnvironment::SymbolTable::PopSymbol() -> std::shared_ptr<Symbol> {
   }
   Symbol top_symbol = symbol_stack_.top();
   symbol_stack_.pop();
+  auto it = symbol_index_.find(top_symbol.name_);
+  it->second.pop_back();
+  if (it->second.empty()) {
+    symbol_index_.erase(it);
+  }
   return std::make_shared<Symbol>(top_symbol);
 }
 
@@ -0,0 +1,107 @@
+#include "driver/batch_compiler.h"
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/trace.h"
+#include "driver/compile.h"
+#include "driver/compiler.h"
+#include "driver/thread_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace scp::driver {
+
+BatchCompiler::BatchCompiler(cgen::CodeGeneratorOptions options, size_t jobs, CompilationCache *cache)
+    : options_(options), jobs_(jobs), compiler_(cache) {}
+
+auto BatchCompiler::Compile(const std::vector<std::string> &inputs, const std::string &output_dir)
+    -> std::vector<BatchResult> {
+  std::vector<BatchResult> results(inputs.size());
+  std::unordered_map<std::string, size_t> claimed_outputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    results[i].input_ = inputs[i];
+    results[i].output_ = GetOutputPath(inputs[i], output_dir);
+  }
+  if (!output_dir.empty()) {
+    std::error_code error;
+    fs::create_directories(output_dir, error);
+  }
+
+  ThreadPool pool(jobs_);
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto [claim, inserted] = claimed_outputs.emplace(results[i].output_, i);
+    if (!inserted) {
+      results[i].diagnostics_ = "Error: Output " + results[i].output_ + " is also produced by " +
+                                results[claim->second].input_ + "\n";
+      continue;
+    }
+    pool.Submit([this, &results, i](size_t /*worker*/) { CompileOne(results[i]); });
+  }
+  pool.Wait();
+  return results;
+}
+
+auto BatchCompiler::ReadResponseFile(const std::string &path) -> std::vector<std::string> {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Cannot open response file: " + path);
+  }
+  std::vector<std::string> inputs;
+  std::string line;
+  while (std::getline(file, line)) {
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#') {
+      continue;
+    }
+    auto end = line.find_last_not_of(" \t\r");
+    inputs.push_back(line.substr(begin, end - begin + 1));
+  }
+  return inputs;
+}
+
+auto BatchCompiler::GetOutputPath(const std::string &input, const std::string &output_dir) -> std::string {
+  fs::path path(input);
+  if (output_dir.empty()) {
+    return path.replace_extension(".s").string();
+  }
+  return (fs::path(output_dir) / path.stem()).string() + ".s";
+}
+
+void BatchCompiler::CompileOne(BatchResult &result) {
+  SCP_TRACE_SCOPE_DETAIL("CompileFile", result.input_);
+  std::string source;
+  try {
+    source = ReadSource(result.input_);
+  } catch (const std::exception &e) {
+    result.diagnostics_ = std::string("Error: ") + e.what() + "\n";
+    return;
+  }
+  if (source.empty()) {
+    result.diagnostics_ = std::string(EMPTY_INPUT_WARNING) + "\n";
+    result.success_ = true;
+    return;
+  }
+
+  auto compiled = compiler_.Compile(source, options_, fs::path(result.input_).stem().string());
+  result.cached_ = compiled.cached_;
+  result.diagnostics_ = compiled.diagnostics_;
+  if (!compiled.success_) {
+    return;
+  }
+
+  std::ofstream output(result.output_);
+  if (!output.is_open()) {
+    result.diagnostics_ += "Error: Cannot open output file: " + result.output_ + "\n";
+    return;
+  }
+  output << compiled.output_ << std::endl;
+  result.success_ = output.good();
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,35 @@
+#include "driver/checkpoint.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace scp::driver {
+
+auto Checkpoint::Serialize() const -> std::string {
+  std::ostringstream out;
+  out << MAGIC << "\n";
+  out << "offset " << offset_ << "\n";
+  out << "line " << line_ << "\n";
+  out << unit_.Serialize();
+  return out.str();
+}
+
+auto Checkpoint::Deserialize(const std::string &bytes) -> Checkpoint {
+  std::istringstream in(bytes);
+  std::string line;
+  if (!std::getline(in, line) || line != MAGIC) {
+    throw std::runtime_error("Not a checkpoint of this compiler version.");
+  }
+  Checkpoint checkpoint;
+  std::string field;
+  if (!(in >> field >> checkpoint.offset_) || field != "offset" || !(in >> field >> checkpoint.line_) ||
+      field != "line") {
+    throw std::runtime_error("Malformed checkpoint: bad header.");
+  }
+  in.ignore(1);  // The newline
+  checkpoint.unit_ = cgen::ObjectUnit::Deserialize(bytes.substr(static_cast<size_t>(in.tellg())));
+  return checkpoint;
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,328 @@
+#include "driver/compilation_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace scp::driver {
+
+namespace {
+
+// SHA-256 (FIPS 180-4), so a key identifies its material beyond accidental or crafted collisions
+auto Sha256(const std::string &data) -> std::array<uint32_t, 8> {
+  static constexpr std::array<uint32_t, 64> ROUND_CONSTANTS = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+  std::array<uint32_t, 8> hash = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  auto rotate = [](uint32_t value, int bits) { return (value >> bits) | (value << (32 - bits)); };
+
+  // Pad with a one bit, zeros and the bit length to a multiple of 64 bytes
+  std::string message = data;
+  message += static_cast<char>(0x80);
+  while (message.size() % 64 != 56) {
+    message += '\0';
+  }
+  uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    message += static_cast<char>((bits >> shift) & 0xFF);
+  }
+
+  std::array<uint32_t, 64> schedule{};
+  for (size_t block = 0; block < message.size(); block += 64) {
+    for (size_t i = 0; i < 16; i++) {
+      schedule[i] = 0;
+      for (size_t j = 0; j < 4; j++) {
+        schedule[i] = (schedule[i] << 8) | static_cast<unsigned char>(message[block + i * 4 + j]);
+      }
+    }
+    for (size_t i = 16; i < 64; i++) {
+      uint32_t s0 = rotate(schedule[i - 15], 7) ^ rotate(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+      uint32_t s1 = rotate(schedule[i - 2], 17) ^ rotate(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+      schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+    auto [a, b, c, d, e, f, g, h] = hash;
+    for (size_t i = 0; i < 64; i++) {
+      uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + ROUND_CONSTANTS[i] +
+                    schedule[i];
+      uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    std::array<uint32_t, 8> rounds = {a, b, c, d, e, f, g, h};
+    for (size_t i = 0; i < 8; i++) {
+      hash[i] += rounds[i];
+    }
+  }
+  return hash;
+}
+
+// Write a file under a unique temporary name next to its final path, returns an empty path on failure
+auto WriteTemporary(const fs::path &path, const std::string &content) -> fs::path {
+  std::random_device device;
+  fs::path temporary = path;
+  temporary += ".tmp" + std::to_string(device());
+  std::ofstream output(temporary, std::ios::binary);
+  if (!output.is_open()) {
+    return {};
+  }
+  output << content;
+  output.close();
+  if (!output) {
+    std::error_code error;
+    fs::remove(temporary, error);
+    return {};
+  }
+  return temporary;
+}
+
+// Rename a temporary file into place
+auto Publish(const fs::path &temporary, const fs::path &path) -> bool {
+  std::error_code error;
+  fs::rename(temporary, path, error);
+  if (error) {
+    fs::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+// Write a file under a unique temporary name and rename it into place
+void WriteAtomically(const fs::path &path, const std::string &content) {
+  fs::path temporary = WriteTemporary(path, content);
+  if (!temporary.empty()) {
+    Publish(temporary, path);
+  }
+}
+
+auto ReadWhole(const fs::path &path, std::string &content) -> bool {
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  content = buffer.str();
+  return true;
+}
+
+// The stats file holds the hits, misses and total entry size; the size is absent in files of older compilers
+auto ReadStatsFile(const fs::path &path, CacheStats &stats) -> bool {
+  std::string content;
+  if (!ReadWhole(path, content)) {
+    return false;
+  }
+  std::istringstream stream(content);
+  stream >> stats.hits_ >> stats.misses_;
+  return static_cast<bool>(stream >> stats.bytes_);
+}
+
+}  // namespace
+
+CompilationCache::CompilationCache(fs::path directory, uint64_t max_bytes)
+    : directory_(std::move(directory)), max_bytes_(max_bytes) {}
+
+CompilationCache::~CompilationCache() { Flush(); }
+
+auto CompilationCache::MakeKey(const std::string &source, const std::string &compiler, const std::string &options)
+    -> std::string {
+  // Length prefixes keep the fields from running into each other
+  std::string material = std::to_string(source.size()) + ":" + source + std::to_string(compiler.size()) + ":" +
+                         compiler + std::to_string(options.size()) + ":" + options;
+  std::stringstream key;
+  key << std::hex << std::setfill('0');
+  for (uint32_t word : Sha256(material)) {
+    key << std::setw(8) << word;
+  }
+  return key.str();
+}
+
+auto CompilationCache::DescribeOptions(const cgen::CodeGeneratorOptions &options) -> std::string {
+  return std::string("peephole=") + (options.apply_peephole_rules_ ? "1" : "0") +
+         " rle=" + (options.eliminate_redundant_loads_ ? "1" : "0") +
+         " sched=" + (options.schedule_instructions_ ? "1" : "0") +
+         " noreorder=" + (options.fill_delay_slots_ ? "1" : "0") +
+         " strings=" + (options.string_runtime_ == cgen::StringRuntime::ROPE ? "rope" : "flat");
+}
+
+auto CompilationCache::GetCompilerIdentity() -> std::string {
+  std::string identity = SCP_VERSION;
+  std::error_code error;
+  fs::path executable = fs::read_symlink("/proc/self/exe", error);
+  if (!error) {
+    auto size = fs::file_size(executable, error);
+    auto time = fs::last_write_time(executable, error);
+    if (!error) {
+      return identity + "/" + std::to_string(size) + "/" + std::to_string(time.time_since_epoch().count());
+    }
+  }
+  // Without a way to find the executable, tell builds apart by when this unit was compiled
+  return identity + "/" + __DATE__ + " " + __TIME__;
+}
+
+auto CompilationCache::GetDefaultDirectory() -> fs::path {
+  if (const char *dir = std::getenv("SCP_CACHE_DIR"); dir != nullptr && *dir != '\0') {
+    return dir;
+  }
+  if (const char *dir = std::getenv("XDG_CACHE_HOME"); dir != nullptr && *dir != '\0') {
+    return fs::path(dir) / "scp";
+  }
+  if (const char *dir = std::getenv("HOME"); dir != nullptr && *dir != '\0') {
+    return fs::path(dir) / ".cache" / "scp";
+  }
+  return {};
+}
+
+auto CompilationCache::Lookup(const std::string &key, std::string &artifact) -> bool {
+  fs::path path = EntryPath(key);
+  if (!ReadWhole(path, artifact)) {
+    pending_misses_++;
+    return false;
+  }
+  // Refresh the entry for LRU eviction
+  std::error_code error;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+  pending_hits_++;
+  return true;
+}
+
+void CompilationCache::Store(const std::string &key, const std::string &artifact) {
+  fs::path path = EntryPath(key);
+  std::error_code error;
+  fs::create_directories(path.parent_path(), error);
+  if (error) {
+    return;
+  }
+  fs::path temporary = WriteTemporary(path, artifact);
+  if (temporary.empty()) {
+    return;
+  }
+
+  // Replacing an entry, as workers compiling the same source do, only changes the size by the difference
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto replaced = fs::file_size(path, error);
+  if (error) {
+    replaced = 0;
+  }
+  if (!Publish(temporary, path)) {
+    return;
+  }
+  if (!size_known_) {
+    CacheStats stats;
+    size_known_ = ReadStatsFile(directory_ / "stats", stats);
+    known_bytes_ = stats.bytes_;
+  }
+  pending_bytes_ += static_cast<int64_t>(artifact.size()) - static_cast<int64_t>(replaced);
+  if (!size_known_ || static_cast<int64_t>(known_bytes_) + pending_bytes_ > static_cast<int64_t>(max_bytes_)) {
+    Evict();
+  }
+}
+
+void CompilationCache::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t hits = pending_hits_.exchange(0);
+  uint64_t misses = pending_misses_.exchange(0);
+  if (hits == 0 && misses == 0 && pending_bytes_ == 0 && !size_scanned_) {
+    return;
+  }
+  std::error_code error;
+  fs::create_directories(directory_, error);
+  if (error) {
+    return;
+  }
+  // Counters from concurrent processes may occasionally be lost; the entries themselves never are
+  CacheStats stats;
+  bool has_size = ReadStatsFile(directory_ / "stats", stats);
+  std::string content = std::to_string(stats.hits_ + hits) + " " + std::to_string(stats.misses_ + misses);
+  // Without a recorded or scanned size, leave it to the next store to scan
+  if (has_size || size_scanned_) {
+    int64_t bytes = static_cast<int64_t>(size_scanned_ ? known_bytes_ : stats.bytes_) + pending_bytes_;
+    known_bytes_ = static_cast<uint64_t>(std::max<int64_t>(bytes, 0));
+    size_known_ = true;
+    content += " " + std::to_string(known_bytes_);
+  }
+  size_scanned_ = false;
+  pending_bytes_ = 0;
+  WriteAtomically(directory_ / "stats", content + "\n");
+}
+
+auto CompilationCache::GetStats() const -> CacheStats {
+  CacheStats stats;
+  ReadStatsFile(directory_ / "stats", stats);
+  stats.hits_ += pending_hits_.load();
+  stats.misses_ += pending_misses_.load();
+  stats.bytes_ = 0;
+  std::error_code error;
+  for (fs::recursive_directory_iterator it(directory_, error), end; !error && it != end; it.increment(error)) {
+    if (it->is_regular_file(error) && it->path().extension() == ".s") {
+      stats.entries_++;
+      stats.bytes_ += it->file_size(error);
+    }
+  }
+  return stats;
+}
+
+auto CompilationCache::EntryPath(const std::string &key) const -> fs::path {
+  return directory_ / key.substr(0, 2) / (key + ".s");
+}
+
+void CompilationCache::Evict() {
+  struct Entry {
+    fs::path path_;
+    fs::file_time_type time_;
+    uint64_t bytes_;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  std::error_code error;
+  for (fs::recursive_directory_iterator it(directory_, error), end; !error && it != end; it.increment(error)) {
+    if (it->is_regular_file(error) && it->path().extension() == ".s") {
+      Entry entry{it->path(), it->last_write_time(error), it->file_size(error)};
+      total += entry.bytes_;
+      entries.push_back(std::move(entry));
+    }
+  }
+  size_known_ = true;
+  size_scanned_ = true;
+  pending_bytes_ = 0;
+  if (total <= max_bytes_) {
+    known_bytes_ = total;
+    return;
+  }
+
+  uint64_t target = max_bytes_ - max_bytes_ / 10;
+  std::sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs) { return lhs.time_ < rhs.time_; });
+  for (const auto &entry : entries) {
+    if (total <= target) {
+      break;
+    }
+    if (fs::remove(entry.path_, error)) {
+      total -= entry.bytes_;
+    }
+  }
+  known_bytes_ = total;
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,196 @@
+#include "driver/compile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "cgen/linker.h"
+#include "cgen/one_pass_compiler.h"
+#include "cgen/streaming_code_generator.h"
+#include "constant/error_messages.h"
+#include "core/diagnostics.h"
+#include "core/trace.h"
+#include "semant/type_checker.h"
+
+namespace scp::driver {
+
+auto ReadSource(const std::string &path) -> std::string {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Cannot open file: " + path);
+  }
+  std::string content;
+  std::string line;
+  while (std::getline(file, line)) {
+    content += line + "\n";
+  }
+  return content;
+}
+
+auto CompileSource(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                   const cgen::CodeGeneratorOptions &options, CompilationCache *cache) -> CompileResult {
+  SCP_TRACE_SCOPE_DETAIL("Compile", name);
+  CompileResult result;
+  std::ostringstream diagnostics;
+  core::DiagnosticCapture capture(diagnostics);
+  try {
+    std::string cache_key;
+    if (cache != nullptr) {
+      cache_key = CompilationCache::MakeKey(source, CompilationCache::GetCompilerIdentity(),
+                                            CompilationCache::DescribeOptions(options));
+      result.cached_ = cache->Lookup(cache_key, result.output_);
+    }
+
+    if (!result.cached_ && options.one_pass_) {
+      parser.SetProgramName(name);
+      parser.SetInput(source);
+      cgen::OnePassCompiler one_pass(options);
+      if (!parser.ParseWithActions(one_pass)) {
+        throw std::runtime_error("Failed to parse the input file.");
+      }
+      result.output_ = one_pass.Finish();
+      if (cache != nullptr) {
+        cache->Store(cache_key, result.output_);
+      }
+    } else if (!result.cached_) {
+      parser.SetProgramName(name);
+      parser.SetInput(source);
+      auto ast = parser.Parse();
+      if (!ast) {
+        throw std::runtime_error("Failed to parse the input file.");
+      }
+      semant::TypeChecker type_checker(ast);
+      auto type_environment = type_checker.CheckType();
+      cgen::CodeGenerator code_generator(ast, type_environment, options);
+      result.output_ = code_generator.GenerateCode();
+      if (cache != nullptr) {
+        cache->Store(cache_key, result.output_);
+      }
+    }
+    result.success_ = true;
+  } catch (const std::exception &e) {
+    diagnostics << "Error: " << e.what() << std::endl;
+  }
+  result.diagnostics_ = diagnostics.str();
+  return result;
+}
+
+auto CompileStream(parser::SLRParser &parser, const std::string &name, std::istream &input, std::ostream &output,
+                   const cgen::CodeGeneratorOptions &options) -> CompileResult {
+  SCP_TRACE_SCOPE_DETAIL("CompileStream", name);
+  CompileResult result;
+  std::ostringstream diagnostics;
+  core::DiagnosticCapture capture(diagnostics);
+  try {
+    parser.SetProgramName(name);
+    semant::TypeChecker type_checker;
+    cgen::StreamingCodeGenerator code_generator(output, options);
+    bool has_bug = false;
+    bool parsed = parser.ParseStatements(input, [&](const std::shared_ptr<core::AST::ASTNode> &statement) {
+      if (!type_checker.CheckStatement(statement)) {
+        has_bug = true;
+      } else if (!has_bug) {
+        code_generator.AddStatement(statement, type_checker.GetTypeEnvironment());
+      }
+      return true;
+    });
+    if (!parsed) {
+      throw std::runtime_error("Failed to parse the input file.");
+    }
+    if (has_bug) {
+      throw std::runtime_error(constant::ErrorMessages::TYPE_CHECK_FAILED);
+    }
+    code_generator.Finish();
+    result.success_ = true;
+  } catch (const std::exception &e) {
+    diagnostics << "Error: " << e.what() << std::endl;
+  }
+  result.diagnostics_ = diagnostics.str();
+  return result;
+}
+
+auto CompileUnit(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                 const cgen::ObjectUnit::Symbols &environment, const cgen::CodeGeneratorOptions &options,
+                 cgen::ObjectUnit &unit) -> CompileResult {
+  SCP_TRACE_SCOPE_DETAIL("CompileUnit", name);
+  CompileResult result;
+  std::ostringstream diagnostics;
+  core::DiagnosticCapture capture(diagnostics);
+  try {
+    parser.SetProgramName(name);
+    parser.SetInput(source);
+    cgen::OnePassCompiler one_pass(options);
+    one_pass.Import(environment);
+    if (!parser.ParseWithActions(one_pass)) {
+      throw std::runtime_error("Failed to parse the input file.");
+    }
+    unit = one_pass.FinishUnit();
+    unit.key_ = GetUnitKey(source, options);
+    result.success_ = true;
+  } catch (const std::exception &e) {
+    diagnostics << "Error: " << e.what() << std::endl;
+  }
+  result.diagnostics_ = diagnostics.str();
+  return result;
+}
+
+auto GetUnitKey(const std::string &source, const cgen::CodeGeneratorOptions &options) -> std::string {
+  // Optimization runs at link time, so only the string runtime shapes a unit
+  return CompilationCache::MakeKey(
+      source, CompilationCache::GetCompilerIdentity(),
+      std::string("unit strings=") + (options.string_runtime_ == cgen::StringRuntime::ROPE ? "rope" : "flat"));
+}
+
+auto CompileIncremental(parser::SLRParser &parser, const std::string &name, const std::string &source,
+                        const cgen::CodeGeneratorOptions &options, Checkpoint &checkpoint) -> CompileResult {
+  SCP_TRACE_SCOPE_DETAIL("CompileIncremental", name);
+  CompileResult result;
+  std::ostringstream diagnostics;
+  core::DiagnosticCapture capture(diagnostics);
+  try {
+    Checkpoint empty;
+    empty.unit_.string_runtime_ = options.string_runtime_;
+    bool resume = checkpoint.offset_ <= source.size() &&
+                  checkpoint.unit_.key_ == GetUnitKey(source.substr(0, checkpoint.offset_), options);
+    const Checkpoint &start = resume ? checkpoint : empty;
+    result.reused_bytes_ = start.offset_;
+
+    std::string appended = source.substr(start.offset_);
+    parser.SetProgramName(name);
+    parser.SetInput(appended, start.line_);
+    cgen::OnePassCompiler one_pass(options);
+    one_pass.Import(start.unit_.exports_);
+    if (!parser.ParseWithActions(one_pass)) {
+      throw std::runtime_error("Failed to parse the input file.");
+    }
+    cgen::Linker linker(options);
+    linker.AddUnit(name, start.unit_);
+    linker.AddUnit(name, one_pass.FinishUnit());
+    result.output_ = linker.Link();
+    result.success_ = true;
+
+    // Only blanks follow the last semicolon; a statement on an unfinished line is compiled again next time
+    size_t last = appended.rfind(';');
+    size_t end = last == std::string::npos ? std::string::npos : appended.find('\n', last);
+    if (end != std::string::npos) {
+      Checkpoint next;
+      next.offset_ = start.offset_ + end + 1;
+      next.line_ = start.line_ + static_cast<int>(std::count(appended.begin(), appended.begin() + end + 1, '\n'));
+      next.unit_ = linker.Merge();
+      next.unit_.key_ = GetUnitKey(source.substr(0, next.offset_), options);
+      checkpoint = std::move(next);
+    }
+  } catch (const std::exception &e) {
+    diagnostics << "Error: " << e.what() << std::endl;
+  }
+  result.diagnostics_ = diagnostics.str();
+  return result;
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,174 @@
+#include "driver/compile_report.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/json.h"
+#include "core/trace.h"
+#include "driver/memory_accounting.h"
+
+namespace scp::driver {
+
+namespace {
+
+// Statistics in report order
+auto ListStats(const CompileStats &stats) -> std::vector<std::pair<std::string, size_t>> {
+  return {{"tokens", stats.tokens_},
+          {"parse_tree_nodes", stats.parse_tree_nodes_},
+          {"ast_nodes", stats.ast_nodes_},
+          {"symbols", stats.symbols_},
+          {"string_literal_bytes", stats.string_literal_bytes_},
+          {"instructions", stats.instructions_},
+          {"data_bytes", stats.data_bytes_}};
+}
+
+}  // namespace
+
+void CompileReport::AddPhase(PhaseTime phase) { phases_.push_back(std::move(phase)); }
+
+void CompileReport::CountAST(const core::AST &ast) {
+  std::vector<const core::AST::ASTNode *> stack;
+  if (ast.GetRoot()) {
+    stack.push_back(ast.GetRoot().get());
+  }
+  while (!stack.empty()) {
+    const auto *node = stack.back();
+    stack.pop_back();
+    stats_.ast_nodes_++;
+    if (node->GetType() == core::ASTNodeType::STRING && node->GetValue().size() >= 2) {
+      stats_.string_literal_bytes_ += node->GetValue().size() - 2;
+    }
+    for (const auto &child : node->GetChildren()) {
+      stack.push_back(child.get());
+    }
+  }
+}
+
+auto CompileReport::FormatTimes() const -> std::string {
+  std::stringstream out;
+  out << std::left << std::setw(14) << "phase" << std::right << std::setw(12) << "wall ms" << std::setw(12)
+      << "cpu ms" << "\n";
+  out << std::fixed << std::setprecision(3);
+  PhaseTime total{"total"};
+  for (const auto &phase : phases_) {
+    out << std::left << std::setw(14) << phase.name_ << std::right << std::setw(12) << phase.wall_seconds_ * 1000
+        << std::setw(12) << phase.cpu_seconds_ * 1000 << "\n";
+    total.wall_seconds_ += phase.wall_seconds_;
+    total.cpu_seconds_ += phase.cpu_seconds_;
+  }
+  out << std::left << std::setw(14) << total.name_ << std::right << std::setw(12) << total.wall_seconds_ * 1000
+      << std::setw(12) << total.cpu_seconds_ * 1000 << "\n";
+  return out.str();
+}
+
+auto CompileReport::FormatMemory() const -> std::string {
+  std::stringstream out;
+  if (!MemoryAccounting::IsEnabled()) {
+    out << "allocations are counted in builds configured with -DSCP_ENABLE_MEMORY_ACCOUNTING=ON\n";
+    out << std::left << std::setw(14) << "peak RSS" << std::right << std::setw(40) << peak_rss_bytes_ << "\n";
+    return out.str();
+  }
+  out << std::left << std::setw(14) << "phase" << std::right << std::setw(12) << "allocs" << std::setw(14) << "bytes"
+      << std::setw(14) << "peak bytes" << "\n";
+  PhaseTime total{"total"};
+  for (const auto &phase : phases_) {
+    out << std::left << std::setw(14) << phase.name_ << std::right << std::setw(12) << phase.allocations_
+        << std::setw(14) << phase.allocated_bytes_ << std::setw(14) << phase.peak_bytes_ << "\n";
+    total.allocations_ += phase.allocations_;
+    total.allocated_bytes_ += phase.allocated_bytes_;
+    total.peak_bytes_ = std::max(total.peak_bytes_, phase.peak_bytes_);
+  }
+  out << std::left << std::setw(14) << total.name_ << std::right << std::setw(12) << total.allocations_
+      << std::setw(14) << total.allocated_bytes_ << std::setw(14) << total.peak_bytes_ << "\n";
+  out << std::left << std::setw(14) << "peak RSS" << std::right << std::setw(40) << peak_rss_bytes_ << "\n";
+  return out.str();
+}
+
+auto CompileReport::FormatStats() const -> std::string {
+  std::stringstream out;
+  for (const auto &[name, value] : ListStats(stats_)) {
+    std::string label = name;
+    for (auto &c : label) {
+      c = c == '_' ? ' ' : c;
+    }
+    out << std::left << std::setw(22) << label << value << "\n";
+  }
+  return out.str();
+}
+
+auto CompileReport::FormatJson(bool times, bool memory, bool stats) const -> std::string {
+  std::stringstream out;
+  out << "{";
+  if (times || memory) {
+    out << "\"phases\": [";
+    for (size_t i = 0; i < phases_.size(); ++i) {
+      const auto &phase = phases_[i];
+      out << (i == 0 ? "" : ", ") << "{\"name\": " << core::JsonQuote(phase.name_);
+      if (times) {
+        out << ", \"wall_ms\": " << phase.wall_seconds_ * 1000 << ", \"cpu_ms\": " << phase.cpu_seconds_ * 1000;
+      }
+      if (memory && MemoryAccounting::IsEnabled()) {
+        out << ", \"allocations\": " << phase.allocations_ << ", \"allocated_bytes\": " << phase.allocated_bytes_
+            << ", \"peak_bytes\": " << phase.peak_bytes_;
+      }
+      out << "}";
+    }
+    out << "]";
+  }
+  if (memory) {
+    out << ", \"peak_rss_bytes\": " << peak_rss_bytes_;
+  }
+  if (stats) {
+    out << (times || memory ? ", " : "") << "\"stats\": {";
+    bool first = true;
+    for (const auto &[name, value] : ListStats(stats_)) {
+      out << (first ? "" : ", ") << core::JsonQuote(name) << ": " << value;
+      first = false;
+    }
+    out << "}";
+  }
+  out << "}\n";
+  return out.str();
+}
+
+PhaseTimer::PhaseTimer(CompileReport *report, const char *name)
+    : report_(report),
+      name_(name),
+      tracing_(core::Trace::IsEnabled()),
+      wall_start_(std::chrono::steady_clock::now()),
+      cpu_start_(std::clock()) {
+  if (report_ != nullptr && MemoryAccounting::IsEnabled()) {
+    allocations_start_ = MemoryAccounting::GetAllocationCount();
+    allocated_bytes_start_ = MemoryAccounting::GetAllocatedBytes();
+    MemoryAccounting::ResetPeak();
+  }
+}
+
+void PhaseTimer::Stop() {
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+  auto wall_end = std::chrono::steady_clock::now();
+  if (tracing_) {
+    core::Trace::Record(name_, {}, wall_start_, wall_end);
+  }
+  if (report_ == nullptr) {
+    return;
+  }
+  std::chrono::duration<double> wall = wall_end - wall_start_;
+  double cpu = static_cast<double>(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+  PhaseTime phase{name_, wall.count(), cpu};
+  if (MemoryAccounting::IsEnabled()) {
+    phase.allocations_ = MemoryAccounting::GetAllocationCount() - allocations_start_;
+    phase.allocated_bytes_ = MemoryAccounting::GetAllocatedBytes() - allocated_bytes_start_;
+    phase.peak_bytes_ = MemoryAccounting::GetPeakBytes();
+  }
+  report_->AddPhase(phase);
+}
+
+}  // namespace scp::driver
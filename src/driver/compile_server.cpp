@@ -0,0 +1,471 @@
+#include "driver/compile_server.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "driver/thread_pool.h"
+
+namespace scp::driver {
+
+namespace {
+
+// Frames larger than this are rejected rather than allocated
+constexpr uint32_t MAX_FRAME_BYTES = 64U << 20;
+
+// Writes use send with MSG_NOSIGNAL so a client hanging up cannot kill the server with SIGPIPE
+auto WriteAll(int fd, const char *data, size_t size) -> bool {
+  while (size > 0) {
+    ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+auto ReadAll(int fd, char *data, size_t size) -> bool {
+  while (size > 0) {
+    ssize_t count = ::read(fd, data, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    data += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+void AppendLength(std::string &out, uint32_t length) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out += static_cast<char>((length >> shift) & 0xFF);
+  }
+}
+
+auto DecodeLength(const char *bytes) -> uint32_t {
+  uint32_t length = 0;
+  for (int i = 0; i < 4; ++i) {
+    length = (length << 8) | static_cast<unsigned char>(bytes[i]);
+  }
+  return length;
+}
+
+// A frame is a big-endian length followed by length-prefixed fields
+auto SendFrame(int fd, const std::vector<std::string> &fields) -> bool {
+  std::string payload;
+  for (const auto &field : fields) {
+    AppendLength(payload, static_cast<uint32_t>(field.size()));
+    payload += field;
+  }
+  std::string frame;
+  AppendLength(frame, static_cast<uint32_t>(payload.size()));
+  frame += payload;
+  return WriteAll(fd, frame.data(), frame.size());
+}
+
+// Split the payload of a frame into its length-prefixed fields
+auto DecodeFields(const std::string &payload, std::vector<std::string> &fields) -> bool {
+  fields.clear();
+  for (size_t pos = 0; pos < payload.size();) {
+    if (payload.size() - pos < 4) {
+      return false;
+    }
+    uint32_t length = DecodeLength(payload.data() + pos);
+    pos += 4;
+    if (payload.size() - pos < length) {
+      return false;
+    }
+    fields.push_back(payload.substr(pos, length));
+    pos += length;
+  }
+  return true;
+}
+
+auto ReceiveFrame(int fd, std::vector<std::string> &fields) -> bool {
+  char header[4];
+  if (!ReadAll(fd, header, sizeof(header))) {
+    return false;
+  }
+  uint32_t size = DecodeLength(header);
+  if (size > MAX_FRAME_BYTES) {
+    return false;
+  }
+  std::string payload(size, '\0');
+  return ReadAll(fd, payload.data(), size) && DecodeFields(payload, fields);
+}
+
+/**
+ * Enum class for the outcome of taking a frame off the bytes a connection has received.
+ */
+enum class FrameStatus { COMPLETE, INCOMPLETE, MALFORMED };
+
+// Take the first whole frame off the front of the received bytes
+auto TakeFrame(std::string &input, std::vector<std::string> &fields) -> FrameStatus {
+  if (input.size() < 4) {
+    return FrameStatus::INCOMPLETE;
+  }
+  uint32_t size = DecodeLength(input.data());
+  if (size > MAX_FRAME_BYTES) {
+    return FrameStatus::MALFORMED;
+  }
+  if (input.size() - 4 < size) {
+    return FrameStatus::INCOMPLETE;
+  }
+  bool decoded = DecodeFields(input.substr(4, size), fields);
+  input.erase(0, 4 + static_cast<size_t>(size));
+  return decoded ? FrameStatus::COMPLETE : FrameStatus::MALFORMED;
+}
+
+// Bound how long blocking sends, receives and connects on a socket may wait
+void SetTimeouts(int fd, int timeout_ms) {
+  timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// Parse the rendering of CompilationCache::DescribeOptions back into options
+auto DecodeOptions(const std::string &text) -> cgen::CodeGeneratorOptions {
+  cgen::CodeGeneratorOptions options;
+  std::istringstream stream(text);
+  std::string item;
+  while (stream >> item) {
+    auto equals = item.find('=');
+    std::string key = item.substr(0, equals);
+    std::string value = equals == std::string::npos ? "" : item.substr(equals + 1);
+    if (key == "peephole") {
+      options.apply_peephole_rules_ = value == "1";
+    } else if (key == "rle") {
+      options.eliminate_redundant_loads_ = value == "1";
+    } else if (key == "sched") {
+      options.schedule_instructions_ = value == "1";
+    } else if (key == "noreorder") {
+      options.fill_delay_slots_ = value == "1";
+    } else if (key == "strings") {
+      options.string_runtime_ = value == "rope" ? cgen::StringRuntime::ROPE : cgen::StringRuntime::FLAT;
+    }
+  }
+  return options;
+}
+
+auto MakeAddress(const std::string &socket_path, sockaddr_un &address) -> bool {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+  return true;
+}
+
+// Whether the process at the other end of a connected socket runs as this user
+auto PeerIsSelf(int fd) -> bool {
+#ifdef SO_PEERCRED
+  ucred credentials{};
+  socklen_t size = sizeof(credentials);
+  return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == ::getuid();
+#else
+  uid_t uid = 0;
+  gid_t gid = 0;
+  return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::getuid();
+#endif
+}
+
+// Create a directory only this user may enter, or check that an existing one is such a directory
+auto MakePrivateDirectory(const std::string &path) -> bool {
+  if (::mkdir(path.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+    return false;
+  }
+  struct stat info {};
+  return ::lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == ::getuid() &&
+         (info.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+// Connect to a server, returns -1 if none answers or it runs as another user
+auto Connect(const std::string &socket_path, int timeout_ms) -> int {
+  sockaddr_un address{};
+  if (socket_path.empty() || !MakeAddress(socket_path, address)) {
+    return -1;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  // The send timeout also bounds a connect waiting on a full backlog
+  SetTimeouts(fd, timeout_ms);
+  // A socket planted by another user must not see the source nor supply the output
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || !PeerIsSelf(fd)) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Send one request and wait for its response; a server that does not answer in time counts as none
+auto RoundTrip(const std::string &socket_path, const std::vector<std::string> &request,
+               std::vector<std::string> &response, int timeout_ms) -> bool {
+  int fd = Connect(socket_path, timeout_ms);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = SendFrame(fd, request) && ReceiveFrame(fd, response);
+  ::close(fd);
+  return ok;
+}
+
+}  // namespace
+
+CompileServer::CompileServer(std::string socket_path, size_t jobs, CompilationCache *cache)
+    : socket_path_(std::move(socket_path)), jobs_(jobs), compiler_(cache) {}
+
+CompileServer::~CompileServer() {
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    ::unlink(socket_path_.c_str());
+  }
+}
+
+auto CompileServer::Start(std::string &error) -> bool {
+  sockaddr_un address{};
+  if (socket_path_.empty()) {
+    error = "No private directory for the socket, set $SCP_SERVER_SOCKET or pass --socket";
+    return false;
+  }
+  if (!MakeAddress(socket_path_, address)) {
+    error = "Socket path too long: " + socket_path_;
+    return false;
+  }
+  int existing = Connect(socket_path_, CompileClient::DEFAULT_TIMEOUT_MS);
+  if (existing >= 0) {
+    ::close(existing);
+    error = "A server is already listening on " + socket_path_;
+    return false;
+  }
+  ::unlink(socket_path_.c_str());  // a stale socket of a server that died
+
+  // Only the owner may submit work; the umask gives the socket that mode from the moment it exists
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  mode_t mask = ::umask(S_IRWXG | S_IRWXO);
+  bool bound = listen_fd_ >= 0 && ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+  int bind_errno = errno;
+  ::umask(mask);
+  errno = bind_errno;
+  if (!bound || ::listen(listen_fd_, SOMAXCONN) != 0) {
+    error = "Cannot listen on " + socket_path_ + ": " + std::strerror(errno);
+    if (listen_fd_ >= 0) {
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    return false;
+  }
+  return true;
+}
+
+void CompileServer::Serve() {
+  // A connection of the server, read by the accepting thread whenever no request of it is being compiled
+  struct Connection {
+    /* The bytes received and not yet taken as a frame */
+    std::string input_;
+    /* Whether a worker is compiling a request of the connection and will answer it */
+    bool busy_{false};
+  };
+  std::map<int, Connection> connections;
+
+  // Workers report the connections they answered through a pipe, which wakes the poll
+  int wake[2];
+  if (::pipe(wake) != 0) {
+    return;
+  }
+  std::mutex answered_mutex;
+  std::vector<std::pair<int, bool>> answered;
+
+  auto close_connection = [&connections](int fd) {
+    ::close(fd);
+    connections.erase(fd);
+  };
+
+  ThreadPool pool(jobs_);
+  // Take every whole frame of an idle connection, up to the first compile request
+  auto dispatch = [&](int fd) {
+    auto &connection = connections.at(fd);
+    std::vector<std::string> request;
+    while (!connection.busy_) {
+      auto status = TakeFrame(connection.input_, request);
+      if (status == FrameStatus::INCOMPLETE) {
+        return;
+      }
+      if (status == FrameStatus::COMPLETE && request.size() == 1 && request[0] == "shutdown") {
+        Stop();
+        SendFrame(fd, {"ok"});
+        close_connection(fd);
+        return;
+      }
+      if (status == FrameStatus::MALFORMED || request.size() != 5 || request[0] != "compile") {
+        SendFrame(fd, {"error", "", "Error: Malformed request.\n", "0"});
+        close_connection(fd);
+        return;
+      }
+      connection.busy_ = true;
+      pool.Submit([this, fd, request = std::move(request), &answered_mutex, &answered, &wake](size_t /*worker*/) {
+        bool sent = SendFrame(fd, Answer(request));
+        {
+          std::lock_guard<std::mutex> lock(answered_mutex);
+          answered.emplace_back(fd, sent);
+        }
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = ::write(wake[1], &byte, 1);
+      });
+    }
+  };
+
+  std::vector<pollfd> polled;
+  while (!stopping_) {
+    polled = {{listen_fd_, POLLIN, 0}, {wake[0], POLLIN, 0}};
+    for (const auto &[fd, connection] : connections) {
+      if (!connection.busy_) {
+        polled.push_back({fd, POLLIN, 0});
+      }
+    }
+    // Wake up regularly to notice a Stop from another thread
+    if (::poll(polled.data(), polled.size(), 100) <= 0) {
+      continue;
+    }
+
+    if ((polled[1].revents & POLLIN) != 0) {
+      char bytes[64];
+      [[maybe_unused]] ssize_t drained = ::read(wake[0], bytes, sizeof(bytes));
+      std::vector<std::pair<int, bool>> done;
+      {
+        std::lock_guard<std::mutex> lock(answered_mutex);
+        done.swap(answered);
+      }
+      for (auto [fd, sent] : done) {
+        if (!sent) {
+          close_connection(fd);
+          continue;
+        }
+        // Requests sent back to back may already be waiting
+        connections.at(fd).busy_ = false;
+        dispatch(fd);
+      }
+    }
+
+    for (size_t i = 2; i < polled.size(); i++) {
+      if (polled[i].revents == 0) {
+        continue;
+      }
+      int fd = polled[i].fd;
+      char chunk[65536];
+      ssize_t count = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        continue;
+      }
+      if (count <= 0) {
+        close_connection(fd);
+        continue;
+      }
+      connections.at(fd).input_.append(chunk, static_cast<size_t>(count));
+      dispatch(fd);
+    }
+
+    if ((polled[0].revents & POLLIN) != 0) {
+      int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        // A worker answering a client that stopped reading gives up instead of blocking
+        SetTimeouts(fd, CompileClient::DEFAULT_TIMEOUT_MS);
+        connections[fd];
+      }
+    }
+  }
+
+  pool.Wait();
+  for (const auto &entry : connections) {
+    ::close(entry.first);
+  }
+  ::close(wake[0]);
+  ::close(wake[1]);
+}
+
+auto CompileServer::GetDefaultSocketPath() -> std::string {
+  if (const char *path = std::getenv("SCP_SERVER_SOCKET"); path != nullptr && *path != '\0') {
+    return path;
+  }
+  if (const char *runtime = std::getenv("XDG_RUNTIME_DIR"); runtime != nullptr && *runtime != '\0') {
+    return std::string(runtime) + "/scp-server.sock";
+  }
+  // /tmp is shared, so the socket goes into a directory only this user can create files in
+  std::string directory = "/tmp/scp-" + std::to_string(::getuid());
+  if (!MakePrivateDirectory(directory)) {
+    return "";
+  }
+  return directory + "/server.sock";
+}
+
+auto CompileServer::Answer(const std::vector<std::string> &request) -> std::vector<std::string> {
+  const std::string &name = request[1];
+  const std::string &path = request[2];
+  std::string source = request[3];
+  CompileResult result;
+  try {
+    if (source.empty() && !path.empty()) {
+      source = ReadSource(path);
+    }
+    if (source.empty()) {
+      result.success_ = true;
+      result.diagnostics_ = std::string(EMPTY_INPUT_WARNING) + "\n";
+    } else {
+      result = compiler_.Compile(source, DecodeOptions(request[4]), name);
+    }
+  } catch (const std::exception &e) {
+    result.diagnostics_ = std::string("Error: ") + e.what() + "\n";
+  }
+  request_count_++;
+  return {result.success_ ? "ok" : "error", result.output_, result.diagnostics_, result.cached_ ? "1" : "0"};
+}
+
+auto CompileClient::Compile(const std::string &socket_path, const CompileRequest &request, CompileResult &result,
+                            int timeout_ms) -> bool {
+  std::vector<std::string> response;
+  if (!RoundTrip(socket_path,
+                 {"compile", request.name_, request.path_, request.source_,
+                  CompilationCache::DescribeOptions(request.options_)},
+                 response, timeout_ms) ||
+      response.size() != 4) {
+    return false;
+  }
+  result.success_ = response[0] == "ok";
+  result.output_ = std::move(response[1]);
+  result.diagnostics_ = std::move(response[2]);
+  result.cached_ = response[3] == "1";
+  return true;
+}
+
+auto CompileClient::Shutdown(const std::string &socket_path, int timeout_ms) -> bool {
+  std::vector<std::string> response;
+  return RoundTrip(socket_path, {"shutdown"}, response, timeout_ms);
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,46 @@
+#include "driver/compiler.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace scp::driver {
+
+Compiler::Compiler(CompilationCache *cache) : cache_(cache) {
+  // Build the shared tables now rather than in the first request
+  parser::SLRParser::GetTables();
+}
+
+auto Compiler::Compile(std::string_view source, const Options &options, const std::string &name) -> Result {
+  auto parser = AcquireParser();
+  auto result = CompileSource(*parser, name, std::string(source), options, cache_);
+  ReleaseParser(std::move(parser));
+  return result;
+}
+
+auto Compiler::GetIdleParserCount() const -> size_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_parsers_.size();
+}
+
+auto Compiler::AcquireParser() -> std::unique_ptr<parser::SLRParser> {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_parsers_.empty()) {
+      auto parser = std::move(idle_parsers_.back());
+      idle_parsers_.pop_back();
+      return parser;
+    }
+  }
+  // Building the lexer automata needs no lock
+  return std::make_unique<parser::SLRParser>("");
+}
+
+void Compiler::ReleaseParser(std::unique_ptr<parser::SLRParser> parser) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_parsers_.push_back(std::move(parser));
+}
+
+}  // namespace scp::driver
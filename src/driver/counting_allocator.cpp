@@ -0,0 +1,60 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "driver/memory_accounting.h"
+
+namespace scp::driver {
+
+namespace {
+
+// The header keeps the size of a block for delete; its size keeps the payload aligned like malloc
+constexpr size_t HEADER_BYTES = alignof(std::max_align_t);
+
+auto CountedAllocate(size_t size) -> void * {
+  auto *block = static_cast<unsigned char *>(std::malloc(size + HEADER_BYTES));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *reinterpret_cast<size_t *>(block) = size;
+  MemoryAccounting::RecordAllocation(size);
+  return block + HEADER_BYTES;
+}
+
+auto AllocateOrThrow(size_t size) -> void * {
+  void *pointer = CountedAllocate(size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void CountedFree(void *pointer) {
+  if (pointer == nullptr) {
+    return;
+  }
+  auto *block = static_cast<unsigned char *>(pointer) - HEADER_BYTES;
+  MemoryAccounting::RecordDeallocation(*reinterpret_cast<size_t *>(block));
+  std::free(block);
+}
+
+// Linking this file is what turns the counters on
+const bool REGISTERED = (MemoryAccounting::Enable(), true);
+
+}  // namespace
+
+}  // namespace scp::driver
+
+// Replacements of the global allocation functions; the nothrow and aligned forms keep their default behavior,
+// which forwards to these or pairs with its own deallocation
+auto operator new(size_t size) -> void * { return scp::driver::AllocateOrThrow(size); }
+
+auto operator new[](size_t size) -> void * { return scp::driver::AllocateOrThrow(size); }
+
+void operator delete(void *pointer) noexcept { scp::driver::CountedFree(pointer); }
+
+void operator delete[](void *pointer) noexcept { scp::driver::CountedFree(pointer); }
+
+void operator delete(void *pointer, size_t /*size*/) noexcept { scp::driver::CountedFree(pointer); }
+
+void operator delete[](void *pointer, size_t /*size*/) noexcept { scp::driver::CountedFree(pointer); }
@@ -0,0 +1,88 @@
+#include "driver/fuzz_check.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "cgen/code_generator.h"
+#include "core/diagnostics.h"
+#include "driver/compilation_cache.h"
+#include "semant/type_checker.h"
+
+namespace fs = std::filesystem;
+
+namespace scp::driver {
+
+FuzzCheck::FuzzCheck(double max_seconds_per_byte, size_t min_slow_bytes)
+    : max_seconds_per_byte_(max_seconds_per_byte),
+      min_slow_bytes_(min_slow_bytes),
+      ll1_parser_("fuzz"),
+      slr_parser_("fuzz") {}
+
+auto FuzzCheck::Run(const std::string &source) -> FuzzResult {
+  FuzzResult result;
+  std::ostringstream discarded;
+  core::DiagnosticCapture capture(discarded);
+  auto start = std::chrono::steady_clock::now();
+
+  // Every stage runs until one rejects the input; exceptions other than type errors escape to the fuzzer
+  lexer_.Tokenize(source);
+  if (!lexer_.HasNext()) {
+    result.stage_ = FuzzStage::PARSE_ERROR;
+    ll1_parser_.SetInput(source);
+    auto ll1_ast = ll1_parser_.Parse();
+    slr_parser_.SetInput(source);
+    auto slr_ast = slr_parser_.Parse();
+
+    if (!ll1_ast != !slr_ast) {
+      result.mismatch_ = ll1_ast ? "only LL1Parser accepts the input" : "only SLRParser accepts the input";
+    } else if (slr_ast && !ll1_ast->GetRoot() != !slr_ast->GetRoot()) {
+      result.mismatch_ = "only one parser produced an AST root";
+    } else if (slr_ast && slr_ast->GetRoot() && !ll1_ast->GetRoot()->IsStructurallyEqual(*slr_ast->GetRoot())) {
+      result.mismatch_ = "the parsers built different ASTs";
+    }
+
+    if (slr_ast && slr_ast->GetRoot()) {
+      result.stage_ = FuzzStage::TYPE_ERROR;
+      std::shared_ptr<core::TypeEnvironment> environment;
+      try {
+        semant::TypeChecker type_checker(slr_ast);
+        environment = type_checker.CheckType();
+      } catch (const std::runtime_error &) {
+        environment = nullptr;
+      }
+      if (environment) {
+        // The default options and the optimizing ones with the rope runtime take different paths
+        cgen::CodeGeneratorOptions optimized;
+        optimized.apply_peephole_rules_ = true;
+        optimized.eliminate_redundant_loads_ = true;
+        optimized.schedule_instructions_ = true;
+        optimized.string_runtime_ = cgen::StringRuntime::ROPE;
+        for (const auto &options : {cgen::CodeGeneratorOptions{}, optimized}) {
+          cgen::CodeGenerator code_generator(slr_ast, environment, options);
+          code_generator.GenerateCode();
+        }
+        result.stage_ = FuzzStage::COMPILED;
+      }
+    }
+  }
+
+  result.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.slow_ = source.size() >= min_slow_bytes_ &&
+                 result.seconds_ > max_seconds_per_byte_ * static_cast<double>(source.size());
+  return result;
+}
+
+auto FuzzCheck::SaveInput(const std::string &directory, const std::string &source) -> std::string {
+  std::error_code error;
+  fs::create_directories(directory, error);
+  auto path = (fs::path(directory) / (CompilationCache::MakeKey(source, "fuzz", "") + ".scpl")).string();
+  std::ofstream file(path, std::ios::binary);
+  file << source;
+  return file.good() ? path : "";
+}
+
+}  // namespace scp::driver
@@ -0,0 +1,59 @@
+#include "driver/memory_accounting.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace scp::driver {
+
+namespace {
+
+// Constant-initialized, so allocations made before main are counted too
+std::atomic<bool> enabled{false};
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocated_bytes{0};
+std::atomic<uint64_t> live_bytes{0};
+std::atomic<uint64_t> peak_bytes{0};
+
+}  // namespace
+
+auto MemoryAccounting::IsEnabled() -> bool { return enabled.load(std::memory_order_relaxed); }
+
+auto MemoryAccounting::GetAllocationCount() -> uint64_t { return allocation_count.load(); }
+
+auto MemoryAccounting::GetAllocatedBytes() -> uint64_t { return allocated_bytes.load(); }
+
+auto MemoryAccounting::GetLiveBytes() -> uint64_t { return live_bytes.load(); }
+
+auto MemoryAccounting::GetPeakBytes() -> uint64_t { return peak_bytes.load(); }
+
+void MemoryAccounting::ResetPeak() { peak_bytes.store(live_bytes.load()); }
+
+auto MemoryAccounting::GetPeakRss() -> uint64_t {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<uint64_t>(usage.ru_maxrss);  // bytes
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // KiB
+#endif
+}
+
+void MemoryAccounting::Enable() { enabled.store(true, std::memory_order_relaxed); }
+
+void MemoryAccounting::RecordAllocation(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  uint64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  uint64_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryAccounting::RecordDeallocation(size_t size) { live_bytes.fetch_sub(size, std::memory_order_relaxed); }
+
+}  // namespace scp::driver
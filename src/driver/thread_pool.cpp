@@ -0,0 +1,106 @@
+#include "driver/thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace scp::driver {
+
+namespace {
+
+// The pool and worker index of the calling thread, if it is a worker
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  for (size_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Submit(Task task) {
+  size_t index = current_pool == this ? current_worker : next_queue_++ % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex_);
+    queues_[index]->tasks_.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_count_++;
+    pending_count_++;
+  }
+  work_available_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  all_done_.wait(lock, [this] { return pending_count_ == 0; });
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+  current_pool = this;
+  current_worker = index;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this] { return stopping_ || queued_count_ > 0; });
+      if (queued_count_ == 0) {
+        return;  // stopping with nothing left to do
+      }
+      queued_count_--;  // claim one of the queued tasks
+    }
+
+    // The claim guarantees some deque holds a task nobody else has claimed
+    Task task;
+    while (!TryTake(index, task)) {
+      std::this_thread::yield();
+    }
+    task(index);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_count_ == 0) {
+      all_done_.notify_all();
+    }
+  }
+}
+
+auto ThreadPool::TryTake(size_t index, Task &task) -> bool {
+  {
+    Queue &own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex_);
+    if (!own.tasks_.empty()) {
+      task = std::move(own.tasks_.back());
+      own.tasks_.pop_back();
+      return true;
+    }
+  }
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    Queue &victim = *queues_[(index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex_);
+    if (!victim.tasks_.empty()) {
+      task = std::move(victim.tasks_.front());
+      victim.tasks_.pop_front();
+      stolen_count_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace scp::driver
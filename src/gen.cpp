@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+
+#include "workload/program_generator.h"
+
+/**
+ * Print the usage information for the program generator.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " [--<knob> <value>]..." << std::endl;
+  std::cout << "  Print a valid SCP program; equal knobs always give the same program" << std::endl;
+  std::cout << "  --seed <N>: Seed of the generator (default 1)" << std::endl;
+  std::cout << "  --statements <N>: Number of statements (default 1000)" << std::endl;
+  std::cout << "  --depth <N>: Maximum nesting of parenthesized subexpressions (default 2)" << std::endl;
+  std::cout << "  --chain <N>: Maximum number of operands of one expression (default 4)" << std::endl;
+  std::cout << "  --string-share <p>: Share of string expressions (default 0.3)" << std::endl;
+  std::cout << "  --literal-length <N>: Maximum length of a literal (default 8)" << std::endl;
+  std::cout << "  --stdin-share <p>: Share of statements reading stdin (default 0)" << std::endl;
+  std::cout << "  --output-share <p>: Share of statements printing (default 0.1)" << std::endl;
+  std::cout << "  --new-variable-share <p>: Share of assignments defining a new variable (default 0.5)" << std::endl;
+}
+
+/**
+ * Main entry point for the program generator.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  scp::workload::GeneratorOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    }
+    if (arg.rfind("--", 0) != 0 || i + 1 >= argc ||
+        !scp::workload::SetGeneratorOption(options, arg.substr(2), argv[i + 1])) {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    i++;
+  }
+  scp::workload::ProgramGenerator(options).Generate(std::cout);
+  return 0;
+}
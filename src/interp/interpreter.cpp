@@ -0,0 +1,275 @@
+#include "interp/interpreter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "constant/error_messages.h"
+#include "core/diagnostics.h"
+#include "core/trace.h"
+
+namespace scp::interp {
+
+namespace {
+
+// Parse a number literal into the word `li` would load
+auto ParseNumber(const std::string &literal) -> int32_t {
+  uint64_t value = 0;
+  for (char c : literal) {
+    value = value * 10 + static_cast<uint64_t>(c - '0');
+    if (value > std::numeric_limits<uint32_t>::max()) {
+      throw std::runtime_error(constant::ErrorMessages::NumberOutOfRange(literal));
+    }
+  }
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+// Decode a string literal the way the assembler reads an .asciiz directive
+void DecodeString(const std::string &literal, std::string &text) {
+  text.clear();
+  for (size_t i = 1; i + 1 < literal.size(); i++) {
+    if (literal[i] != '\\' || i + 2 >= literal.size()) {
+      text += literal[i];
+      continue;
+    }
+    switch (literal[++i]) {
+      case 'n':
+        text += '\n';
+        break;
+      case 't':
+        text += '\t';
+        break;
+      case 'r':
+        text += '\r';
+        break;
+      default:
+        text += literal[i];  // \\ and \"
+    }
+  }
+}
+
+}  // namespace
+
+Interpreter::Interpreter(std::istream &input, std::ostream &output) : input_(input), output_(output) {}
+
+auto Interpreter::Execute(const std::string &source, std::vector<StatementTiming> *timings) -> bool {
+  SCP_TRACE_SCOPE("Execute");
+  parser_.SetInput(source, line_);
+  line_ += static_cast<int>(std::count(source.begin(), source.end(), '\n'));
+  auto ast = parser_.Parse();
+  if (!ast) {
+    core::Diagnostics() << "Error: Failed to parse the input." << std::endl;
+    return false;
+  }
+  if (!ast->GetRoot()) {
+    return true;
+  }
+
+  try {
+    for (const auto &statement : ast->GetRoot()->GetChildren()) {
+      auto start = std::chrono::steady_clock::now();
+      if (!Check(statement)) {
+        core::Diagnostics() << "Error: " << constant::ErrorMessages::TYPE_CHECK_FAILED << std::endl;
+        return false;
+      }
+      auto checked = std::chrono::steady_clock::now();
+      Run(statement);
+      if (timings != nullptr) {
+        timings->push_back({checked - start, std::chrono::steady_clock::now() - checked});
+      }
+    }
+  } catch (const std::exception &e) {
+    core::Diagnostics() << "Error: " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+auto Interpreter::Check(const std::shared_ptr<core::AST::ASTNode> &statement) -> bool {
+  bool success = type_checker_.CheckStatement(statement);
+  // A variable gets its slot when it is declared, even if the statement declaring it then fails to run
+  const auto &target = statement->GetChildren().front()->GetValue();
+  core::Type type = type_checker_.GetTypeEnvironment()->GetType(target);
+  if (type != core::Type::UNDEFINED && target != "stdin" && target != "stdout" &&
+      slots_.find(target) == slots_.end()) {
+    slots_.emplace(target, variables_.size());
+    Value value;
+    value.type_ = type;
+    variables_.emplace_back(target, std::move(value));
+  }
+  return success;
+}
+
+void Interpreter::Run(const std::shared_ptr<core::AST::ASTNode> &statement) {
+  const auto &target = statement->GetChildren().front()->GetValue();
+  const auto &value = *statement->GetChildren().back();
+  bool read = value.GetType() == core::ASTNodeType::IDENTIFIER && value.GetValue() == "stdin";
+  if (target == "stdout") {
+    // stdin is a stream rather than a string, so `stdout <- stdin` reads and prints a number
+    if (read) {
+      Print(std::to_string(ReadNumber()));
+      return;
+    }
+    Evaluate(value, result_);
+    Print(result_.type_ == core::Type::STRING ? result_.string_ : std::to_string(result_.number_));
+    return;
+  }
+
+  if (read) {
+    result_.type_ = core::Type::STRING;
+    result_.string_ = ReadString();
+  } else {
+    Evaluate(value, result_);
+  }
+  // Swapping leaves the old buffer of the variable for the next statement to fill
+  Value &variable = variables_[slots_.at(target)].second;
+  variable.type_ = result_.type_;
+  variable.number_ = result_.number_;
+  std::swap(variable.string_, result_.string_);
+}
+
+void Interpreter::Evaluate(const core::AST::ASTNode &node, Value &result) {
+  // A + or * is visited before its operands, and again to combine their values once both are on top of operands_
+  std::vector<std::pair<const core::AST::ASTNode *, bool>> pending = {{&node, false}};
+  size_t count = 0;
+  while (!pending.empty()) {
+    auto [current, combine] = pending.back();
+    pending.pop_back();
+    if (combine) {
+      Combine(current->GetType(), operands_[count - 2], operands_[count - 1]);
+      count--;
+    } else if (current->GetType() == core::ASTNodeType::PLUS || current->GetType() == core::ASTNodeType::TIMES) {
+      pending.emplace_back(current, true);
+      pending.emplace_back(current->GetChildren().back().get(), false);
+      pending.emplace_back(current->GetChildren().front().get(), false);
+    } else {
+      if (count == operands_.size()) {
+        operands_.emplace_back();
+      }
+      Load(*current, operands_[count++]);
+    }
+  }
+  std::swap(result, operands_.front());
+}
+
+void Interpreter::Load(const core::AST::ASTNode &node, Value &result) {
+  switch (node.GetType()) {
+    case core::ASTNodeType::NUMBER:
+      result.type_ = core::Type::NUMBER;
+      result.number_ = ParseNumber(node.GetValue());
+      return;
+    case core::ASTNodeType::STRING:
+      result.type_ = core::Type::STRING;
+      DecodeString(node.GetValue(), result.string_);
+      return;
+    case core::ASTNodeType::IDENTIFIER: {
+      auto it = slots_.find(node.GetValue());
+      if (it == slots_.end()) {
+        // A stream holds no value
+        result.type_ = type_checker_.GetTypeEnvironment()->GetType(node.GetValue());
+        result.number_ = 0;
+        result.string_.clear();
+        return;
+      }
+      const Value &variable = variables_[it->second].second;
+      result.type_ = variable.type_;
+      result.number_ = variable.number_;
+      result.string_.assign(variable.string_);
+      return;
+    }
+    default:
+      throw std::runtime_error(constant::ErrorMessages::Panic("Invalid AST node in an expression"));
+  }
+}
+
+void Interpreter::Combine(core::ASTNodeType type, Value &result, const Value &right) {
+  if (result.type_ == core::Type::NUMBER && right.type_ == core::Type::NUMBER) {
+    int64_t word = type == core::ASTNodeType::PLUS
+                       ? static_cast<int64_t>(result.number_) + right.number_
+                       : static_cast<int64_t>(result.number_) * right.number_;
+    // `add` traps on overflow, while `mul` keeps the low word
+    if (type == core::ASTNodeType::PLUS &&
+        (word > std::numeric_limits<int32_t>::max() || word < std::numeric_limits<int32_t>::min())) {
+      throw std::runtime_error(constant::ErrorMessages::ARITHMETIC_OVERFLOW);
+    }
+    result.number_ = static_cast<int32_t>(static_cast<uint32_t>(word));
+    return;
+  }
+
+  if (type == core::ASTNodeType::PLUS) {
+    if (result.string_.size() + right.string_.size() > MAX_STRING_LENGTH) {
+      throw std::runtime_error(constant::ErrorMessages::STRING_TOO_LONG);
+    }
+    result.string_ += right.string_;
+    return;
+  }
+  // Repetition, with the string on either side
+  const std::string &text = result.type_ == core::Type::STRING ? result.string_ : right.string_;
+  int32_t count = result.type_ == core::Type::STRING ? right.number_ : result.number_;
+  size_t times = count > 0 ? static_cast<size_t>(count) : 0;
+  if (!text.empty() && times > MAX_STRING_LENGTH / text.size()) {
+    throw std::runtime_error(constant::ErrorMessages::STRING_TOO_LONG);
+  }
+  std::string repeated;
+  repeated.reserve(text.size() * times);
+  for (size_t i = 0; i < times; i++) {
+    repeated += text;
+  }
+  result.type_ = core::Type::STRING;
+  result.string_ = std::move(repeated);
+}
+
+auto Interpreter::ReadString() -> std::string {
+  // The read string syscall stops after a newline or when the buffer is full, and the code trims the line break
+  std::string line;
+  char c;
+  while (line.size() < MAX_INPUT_LENGTH && input_.get(c)) {
+    line += c;
+    if (c == '\n') {
+      break;
+    }
+  }
+  size_t end = line.find_first_of("\r\n");
+  if (end != std::string::npos) {
+    line.resize(end);
+  }
+  return line;
+}
+
+auto Interpreter::ReadNumber() -> int32_t {
+  std::string line;
+  std::getline(input_, line);
+  size_t i = 0;
+  while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i])) != 0) {
+    i++;
+  }
+  bool negative = i < line.size() && line[i] == '-';
+  if (i < line.size() && (line[i] == '-' || line[i] == '+')) {
+    i++;
+  }
+  uint32_t value = 0;
+  for (; i < line.size() && std::isdigit(static_cast<unsigned char>(line[i])) != 0; i++) {
+    value = value * 10 + static_cast<uint32_t>(line[i] - '0');
+  }
+  return static_cast<int32_t>(negative ? 0U - value : value);
+}
+
+void Interpreter::Print(const std::string &text) {
+  output_ << text;
+  if (!text.empty()) {
+    at_line_start_ = text.back() == '\n';
+  }
+}
+
+void Interpreter::FinishLine() {
+  if (!at_line_start_) {
+    Print("\n");
+  }
+}
+
+auto Interpreter::GetVariables() const -> std::vector<std::pair<std::string, Value>> { return variables_; }
+
+}  // namespace scp::interp
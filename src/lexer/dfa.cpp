@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "constant/error_messages.h"
+#include "core/diagnostics.h"
 
 namespace scp::lexer {
 
@@ -89,18 +90,18 @@ auto DeterministicFiniteAutomata::Release() -> void {
 
 auto DeterministicFiniteAutomata::AddTransition(int from_state, char symbol, int to_state) -> bool {
   if (released_) {
-    std::cerr << constant::ErrorMessages::DFA_RELEASED_CANNOT_ADD_TRANSITION << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::DFA_RELEASED_CANNOT_ADD_TRANSITION << std::endl;
     return false;
   }
 
   if (from_state < 0 || from_state >= num_states_ || to_state < 0 || to_state >= num_states_) {
-    std::cerr << constant::ErrorMessages::INVALID_STATE << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::INVALID_STATE << std::endl;
     return false;
   }
 
   auto symbol_it = alphabet_.find(symbol);
   if (symbol_it == alphabet_.end()) {
-    std::cerr << constant::ErrorMessages::SymbolNotInAlphabetWithDetails(symbol) << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::SymbolNotInAlphabetWithDetails(symbol) << std::endl;
     return false;
   }
 
@@ -110,12 +111,12 @@ auto DeterministicFiniteAutomata::AddTransition(int from_state, char symbol, int
 
 auto DeterministicFiniteAutomata::SetFinalState(int state) -> bool {
   if (released_) {
-    std::cerr << constant::ErrorMessages::DFA_RELEASED_CANNOT_SET_FINAL << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::DFA_RELEASED_CANNOT_SET_FINAL << std::endl;
     return false;
   }
 
   if (state < 0 || state >= num_states_) {
-    std::cerr << constant::ErrorMessages::INVALID_STATE << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::INVALID_STATE << std::endl;
     return false;
   }
 
@@ -125,17 +126,17 @@ auto DeterministicFiniteAutomata::SetFinalState(int state) -> bool {
 
 auto DeterministicFiniteAutomata::Evaluate(char byte) -> bool {
   if (!released_) {
-    std::cerr << constant::ErrorMessages::DFA_NOT_RELEASED_CANNOT_EVALUATE << std::endl;
+    core::Diagnostics() << constant::ErrorMessages::DFA_NOT_RELEASED_CANNOT_EVALUATE << std::endl;
     return false;
   }
 
-  if (alphabet_.find(byte) == alphabet_.end()) {
+  auto symbol_it = alphabet_.find(byte);
+  if (symbol_it == alphabet_.end()) {
     current_state_ = -1;
     return false;
   }
 
-  int symbol_index = alphabet_[byte];
-  current_state_ = (*states_transition_released_[current_state_])[symbol_index];
+  current_state_ = (*states_transition_released_[current_state_])[symbol_it->second];
 
   return current_state_ != -1;
 }
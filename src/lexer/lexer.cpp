@@ -6,7 +6,9 @@
 #include <vector>
 
 #include "constant/alphabet.h"
+#include "core/diagnostics.h"
 #include "core/token.h"
+#include "core/trace.h"
 
 namespace scp::lexer {
 
@@ -159,11 +161,35 @@ void Lexer::SetupStringDFA() {
   string_dfa_->SetFinalState(3);
 }
 
-void Lexer::SetInput(const std::string &input) {
+void Lexer::SetInput(const std::string &input, int first_line) {
   input_ = input;
+  stream_ = nullptr;
   current_pos_ = 0;
+  first_line_ = first_line;
+  current_line_ = first_line_;
+  current_column_ = 1;
+}
+
+void Lexer::SetInputStream(std::istream &stream) {
+  input_.clear();
+  stream_ = &stream;
+  current_pos_ = 0;
+  first_line_ = 1;
   current_line_ = 1;
   current_column_ = 1;
+  // HasNext only looks at input_, so the buffer always reaches past the whitespace ahead
+  SkipWhitespace();
+}
+
+auto Lexer::ReadChunk() -> bool {
+  if (stream_ == nullptr || !*stream_) {
+    return false;
+  }
+  size_t size = input_.size();
+  input_.resize(size + STREAM_CHUNK_SIZE);
+  stream_->read(&input_[size], STREAM_CHUNK_SIZE);
+  input_.resize(size + static_cast<size_t>(stream_->gcount()));
+  return input_.size() > size;
 }
 
 auto Lexer::Next() -> std::optional<core::Token> {
@@ -186,13 +212,14 @@ auto Lexer::HasNext() const -> bool {
 
 void Lexer::Reset() {
   current_pos_ = 0;
-  current_line_ = 1;
+  current_line_ = first_line_;
   current_column_ = 1;
 }
 
 void Lexer::SkipWhitespace() {
-  while (current_pos_ < input_.size() && (input_[current_pos_] == ' ' || input_[current_pos_] == '\t' ||
-                                          input_[current_pos_] == '\n' || input_[current_pos_] == '\r')) {
+  while ((current_pos_ < input_.size() || ReadChunk()) &&
+         (input_[current_pos_] == ' ' || input_[current_pos_] == '\t' || input_[current_pos_] == '\n' ||
+          input_[current_pos_] == '\r')) {
     if (input_[current_pos_] == '\n') {
       current_line_++;
       current_column_ = 1;
@@ -211,6 +238,12 @@ auto Lexer::GetNextToken(core::Token &token) -> bool {
     return false;
   }
 
+  // Drop the consumed prefix of a streamed input, once it is worth the copy
+  if (stream_ != nullptr && current_pos_ >= STREAM_CHUNK_SIZE) {
+    input_.erase(0, current_pos_);
+    current_pos_ = 0;
+  }
+
   size_t token_start = current_pos_;
   int token_start_line = current_line_;
   int token_start_column = current_column_;
@@ -226,7 +259,7 @@ auto Lexer::GetNextToken(core::Token &token) -> bool {
   bool have_survival = true;
 
   // Try to consume characters as long as possible
-  while (current_pos_ < input_.size() && have_survival) {
+  while ((current_pos_ < input_.size() || ReadChunk()) && have_survival) {
     // Stop at whitespace only if string DFA is not active
     if ((input_[current_pos_] == ' ' || input_[current_pos_] == '\t' || input_[current_pos_] == '\n' ||
          input_[current_pos_] == '\r') &&
@@ -269,13 +302,27 @@ auto Lexer::GetNextToken(core::Token &token) -> bool {
 
     token = core::Token(token_type, token_value, token_start_line, token_start_column);
 
-    // Set current_pos_ to the position after the accepted token
+    // Set current_pos_ to the position after the accepted token, counting the position from the token alone, as
+    // the scan may have looked past it
     current_pos_ = last_accepted_pos;
+    current_line_ = token_start_line;
+    current_column_ = token_start_column;
+    for (char c : token_value) {
+      if (c == '\n') {
+        current_line_++;
+        current_column_ = 1;
+      } else {
+        current_column_++;
+      }
+    }
+    if (stream_ != nullptr) {
+      SkipWhitespace();
+    }
     return true;
   }
   // Skip the problematic character
-  std::cerr << "Lexer: No valid token found at line " << current_line_ << ", column " << current_column_
-            << " for character '" << input_[token_start] << "'" << std::endl;
+  core::Diagnostics() << "Lexer: No valid token found at line " << current_line_ << ", column " << current_column_
+                      << " for character '" << input_[token_start] << "'" << std::endl;
   if (input_[current_pos_] == '\n') {
     current_line_++;
     current_column_ = 1;
@@ -283,10 +330,14 @@ auto Lexer::GetNextToken(core::Token &token) -> bool {
     current_column_++;
   }
   ++current_pos_;
+  if (stream_ != nullptr) {
+    SkipWhitespace();
+  }
   return false;
 }
 
 auto Lexer::Tokenize(const std::string &input) -> std::vector<core::Token> {
+  SCP_TRACE_SCOPE("Lex");
   std::vector<core::Token> tokens;
 
   // Set input and reset position
@@ -0,0 +1,77 @@
+#include "lexer/token_ring.h"
+
+#include <thread>
+#include <utility>
+
+namespace scp::lexer {
+
+namespace {
+
+/* Number of checks before a waiting thread starts yielding its core */
+constexpr int SPINS_BEFORE_YIELD = 64;
+
+}  // namespace
+
+TokenRing::TokenRing() : slots_(CAPACITY) {}
+
+void TokenRing::Reset() {
+  head_.store(0, std::memory_order_relaxed);
+  tail_.store(0, std::memory_order_relaxed);
+  cancelled_.store(false, std::memory_order_relaxed);
+  diagnostics_.clear();
+}
+
+template <typename Condition>
+void TokenRing::WaitUntil(const Condition &ready) {
+  for (int spins = 0; !ready(); spins++) {
+    if (spins >= SPINS_BEFORE_YIELD) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+auto TokenRing::Push(core::Token &&token) -> bool {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  WaitUntil([&] {
+    return tail - head_.load(std::memory_order_acquire) < CAPACITY || cancelled_.load(std::memory_order_relaxed);
+  });
+  if (cancelled_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  slots_[tail & (CAPACITY - 1)] = std::move(token);
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+void TokenRing::Close(std::string diagnostics) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  WaitUntil([&] {
+    return tail - head_.load(std::memory_order_acquire) < CAPACITY || cancelled_.load(std::memory_order_relaxed);
+  });
+  if (cancelled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  diagnostics_ = std::move(diagnostics);
+  slots_[tail & (CAPACITY - 1)].reset();
+  tail_.store(tail + 1, std::memory_order_release);
+}
+
+auto TokenRing::Front() -> const std::optional<core::Token> & { return WaitFront(); }
+
+auto TokenRing::WaitFront() -> std::optional<core::Token> & {
+  size_t head = head_.load(std::memory_order_relaxed);
+  WaitUntil([&] { return tail_.load(std::memory_order_acquire) != head; });
+  return slots_[head & (CAPACITY - 1)];
+}
+
+auto TokenRing::Pop() -> std::optional<core::Token> {
+  auto &slot = WaitFront();
+  if (!slot) {
+    return std::nullopt;  // The end marker stays, so every later call sees it too
+  }
+  std::optional<core::Token> token = std::move(slot);
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  return token;
+}
+
+}  // namespace scp::lexer
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <string>
+
+#include "lsp/language_server.h"
+
+namespace {
+
+/**
+ * Print the usage information for the language server.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << std::endl;
+  std::cout << "  Serve the Language Server Protocol over stdin and stdout: diagnostics, hover types and go to"
+            << " definition, updated incrementally as documents change" << std::endl;
+}
+
+}  // namespace
+
+/**
+ * Main entry point for the language server.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    }
+    // Editors pass the transport; stdio is the only one
+    if (arg != "--stdio") {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::ios::sync_with_stdio(false);
+  scp::lsp::LanguageServer server(std::cin, std::cout);
+  return server.Serve();
+}
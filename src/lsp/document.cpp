@@ -0,0 +1,564 @@
+#include "lsp/document.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "core/diagnostics.h"
+#include "core/trace.h"
+#include "semant/type_checker.h"
+
+namespace scp::lsp {
+
+namespace {
+
+// Move a position over text[from, to)
+void Walk(const std::string &text, size_t from, size_t to, int &line, int &column) {
+  for (size_t i = from; i < to; i++) {
+    if (text[i] == '\n') {
+      line++;
+      column = 1;
+    } else {
+      column++;
+    }
+  }
+}
+
+// Get the position after a token
+auto EndOf(const core::Token &token) -> std::pair<int, int> {
+  int line = token.GetLine();
+  int column = token.GetColumn();
+  Walk(token.GetValue(), 0, token.GetValue().size(), line, column);
+  return {line, column};
+}
+
+auto IsStream(const std::string &name) -> bool { return name == "stdin" || name == "stdout"; }
+
+// Turn a lexer or parser message into a diagnostic, taking the position out of its text
+auto ToDiagnostic(const std::string &message) -> std::optional<Diagnostic> {
+  static const std::string LINE = " at line ";
+  static const std::string COLUMN = ", column ";
+  Diagnostic diagnostic;
+  size_t at = message.find(LINE);
+  size_t comma = at == std::string::npos ? at : message.find(COLUMN, at);
+  if (comma == std::string::npos) {
+    return std::nullopt;
+  }
+  size_t digits = comma + COLUMN.size();
+  size_t after = message.find_first_not_of("0123456789", digits);
+  after = after == std::string::npos ? message.size() : after;
+  try {
+    diagnostic.line_ = std::stoi(message.substr(at + LINE.size(), comma - at - LINE.size()));
+    diagnostic.column_ = std::stoi(message.substr(digits, after - digits));
+  } catch (const std::exception &) {
+    return std::nullopt;
+  }
+  diagnostic.end_line_ = diagnostic.line_;
+  diagnostic.end_column_ = diagnostic.column_ + 1;
+  diagnostic.message_ = message.substr(0, at) + message.substr(after);
+  return diagnostic;
+}
+
+}  // namespace
+
+Document::Document(std::string text) { SetText(std::move(text)); }
+
+void Document::SetText(std::string text) {
+  SCP_TRACE_SCOPE("Document::SetText");
+  text_ = std::move(text);
+  statements_.clear();
+  spans_.clear();
+  assigners_.clear();
+  readers_.clear();
+  diagnosed_.clear();
+  Split(0, text_.size(), 1, 1, statements_, spans_);
+  AssignKeys(0, statements_.size());
+  for (size_t i = 0; i < statements_.size(); i++) {
+    Parse(*statements_[i], spans_[i]);
+    Index(*statements_[i], true);
+  }
+  // In source order every declaration a statement depends on is already known
+  checked_count_ = 0;
+  for (auto &statement : statements_) {
+    Check(*statement);
+  }
+  parsed_count_ = statements_.size();
+}
+
+void Document::Replace(size_t offset, size_t length, const std::string &text) {
+  SCP_TRACE_SCOPE("Document::Replace");
+  offset = std::min(offset, text_.size());
+  length = std::min(length, text_.size() - offset);
+  size_t old_end = offset + length;
+  auto delta = static_cast<std::ptrdiff_t>(text.size()) - static_cast<std::ptrdiff_t>(length);
+  auto line_delta = static_cast<int>(std::count(text.begin(), text.end(), '\n') -
+                                     std::count(text_.begin() + offset, text_.begin() + old_end, '\n'));
+
+  // The statements from the one holding the edit on are split again, starting where it starts
+  auto ends_after = [](size_t position, const Span &span) { return position < span.end_; };
+  size_t first = std::upper_bound(spans_.begin(), spans_.end(), offset, ends_after) - spans_.begin();
+  size_t next = std::upper_bound(spans_.begin(), spans_.end(), old_end, ends_after) - spans_.begin();
+  // Text appended to tokens after the last semicolon continues them
+  if (first == statements_.size() && first > 0 &&
+      (statements_.back()->tokens_.empty() ||
+       statements_.back()->tokens_.back().GetType() != core::TokenType::SEMICOLON)) {
+    first--;
+  }
+  Span start;
+  if (first < spans_.size()) {
+    start = spans_[first];
+  } else if (!spans_.empty()) {
+    start = spans_.back();
+    Walk(text_, start.begin_, start.end_, start.line_, start.column_);
+    start.begin_ = start.end_;
+  }
+  text_.replace(offset, length, text);
+
+  // Stop at the first old boundary after the edit the lexer meets again, trying boundaries further and further on
+  // when a string opened by the edit runs past one
+  std::vector<std::unique_ptr<Statement>> parsed;
+  std::vector<Span> spans;
+  size_t stop = next;
+  for (size_t step = 1;; step *= 2) {
+    parsed.clear();
+    spans.clear();
+    if (stop >= statements_.size()) {
+      Split(start.begin_, text_.size(), start.line_, start.column_, parsed, spans);
+      stop = statements_.size();
+      break;
+    }
+    if (Split(start.begin_, spans_[stop].end_ + delta, start.line_, start.column_, parsed, spans)) {
+      stop++;
+      break;
+    }
+    stop += step;
+  }
+
+  std::vector<std::string> touched;
+  for (size_t i = first; i < stop; i++) {
+    touched.push_back(statements_[i]->target_);
+    Index(*statements_[i], false);
+  }
+  size_t count = parsed.size();
+  statements_.erase(statements_.begin() + first, statements_.begin() + stop);
+  statements_.insert(statements_.begin() + first, std::make_move_iterator(parsed.begin()),
+                     std::make_move_iterator(parsed.end()));
+  spans_.erase(spans_.begin() + first, spans_.begin() + stop);
+  spans_.insert(spans_.begin() + first, spans.begin(), spans.end());
+  AssignKeys(first, count);
+
+  // Move the statements after the edit; those on the line the edit ends on also move sideways
+  size_t reused = first + count;
+  for (size_t i = reused; i < spans_.size(); i++) {
+    spans_[i].begin_ += delta;
+    spans_[i].end_ += delta;
+    spans_[i].line_ += line_delta;
+  }
+  if (reused < spans_.size()) {
+    int reused_line = spans_[reused].line_;
+    int column_delta = GetColumn(spans_[reused].begin_) - spans_[reused].column_;
+    for (size_t i = reused; i < spans_.size() && spans_[i].line_ == reused_line; i++) {
+      spans_[i].column_ += column_delta;
+    }
+  }
+
+  StatementSet dirty;
+  for (size_t i = first; i < reused; i++) {
+    Parse(*statements_[i], spans_[i]);
+    Index(*statements_[i], true);
+    dirty.insert(statements_[i].get());
+  }
+  // The removed statements may have declared variables the later statements name
+  Statement probe;
+  probe.key_ = reused < statements_.size() ? statements_[reused]->key_ : UINT64_MAX;
+  for (const auto &name : touched) {
+    for (auto *names : {&assigners_, &readers_}) {
+      auto it = names->find(name);
+      if (it != names->end()) {
+        dirty.insert(it->second.lower_bound(&probe), it->second.end());
+      }
+    }
+  }
+  parsed_count_ = count;
+  checked_count_ = 0;
+  Propagate(std::move(dirty));
+}
+
+void Document::AssignKeys(size_t first, size_t count) {
+  uint64_t lower = first > 0 ? statements_[first - 1]->key_ : 0;
+  uint64_t upper =
+      first + count < statements_.size() ? statements_[first + count]->key_ : lower + (count + 1) * KEY_GAP;
+  uint64_t step = (upper - lower) / (count + 1);
+  if (step == 0) {
+    // Renumbering keeps the order, so the sets of statements stay sorted
+    for (size_t i = 0; i < statements_.size(); i++) {
+      statements_[i]->key_ = (i + 1) * KEY_GAP;
+    }
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    statements_[first + i]->key_ = lower + (i + 1) * step;
+  }
+}
+
+auto Document::Split(size_t begin, size_t end, int line, int column,
+                     std::vector<std::unique_ptr<Statement>> &statements, std::vector<Span> &spans) -> bool {
+  std::vector<core::Token> tokens;
+  {
+    // Parse reports the lexer errors of each statement
+    std::ostringstream ignored;
+    core::DiagnosticCapture capture(ignored);
+    lexer_.SetInput(text_.substr(begin, end - begin), line);
+    while (lexer_.HasNext()) {
+      auto token = lexer_.Next();
+      if (token) {
+        tokens.push_back(std::move(*token));
+      }
+    }
+  }
+
+  // Walk the text alongside the tokens to find their offsets
+  size_t offset = begin;
+  int cursor_line = line;
+  int cursor_column = column;
+  auto statement = std::make_unique<Statement>();
+  Span span{begin, end, line, column};
+  for (const auto &token : tokens) {
+    int token_line = token.GetLine();
+    int token_column = token_line == line ? column + token.GetColumn() - 1 : token.GetColumn();
+    while (offset < end && (cursor_line < token_line || (cursor_line == token_line && cursor_column < token_column))) {
+      Walk(text_, offset, offset + 1, cursor_line, cursor_column);
+      offset++;
+    }
+    int relative_line = token_line - span.line_ + 1;
+    int relative_column = token_line == span.line_ ? token_column - span.column_ + 1 : token_column;
+    statement->tokens_.emplace_back(token.GetType(), token.GetValue(), relative_line, relative_column);
+    Walk(text_, offset, offset + token.GetValue().size(), cursor_line, cursor_column);
+    offset += token.GetValue().size();
+
+    if (token.GetType() == core::TokenType::SEMICOLON) {
+      span.end_ = offset;
+      statements.push_back(std::move(statement));
+      spans.push_back(span);
+      statement = std::make_unique<Statement>();
+      span = {offset, end, cursor_line, cursor_column};
+    }
+  }
+
+  // What follows the last semicolon is a statement of its own unless it is blank
+  if (statement->tokens_.empty() && text_.find_first_not_of(" \t\r\n", offset) >= end) {
+    return offset == end && !statements.empty();
+  }
+  statements.push_back(std::move(statement));
+  spans.push_back(span);
+  return false;
+}
+
+void Document::Parse(Statement &statement, const Span &span) {
+  statement.ast_.reset();
+  statement.target_.clear();
+  statement.reads_.clear();
+  statement.parse_diagnostics_.clear();
+
+  std::ostringstream diagnostics;
+  {
+    core::DiagnosticCapture capture(diagnostics);
+    parser_.SetInput(text_.substr(span.begin_, span.end_ - span.begin_));
+    auto ast = parser_.Parse();
+    if (ast && ast->GetRoot() && !ast->GetRoot()->GetChildren().empty()) {
+      statement.ast_ = ast->GetRoot()->GetChildren().front();
+    }
+  }
+
+  std::istringstream lines(diagnostics.str());
+  std::string message;
+  while (std::getline(lines, message)) {
+    auto diagnostic = ToDiagnostic(message);
+    if (!diagnostic) {
+      // Without a position the message covers the statement
+      diagnostic.emplace();
+      diagnostic->message_ = message;
+      if (!statement.tokens_.empty()) {
+        diagnostic->line_ = statement.tokens_.front().GetLine();
+        diagnostic->column_ = statement.tokens_.front().GetColumn();
+        std::tie(diagnostic->end_line_, diagnostic->end_column_) = EndOf(statement.tokens_.back());
+      } else {
+        diagnostic->end_column_ = 2;
+      }
+    }
+    statement.parse_diagnostics_.push_back(std::move(*diagnostic));
+  }
+
+  // The tokens of a statement that does not parse still show the types of the variables they name
+  if (statement.ast_ && !statement.tokens_.empty() &&
+      statement.tokens_.front().GetType() == core::TokenType::IDENTIFIER) {
+    statement.target_ = statement.tokens_.front().GetValue();
+  }
+  for (size_t i = statement.target_.empty() ? 0 : 1; i < statement.tokens_.size(); i++) {
+    const auto &token = statement.tokens_[i];
+    if (token.GetType() == core::TokenType::IDENTIFIER &&
+        std::find(statement.reads_.begin(), statement.reads_.end(), token.GetValue()) == statement.reads_.end()) {
+      statement.reads_.push_back(token.GetValue());
+    }
+  }
+}
+
+void Document::Check(Statement &statement) {
+  checked_count_++;
+  statement.type_diagnostics_.clear();
+  statement.declared_ = core::Type::UNDEFINED;
+  statement.types_.assign(statement.tokens_.size(), core::Type::UNDEFINED);
+  for (size_t i = 0; i < statement.tokens_.size(); i++) {
+    const auto &token = statement.tokens_[i];
+    if (token.GetType() == core::TokenType::NUMBER) {
+      statement.types_[i] = core::Type::NUMBER;
+    } else if (token.GetType() == core::TokenType::STRING) {
+      statement.types_[i] = core::Type::STRING;
+    } else if (token.GetType() == core::TokenType::IDENTIFIER) {
+      statement.types_[i] = GetTypeBefore(token.GetValue(), statement.key_);
+    }
+  }
+
+  if (!statement.target_.empty()) {
+    // The checker sees just the declarations of the variables the statement names
+    semant::TypeChecker checker;
+    const auto &environment = checker.GetTypeEnvironment();
+    core::Type before = GetTypeBefore(statement.target_, statement.key_);
+    for (const auto &name : statement.reads_) {
+      core::Type type = GetTypeBefore(name, statement.key_);
+      if (type != core::Type::UNDEFINED && !IsStream(name)) {
+        environment->AddSymbol(name, type);
+      }
+    }
+    if (before != core::Type::UNDEFINED && !IsStream(statement.target_)) {
+      environment->AddSymbol(statement.target_, before);
+    }
+
+    std::ostringstream diagnostics;
+    {
+      core::DiagnosticCapture capture(diagnostics);
+      try {
+        checker.CheckStatement(statement.ast_);
+      } catch (const std::exception &e) {
+        core::Diagnostics() << e.what() << std::endl;
+      }
+    }
+    std::istringstream lines(diagnostics.str());
+    std::string message;
+    while (std::getline(lines, message)) {
+      statement.type_diagnostics_.push_back(message);
+    }
+
+    statement.types_.front() = environment->GetType(statement.target_);
+    if (before == core::Type::UNDEFINED) {
+      statement.declared_ = statement.types_.front();
+    }
+  }
+
+  if (statement.parse_diagnostics_.empty() && statement.type_diagnostics_.empty()) {
+    diagnosed_.erase(&statement);
+  } else {
+    diagnosed_.insert(&statement);
+  }
+}
+
+void Document::Propagate(StatementSet dirty) {
+  while (!dirty.empty()) {
+    Statement *statement = *dirty.begin();
+    dirty.erase(dirty.begin());
+    core::Type declared = statement->declared_;
+    Check(*statement);
+    if (statement->declared_ == declared) {
+      continue;
+    }
+    for (auto *names : {&assigners_, &readers_}) {
+      auto it = names->find(statement->target_);
+      if (it != names->end()) {
+        dirty.insert(it->second.upper_bound(statement), it->second.end());
+      }
+    }
+  }
+}
+
+void Document::Index(Statement &statement, bool add) {
+  auto update = [&](std::unordered_map<std::string, StatementSet> &names, const std::string &name) {
+    if (IsStream(name)) {
+      return;
+    }
+    if (add) {
+      names[name].insert(&statement);
+      return;
+    }
+    auto it = names.find(name);
+    it->second.erase(&statement);
+    if (it->second.empty()) {
+      names.erase(it);
+    }
+  };
+  if (!statement.target_.empty()) {
+    update(assigners_, statement.target_);
+  }
+  for (const auto &name : statement.reads_) {
+    update(readers_, name);
+  }
+  // Check adds the statement back once it knows its diagnostics
+  if (!add) {
+    diagnosed_.erase(&statement);
+  }
+}
+
+auto Document::FindDeclaration(const std::string &name, uint64_t key) const -> const Statement * {
+  auto it = assigners_.find(name);
+  if (it == assigners_.end()) {
+    return nullptr;
+  }
+  for (const auto *statement : it->second) {
+    if (statement->key_ >= key) {
+      break;
+    }
+    if (statement->declared_ != core::Type::UNDEFINED) {
+      return statement;
+    }
+  }
+  return nullptr;
+}
+
+auto Document::GetTypeBefore(const std::string &name, uint64_t key) const -> core::Type {
+  if (name == "stdin") {
+    return core::Type::IN_STREAM;
+  }
+  if (name == "stdout") {
+    return core::Type::OUT_STREAM;
+  }
+  const Statement *declaration = FindDeclaration(name, key);
+  return declaration != nullptr ? declaration->declared_ : core::Type::UNDEFINED;
+}
+
+auto Document::IndexOf(const Statement &statement) const -> size_t {
+  auto before = [](const std::unique_ptr<Statement> &left, uint64_t key) { return left->key_ < key; };
+  return std::lower_bound(statements_.begin(), statements_.end(), statement.key_, before) - statements_.begin();
+}
+
+auto Document::GetColumn(size_t offset) const -> int {
+  size_t line_start = offset == 0 ? std::string::npos : text_.rfind('\n', offset - 1);
+  return static_cast<int>(offset - (line_start == std::string::npos ? 0 : line_start + 1)) + 1;
+}
+
+auto Document::FindStatement(int line, int column) const -> size_t {
+  auto starts_after = [](std::pair<int, int> position, const Span &span) {
+    return position < std::make_pair(span.line_, span.column_);
+  };
+  size_t index =
+      std::upper_bound(spans_.begin(), spans_.end(), std::make_pair(line, column), starts_after) - spans_.begin();
+  return index == 0 ? spans_.size() : index - 1;
+}
+
+auto Document::FindToken(size_t index, int line, int column) const -> size_t {
+  const Span &span = spans_[index];
+  const auto &tokens = statements_[index]->tokens_;
+  std::pair<int, int> position{line - span.line_ + 1, column};
+  if (position.first == 1) {
+    position.second = column - span.column_ + 1;
+  }
+  for (size_t i = 0; i < tokens.size(); i++) {
+    if (tokens[i].GetPosition() <= position && position < EndOf(tokens[i])) {
+      return i;
+    }
+  }
+  return tokens.size();
+}
+
+auto Document::ToDocument(const Span &span, const core::Token &token) -> core::Token {
+  int line = span.line_ + token.GetLine() - 1;
+  int column = token.GetLine() == 1 ? span.column_ + token.GetColumn() - 1 : token.GetColumn();
+  return {token.GetType(), token.GetValue(), line, column};
+}
+
+auto Document::GetOffset(int line, int column) const -> size_t {
+  size_t index = FindStatement(line, column);
+  size_t offset = 0;
+  int cursor_line = 1;
+  int cursor_column = 1;
+  if (index < spans_.size()) {
+    offset = spans_[index].begin_;
+    cursor_line = spans_[index].line_;
+    cursor_column = spans_[index].column_;
+  }
+  while (offset < text_.size() && (cursor_line < line || (cursor_line == line && cursor_column < column))) {
+    if (cursor_line == line && text_[offset] == '\n') {
+      break;
+    }
+    Walk(text_, offset, offset + 1, cursor_line, cursor_column);
+    offset++;
+  }
+  return offset;
+}
+
+auto Document::GetDiagnostics() const -> std::vector<Diagnostic> {
+  std::vector<Diagnostic> diagnostics;
+  for (const auto *statement : diagnosed_) {
+    const Span &span = spans_[IndexOf(*statement)];
+    auto to_document = [&](int &line, int &column) {
+      column = line == 1 ? span.column_ + column - 1 : column;
+      line = span.line_ + line - 1;
+    };
+    for (auto diagnostic : statement->parse_diagnostics_) {
+      to_document(diagnostic.line_, diagnostic.column_);
+      to_document(diagnostic.end_line_, diagnostic.end_column_);
+      diagnostics.push_back(std::move(diagnostic));
+    }
+    for (const auto &message : statement->type_diagnostics_) {
+      Diagnostic diagnostic;
+      diagnostic.line_ = statement->tokens_.front().GetLine();
+      diagnostic.column_ = statement->tokens_.front().GetColumn();
+      std::tie(diagnostic.end_line_, diagnostic.end_column_) = EndOf(statement->tokens_.back());
+      to_document(diagnostic.line_, diagnostic.column_);
+      to_document(diagnostic.end_line_, diagnostic.end_column_);
+      diagnostic.message_ = message;
+      diagnostics.push_back(std::move(diagnostic));
+    }
+  }
+  return diagnostics;
+}
+
+auto Document::GetSymbol(int line, int column) const -> std::optional<Symbol> {
+  size_t index = FindStatement(line, column);
+  if (index == statements_.size()) {
+    return std::nullopt;
+  }
+  const Statement &statement = *statements_[index];
+  size_t token = FindToken(index, line, column);
+  if (token == statement.tokens_.size()) {
+    return std::nullopt;
+  }
+  return Symbol{ToDocument(spans_[index], statement.tokens_[token]), statement.types_[token]};
+}
+
+auto Document::GetDefinition(int line, int column) const -> std::optional<core::Token> {
+  size_t index = FindStatement(line, column);
+  if (index == statements_.size()) {
+    return std::nullopt;
+  }
+  const Statement &statement = *statements_[index];
+  size_t token = FindToken(index, line, column);
+  if (token == statement.tokens_.size() || statement.tokens_[token].GetType() != core::TokenType::IDENTIFIER) {
+    return std::nullopt;
+  }
+  const std::string &name = statement.tokens_[token].GetValue();
+  const Statement *declaration = FindDeclaration(name, statement.key_);
+  if (declaration == nullptr && token == 0 && statement.declared_ != core::Type::UNDEFINED) {
+    declaration = &statement;
+  }
+  if (declaration == nullptr) {
+    return std::nullopt;
+  }
+  return ToDocument(spans_[IndexOf(*declaration)], declaration->tokens_.front());
+}
+
+}  // namespace scp::lsp
@@ -0,0 +1,248 @@
+#include "lsp/language_server.h"
+
+#include <cstddef>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "core/token.h"
+#include "core/trace.h"
+#include "core/type.h"
+
+namespace scp::lsp {
+
+namespace {
+
+/* JSON-RPC error codes */
+constexpr int PARSE_ERROR = -32700;
+constexpr int INVALID_PARAMS = -32602;
+constexpr int METHOD_NOT_FOUND = -32601;
+
+/* Messages longer than this are rejected rather than allocated */
+constexpr size_t MAX_CONTENT_LENGTH = 64U << 20;
+
+// Parse the value of a Content-Length header, std::nullopt unless it is a number up to MAX_CONTENT_LENGTH
+auto ParseContentLength(const std::string &value) -> std::optional<size_t> {
+  size_t begin = value.find_first_not_of(" \t");
+  size_t end = value.find_last_not_of(" \t");
+  if (begin == std::string::npos) {
+    return std::nullopt;
+  }
+  size_t length = 0;
+  for (size_t i = begin; i <= end; i++) {
+    if (value[i] < '0' || value[i] > '9') {
+      return std::nullopt;
+    }
+    length = length * 10 + static_cast<size_t>(value[i] - '0');
+    if (length > MAX_CONTENT_LENGTH) {
+      return std::nullopt;
+    }
+  }
+  return length;
+}
+
+// Get a member of an object as an integer, -1 if it is missing
+auto GetInt(const core::JsonValue *object, const std::string &key) -> int {
+  const core::JsonValue *value = object != nullptr ? object->Find(key) : nullptr;
+  return value != nullptr && value->GetKind() == core::JsonValue::Kind::NUMBER ? static_cast<int>(value->AsNumber())
+                                                                               : -1;
+}
+
+// Get a member of an object as a string, empty if it is missing
+auto GetString(const core::JsonValue *object, const std::string &key) -> std::string {
+  const core::JsonValue *value = object != nullptr ? object->Find(key) : nullptr;
+  return value != nullptr ? value->AsString() : "";
+}
+
+// Format a 1-based line and column as an LSP position
+auto ToPosition(int line, int column) -> std::string {
+  return "{\"line\": " + std::to_string(line - 1) + ", \"character\": " + std::to_string(column - 1) + "}";
+}
+
+// Format the range a token covers
+auto ToRange(const core::Token &token) -> std::string {
+  return "{\"start\": " + ToPosition(token.GetLine(), token.GetColumn()) +
+         ", \"end\": " + ToPosition(token.GetLine(), token.GetColumn() + static_cast<int>(token.GetValue().size())) +
+         "}";
+}
+
+}  // namespace
+
+LanguageServer::LanguageServer(std::istream &input, std::ostream &output) : input_(input), output_(output) {}
+
+auto LanguageServer::Serve() -> int {
+  std::string content;
+  while (Read(content)) {
+    core::JsonValue message;
+    try {
+      message = core::JsonValue::Parse(content);
+    } catch (const std::exception &e) {
+      ReplyError("null", PARSE_ERROR, e.what());
+      continue;
+    }
+    if (!Handle(message)) {
+      return shutdown_ ? 0 : 1;
+    }
+  }
+  return 1;
+}
+
+auto LanguageServer::Read(std::string &content) -> bool {
+  size_t length = 0;
+  bool has_length = false;
+  std::string header;
+  while (std::getline(input_, header)) {
+    if (!header.empty() && header.back() == '\r') {
+      header.pop_back();
+    }
+    if (header.empty()) {
+      if (!has_length) {
+        continue;  // Blank lines between messages
+      }
+      content.resize(length);
+      input_.read(content.data(), static_cast<std::streamsize>(length));
+      return static_cast<size_t>(input_.gcount()) == length;
+    }
+    // After a malformed header the content that follows is skipped line by line, and the next header may then
+    // directly follow the skipped content on the same line
+    static const std::string CONTENT_LENGTH = "Content-Length:";
+    size_t at = has_length ? 0 : header.find(CONTENT_LENGTH);
+    if (at != std::string::npos && header.compare(at, CONTENT_LENGTH.size(), CONTENT_LENGTH) == 0) {
+      auto parsed = ParseContentLength(header.substr(at + CONTENT_LENGTH.size()));
+      if (!parsed) {
+        ReplyError("null", PARSE_ERROR, "Malformed Content-Length header: " + header.substr(at));
+        has_length = false;
+        continue;
+      }
+      length = *parsed;
+      has_length = true;
+    }
+  }
+  return false;
+}
+
+void LanguageServer::Send(const std::string &content) {
+  output_ << "Content-Length: " << content.size() << "\r\n\r\n" << content << std::flush;
+}
+
+void LanguageServer::Reply(const std::string &id, const std::string &result) {
+  Send("{\"jsonrpc\": \"2.0\", \"id\": " + id + ", \"result\": " + result + "}");
+}
+
+void LanguageServer::ReplyError(const std::string &id, int code, const std::string &message) {
+  Send("{\"jsonrpc\": \"2.0\", \"id\": " + id + ", \"error\": {\"code\": " + std::to_string(code) +
+       ", \"message\": " + core::JsonQuote(message) + "}}");
+}
+
+void LanguageServer::Publish(const std::string &uri) {
+  std::ostringstream out;
+  out << "{\"jsonrpc\": \"2.0\", \"method\": \"textDocument/publishDiagnostics\", \"params\": {\"uri\": "
+      << core::JsonQuote(uri) << ", \"diagnostics\": [";
+  auto it = documents_.find(uri);
+  if (it != documents_.end()) {
+    bool first = true;
+    for (const auto &diagnostic : it->second->GetDiagnostics()) {
+      out << (first ? "" : ", ") << "{\"range\": {\"start\": " << ToPosition(diagnostic.line_, diagnostic.column_)
+          << ", \"end\": " << ToPosition(diagnostic.end_line_, diagnostic.end_column_)
+          << "}, \"severity\": 1, \"source\": \"scp\", \"message\": " << core::JsonQuote(diagnostic.message_) << "}";
+      first = false;
+    }
+  }
+  out << "]}}";
+  Send(out.str());
+}
+
+auto LanguageServer::FindDocument(const core::JsonValue *params) const -> const Document * {
+  std::string uri = GetString(params != nullptr ? params->Find("textDocument") : nullptr, "uri");
+  auto it = documents_.find(uri);
+  return it != documents_.end() ? it->second.get() : nullptr;
+}
+
+auto LanguageServer::Handle(const core::JsonValue &message) -> bool {
+  SCP_TRACE_SCOPE("LanguageServer::Handle");
+  std::string method = GetString(&message, "method");
+  const core::JsonValue *params = message.Find("params");
+  const core::JsonValue *id_value = message.Find("id");
+  std::string id = "null";
+  if (id_value != nullptr && id_value->GetKind() == core::JsonValue::Kind::NUMBER) {
+    id = std::to_string(static_cast<long long>(id_value->AsNumber()));
+  } else if (id_value != nullptr && id_value->GetKind() == core::JsonValue::Kind::STRING) {
+    id = core::JsonQuote(id_value->AsString());
+  }
+
+  if (method == "initialize") {
+    Reply(id,
+          "{\"capabilities\": {\"textDocumentSync\": {\"openClose\": true, \"change\": 2}, \"hoverProvider\": true, "
+          "\"definitionProvider\": true}, \"serverInfo\": {\"name\": \"scp-lsp\"}}");
+  } else if (method == "shutdown") {
+    shutdown_ = true;
+    Reply(id, "null");
+  } else if (method == "exit") {
+    return false;
+  } else if (method == "textDocument/didOpen") {
+    const core::JsonValue *document = params != nullptr ? params->Find("textDocument") : nullptr;
+    std::string uri = GetString(document, "uri");
+    documents_[uri] = std::make_unique<Document>(GetString(document, "text"));
+    Publish(uri);
+  } else if (method == "textDocument/didChange") {
+    std::string uri = GetString(params != nullptr ? params->Find("textDocument") : nullptr, "uri");
+    const core::JsonValue *changes = params != nullptr ? params->Find("contentChanges") : nullptr;
+    auto it = documents_.find(uri);
+    if (it == documents_.end() || changes == nullptr) {
+      return true;
+    }
+    Document &document = *it->second;
+    for (const auto &change : changes->AsArray()) {
+      const core::JsonValue *range = change.Find("range");
+      if (range == nullptr) {
+        document.SetText(GetString(&change, "text"));
+        continue;
+      }
+      const core::JsonValue *start = range->Find("start");
+      const core::JsonValue *end = range->Find("end");
+      size_t begin = document.GetOffset(GetInt(start, "line") + 1, GetInt(start, "character") + 1);
+      size_t finish = document.GetOffset(GetInt(end, "line") + 1, GetInt(end, "character") + 1);
+      document.Replace(begin, finish > begin ? finish - begin : 0, GetString(&change, "text"));
+    }
+    Publish(uri);
+  } else if (method == "textDocument/didClose") {
+    std::string uri = GetString(params != nullptr ? params->Find("textDocument") : nullptr, "uri");
+    documents_.erase(uri);
+    Publish(uri);
+  } else if (method == "textDocument/hover" || method == "textDocument/definition") {
+    const Document *document = FindDocument(params);
+    const core::JsonValue *position = params != nullptr ? params->Find("position") : nullptr;
+    if (document == nullptr || position == nullptr) {
+      ReplyError(id, INVALID_PARAMS, "No open document at " + method);
+      return true;
+    }
+    int line = GetInt(position, "line") + 1;
+    int column = GetInt(position, "character") + 1;
+    if (method == "textDocument/hover") {
+      auto symbol = document->GetSymbol(line, column);
+      if (!symbol || (symbol->token_.GetType() != core::TokenType::IDENTIFIER &&
+                      symbol->type_ == core::Type::UNDEFINED)) {
+        Reply(id, "null");
+        return true;
+      }
+      std::string text = symbol->token_.GetType() == core::TokenType::IDENTIFIER
+                             ? symbol->token_.GetValue() + ": " + core::TypeToString(symbol->type_)
+                             : core::TypeToString(symbol->type_);
+      Reply(id, "{\"contents\": {\"kind\": \"plaintext\", \"value\": " + core::JsonQuote(text) +
+                    "}, \"range\": " + ToRange(symbol->token_) + "}");
+    } else {
+      auto definition = document->GetDefinition(line, column);
+      std::string uri = GetString(params->Find("textDocument"), "uri");
+      Reply(id, definition ? "{\"uri\": " + core::JsonQuote(uri) + ", \"range\": " + ToRange(*definition) + "}"
+                           : "null");
+    }
+  } else if (id_value != nullptr) {
+    ReplyError(id, METHOD_NOT_FOUND, "Unknown method: " + method);
+  }
+  // Other notifications, such as initialized, need no answer
+  return true;
+}
+
+}  // namespace scp::lsp
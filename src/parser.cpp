@@ -2,16 +2,18 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "core/ast.h"
 #include "parser/ll1_parser.h"
 #include "parser/slr_parser.h"
 
 /**
- * Print the Abstract Syntax Tree (AST).
- * @param node The root node of the AST.
- * @param depth The current depth in the tree (for indentation).
+ * Print one line of the Abstract Syntax Tree (AST).
+ * @param node The node, or nullptr.
+ * @param depth The depth of the node in the tree (for indentation).
  */
-void PrintAST(const std::shared_ptr<scp::core::AST::ASTNode> &node, int depth = 0) {
+void PrintASTNode(const scp::core::AST::ASTNode *node, int depth) {
   if (!node) {
     for (int i = 0; i < depth; ++i) {
       std::cout << "  ";
@@ -49,9 +51,26 @@ void PrintAST(const std::shared_ptr<scp::core::AST::ASTNode> &node, int depth =
       break;
   }
   std::cout << ", Value: '" << node->GetValue() << "'" << std::endl;
+}
 
-  for (const auto &child : node->GetChildren()) {
-    PrintAST(child, depth + 1);
+/**
+ * Print the Abstract Syntax Tree (AST).
+ * @param root The root node of the AST.
+ * @param depth The depth of the root (for indentation).
+ */
+void PrintAST(const std::shared_ptr<scp::core::AST::ASTNode> &root, int depth = 0) {
+  // An explicit stack of the nodes to print with their depths, so deeply nested expressions cannot overflow it
+  std::vector<std::pair<const scp::core::AST::ASTNode *, int>> pending = {{root.get(), depth}};
+  while (!pending.empty()) {
+    auto [node, node_depth] = pending.back();
+    pending.pop_back();
+    PrintASTNode(node, node_depth);
+    if (node != nullptr) {
+      const auto &children = node->GetChildren();
+      for (auto child = children.rbegin(); child != children.rend(); ++child) {
+        pending.emplace_back(child->get(), node_depth + 1);
+      }
+    }
   }
 }
 
@@ -1,20 +1,22 @@
 #include "parser/ll1_parser.h"
 
+#include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <stack>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "constant/ast_constant.h"
 #include "constant/error_messages.h"
 #include "core/ast.h"
+#include "core/diagnostics.h"
 #include "core/token.h"
+#include "core/trace.h"
 
 namespace scp::parser {
 
@@ -25,7 +27,7 @@ namespace scp::parser {
  * @param terminals The set of terminal symbols.
  * @return True if the symbol is a terminal, false otherwise.
  */
-auto IsTerminal(const std::string &symbol, const std::unordered_set<std::string> &terminals) -> bool {
+auto IsTerminal(const std::string &symbol, const core::FlatHashSet<std::string> &terminals) -> bool {
   return terminals.find(symbol) != terminals.end();
 }
 
@@ -120,6 +122,7 @@ void LL1Parser::Init() {
 }
 
 auto LL1Parser::Parse() -> std::shared_ptr<core::AST> {
+  SCP_TRACE_SCOPE("LL1Parser::Parse");
   lexer_.Reset();
   // Reset parser stack to initial state
   parse_stack_ = {};
@@ -144,7 +147,7 @@ auto LL1Parser::Parse() -> std::shared_ptr<core::AST> {
       } else {
         std::optional<core::Token> token_opt = lexer_.Next();
         if (!token_opt.has_value()) {
-          std::cerr << constant::ErrorMessages::FAIL_TO_GET_NEXT_TOKEN << std::endl;
+          core::Diagnostics() << constant::ErrorMessages::FAIL_TO_GET_NEXT_TOKEN << std::endl;
           return nullptr;
         }
         current_token = token_opt.value();
@@ -163,14 +166,14 @@ auto LL1Parser::Parse() -> std::shared_ptr<core::AST> {
         parse_stack_.pop();
         token_consumed = true;
       } else {
-        std::cerr << constant::ErrorMessages::ParsingError(current_symbol, current_token) << std::endl;
+        core::Diagnostics() << constant::ErrorMessages::ParsingError(current_symbol, current_token) << std::endl;
         return nullptr;
       }
     } else {
       // Non-terminal processing
       auto non_terminal_it = parse_table_.find(current_symbol);
       if (non_terminal_it == parse_table_.end()) {
-        std::cerr << constant::ErrorMessages::NoEntriesInParseTable(current_symbol) << std::endl;
+        core::Diagnostics() << constant::ErrorMessages::NoEntriesInParseTable(current_symbol) << std::endl;
         return nullptr;
       }
 
@@ -183,7 +186,8 @@ auto LL1Parser::Parse() -> std::shared_ptr<core::AST> {
       }
 
       if (production_it == non_terminal_it->second.end()) {
-        std::cerr << constant::ErrorMessages::NoProductionRuleForSymbol(current_symbol, token_string) << std::endl;
+        core::Diagnostics() << constant::ErrorMessages::NoProductionRuleForSymbol(current_symbol, token_string)
+                            << std::endl;
         return nullptr;
       }
 
@@ -214,19 +218,19 @@ auto LL1Parser::Parse() -> std::shared_ptr<core::AST> {
 
   // Check if parsing completed successfully
   if (parse_stack_.empty() || parse_stack_.top().first != constant::ASTConstant::END_NODE_VALUE) {
-    std::cerr << constant::ErrorMessages::UNEXPECTED_END_OF_PARSING;
+    core::Diagnostics() << constant::ErrorMessages::UNEXPECTED_END_OF_PARSING;
     if (parse_stack_.empty()) {
-      std::cerr << "empty";
+      core::Diagnostics() << "empty";
     } else {
-      std::cerr << "top = '" << parse_stack_.top().first << "'";
+      core::Diagnostics() << "top = '" << parse_stack_.top().first << "'";
     }
-    std::cerr << std::endl;
+    core::Diagnostics() << std::endl;
     return nullptr;
   }
 
-  // Check if all tokens consumed
-  if (lexer_.HasNext()) {
-    std::cerr << constant::ErrorMessages::INPUT_NOT_FULLY_CONSUMED << std::endl;
+  // Check if all tokens consumed, including a lookahead the ε fallback above left unconsumed
+  if ((!token_consumed && current_token.GetType() != core::TokenType::END_OF_FILE) || lexer_.HasNext()) {
+    core::Diagnostics() << constant::ErrorMessages::INPUT_NOT_FULLY_CONSUMED << std::endl;
     return nullptr;
   }
 
@@ -291,6 +295,7 @@ auto LL1Parser::HasParseTableEntry(const std::string &nonTerminal, const std::st
 }
 
 auto LL1Parser::BuildAST(const std::shared_ptr<core::TreeNode> &parse_tree) -> std::shared_ptr<core::AST> {
+  SCP_TRACE_SCOPE("BuildAST");
   if (!parse_tree) {
     return nullptr;
   }
@@ -351,15 +356,9 @@ auto LL1Parser::TransformToASTNode(const std::shared_ptr<core::TreeNode> &parse_
   if (symbol == "Statement") {
     return TransformStatement(parse_node);
   }
-  if (symbol == "Expression") {
+  if (symbol == "Expression" || symbol == "Term" || symbol == "Factor") {
     return TransformExpression(parse_node);
   }
-  if (symbol == "Term") {
-    return TransformTerm(parse_node);
-  }
-  if (symbol == "Factor") {
-    return TransformFactor(parse_node);
-  }
 
   // Default case - create a generic node
   auto ast_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::ROOT, symbol);
@@ -415,15 +414,19 @@ auto LL1Parser::TransformProgram(const std::shared_ptr<core::TreeNode> &parse_no
 void LL1Parser::CollectStatements(const std::shared_ptr<core::TreeNode> &parse_node,
                                   const std::shared_ptr<core::AST::ASTNode> &root) {
   // StatementList -> Statement StatementList | ε
-  for (const auto &child : parse_node->children_) {
+  // An explicit stack rather than recursion, since the list nests once per statement
+  std::vector<std::shared_ptr<core::TreeNode>> pending(parse_node->children_.rbegin(), parse_node->children_.rend());
+  while (!pending.empty()) {
+    auto child = std::move(pending.back());
+    pending.pop_back();
     if (child->val_ == "Statement") {
       auto stmt_node = TransformToASTNode(child);
       if (stmt_node) {
         root->AddChild(stmt_node);
       }
     } else if (child->val_ == "StatementList") {
-      // Recursively process nested StatementList
-      CollectStatements(child, root);
+      // Nested StatementList, its children are processed before the remaining siblings
+      pending.insert(pending.end(), child->children_.rbegin(), child->children_.rend());
     }
   }
 }
@@ -468,121 +471,91 @@ auto LL1Parser::TransformStatement(const std::shared_ptr<core::TreeNode> &parse_
 
 auto LL1Parser::TransformExpression(const std::shared_ptr<core::TreeNode> &parse_node)
     -> std::shared_ptr<core::AST::ASTNode> {
-  // Expression -> Term Expression'
-  // We need to handle left-associative operators properly
-
-  std::shared_ptr<core::AST::ASTNode> left_operand = nullptr;
-  std::shared_ptr<core::AST::ASTNode> expression_prime = nullptr;
-
-  for (const auto &child : parse_node->children_) {
-    if (child->val_ == "Term") {
-      left_operand = TransformToASTNode(child);
-    } else if (child->val_ == "Expression'") {
-      expression_prime = TransformExpressionPrime(child, left_operand);
-    }
-  }
-
-  return expression_prime ? expression_prime : left_operand;
-}
-
-auto LL1Parser::TransformExpressionPrime(const std::shared_ptr<core::TreeNode> &parse_node,
-                                         std::shared_ptr<core::AST::ASTNode> left_operand)
-    -> std::shared_ptr<core::AST::ASTNode> {
-  // Expression' -> plus Term Expression' | ε
-
-  if (parse_node->children_.empty()) {
-    // ε production - return the left operand as is
-    return left_operand;
-  }
-
-  std::shared_ptr<core::AST::ASTNode> operator_node = nullptr;
-  std::shared_ptr<core::AST::ASTNode> right_operand = nullptr;
-  std::shared_ptr<core::AST::ASTNode> rest_expression = nullptr;
-
-  // Children order: index 0='+', index 1='Term', index 2='Expression''
-  int child_count = 0;
-  for (const auto &child : parse_node->children_) {
-    if (child_count == 0 && child->val_ == "+") {
-      operator_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::PLUS, "+");
-    } else if (child_count == 1 && child->val_ == "Term") {
-      right_operand = TransformToASTNode(child);
-    } else if (child_count == 2 && child->val_ == "Expression'") {
-      // Create binary operation node first
-      if (operator_node && left_operand && right_operand) {
-        operator_node->AddChild(left_operand);
-        operator_node->AddChild(right_operand);
-        rest_expression = TransformExpressionPrime(child, operator_node);
+  // Expression -> Term Expression', Expression' -> plus Term Expression' | ε
+  // Term -> Factor Term', Term' -> times Factor Term' | ε
+  // Factor -> identifier | number | string | left_paren Expression right_paren
+  // The parse tree nests once per operator and parenthesis, so the walk keeps explicit stacks of the parse nodes to
+  // visit and of the operands built rather than recursing. The operators are left-associative: the top operand is
+  // the left operand of the next Expression' or Term', which is visited again to combine it with its right operand.
+  std::vector<std::pair<std::shared_ptr<core::TreeNode>, bool>> pending = {{parse_node, false}};
+  std::vector<std::shared_ptr<core::AST::ASTNode>> operands;
+  auto child_at = [](const std::shared_ptr<core::TreeNode> &node, size_t index) -> std::shared_ptr<core::TreeNode> {
+    return node->children_.size() > index ? *std::next(node->children_.begin(), index) : nullptr;
+  };
+  while (!pending.empty()) {
+    auto [node, combine] = std::move(pending.back());
+    pending.pop_back();
+    const std::string &symbol = node->val_;
+
+    if (symbol == "Expression" || symbol == "Term") {
+      // The operand, then the rest of the chain
+      auto operand = child_at(node, 0);
+      auto rest = child_at(node, 1);
+      std::string operand_symbol = symbol == "Expression" ? "Term" : "Factor";
+      std::string rest_symbol = symbol + "'";
+      if (rest && rest->val_ == rest_symbol) {
+        pending.emplace_back(rest, false);
       }
-    }
-    child_count++;
-  }
-
-  return rest_expression ? rest_expression : (operator_node ? operator_node : left_operand);
-}
-
-auto LL1Parser::TransformTerm(const std::shared_ptr<core::TreeNode> &parse_node)
-    -> std::shared_ptr<core::AST::ASTNode> {
-  // Term -> Factor Term'
-
-  std::shared_ptr<core::AST::ASTNode> left_operand = nullptr;
-  std::shared_ptr<core::AST::ASTNode> term_prime = nullptr;
-
-  for (const auto &child : parse_node->children_) {
-    if (child->val_ == "Factor") {
-      left_operand = TransformToASTNode(child);
-    } else if (child->val_ == "Term'") {
-      term_prime = TransformTermPrime(child, left_operand);
-    }
-  }
-
-  return term_prime ? term_prime : left_operand;
-}
-
-auto LL1Parser::TransformTermPrime(const std::shared_ptr<core::TreeNode> &parse_node,
-                                   std::shared_ptr<core::AST::ASTNode> left_operand)
-    -> std::shared_ptr<core::AST::ASTNode> {
-  // Term' -> times Factor Term' | ε
-
-  if (parse_node->children_.empty()) {
-    // ε production - return the left operand as is
-    return left_operand;
-  }
-
-  std::shared_ptr<core::AST::ASTNode> operator_node = nullptr;
-  std::shared_ptr<core::AST::ASTNode> right_operand = nullptr;
-  std::shared_ptr<core::AST::ASTNode> rest_term = nullptr;
-
-  // Children order: index 0='*', index 1='Factor', index 2='Term''
-  int child_count = 0;
-  for (const auto &child : parse_node->children_) {
-    if (child_count == 0 && child->val_ == "*") {
-      operator_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::TIMES, "*");
-    } else if (child_count == 1 && child->val_ == "Factor") {
-      right_operand = TransformToASTNode(child);
-    } else if (child_count == 2 && child->val_ == "Term'") {
-      // Create binary operation node first
-      if (operator_node && left_operand && right_operand) {
+      if (operand && operand->val_ == operand_symbol) {
+        pending.emplace_back(operand, false);
+      } else {
+        operands.push_back(nullptr);
+      }
+    } else if (symbol == "Expression'" || symbol == "Term'") {
+      if (node->children_.empty()) {
+        continue;  // ε production - the left operand stays as is
+      }
+      bool is_plus = symbol == "Expression'";
+      // Children order: index 0 = the operator, index 1 = the operand, index 2 = the rest of the chain
+      auto operand = child_at(node, 1);
+      if (!combine) {
+        pending.emplace_back(node, true);
+        if (operand && operand->val_ == (is_plus ? "Term" : "Factor")) {
+          pending.emplace_back(operand, false);
+        } else {
+          operands.push_back(nullptr);
+        }
+        continue;
+      }
+      auto right_operand = std::move(operands.back());
+      operands.pop_back();
+      auto left_operand = std::move(operands.back());
+      operands.pop_back();
+      std::shared_ptr<core::AST::ASTNode> operator_node = nullptr;
+      if (child_at(node, 0)->val_ == (is_plus ? "+" : "*")) {
+        operator_node = is_plus ? std::make_shared<core::AST::ASTNode>(core::ASTNodeType::PLUS, "+")
+                                : std::make_shared<core::AST::ASTNode>(core::ASTNodeType::TIMES, "*");
+      }
+      auto rest = child_at(node, 2);
+      if (operator_node && left_operand && right_operand && rest && rest->val_ == symbol) {
+        // Create binary operation node first
         operator_node->AddChild(left_operand);
         operator_node->AddChild(right_operand);
-        rest_term = TransformTermPrime(child, operator_node);
+        pending.emplace_back(rest, false);
       }
+      operands.push_back(operator_node ? operator_node : left_operand);
+    } else if (symbol == "Factor") {
+      // For parenthesized expressions, the expression stands for the factor
+      auto expression = std::find_if(node->children_.begin(), node->children_.end(),
+                                     [](const auto &child) { return child->val_ == "Expression"; });
+      if (expression != node->children_.end()) {
+        pending.emplace_back(*expression, false);
+      } else {
+        operands.push_back(TransformFactor(node));
+      }
+    } else {
+      operands.push_back(TransformToASTNode(node));
     }
-    child_count++;
   }
-
-  return rest_term ? rest_term : (operator_node ? operator_node : left_operand);
+  return operands.back();
 }
 
 auto LL1Parser::TransformFactor(const std::shared_ptr<core::TreeNode> &parse_node)
     -> std::shared_ptr<core::AST::ASTNode> {
-  // Factor -> identifier | number | string | left_paren Expression right_paren
+  // Factor -> identifier | number | string, a parenthesized Expression is walked by TransformExpression
 
   // Check each child to find the meaningful content
   for (const auto &child : parse_node->children_) {
-    if (child->val_ == "Expression") {
-      // For parenthesized expressions, just return the expression node
-      return TransformToASTNode(child);
-    }
     if (child->children_.empty() && !child->val_.empty()) {
       // This is a leaf node with actual value
       // Determine type based on content
@@ -1,182 +1,346 @@
 #include "parser/slr_parser.h"
 
+#include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <istream>
 #include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "constant/ast_constant.h"
 #include "constant/error_messages.h"
 #include "core/ast.h"
+#include "core/diagnostics.h"
 #include "core/token.h"
+#include "core/trace.h"
 
 namespace scp::parser {
 
-void SLRParser::SetInput(const std::string &input) { lexer_.SetInput(input); }
+void SLRParser::SetInput(const std::string &input, int first_line) {
+  lexer_.SetInput(input, first_line);
+  tokens_.clear();
+  lexed_ = false;
+}
+
+auto SLRParser::Lex() -> bool {
+  SCP_TRACE_SCOPE("Lex");
+  lexer_.Reset();
+  tokens_.clear();
+  lexed_ = false;
+  while (lexer_.HasNext()) {
+    auto token = lexer_.Next();
+    if (!token) {
+      return false;
+    }
+    tokens_.push_back(*token);
+  }
+  lexed_ = true;
+  return true;
+}
+
+auto SLRParser::HasNextToken() const -> bool {
+  if (lexer_thread_.joinable()) {
+    // A failed lexer still has a token, whose Next reports the error
+    return token_ring_->Front().has_value() || !token_ring_->GetDiagnostics().empty();
+  }
+  return lexed_ ? next_token_ < tokens_.size() : lexer_.HasNext();
+}
+
+auto SLRParser::NextToken() -> std::optional<core::Token> {
+  if (lexed_) {
+    return next_token_ < tokens_.size() ? std::optional<core::Token>(tokens_[next_token_++]) : std::nullopt;
+  }
+  if (lexer_thread_.joinable()) {
+    auto token = token_ring_->Pop();
+    if (token) {
+      streamed_token_count_++;
+    } else {
+      core::Diagnostics() << token_ring_->GetDiagnostics();
+    }
+    return token;
+  }
+  auto token = lexer_.Next();
+  if (token) {
+    streamed_token_count_++;
+  }
+  return token;
+}
 
 void SLRParser::Init() {
-  symbols_ = {"Program", "StatementList", "Statement", "Expression", "Term", "Factor"};
-  terminals_ = {"identifier", "number", "left_paren", "right_paren", "plus",
-                "times",      "assign", "semicolon",  "$",           "string"};
-  symbols_.insert(terminals_.begin(), terminals_.end());
   slr_stack_ = {};
   slr_stack_.push({constant::ASTConstant::ROOT_NODE_VALUE, nullptr, 0});
+}
+
+auto SLRParser::GetTables() -> const Tables & {
+  // Built once on first use; C++ guarantees the initialization is thread-safe
+  static const Tables tables = BuildTables();
+  return tables;
+}
+
+auto SLRParser::BuildTables() -> Tables {
+  Tables tables;
+  tables.symbols_ = {"Program", "StatementList", "Statement", "Expression", "Term", "Factor"};
+  tables.terminals_ = {"identifier", "number", "left_paren", "right_paren", "plus",
+                       "times",      "assign", "semicolon",  "$",           "string"};
+  tables.symbols_.insert(tables.terminals_.begin(), tables.terminals_.end());
 
   // Build goto table - state transitions for non-terminals
-  goto_table_[0]["Program"] = 1;
-  goto_table_[0]["StatementList"] = 2;
-  goto_table_[0]["Statement"] = 3;
-  goto_table_[2]["Statement"] = 4;
-  goto_table_[2]["StatementList"] = 5;
-  goto_table_[3]["Statement"] = 4;  // Missing goto for Statement from state 3
-  goto_table_[3]["StatementList"] = 5;
-  goto_table_[4]["Statement"] = 4;  // Missing goto for Statement from state 4
-  goto_table_[4]["StatementList"] = 5;
-  goto_table_[6]["Expression"] = 8;
-  goto_table_[6]["Term"] = 9;
-  goto_table_[6]["Factor"] = 10;
-  goto_table_[8]["Term"] = 11;
-  goto_table_[9]["Factor"] = 12;
-  goto_table_[11]["Factor"] = 12;
-  goto_table_[13]["Expression"] = 14;
-  goto_table_[13]["Term"] = 9;
-  goto_table_[13]["Factor"] = 10;
-  goto_table_[18]["Term"] = 11;
-  goto_table_[18]["Factor"] = 10;
-  goto_table_[19]["Factor"] = 12;
+  tables.goto_table_[0]["Program"] = 1;
+  tables.goto_table_[0]["StatementList"] = 2;
+  tables.goto_table_[0]["Statement"] = 3;
+  tables.goto_table_[2]["Statement"] = 4;
+  tables.goto_table_[2]["StatementList"] = 5;
+  tables.goto_table_[3]["Statement"] = 4;  // Missing goto for Statement from state 3
+  tables.goto_table_[3]["StatementList"] = 5;
+  tables.goto_table_[4]["Statement"] = 4;  // Missing goto for Statement from state 4
+  tables.goto_table_[4]["StatementList"] = 5;
+  tables.goto_table_[6]["Expression"] = 8;
+  tables.goto_table_[6]["Term"] = 9;
+  tables.goto_table_[6]["Factor"] = 10;
+  tables.goto_table_[8]["Term"] = 11;
+  tables.goto_table_[9]["Factor"] = 12;
+  tables.goto_table_[11]["Factor"] = 12;
+  tables.goto_table_[13]["Expression"] = 14;
+  tables.goto_table_[13]["Term"] = 9;
+  tables.goto_table_[13]["Factor"] = 10;
+  tables.goto_table_[18]["Term"] = 11;
+  tables.goto_table_[18]["Factor"] = 10;
+  tables.goto_table_[19]["Factor"] = 12;
 
   // Build action table - actions for each state and terminal
   // State 0: Start state
-  action_table_[0]["identifier"] = Action(Action::ActionType::SHIFT, 7);
-  action_table_[0]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
+  tables.action_table_[0]["identifier"] = Action(Action::ActionType::SHIFT, 7);
+  tables.action_table_[0]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
 
   // State 1: S' -> Program.
-  action_table_[1]["$"] = Action(Action::ActionType::ACCEPT);
+  tables.action_table_[1]["$"] = Action(Action::ActionType::ACCEPT);
 
   // State 2: Program -> StatementList.
-  action_table_[2]["$"] = Action(Action::ActionType::REDUCE, 0, {"StatementList"}, "Program");
+  tables.action_table_[2]["$"] = Action(Action::ActionType::REDUCE, 0, {"StatementList"}, "Program");
 
   // State 3: StatementList -> Statement .StatementList
-  action_table_[3]["identifier"] = Action(Action::ActionType::SHIFT, 7);
-  action_table_[3]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
+  tables.action_table_[3]["identifier"] = Action(Action::ActionType::SHIFT, 7);
+  tables.action_table_[3]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
 
   // State 4: StatementList -> Statement .StatementList
-  action_table_[4]["identifier"] = Action(Action::ActionType::SHIFT, 7);
-  action_table_[4]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
+  tables.action_table_[4]["identifier"] = Action(Action::ActionType::SHIFT, 7);
+  tables.action_table_[4]["$"] = Action(Action::ActionType::REDUCE, 0, {}, "StatementList");  // reduce by ε production
 
   // State 5: StatementList -> Statement StatementList.
-  action_table_[5]["identifier"] =
+  tables.action_table_[5]["identifier"] =
       Action(Action::ActionType::REDUCE, 0, {"Statement", "StatementList"}, "StatementList");
-  action_table_[5]["$"] = Action(Action::ActionType::REDUCE, 0, {"Statement", "StatementList"}, "StatementList");
+  tables.action_table_[5]["$"] = Action(Action::ActionType::REDUCE, 0, {"Statement", "StatementList"}, "StatementList");
 
   // State 6: Statement -> identifier assign .Expression semicolon
-  action_table_[6]["identifier"] = Action(Action::ActionType::SHIFT, 15);
-  action_table_[6]["number"] = Action(Action::ActionType::SHIFT, 16);
-  action_table_[6]["string"] = Action(Action::ActionType::SHIFT, 21);
-  action_table_[6]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
+  tables.action_table_[6]["identifier"] = Action(Action::ActionType::SHIFT, 15);
+  tables.action_table_[6]["number"] = Action(Action::ActionType::SHIFT, 16);
+  tables.action_table_[6]["string"] = Action(Action::ActionType::SHIFT, 21);
+  tables.action_table_[6]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
 
   // State 7: Statement -> identifier .assign Expression semicolon
-  action_table_[7]["assign"] = Action(Action::ActionType::SHIFT, 6);
+  tables.action_table_[7]["assign"] = Action(Action::ActionType::SHIFT, 6);
 
   // State 8: Statement -> identifier assign Expression .semicolon
-  action_table_[8]["semicolon"] = Action(Action::ActionType::SHIFT, 17);
-  action_table_[8]["plus"] = Action(Action::ActionType::SHIFT, 18);
+  tables.action_table_[8]["semicolon"] = Action(Action::ActionType::SHIFT, 17);
+  tables.action_table_[8]["plus"] = Action(Action::ActionType::SHIFT, 18);
 
   // State 9: Expression -> Term., Term -> Term .times Factor
-  action_table_[9]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
-  action_table_[9]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
-  action_table_[9]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
-  action_table_[9]["times"] = Action(Action::ActionType::SHIFT, 19);
+  tables.action_table_[9]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
+  tables.action_table_[9]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
+  tables.action_table_[9]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Term"}, "Expression");
+  tables.action_table_[9]["times"] = Action(Action::ActionType::SHIFT, 19);
 
   // State 10: Term -> Factor.
-  action_table_[10]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
-  action_table_[10]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
-  action_table_[10]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
-  action_table_[10]["times"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
+  tables.action_table_[10]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
+  tables.action_table_[10]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
+  tables.action_table_[10]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
+  tables.action_table_[10]["times"] = Action(Action::ActionType::REDUCE, 0, {"Factor"}, "Term");
 
   // State 11: Expression -> Expression plus Term., Term -> Term .times Factor
-  action_table_[11]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Expression", "plus", "Term"}, "Expression");
-  action_table_[11]["right_paren"] =
+  tables.action_table_[11]["semicolon"] =
+      Action(Action::ActionType::REDUCE, 0, {"Expression", "plus", "Term"}, "Expression");
+  tables.action_table_[11]["right_paren"] =
+      Action(Action::ActionType::REDUCE, 0, {"Expression", "plus", "Term"}, "Expression");
+  tables.action_table_[11]["plus"] =
       Action(Action::ActionType::REDUCE, 0, {"Expression", "plus", "Term"}, "Expression");
-  action_table_[11]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Expression", "plus", "Term"}, "Expression");
-  action_table_[11]["times"] = Action(Action::ActionType::SHIFT, 19);
+  tables.action_table_[11]["times"] = Action(Action::ActionType::SHIFT, 19);
 
   // State 12: Term -> Term times Factor.
-  action_table_[12]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
-  action_table_[12]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
-  action_table_[12]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
-  action_table_[12]["times"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
+  tables.action_table_[12]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
+  tables.action_table_[12]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
+  tables.action_table_[12]["plus"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
+  tables.action_table_[12]["times"] = Action(Action::ActionType::REDUCE, 0, {"Term", "times", "Factor"}, "Term");
 
   // State 13: Factor -> left_paren .Expression right_paren
-  action_table_[13]["identifier"] = Action(Action::ActionType::SHIFT, 15);
-  action_table_[13]["number"] = Action(Action::ActionType::SHIFT, 16);
-  action_table_[13]["string"] = Action(Action::ActionType::SHIFT, 21);
-  action_table_[13]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
+  tables.action_table_[13]["identifier"] = Action(Action::ActionType::SHIFT, 15);
+  tables.action_table_[13]["number"] = Action(Action::ActionType::SHIFT, 16);
+  tables.action_table_[13]["string"] = Action(Action::ActionType::SHIFT, 21);
+  tables.action_table_[13]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
 
   // State 14: Factor -> left_paren Expression .right_paren, Expression -> Expression .plus Term
-  action_table_[14]["right_paren"] = Action(Action::ActionType::SHIFT, 20);
-  action_table_[14]["plus"] = Action(Action::ActionType::SHIFT, 18);
+  tables.action_table_[14]["right_paren"] = Action(Action::ActionType::SHIFT, 20);
+  tables.action_table_[14]["plus"] = Action(Action::ActionType::SHIFT, 18);
 
   // State 15: Factor -> identifier.
-  action_table_[15]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
-  action_table_[15]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
-  action_table_[15]["plus"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
-  action_table_[15]["times"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
+  tables.action_table_[15]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
+  tables.action_table_[15]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
+  tables.action_table_[15]["plus"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
+  tables.action_table_[15]["times"] = Action(Action::ActionType::REDUCE, 0, {"identifier"}, "Factor");
 
   // State 16: Factor -> number.
-  action_table_[16]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
-  action_table_[16]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
-  action_table_[16]["plus"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
-  action_table_[16]["times"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
+  tables.action_table_[16]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
+  tables.action_table_[16]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
+  tables.action_table_[16]["plus"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
+  tables.action_table_[16]["times"] = Action(Action::ActionType::REDUCE, 0, {"number"}, "Factor");
 
   // State 17: Statement -> identifier assign Expression semicolon.
-  action_table_[17]["identifier"] =
+  tables.action_table_[17]["identifier"] =
       Action(Action::ActionType::REDUCE, 0, {"identifier", "assign", "Expression", "semicolon"}, "Statement");
-  action_table_[17]["$"] =
+  tables.action_table_[17]["$"] =
       Action(Action::ActionType::REDUCE, 0, {"identifier", "assign", "Expression", "semicolon"}, "Statement");
 
   // State 18: Expression -> Expression plus .Term
-  action_table_[18]["identifier"] = Action(Action::ActionType::SHIFT, 15);
-  action_table_[18]["number"] = Action(Action::ActionType::SHIFT, 16);
-  action_table_[18]["string"] = Action(Action::ActionType::SHIFT, 21);
-  action_table_[18]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
+  tables.action_table_[18]["identifier"] = Action(Action::ActionType::SHIFT, 15);
+  tables.action_table_[18]["number"] = Action(Action::ActionType::SHIFT, 16);
+  tables.action_table_[18]["string"] = Action(Action::ActionType::SHIFT, 21);
+  tables.action_table_[18]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
 
   // State 19: Term -> Term times .Factor
-  action_table_[19]["identifier"] = Action(Action::ActionType::SHIFT, 15);
-  action_table_[19]["number"] = Action(Action::ActionType::SHIFT, 16);
-  action_table_[19]["string"] = Action(Action::ActionType::SHIFT, 21);
-  action_table_[19]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
+  tables.action_table_[19]["identifier"] = Action(Action::ActionType::SHIFT, 15);
+  tables.action_table_[19]["number"] = Action(Action::ActionType::SHIFT, 16);
+  tables.action_table_[19]["string"] = Action(Action::ActionType::SHIFT, 21);
+  tables.action_table_[19]["left_paren"] = Action(Action::ActionType::SHIFT, 13);
 
   // State 20: Factor -> left_paren Expression right_paren.
-  action_table_[20]["semicolon"] =
+  tables.action_table_[20]["semicolon"] =
       Action(Action::ActionType::REDUCE, 0, {"left_paren", "Expression", "right_paren"}, "Factor");
-  action_table_[20]["right_paren"] =
+  tables.action_table_[20]["right_paren"] =
       Action(Action::ActionType::REDUCE, 0, {"left_paren", "Expression", "right_paren"}, "Factor");
-  action_table_[20]["plus"] =
+  tables.action_table_[20]["plus"] =
       Action(Action::ActionType::REDUCE, 0, {"left_paren", "Expression", "right_paren"}, "Factor");
-  action_table_[20]["times"] =
+  tables.action_table_[20]["times"] =
       Action(Action::ActionType::REDUCE, 0, {"left_paren", "Expression", "right_paren"}, "Factor");
 
   // State 21: Factor -> string.
-  action_table_[21]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
-  action_table_[21]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
-  action_table_[21]["plus"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
-  action_table_[21]["times"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
+  tables.action_table_[21]["semicolon"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
+  tables.action_table_[21]["right_paren"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
+  tables.action_table_[21]["plus"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
+  tables.action_table_[21]["times"] = Action(Action::ActionType::REDUCE, 0, {"string"}, "Factor");
+  return tables;
 }
 
 auto SLRParser::Parse() -> std::shared_ptr<core::AST> {
-  lexer_.Reset();
+  SCP_TRACE_SCOPE("SLRParser::Parse");
+  if (lexed_) {
+    next_token_ = 0;
+  } else {
+    lexer_.Reset();
+  }
+  return RunParser();
+}
+
+auto SLRParser::ParseStatements(std::istream &input, const StatementCallback &on_statement) -> bool {
+  SCP_TRACE_SCOPE("SLRParser::ParseStatements");
+  lexer_.SetInputStream(input);
+  tokens_.clear();
+  lexed_ = false;
+  on_statement_ = &on_statement;
+  std::shared_ptr<core::AST> ast;
+  try {
+    ast = RunParser();
+  } catch (...) {
+    on_statement_ = nullptr;
+    throw;
+  }
+  on_statement_ = nullptr;
+  return ast != nullptr;
+}
+
+auto SLRParser::ParseWithActions(SemanticActions &actions) -> bool {
+  SCP_TRACE_SCOPE("SLRParser::ParseWithActions");
+  if (lexed_) {
+    next_token_ = 0;
+  } else {
+    lexer_.Reset();
+  }
+  actions_ = &actions;
+  std::shared_ptr<core::AST> ast;
+  try {
+    ast = RunParser();
+  } catch (...) {
+    actions_ = nullptr;
+    throw;
+  }
+  actions_ = nullptr;
+  return ast != nullptr;
+}
+
+auto SLRParser::RunParser() -> std::shared_ptr<core::AST> {
+  if (!pipelined_ || lexed_) {
+    return ParseTokens();
+  }
+  if (!token_ring_) {
+    token_ring_ = std::make_unique<lexer::TokenRing>();
+  }
+  token_ring_->Reset();
+  lexer_thread_ = std::thread(&SLRParser::LexIntoRing, this);
+  // A parse that stops early, or throws, leaves the lexer waiting for room in the ring
+  auto stop_lexer = [this] {
+    token_ring_->Cancel();
+    lexer_thread_.join();
+  };
+  std::shared_ptr<core::AST> ast;
+  try {
+    ast = ParseTokens();
+  } catch (...) {
+    stop_lexer();
+    throw;
+  }
+  stop_lexer();
+  return ast;
+}
+
+void SLRParser::LexIntoRing() {
+  SCP_TRACE_SCOPE("LexIntoRing");
+  // The lexer reports to this thread's sink; the parser forwards the report when it reaches the failed token
+  std::ostringstream diagnostics;
+  core::DiagnosticCapture capture(diagnostics);
+  while (lexer_.HasNext()) {
+    auto token = lexer_.Next();
+    if (!token) {
+      token_ring_->Close(diagnostics.str());
+      return;
+    }
+    if (!token_ring_->Push(std::move(*token))) {
+      return;
+    }
+  }
+  token_ring_->Close("");
+}
+
+auto SLRParser::ParseTokens() -> std::shared_ptr<core::AST> {
+  streamed_token_count_ = 0;
+  parse_tree_node_count_ = 0;
   // Reset parser stack to initial state
   slr_stack_ = {};
   slr_stack_.push({constant::ASTConstant::ROOT_NODE_VALUE, nullptr, 0});
   auto root_node = std::make_shared<core::TreeNode>(constant::ASTConstant::ROOT_NODE_VALUE);
   while (true) {
-    if (lexer_.HasNext()) {
-      auto token = lexer_.Next();
-      auto terminal_node = std::make_shared<core::TreeNode>(token->GetValue());
+    if (HasNextToken()) {
+      auto token = NextToken();
+      if (!token) {
+        return nullptr;  // the lexer reported the character
+      }
+      std::shared_ptr<core::TreeNode> terminal_node;
+      if (actions_ == nullptr) {
+        terminal_node = std::make_shared<core::TreeNode>(token->GetValue());
+        parse_tree_node_count_++;
+      }
 
       std::string token_value = TokenTypeToString(token->GetType());
 
@@ -184,109 +348,131 @@ auto SLRParser::Parse() -> std::shared_ptr<core::AST> {
       while (!to_next) {
         int current_state = std::get<2>(slr_stack_.top());
 
-        auto state_action_it = action_table_.find(current_state);
-        if (state_action_it == action_table_.end()) {
-          std::cerr << constant::ErrorMessages::NoActionFoundForState(current_state) << std::endl;
+        auto state_action_it = tables_.action_table_.find(current_state);
+        if (state_action_it == tables_.action_table_.end()) {
+          core::Diagnostics() << constant::ErrorMessages::NoActionFoundForState(current_state) << std::endl;
           return nullptr;
         }
         auto action_it = state_action_it->second.find(token_value);
         if (action_it == state_action_it->second.end()) {
-          std::cerr << constant::ErrorMessages::NoActionFoundForToken(token_value) << std::endl;
+          core::Diagnostics() << constant::ErrorMessages::NoActionFoundForToken(token_value) << std::endl;
           return nullptr;
         }
-        Action action_to_take = action_it->second;
+        const Action &action_to_take = action_it->second;
 
         // Process the token
         switch (action_to_take.type_) {
           case Action::ActionType::SHIFT:
+            if (actions_ != nullptr) {
+              actions_->Shift(*token);
+            }
             slr_stack_.push({token_value, terminal_node, action_to_take.state_});
             to_next = true;
             break;
-          case Action::ActionType::REDUCE: {
-            auto reduce_node = std::make_shared<core::TreeNode>(action_to_take.lhs_);
-            std::vector<std::shared_ptr<core::TreeNode>> child_nodes;
-            for (size_t i = 0; i < action_to_take.rhs_.size(); ++i) {
-              child_nodes.push_back(std::get<1>(slr_stack_.top()));
-              slr_stack_.pop();
-            }
-            for (auto it = child_nodes.rbegin(); it != child_nodes.rend(); ++it) {
-              reduce_node->AddChild(*it);
-            }
-            int top_state = std::get<2>(slr_stack_.top());
-
-            auto goto_it = goto_table_.find(top_state);
-            if (goto_it == goto_table_.end() || goto_it->second.find(action_to_take.lhs_) == goto_it->second.end()) {
-              std::cerr << "Error: No goto entry for state " << top_state << " and symbol " << action_to_take.lhs_
-                        << std::endl;
+          case Action::ActionType::REDUCE:
+            if (!Reduce(action_to_take)) {
               return nullptr;
             }
-
-            int new_state = goto_table_[top_state][action_to_take.lhs_];
-            slr_stack_.push({action_to_take.lhs_, reduce_node, new_state});
             to_next = false;
             break;
-          }
           case Action::ActionType::ACCEPT:
             return BuildAST(root_node);
           case Action::ActionType::REJECT:
-            std::cerr << constant::ErrorMessages::ParsingError(token_value, *token) << std::endl;
+            core::Diagnostics() << constant::ErrorMessages::ParsingError(token_value, *token) << std::endl;
             break;
         }
       }
     } else {
       int current_state = std::get<2>(slr_stack_.top());
 
-      auto state_action_it = action_table_.find(current_state);
-      if (state_action_it == action_table_.end()) {
-        std::cerr << constant::ErrorMessages::ParsingError("$", core::Token(core::TokenType::END_OF_FILE, "$", 0, 0))
-                  << std::endl;
+      auto state_action_it = tables_.action_table_.find(current_state);
+      if (state_action_it == tables_.action_table_.end()) {
+        core::Diagnostics() << constant::ErrorMessages::ParsingError(
+                                   "$", core::Token(core::TokenType::END_OF_FILE, "$", 0, 0))
+                            << std::endl;
         return nullptr;
       }
       auto action_it = state_action_it->second.find("$");
       if (action_it == state_action_it->second.end()) {
-        std::cerr << constant::ErrorMessages::NoActionFoundForToken("$") << std::endl;
+        core::Diagnostics() << constant::ErrorMessages::NoActionFoundForToken("$") << std::endl;
         return nullptr;
       }
-      Action action_to_take = action_it->second;
+      const Action &action_to_take = action_it->second;
 
       // Process EOF token
       if (action_to_take.type_ == Action::ActionType::ACCEPT) {
+        if (actions_ != nullptr) {
+          return std::make_shared<core::AST>(program_name_);  // The actions hold the result
+        }
         // The Program node should be on top of the stack
         auto program_node = std::get<1>(slr_stack_.top());
         return BuildAST(program_node);
       }
       if (action_to_take.type_ == Action::ActionType::REDUCE) {
-        auto reduce_node = std::make_shared<core::TreeNode>(action_to_take.lhs_);
-        std::vector<std::shared_ptr<core::TreeNode>> child_nodes;
-        for (size_t i = 0; i < action_to_take.rhs_.size(); ++i) {
-          child_nodes.push_back(std::get<1>(slr_stack_.top()));
-          slr_stack_.pop();
-        }
-        for (auto it = child_nodes.rbegin(); it != child_nodes.rend(); ++it) {
-          reduce_node->AddChild(*it);
-        }
-        int top_state = std::get<2>(slr_stack_.top());
-
-        auto goto_it = goto_table_.find(top_state);
-        if (goto_it == goto_table_.end() || goto_it->second.find(action_to_take.lhs_) == goto_it->second.end()) {
-          std::cerr << "Error: No goto entry for state " << top_state << " and symbol " << action_to_take.lhs_
-                    << std::endl;
+        // Continue processing EOF with the new state
+        if (!Reduce(action_to_take)) {
           return nullptr;
         }
-
-        int new_state = goto_table_[top_state][action_to_take.lhs_];
-        slr_stack_.push({action_to_take.lhs_, reduce_node, new_state});
-        // Continue processing EOF with the new state
       } else {
-        std::cerr << constant::ErrorMessages::ParsingError("$", core::Token(core::TokenType::END_OF_FILE, "$", 0, 0))
-                  << std::endl;
+        core::Diagnostics() << constant::ErrorMessages::ParsingError(
+                                   "$", core::Token(core::TokenType::END_OF_FILE, "$", 0, 0))
+                            << std::endl;
         return nullptr;
       }
     }
   }
 }
 
+auto SLRParser::Reduce(const Action &action) -> bool {
+  if (actions_ != nullptr) {
+    for (size_t i = 0; i < action.rhs_.size(); ++i) {
+      slr_stack_.pop();
+    }
+    if (!actions_->Reduce(action)) {
+      return false;
+    }
+    if (action.lhs_ == "Statement") {
+      return true;  // Elided as in ParseStatements
+    }
+    return PushGoto(action.lhs_, nullptr);
+  }
+
+  auto reduce_node = std::make_shared<core::TreeNode>(action.lhs_);
+  parse_tree_node_count_++;
+  std::vector<std::shared_ptr<core::TreeNode>> child_nodes;
+  for (size_t i = 0; i < action.rhs_.size(); ++i) {
+    child_nodes.push_back(std::get<1>(slr_stack_.top()));
+    slr_stack_.pop();
+  }
+  for (auto it = child_nodes.rbegin(); it != child_nodes.rend(); ++it) {
+    reduce_node->AddChild(*it);
+  }
+
+  // StatementList is right recursive, so the states before and after a Statement act alike on every lookahead.
+  // Handing the statement out instead of pushing it keeps the stack and the tree at the size of one statement.
+  if (on_statement_ != nullptr && action.lhs_ == "Statement") {
+    return (*on_statement_)(TransformStatement(reduce_node));
+  }
+  return PushGoto(action.lhs_, reduce_node);
+}
+
+auto SLRParser::PushGoto(const std::string &symbol, std::shared_ptr<core::TreeNode> node) -> bool {
+  int top_state = std::get<2>(slr_stack_.top());
+
+  auto goto_it = tables_.goto_table_.find(top_state);
+  if (goto_it != tables_.goto_table_.end()) {
+    auto state_it = goto_it->second.find(symbol);
+    if (state_it != goto_it->second.end()) {
+      slr_stack_.push({symbol, std::move(node), state_it->second});
+      return true;
+    }
+  }
+  core::Diagnostics() << "Error: No goto entry for state " << top_state << " and symbol " << symbol << std::endl;
+  return false;
+}
+
 auto SLRParser::BuildAST(const std::shared_ptr<core::TreeNode> &parse_tree) -> std::shared_ptr<core::AST> {
+  SCP_TRACE_SCOPE("BuildAST");
   if (!parse_tree) {
     return nullptr;
   }
@@ -299,7 +485,8 @@ auto SLRParser::BuildAST(const std::shared_ptr<core::TreeNode> &parse_tree) -> s
 }
 
 auto SLRParser::IsValidSymbol(const std::string &symbol) const -> bool {
-  return symbols_.find(symbol) != symbols_.end() || terminals_.find(symbol) != terminals_.end() ||
+  return tables_.symbols_.find(symbol) != tables_.symbols_.end() ||
+         tables_.terminals_.find(symbol) != tables_.terminals_.end() ||
          symbol == constant::ASTConstant::END_NODE_VALUE;
 }
 
@@ -331,7 +518,7 @@ auto SLRParser::TokenTypeToString(core::TokenType type) -> std::string {
 }
 
 // AST transformation helper methods
-auto SLRParser::IsTerminal(const std::string &symbol, const std::unordered_set<std::string> &terminals) -> bool {
+auto SLRParser::IsTerminal(const std::string &symbol, const core::FlatHashSet<std::string> &terminals) -> bool {
   return terminals.find(symbol) != terminals.end();
 }
 
@@ -344,7 +531,7 @@ auto SLRParser::TransformToASTNode(const std::shared_ptr<core::TreeNode> &parse_
   const std::string &symbol = parse_node->val_;
 
   // Handle terminal nodes
-  if (IsTerminal(symbol, terminals_)) {
+  if (IsTerminal(symbol, tables_.terminals_)) {
     return CreateTerminalASTNode(symbol);
   }
 
@@ -364,15 +551,9 @@ auto SLRParser::TransformToASTNode(const std::shared_ptr<core::TreeNode> &parse_
   if (symbol == "Statement") {
     return TransformStatement(parse_node);
   }
-  if (symbol == "Expression") {
+  if (symbol == "Expression" || symbol == "Term" || symbol == "Factor") {
     return TransformExpression(parse_node);
   }
-  if (symbol == "Term") {
-    return TransformTerm(parse_node);
-  }
-  if (symbol == "Factor") {
-    return TransformFactor(parse_node);
-  }
 
   // Default case - create a generic node
   auto ast_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::ROOT, symbol);
@@ -429,19 +610,21 @@ void SLRParser::CollectStatements(const std::shared_ptr<core::TreeNode> &parse_n
                                   const std::shared_ptr<core::AST::ASTNode> &root) {
   // StatementList -> Statement StatementList | ε
   // Due to reverse order, children are: StatementList, Statement
-  // Process in reverse order to maintain correct statement sequence
-  std::vector<std::shared_ptr<core::TreeNode>> children_vec(parse_node->children_.begin(), parse_node->children_.end());
+  // Process in reverse order to maintain correct statement sequence, using an explicit stack rather than
+  // recursion since the list nests once per statement
+  std::vector<std::shared_ptr<core::TreeNode>> pending(parse_node->children_.begin(), parse_node->children_.end());
 
-  for (auto it = children_vec.rbegin(); it != children_vec.rend(); ++it) {
-    const auto &child = *it;
+  while (!pending.empty()) {
+    auto child = std::move(pending.back());
+    pending.pop_back();
     if (child->val_ == "Statement") {
       auto stmt_node = TransformToASTNode(child);
       if (stmt_node) {
         root->AddChild(stmt_node);
       }
     } else if (child->val_ == "StatementList") {
-      // Recursively process nested StatementList
-      CollectStatements(child, root);
+      // Nested StatementList, its children are processed before the remaining siblings
+      pending.insert(pending.end(), child->children_.begin(), child->children_.end());
     }
   }
 }
@@ -488,75 +671,65 @@ auto SLRParser::TransformStatement(const std::shared_ptr<core::TreeNode> &parse_
 auto SLRParser::TransformExpression(const std::shared_ptr<core::TreeNode> &parse_node)
     -> std::shared_ptr<core::AST::ASTNode> {
   // Expression -> Expression plus Term | Term
-
-  if (parse_node->children_.size() == 1) {
-    // Expression -> Term
-    auto term_node = parse_node->children_.front();
-    return TransformToASTNode(term_node);
-  }
-  if (parse_node->children_.size() == 3) {
-    // Expression -> Expression plus Term
-    // But children are in reverse order: Term, plus, Expression
-    auto it = parse_node->children_.begin();
-    auto right_term = TransformToASTNode(*it);  // This is Term (first child due to reverse order)
-    ++it;                                       // skip plus operator
-    ++it;                                       // get to Expression
-    auto left_expr = TransformToASTNode(*it);   // This is Expression (last child due to reverse order)
-
-    auto plus_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::PLUS, "+");
-    if (left_expr) {
-      plus_node->AddChild(left_expr);
-    }
-    if (right_term) {
-      plus_node->AddChild(right_term);
-    }
-    return plus_node;
-  }
-
-  return nullptr;
-}
-
-auto SLRParser::TransformTerm(const std::shared_ptr<core::TreeNode> &parse_node)
-    -> std::shared_ptr<core::AST::ASTNode> {
   // Term -> Term times Factor | Factor
-
-  if (parse_node->children_.size() == 1) {
-    // Term -> Factor
-    auto factor_node = parse_node->children_.front();
-    return TransformToASTNode(factor_node);
-  }
-  if (parse_node->children_.size() == 3) {
-    // Term -> Term times Factor
-    // But children are in reverse order: Factor, times, Term
-    auto it = parse_node->children_.begin();
-    auto right_factor = TransformToASTNode(*it);  // This is Factor (first child due to reverse order)
-    ++it;                                         // skip times operator
-    ++it;                                         // get to Term
-    auto left_term = TransformToASTNode(*it);     // This is Term (last child due to reverse order)
-
-    auto times_node = std::make_shared<core::AST::ASTNode>(core::ASTNodeType::TIMES, "*");
-    if (left_term) {
-      times_node->AddChild(left_term);
-    }
-    if (right_factor) {
-      times_node->AddChild(right_factor);
+  // Factor -> identifier | number | string | left_paren Expression right_paren
+  // The parse tree nests once per operator and parenthesis, so the walk keeps explicit stacks of the parse nodes to
+  // visit and of the operands built rather than recursing. A binary node is visited again to combine its operands.
+  std::vector<std::pair<std::shared_ptr<core::TreeNode>, bool>> pending = {{parse_node, false}};
+  std::vector<std::shared_ptr<core::AST::ASTNode>> operands;
+  while (!pending.empty()) {
+    auto [node, combine] = std::move(pending.back());
+    pending.pop_back();
+    const std::string &symbol = node->val_;
+    bool is_binary = symbol == "Expression" || symbol == "Term";
+
+    if (combine) {
+      auto right = std::move(operands.back());
+      operands.pop_back();
+      auto left = std::move(operands.back());
+      operands.pop_back();
+      auto binary_node = symbol == "Expression"
+                             ? std::make_shared<core::AST::ASTNode>(core::ASTNodeType::PLUS, "+")
+                             : std::make_shared<core::AST::ASTNode>(core::ASTNodeType::TIMES, "*");
+      if (left) {
+        binary_node->AddChild(left);
+      }
+      if (right) {
+        binary_node->AddChild(right);
+      }
+      operands.push_back(std::move(binary_node));
+    } else if (is_binary && node->children_.size() == 1) {
+      // Expression -> Term, Term -> Factor
+      pending.emplace_back(node->children_.front(), false);
+    } else if (is_binary && node->children_.size() == 3) {
+      // Children are in reverse order: the right operand, the operator, then the left operand, visited first
+      pending.emplace_back(node, true);
+      pending.emplace_back(node->children_.front(), false);
+      pending.emplace_back(node->children_.back(), false);
+    } else if (is_binary) {
+      operands.push_back(nullptr);
+    } else if (symbol == "Factor") {
+      // For parenthesized expressions, the expression stands for the factor
+      auto expression = std::find_if(node->children_.begin(), node->children_.end(),
+                                     [](const auto &child) { return child->val_ == "Expression"; });
+      if (expression != node->children_.end()) {
+        pending.emplace_back(*expression, false);
+      } else {
+        operands.push_back(TransformFactor(node));
+      }
+    } else {
+      operands.push_back(TransformToASTNode(node));
     }
-    return times_node;
   }
-
-  return nullptr;
+  return operands.back();
 }
 
 auto SLRParser::TransformFactor(const std::shared_ptr<core::TreeNode> &parse_node)
     -> std::shared_ptr<core::AST::ASTNode> {
-  // Factor -> identifier | number | string | left_paren Expression right_paren
+  // Factor -> identifier | number | string, a parenthesized Expression is walked by TransformExpression
 
   // Check each child to find the meaningful content
   for (const auto &child : parse_node->children_) {
-    if (child->val_ == "Expression") {
-      // For parenthesized expressions, just return the expression node
-      return TransformToASTNode(child);
-    }
     if (child->children_.empty() && !child->val_.empty()) {
       // This is a leaf node with actual value
       // Determine type based on content
@@ -0,0 +1,210 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/type.h"
+#include "interp/interpreter.h"
+
+namespace {
+
+/**
+ * Print the usage information for the REPL.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " [--time] [<input_file>...]" << std::endl;
+  std::cout << "  Run statements as they are entered, keeping the variables of earlier lines; the input files run first"
+            << std::endl;
+  std::cout << "  --time: Start with :time on" << std::endl;
+}
+
+/**
+ * Print the commands of the REPL.
+ */
+void PrintCommands() {
+  std::cout << "  <statement>;   Check and run statements; a statement may span lines" << std::endl;
+  std::cout << "  :time          Toggle reporting the check and run time of every statement" << std::endl;
+  std::cout << "  :vars          List the variables with their types and values" << std::endl;
+  std::cout << "  :load <file>   Run the statements of a file" << std::endl;
+  std::cout << "  :help          Show this list" << std::endl;
+  std::cout << "  :quit          Leave" << std::endl;
+}
+
+/**
+ * Format a duration in microseconds.
+ * @param duration The duration.
+ * @return The text.
+ */
+auto FormatMicros(std::chrono::nanoseconds duration) -> std::string {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(1) << static_cast<double>(duration.count()) / 1000.0 << " us";
+  return text.str();
+}
+
+/**
+ * Quote a string the way a literal would spell it.
+ * @param text The string.
+ * @return The literal.
+ */
+auto Quote(const std::string &text) -> std::string {
+  std::string literal = "\"";
+  for (char c : text) {
+    switch (c) {
+      case '\n':
+        literal += "\\n";
+        break;
+      case '\t':
+        literal += "\\t";
+        break;
+      case '\r':
+        literal += "\\r";
+        break;
+      case '\\':
+      case '"':
+        literal += '\\';
+        literal += c;
+        break;
+      default:
+        literal += c;
+    }
+  }
+  return literal + "\"";
+}
+
+/**
+ * Run statements and report their latency if asked to.
+ * @param interpreter The interpreter.
+ * @param source The statements.
+ * @param time Whether to report the time of every statement.
+ * @return True if every statement ran.
+ */
+auto Run(scp::interp::Interpreter &interpreter, const std::string &source, bool time) -> bool {
+  std::vector<scp::interp::StatementTiming> timings;
+  auto start = std::chrono::steady_clock::now();
+  bool success = interpreter.Execute(source, time ? &timings : nullptr);
+  auto total = std::chrono::steady_clock::now() - start;
+  interpreter.FinishLine();
+  if (time) {
+    for (size_t i = 0; i < timings.size(); i++) {
+      std::cout << "[time] statement " << i + 1 << ": check " << FormatMicros(timings[i].check_) << ", run "
+                << FormatMicros(timings[i].run_) << std::endl;
+    }
+    std::cout << "[time] total with parsing: " << FormatMicros(total) << std::endl;
+  }
+  return success;
+}
+
+/**
+ * Run the statements of a file.
+ * @param interpreter The interpreter.
+ * @param filename The file.
+ * @param time Whether to report the time of every statement.
+ * @return True if every statement ran.
+ */
+auto Load(scp::interp::Interpreter &interpreter, const std::string &filename, bool time) -> bool {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    std::cerr << "Error: Cannot open file: " << filename << std::endl;
+    return false;
+  }
+  std::stringstream content;
+  content << file.rdbuf();
+  return Run(interpreter, content.str(), time);
+}
+
+}  // namespace
+
+/**
+ * Main entry point for the REPL.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  bool time = false;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    }
+    if (arg == "--time") {
+      time = true;
+    } else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+
+  // stdin of the programs reads the lines after the statement reading it
+  scp::interp::Interpreter interpreter(std::cin, std::cout);
+  for (const auto &input : inputs) {
+    if (!Load(interpreter, input, time)) {
+      return 1;
+    }
+  }
+
+  // Prompts only make sense on a terminal; piped input gives just the output of the statements
+  bool interactive = isatty(fileno(stdin)) != 0;
+  std::string pending;
+  std::string line;
+  while (true) {
+    if (interactive) {
+      std::cout << (pending.empty() ? "scp> " : "...> ") << std::flush;
+    }
+    if (!std::getline(std::cin, line)) {
+      break;
+    }
+    if (pending.empty() && line.rfind(':', 0) == 0) {
+      std::istringstream command(line);
+      std::string name;
+      std::string argument;
+      command >> name >> argument;
+      if (name == ":quit" || name == ":q") {
+        return 0;
+      }
+      if (name == ":time") {
+        time = !time;
+        std::cout << "Timing " << (time ? "on" : "off") << std::endl;
+      } else if (name == ":vars") {
+        for (const auto &[variable, value] : interpreter.GetVariables()) {
+          std::cout << variable << " : " << scp::core::TypeToString(value.type_) << " = "
+                    << (value.type_ == scp::core::Type::STRING ? Quote(value.string_) : std::to_string(value.number_))
+                    << std::endl;
+        }
+      } else if (name == ":load" && !argument.empty()) {
+        Load(interpreter, argument, time);
+      } else if (name == ":help") {
+        PrintCommands();
+      } else {
+        std::cerr << "Error: Unknown command: " << line << " (:help lists the commands)" << std::endl;
+      }
+      continue;
+    }
+
+    // Gather lines until the input ends a statement
+    pending += line + "\n";
+    size_t last = pending.find_last_not_of(" \t\r\n");
+    if (last == std::string::npos) {
+      pending.clear();
+    } else if (pending[last] == ';') {
+      Run(interpreter, pending, time);
+      pending.clear();
+    }
+  }
+  if (!pending.empty()) {
+    Run(interpreter, pending, time);
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+#include "runtime/scprt.h"
+
+namespace scp::runtime {
+
+namespace {
+
+/* The errno of a system call interrupted by a signal, which is retried */
+constexpr intptr_t INTERRUPTED = -4;
+
+/**
+ * Make a system call of three arguments without libc.
+ * @param number The number of the call.
+ * @param first The first argument.
+ * @param second The second argument.
+ * @param third The third argument.
+ * @return The result, or the negated errno.
+ */
+auto Syscall(intptr_t number, intptr_t first, intptr_t second, intptr_t third) -> intptr_t {
+#if defined(__linux__) && defined(__x86_64__)
+  intptr_t result;
+  asm volatile("syscall"
+               : "=a"(result)
+               : "a"(number), "D"(first), "S"(second), "d"(third)
+               : "rcx", "r11", "memory");
+  return result;
+#elif defined(__linux__) && defined(__aarch64__)
+  register intptr_t x8 asm("x8") = number;
+  register intptr_t x0 asm("x0") = first;
+  register intptr_t x1 asm("x1") = second;
+  register intptr_t x2 asm("x2") = third;
+  asm volatile("svc 0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2) : "memory");
+  return x0;
+#else
+#error "libscprt makes system calls on Linux on x86-64 and AArch64 only"
+#endif
+}
+
+#if defined(__x86_64__)
+constexpr intptr_t SYS_READ = 0;
+constexpr intptr_t SYS_WRITE = 1;
+#else
+constexpr intptr_t SYS_READ = 63;
+constexpr intptr_t SYS_WRITE = 64;
+#endif
+
+/**
+ * Read from a file descriptor, retrying when a signal interrupts the call.
+ * @param fd The file descriptor.
+ * @param buffer The buffer.
+ * @param n The size of the buffer.
+ * @return The number of bytes read, 0 at the end of the input, negative on errors.
+ */
+auto Read(int fd, char *buffer, size_t n) -> intptr_t {
+  intptr_t result;
+  do {
+    result = Syscall(SYS_READ, fd, reinterpret_cast<intptr_t>(buffer), static_cast<intptr_t>(n));
+  } while (result == INTERRUPTED);
+  return result;
+}
+
+/**
+ * Write all of a buffer to a file descriptor, retrying short writes and interrupted calls.
+ * @param fd The file descriptor.
+ * @param data The bytes.
+ * @param n The number of bytes.
+ * @return Whether all of them were written.
+ */
+auto WriteAll(int fd, const char *data, size_t n) -> bool {
+  while (n > 0) {
+    intptr_t result = Syscall(SYS_WRITE, fd, reinterpret_cast<intptr_t>(data), static_cast<intptr_t>(n));
+    if (result == INTERRUPTED) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    data += result;
+    n -= static_cast<size_t>(result);
+  }
+  return true;
+}
+
+/**
+ * Make sure a reader has buffered bytes, reading more if it has none.
+ * @param reader The reader.
+ * @return Whether it has any, false at the end of the input or on errors.
+ */
+auto Fill(scprt_reader *reader) -> bool {
+  if (reader->begin_ < reader->end_) {
+    return true;
+  }
+  if (reader->eof_ != 0) {
+    return false;
+  }
+  intptr_t result = Read(reader->fd_, reader->buffer_, sizeof(reader->buffer_));
+  if (result <= 0) {
+    reader->eof_ = 1;
+    return false;
+  }
+  reader->begin_ = 0;
+  reader->end_ = static_cast<size_t>(result);
+  return true;
+}
+
+}  // namespace
+
+}  // namespace scp::runtime
+
+using scp::runtime::Fill;
+
+extern "C" void scprt_reader_init(scprt_reader *reader, int fd) {
+  reader->fd_ = fd;
+  reader->eof_ = 0;
+  reader->begin_ = 0;
+  reader->end_ = 0;
+}
+
+extern "C" auto scprt_read_line(scprt_reader *reader, char *out, size_t capacity) -> size_t {
+  size_t length = 0;
+  bool newline = false;
+  while (!newline && length + 1 < capacity && Fill(reader)) {
+    const char *begin = reader->buffer_ + reader->begin_;
+    size_t available = reader->end_ - reader->begin_;
+    size_t take = capacity - 1 - length < available ? capacity - 1 - length : available;
+    const auto *found = static_cast<const char *>(scprt_memchr(begin, '\n', take));
+    if (found != nullptr) {
+      take = static_cast<size_t>(found - begin) + 1;
+      newline = true;
+    }
+    scprt_memcpy(out + length, begin, take);
+    length += take;
+    reader->begin_ += take;
+  }
+  return scprt_trim_newline(out, length);
+}
+
+extern "C" auto scprt_read_int(scprt_reader *reader) -> int32_t {
+  // Parses like scprt_parse_int as the line streams through the buffer, so a line of any length takes no copy
+  bool started = false;
+  bool stopped = false;
+  bool negative = false;
+  uint32_t value = 0;
+  bool newline = false;
+  while (!newline && Fill(reader)) {
+    const char *begin = reader->buffer_ + reader->begin_;
+    size_t available = reader->end_ - reader->begin_;
+    const auto *found = static_cast<const char *>(scprt_memchr(begin, '\n', available));
+    size_t take = found != nullptr ? static_cast<size_t>(found - begin) : available;
+    newline = found != nullptr;
+    for (size_t i = 0; i < take && !stopped; i++) {
+      char c = begin[i];
+      if (!started) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+          continue;
+        }
+        started = true;
+        if (c == '-' || c == '+') {
+          negative = c == '-';
+          continue;
+        }
+      }
+      if (c >= '0' && c <= '9') {
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+      } else {
+        stopped = true;
+      }
+    }
+    reader->begin_ += take + (newline ? 1 : 0);
+  }
+  return static_cast<int32_t>(negative ? 0U - value : value);
+}
+
+extern "C" void scprt_writer_init(scprt_writer *writer, int fd) {
+  writer->fd_ = fd;
+  writer->error_ = 0;
+  writer->size_ = 0;
+}
+
+extern "C" void scprt_write(scprt_writer *writer, const char *data, size_t n) {
+  if (n > sizeof(writer->buffer_) - writer->size_) {
+    scprt_flush(writer);
+    if (n >= sizeof(writer->buffer_)) {
+      if (!scp::runtime::WriteAll(writer->fd_, data, n)) {
+        writer->error_ = 1;
+      }
+      return;
+    }
+  }
+  scprt_memcpy(writer->buffer_ + writer->size_, data, n);
+  writer->size_ += n;
+}
+
+extern "C" void scprt_write_str(scprt_writer *writer, const char *s) { scprt_write(writer, s, scprt_strlen(s)); }
+
+extern "C" void scprt_write_int(scprt_writer *writer, int32_t value) {
+  if (sizeof(writer->buffer_) - writer->size_ < SCPRT_INT_CHARS) {
+    scprt_flush(writer);
+  }
+  writer->size_ += scprt_format_int(value, writer->buffer_ + writer->size_);
+}
+
+extern "C" auto scprt_flush(scprt_writer *writer) -> int {
+  if (writer->size_ > 0 && !scp::runtime::WriteAll(writer->fd_, writer->buffer_, writer->size_)) {
+    writer->error_ = 1;
+  }
+  writer->size_ = 0;
+  return writer->error_ != 0 ? -1 : 0;
+}
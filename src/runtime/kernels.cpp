@@ -0,0 +1,424 @@
+#include "runtime/scprt.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace scp::runtime {
+
+namespace {
+
+/**
+ * The byte loops of one instruction set.
+ */
+struct Kernels {
+  /* The instruction set */
+  scprt_isa isa_;
+  /* Finds the terminator */
+  size_t (*strlen_)(const char *);
+  /* Finds a byte */
+  const void *(*memchr_)(const void *, int, size_t);
+  /* Copies bytes */
+  void *(*memcpy_)(void *, const void *, size_t);
+};
+
+/* Every byte of a word set to 0x01 */
+constexpr uint64_t ONES = 0x0101010101010101ULL;
+/* Every byte of a word set to 0x7f */
+constexpr uint64_t LOWS = 0x7f7f7f7f7f7f7f7fULL;
+
+auto LoadWord(const void *address) -> uint64_t {
+  uint64_t word;
+  __builtin_memcpy(&word, address, sizeof(word));
+  return word;
+}
+
+void StoreWord(void *address, uint64_t word) { __builtin_memcpy(address, &word, sizeof(word)); }
+
+/**
+ * Mark the zero bytes of a word.
+ * @param word The word.
+ * @return The word with the high bit of each zero byte set and every other bit clear.
+ */
+auto ZeroBytes(uint64_t word) -> uint64_t { return ~(((word & LOWS) + LOWS) | word | LOWS); }
+
+/**
+ * Get the index in memory of the first marked byte of a word.
+ * @param marks The marks of ZeroBytes, not 0.
+ * @return The index.
+ */
+auto FirstMarked(uint64_t marks) -> size_t {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return static_cast<size_t>(__builtin_clzll(marks)) / 8;
+#else
+  return static_cast<size_t>(__builtin_ctzll(marks)) / 8;
+#endif
+}
+
+// The scalar loops go a word at a time. Aligned words never cross a page, so reading all of the word holding the
+// terminator is safe even where the bytes after it are not mapped.
+auto StrlenScalar(const char *s) -> size_t {
+  const char *p = s;
+  for (; (reinterpret_cast<uintptr_t>(p) & 7) != 0; p++) {
+    if (*p == '\0') {
+      return static_cast<size_t>(p - s);
+    }
+  }
+  for (;; p += 8) {
+    uint64_t marks = ZeroBytes(LoadWord(p));
+    if (marks != 0) {
+      return static_cast<size_t>(p - s) + FirstMarked(marks);
+    }
+  }
+}
+
+auto MemchrScalar(const void *s, int c, size_t n) -> const void * {
+  const auto *p = static_cast<const unsigned char *>(s);
+  auto byte = static_cast<unsigned char>(c);
+  uint64_t pattern = ONES * byte;
+  for (; n >= 8; p += 8, n -= 8) {
+    uint64_t marks = ZeroBytes(LoadWord(p) ^ pattern);
+    if (marks != 0) {
+      return p + FirstMarked(marks);
+    }
+  }
+  for (; n > 0; p++, n--) {
+    if (*p == byte) {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+auto MemcpyScalar(void *dst, const void *src, size_t n) -> void * {
+  auto *d = static_cast<unsigned char *>(dst);
+  const auto *s = static_cast<const unsigned char *>(src);
+  for (; n >= 8; d += 8, s += 8, n -= 8) {
+    StoreWord(d, LoadWord(s));
+  }
+  for (; n > 0; n--) {
+    *d++ = *s++;
+  }
+  return dst;
+}
+
+constexpr Kernels SCALAR = {SCPRT_ISA_SCALAR, StrlenScalar, MemchrScalar, MemcpyScalar};
+
+#if defined(__x86_64__)
+
+/**
+ * Copy fewer than 16 bytes with at most two overlapping loads and stores of a size.
+ * @param d The destination.
+ * @param s The source.
+ * @param n The number of bytes.
+ */
+void CopySmall(unsigned char *d, const unsigned char *s, size_t n) {
+  if (n >= 8) {
+    uint64_t head = LoadWord(s);
+    uint64_t tail = LoadWord(s + n - 8);
+    StoreWord(d, head);
+    StoreWord(d + n - 8, tail);
+  } else if (n >= 4) {
+    uint32_t head;
+    uint32_t tail;
+    __builtin_memcpy(&head, s, 4);
+    __builtin_memcpy(&tail, s + n - 4, 4);
+    __builtin_memcpy(d, &head, 4);
+    __builtin_memcpy(d + n - 4, &tail, 4);
+  } else if (n > 0) {
+    // 1 to 3 bytes: the first, the middle and the last, which coincide as needed
+    unsigned char first = s[0];
+    unsigned char middle = s[n / 2];
+    unsigned char last = s[n - 1];
+    d[0] = first;
+    d[n / 2] = middle;
+    d[n - 1] = last;
+  }
+}
+
+// The vector loops read whole aligned vectors for strlen, like the scalar one reads words, and unaligned vectors
+// inside the bounds for memchr and memcpy, finishing with a vector that ends at the last byte and overlaps the one
+// before it. Long strings and buffers go four vectors an iteration, folded into one test.
+
+/**
+ * Mark the zero bytes of an aligned vector.
+ * @param block The address of the vector, a multiple of 16.
+ * @return A bit for each byte, set for zeros.
+ */
+auto ZeroMaskSse2(const char *block) -> unsigned {
+  __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())));
+}
+
+/**
+ * Mark the occurrences of a byte in a vector.
+ * @param p The address of the vector.
+ * @param pattern The byte in every lane.
+ * @return A bit for each byte, set for occurrences.
+ */
+auto MatchMaskSse2(const unsigned char *p, __m128i pattern) -> unsigned {
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, pattern)));
+}
+
+auto StrlenSse2(const char *s) -> size_t {
+  auto address = reinterpret_cast<uintptr_t>(s);
+  const char *block = reinterpret_cast<const char *>(address & ~uintptr_t{15});
+  unsigned mask = ZeroMaskSse2(block) >> (address & 15);
+  if (mask != 0) {
+    return static_cast<size_t>(__builtin_ctz(mask));
+  }
+  // Single vectors up to a 64-byte boundary, so the four vectors of an iteration lie on one page
+  for (block += 16; (reinterpret_cast<uintptr_t>(block) & 63) != 0; block += 16) {
+    mask = ZeroMaskSse2(block);
+    if (mask != 0) {
+      return static_cast<size_t>(block - s) + __builtin_ctz(mask);
+    }
+  }
+  for (;; block += 64) {
+    const auto *vectors = reinterpret_cast<const __m128i *>(block);
+    __m128i low = _mm_min_epu8(_mm_load_si128(vectors), _mm_load_si128(vectors + 1));
+    __m128i high = _mm_min_epu8(_mm_load_si128(vectors + 2), _mm_load_si128(vectors + 3));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(low, high), _mm_setzero_si128())) != 0) {
+      break;
+    }
+  }
+  for (;; block += 16) {
+    mask = ZeroMaskSse2(block);
+    if (mask != 0) {
+      return static_cast<size_t>(block - s) + __builtin_ctz(mask);
+    }
+  }
+}
+
+auto MemchrSse2(const void *s, int c, size_t n) -> const void * {
+  if (n < 16) {
+    return MemchrScalar(s, c, n);
+  }
+  const auto *p = static_cast<const unsigned char *>(s);
+  __m128i pattern = _mm_set1_epi8(static_cast<char>(c));
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    const auto *vectors = reinterpret_cast<const __m128i *>(p + i);
+    __m128i low = _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(vectors), pattern),
+                               _mm_cmpeq_epi8(_mm_loadu_si128(vectors + 1), pattern));
+    __m128i high = _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(vectors + 2), pattern),
+                                _mm_cmpeq_epi8(_mm_loadu_si128(vectors + 3), pattern));
+    if (_mm_movemask_epi8(_mm_or_si128(low, high)) != 0) {
+      break;
+    }
+  }
+  for (; i + 16 <= n; i += 16) {
+    unsigned mask = MatchMaskSse2(p + i, pattern);
+    if (mask != 0) {
+      return p + i + __builtin_ctz(mask);
+    }
+  }
+  if (i < n) {
+    unsigned mask = MatchMaskSse2(p + n - 16, pattern);
+    if (mask != 0) {
+      return p + n - 16 + __builtin_ctz(mask);
+    }
+  }
+  return nullptr;
+}
+
+auto MemcpySse2(void *dst, const void *src, size_t n) -> void * {
+  auto *d = static_cast<unsigned char *>(dst);
+  const auto *s = static_cast<const unsigned char *>(src);
+  if (n < 16) {
+    CopySmall(d, s, n);
+    return dst;
+  }
+  __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + n - 16));
+  for (size_t i = 0; i + 16 < n; i += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(d + i), _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(d + n - 16), tail);
+  return dst;
+}
+
+constexpr Kernels SSE2 = {SCPRT_ISA_SSE2, StrlenSse2, MemchrSse2, MemcpySse2};
+
+__attribute__((target("avx2"))) auto ZeroMaskAvx2(const char *block) -> unsigned {
+  __m256i bytes = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+  return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_setzero_si256())));
+}
+
+__attribute__((target("avx2"))) auto MatchMaskAvx2(const unsigned char *p, __m256i pattern) -> unsigned {
+  __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, pattern)));
+}
+
+__attribute__((target("avx2"))) auto StrlenAvx2(const char *s) -> size_t {
+  auto address = reinterpret_cast<uintptr_t>(s);
+  const char *block = reinterpret_cast<const char *>(address & ~uintptr_t{31});
+  unsigned mask = ZeroMaskAvx2(block) >> (address & 31);
+  if (mask != 0) {
+    return static_cast<size_t>(__builtin_ctz(mask));
+  }
+  for (block += 32; (reinterpret_cast<uintptr_t>(block) & 127) != 0; block += 32) {
+    mask = ZeroMaskAvx2(block);
+    if (mask != 0) {
+      return static_cast<size_t>(block - s) + __builtin_ctz(mask);
+    }
+  }
+  for (;; block += 128) {
+    const auto *vectors = reinterpret_cast<const __m256i *>(block);
+    __m256i low = _mm256_min_epu8(_mm256_load_si256(vectors), _mm256_load_si256(vectors + 1));
+    __m256i high = _mm256_min_epu8(_mm256_load_si256(vectors + 2), _mm256_load_si256(vectors + 3));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(low, high), _mm256_setzero_si256())) != 0) {
+      break;
+    }
+  }
+  for (;; block += 32) {
+    mask = ZeroMaskAvx2(block);
+    if (mask != 0) {
+      return static_cast<size_t>(block - s) + __builtin_ctz(mask);
+    }
+  }
+}
+
+__attribute__((target("avx2"))) auto MemchrAvx2(const void *s, int c, size_t n) -> const void * {
+  if (n < 32) {
+    return MemchrSse2(s, c, n);
+  }
+  const auto *p = static_cast<const unsigned char *>(s);
+  __m256i pattern = _mm256_set1_epi8(static_cast<char>(c));
+  size_t i = 0;
+  for (; i + 128 <= n; i += 128) {
+    const auto *vectors = reinterpret_cast<const __m256i *>(p + i);
+    __m256i low = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(vectors), pattern),
+                                  _mm256_cmpeq_epi8(_mm256_loadu_si256(vectors + 1), pattern));
+    __m256i high = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(vectors + 2), pattern),
+                                   _mm256_cmpeq_epi8(_mm256_loadu_si256(vectors + 3), pattern));
+    if (_mm256_movemask_epi8(_mm256_or_si256(low, high)) != 0) {
+      break;
+    }
+  }
+  for (; i + 32 <= n; i += 32) {
+    unsigned mask = MatchMaskAvx2(p + i, pattern);
+    if (mask != 0) {
+      return p + i + __builtin_ctz(mask);
+    }
+  }
+  if (i < n) {
+    unsigned mask = MatchMaskAvx2(p + n - 32, pattern);
+    if (mask != 0) {
+      return p + n - 32 + __builtin_ctz(mask);
+    }
+  }
+  return nullptr;
+}
+
+__attribute__((target("avx2"))) auto MemcpyAvx2(void *dst, const void *src, size_t n) -> void * {
+  if (n < 32) {
+    return MemcpySse2(dst, src, n);
+  }
+  auto *d = static_cast<unsigned char *>(dst);
+  const auto *s = static_cast<const unsigned char *>(src);
+  __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + n - 32));
+  for (size_t i = 0; i + 32 < n; i += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(d + i),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i)));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(d + n - 32), tail);
+  return dst;
+}
+
+constexpr Kernels AVX2 = {SCPRT_ISA_AVX2, StrlenAvx2, MemchrAvx2, MemcpyAvx2};
+
+/**
+ * Check that the kernel saves the AVX registers on context switches.
+ * @return Whether it does.
+ */
+auto OsSavesYmm() -> bool {
+  uint32_t low;
+  uint32_t high;
+  asm volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (low & 0x6) == 0x6;
+}
+
+#endif
+
+/* The loops in use, null until the first call picks them */
+const Kernels *selected = nullptr;
+
+/**
+ * Get the loops of an instruction set.
+ * @param isa The instruction set.
+ * @return The loops, or nullptr if the build has none for it.
+ */
+auto KernelsOf(scprt_isa isa) -> const Kernels * {
+  switch (isa) {
+    case SCPRT_ISA_SCALAR:
+      return &SCALAR;
+#if defined(__x86_64__)
+    case SCPRT_ISA_SSE2:
+      return &SSE2;
+    case SCPRT_ISA_AVX2:
+      return &AVX2;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * Get the loops in use, picking them on the first call. Threads racing on the first call pick the same loops.
+ * @return The loops.
+ */
+auto GetKernels() -> const Kernels * {
+  const Kernels *kernels = __atomic_load_n(&selected, __ATOMIC_ACQUIRE);
+  if (kernels == nullptr) {
+    kernels = KernelsOf(scprt_detect_isa());
+    __atomic_store_n(&selected, kernels, __ATOMIC_RELEASE);
+  }
+  return kernels;
+}
+
+}  // namespace
+
+}  // namespace scp::runtime
+
+using scp::runtime::GetKernels;
+
+extern "C" auto scprt_detect_isa() -> scprt_isa {
+#if defined(__x86_64__)
+  unsigned eax;
+  unsigned ebx;
+  unsigned ecx;
+  unsigned edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return SCPRT_ISA_SSE2;
+  }
+  bool avx = (ecx & bit_OSXSAVE) != 0 && (ecx & bit_AVX) != 0 && scp::runtime::OsSavesYmm();
+  if (avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ebx & bit_AVX2) != 0) {
+    return SCPRT_ISA_AVX2;
+  }
+  // x86-64 always has SSE2
+  return SCPRT_ISA_SSE2;
+#else
+  return SCPRT_ISA_SCALAR;
+#endif
+}
+
+extern "C" auto scprt_get_isa() -> scprt_isa { return GetKernels()->isa_; }
+
+extern "C" auto scprt_set_isa(scprt_isa isa) -> int {
+  const auto *kernels = scp::runtime::KernelsOf(isa);
+  if (kernels == nullptr || isa > scprt_detect_isa()) {
+    return 0;
+  }
+  __atomic_store_n(&scp::runtime::selected, kernels, __ATOMIC_RELEASE);
+  return 1;
+}
+
+extern "C" auto scprt_strlen(const char *s) -> size_t { return GetKernels()->strlen_(s); }
+
+extern "C" auto scprt_memchr(const void *s, int c, size_t n) -> const void * { return GetKernels()->memchr_(s, c, n); }
+
+extern "C" auto scprt_memcpy(void *dst, const void *src, size_t n) -> void * {
+  return GetKernels()->memcpy_(dst, src, n);
+}
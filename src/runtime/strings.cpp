@@ -0,0 +1,118 @@
+#include "runtime/scprt.h"
+
+namespace scp::runtime {
+
+namespace {
+
+/* The two digits of every number below 100 */
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+}  // namespace
+
+}  // namespace scp::runtime
+
+extern "C" auto scprt_concat(char *out, size_t capacity, const char *left, const char *right) -> size_t {
+  size_t room = capacity - 1;
+  size_t left_length = scprt_strlen(left);
+  if (left_length > room) {
+    left_length = room;
+  }
+  size_t right_length = scprt_strlen(right);
+  if (right_length > room - left_length) {
+    right_length = room - left_length;
+  }
+  // `a <- a + b` concatenates into the buffer a already lies in
+  if (out != left) {
+    scprt_memcpy(out, left, left_length);
+  }
+  scprt_memcpy(out + left_length, right, right_length);
+  out[left_length + right_length] = '\0';
+  return left_length + right_length;
+}
+
+extern "C" auto scprt_repeat(char *out, size_t capacity, const char *s, int32_t count) -> size_t {
+  size_t length = scprt_strlen(s);
+  if (count <= 0 || length == 0) {
+    out[0] = '\0';
+    return 0;
+  }
+  size_t room = capacity - 1;
+  size_t total = static_cast<size_t>(count) > room / length ? room : length * static_cast<size_t>(count);
+  size_t first = length < total ? length : total;
+  if (out != s) {
+    scprt_memcpy(out, s, first);
+  }
+  // Each copy doubles what is there, so a repeat takes log2(count) calls of the copy loop
+  for (size_t done = first; done < total;) {
+    size_t chunk = done < total - done ? done : total - done;
+    scprt_memcpy(out + done, out, chunk);
+    done += chunk;
+  }
+  out[total] = '\0';
+  return total;
+}
+
+extern "C" auto scprt_trim_newline(char *s, size_t n) -> size_t {
+  const auto *newline = static_cast<const char *>(scprt_memchr(s, '\n', n));
+  if (newline != nullptr) {
+    n = static_cast<size_t>(newline - s);
+  }
+  const auto *carriage_return = static_cast<const char *>(scprt_memchr(s, '\r', n));
+  if (carriage_return != nullptr) {
+    n = static_cast<size_t>(carriage_return - s);
+  }
+  s[n] = '\0';
+  return n;
+}
+
+extern "C" auto scprt_parse_int(const char *s, size_t n) -> int32_t {
+  size_t i = 0;
+  while (i < n && (s[i] == ' ' || (s[i] >= '\t' && s[i] <= '\r'))) {
+    i++;
+  }
+  bool negative = i < n && s[i] == '-';
+  if (i < n && (s[i] == '-' || s[i] == '+')) {
+    i++;
+  }
+  uint32_t value = 0;
+  for (; i < n && s[i] >= '0' && s[i] <= '9'; i++) {
+    value = value * 10 + static_cast<uint32_t>(s[i] - '0');
+  }
+  return static_cast<int32_t>(negative ? 0U - value : value);
+}
+
+extern "C" auto scprt_format_int(int32_t value, char *out) -> size_t {
+  auto magnitude = static_cast<uint32_t>(value);
+  if (value < 0) {
+    magnitude = 0U - magnitude;
+  }
+  // Digits go right to left into a scratch buffer, two at a time
+  char digits[SCPRT_INT_CHARS];
+  char *p = digits + sizeof(digits);
+  while (magnitude >= 100) {
+    uint32_t pair = magnitude % 100;
+    magnitude /= 100;
+    p -= 2;
+    p[0] = scp::runtime::DIGIT_PAIRS[pair * 2];
+    p[1] = scp::runtime::DIGIT_PAIRS[pair * 2 + 1];
+  }
+  if (magnitude >= 10) {
+    p -= 2;
+    p[0] = scp::runtime::DIGIT_PAIRS[magnitude * 2];
+    p[1] = scp::runtime::DIGIT_PAIRS[magnitude * 2 + 1];
+  } else {
+    *--p = static_cast<char>('0' + magnitude);
+  }
+  if (value < 0) {
+    *--p = '-';
+  }
+  auto length = static_cast<size_t>(digits + sizeof(digits) - p);
+  for (size_t i = 0; i < length; i++) {
+    out[i] = p[i];
+  }
+  out[length] = '\0';
+  return length;
+}
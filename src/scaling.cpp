@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "driver/compile_report.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+#include "workload/program_generator.h"
+#include "workload/scaling_fit.h"
+
+namespace {
+
+// The measured phases; "free" is the destruction of the parse tree, AST and type environment
+const std::vector<std::string> PHASES = {"lex", "parse", "typecheck", "codegen", "free"};
+
+/**
+ * The best of the repeated measurements of one program size.
+ */
+struct Sample {
+  /* Number of statements */
+  size_t statements_{0};
+  /* Fastest wall-clock time of each phase in seconds, in the order of PHASES */
+  std::vector<double> seconds_;
+  /* Heap high-water mark of the compilation in bytes */
+  uint64_t peak_bytes_{0};
+};
+
+/**
+ * Compile a program once, measuring every phase.
+ * @param source The program.
+ * @param options The code generator options.
+ * @return The report, with one phase per entry of PHASES.
+ */
+auto CompileOnce(const std::string &source, const scp::cgen::CodeGeneratorOptions &options)
+    -> scp::driver::CompileReport {
+  scp::driver::CompileReport report;
+  std::optional<scp::driver::PhaseTimer> free_timer;
+  {
+    scp::driver::PhaseTimer lex_timer(&report, "lex");
+    scp::parser::SLRParser parser("scaling");
+    parser.SetInput(source);
+    if (!parser.Lex()) {
+      throw std::runtime_error("Failed to tokenize the generated program");
+    }
+    lex_timer.Stop();
+
+    scp::driver::PhaseTimer parse_timer(&report, "parse");
+    auto ast = parser.Parse();
+    if (!ast) {
+      throw std::runtime_error("Failed to parse the generated program");
+    }
+    parse_timer.Stop();
+
+    scp::driver::PhaseTimer check_timer(&report, "typecheck");
+    scp::semant::TypeChecker type_checker(ast);
+    auto type_environment = type_checker.CheckType();
+    check_timer.Stop();
+
+    scp::driver::PhaseTimer codegen_timer(&report, "codegen");
+    scp::cgen::CodeGenerator code_generator(ast, type_environment, options);
+    code_generator.GenerateCode();
+    codegen_timer.Stop();
+
+    free_timer.emplace(&report, "free");
+  }
+  free_timer->Stop();
+  return report;
+}
+
+/**
+ * Get the program sizes to measure, evenly spaced on a logarithmic scale.
+ * @param min The smallest size.
+ * @param max The largest size.
+ * @param steps_per_decade The number of sizes per factor of ten.
+ * @return The sizes.
+ */
+auto GetSizes(size_t min, size_t max, size_t steps_per_decade) -> std::vector<size_t> {
+  std::vector<size_t> sizes;
+  for (size_t step = 0;; step++) {
+    double factor = std::pow(10.0, static_cast<double>(step) / static_cast<double>(steps_per_decade));
+    auto size = static_cast<size_t>(std::llround(static_cast<double>(min) * factor));
+    if (size > max) {
+      break;
+    }
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+/**
+ * Print the usage information for the scaling benchmark.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " [options] [--<knob> <value>]..." << std::endl;
+  std::cout << "  Compile generated programs of growing size, fit the time of each phase and the heap" << std::endl;
+  std::cout << "  peak to c * n^k over the number of statements n, and fail if any k exceeds the limit" << std::endl;
+  std::cout << "  --min <N>: Smallest program (default 1000 statements)" << std::endl;
+  std::cout << "  --max <N>: Largest program (default 100000 statements, up to 10000000)" << std::endl;
+  std::cout << "  --steps <N>: Sizes per factor of ten (default 2)" << std::endl;
+  std::cout << "  --repeat <N>: Compilations per size, the fastest counts (default 3)" << std::endl;
+  std::cout << "  --max-exponent <k>: Largest accepted growth exponent (default 1.25)" << std::endl;
+  std::cout << "  -O0/-O1/-O2: Optimization level of the code generator" << std::endl;
+  std::cout << "  Knobs are those of scp-gen, except --statements" << std::endl;
+}
+
+}  // namespace
+
+/**
+ * Main entry point for the scaling benchmark.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code: 1 if a phase grows faster than the limit.
+ */
+auto main(int argc, char *argv[]) -> int {
+  size_t min = 1000;
+  size_t max = 100000;
+  size_t steps = 2;
+  size_t repeat = 3;
+  double max_exponent = 1.25;
+  scp::workload::GeneratorOptions generator_options;
+  scp::cgen::CodeGeneratorOptions options;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    } else if (arg == "--min" && has_value) {
+      min = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--max" && has_value) {
+      max = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--steps" && has_value) {
+      steps = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--repeat" && has_value) {
+      repeat = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--max-exponent" && has_value) {
+      max_exponent = std::strtod(argv[++i], nullptr);
+    } else if (arg == "-O0") {
+      options.apply_peephole_rules_ = false;
+      options.eliminate_redundant_loads_ = false;
+      options.schedule_instructions_ = false;
+    } else if (arg == "-O1") {
+      options.apply_peephole_rules_ = true;
+      options.eliminate_redundant_loads_ = true;
+      options.schedule_instructions_ = false;
+    } else if (arg == "-O2") {
+      options.apply_peephole_rules_ = true;
+      options.eliminate_redundant_loads_ = true;
+      options.schedule_instructions_ = true;
+    } else if (arg.rfind("--", 0) == 0 && arg != "--statements" && has_value &&
+               scp::workload::SetGeneratorOption(generator_options, arg.substr(2), argv[i + 1])) {
+      i++;
+    } else {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (min == 0 || max < min || steps == 0 || repeat == 0) {
+    std::cerr << "Error: Need 0 < --min <= --max and positive --steps and --repeat." << std::endl;
+    return 1;
+  }
+  auto sizes = GetSizes(min, max, steps);
+  if (sizes.size() < 2) {
+    std::cerr << "Error: Fitting needs at least two sizes, raise --max or --steps." << std::endl;
+    return 1;
+  }
+
+  std::cout << std::left << std::setw(12) << "statements";
+  for (const auto &phase : PHASES) {
+    std::cout << std::right << std::setw(14) << phase + " ms";
+  }
+  std::cout << std::setw(12) << "total ms" << std::setw(12) << "peak MiB" << std::endl;
+
+  std::vector<Sample> samples;
+  std::cout << std::fixed;
+  for (auto size : sizes) {
+    generator_options.statements_ = size;
+    std::string source = scp::workload::ProgramGenerator(generator_options).Generate();
+
+    Sample sample{size, std::vector<double>(PHASES.size(), 0), 0};
+    for (size_t run = 0; run < repeat; run++) {
+      scp::driver::CompileReport report;
+      try {
+        report = CompileOnce(source, options);
+      } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << " (" << size << " statements)" << std::endl;
+        return 1;
+      }
+      for (size_t p = 0; p < PHASES.size(); p++) {
+        double seconds = report.phases_[p].wall_seconds_;
+        sample.seconds_[p] = run == 0 ? seconds : std::min(sample.seconds_[p], seconds);
+        sample.peak_bytes_ = std::max(sample.peak_bytes_, report.phases_[p].peak_bytes_);
+      }
+    }
+    samples.push_back(sample);
+
+    double total = 0;
+    std::cout << std::left << std::setw(12) << size << std::right << std::setprecision(2);
+    for (auto seconds : sample.seconds_) {
+      std::cout << std::setw(14) << seconds * 1e3;
+      total += seconds;
+    }
+    std::cout << std::setw(12) << total * 1e3 << std::setw(12) << sample.peak_bytes_ / 1048576.0 << std::endl;
+  }
+
+  // Fit every column against the number of statements
+  std::vector<std::string> names = PHASES;
+  names.emplace_back("total");
+  names.emplace_back("peak heap");
+  std::vector<double> x;
+  std::vector<std::vector<double>> columns(names.size());
+  for (const auto &sample : samples) {
+    x.push_back(static_cast<double>(sample.statements_));
+    double total = 0;
+    for (size_t p = 0; p < PHASES.size(); p++) {
+      columns[p].push_back(sample.seconds_[p]);
+      total += sample.seconds_[p];
+    }
+    columns[PHASES.size()].push_back(total);
+    columns[PHASES.size() + 1].push_back(static_cast<double>(sample.peak_bytes_));
+  }
+
+  std::cout << std::left << std::setw(12) << "exponent" << std::right << std::setprecision(2);
+  std::vector<std::string> failures;
+  for (size_t c = 0; c < names.size(); c++) {
+    auto law = scp::workload::FitPowerLaw(x, columns[c]);
+    std::cout << std::setw(c < PHASES.size() ? 14 : 12) << law.exponent_;
+    if (law.exponent_ > max_exponent) {
+      std::ostringstream failure;
+      failure << std::fixed << std::setprecision(2) << names[c] << " grows as n^" << law.exponent_;
+      failures.push_back(failure.str());
+    }
+  }
+  std::cout << std::endl;
+
+  for (const auto &failure : failures) {
+    std::cerr << "Error: " << failure << ", above the limit of n^" << max_exponent << "." << std::endl;
+  }
+  return failures.empty() ? 0 : 1;
+}
@@ -1,9 +1,32 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "cgen/asm_stats.h"
 #include "cgen/code_generator.h"
+#include "cgen/instruction_buffer.h"
+#include "cgen/linker.h"
+#include "cgen/object_unit.h"
+#include "cgen/one_pass_compiler.h"
+#include "core/trace.h"
+#include "driver/batch_compiler.h"
+#include "driver/checkpoint.h"
+#include "driver/compilation_cache.h"
+#include "driver/compile.h"
+#include "driver/compile_report.h"
+#include "driver/compile_server.h"
+#include "driver/memory_accounting.h"
 #include "parser/slr_parser.h"
 #include "semant/type_checker.h"
 
@@ -14,31 +37,410 @@ namespace fs = std::filesystem;
  * @param programName The name of the program (usually argv[0]).
  */
 void PrintUsage(const std::string &programName) {
-  std::cout << "Usage: " << programName << " <input_file> [-o <output_file>]" << std::endl;
+  std::cout << "Usage: " << programName << " <input_file> [-o <output_file>] [-O0|-O1|-O2] [--noreorder]"
+            << " [--string-runtime <flat|rope>] [--asm-stats]" << std::endl;
+  std::cout << "       " << programName << " <input_file> [--time-report] [--mem-report] [--stats] [--trace=<file>]"
+            << " [--report-format <text|json>]" << std::endl;
+  std::cout << "       " << programName << " --stream <input_file> [-o <output_file>] [options]" << std::endl;
+  std::cout << "       " << programName << " --one-pass <input_file> [-o <output_file>] [options]" << std::endl;
+  std::cout << "       " << programName << " --incremental <input_file> [-o <output_file>] [options]" << std::endl;
+  std::cout << "       " << programName
+            << " -c <input_file>... [-o <unit_file> | -d <output_dir>] [--string-runtime <r>]" << std::endl;
+  std::cout << "       " << programName << " --link <unit_file>... [-o <output_file>] [-O0|-O1|-O2] [--noreorder]"
+            << std::endl;
+  std::cout << "       " << programName << " -j <N> <input_file>... [@<response_file>] [-d <output_dir>] [options]"
+            << std::endl;
+  std::cout << "       " << programName << " [--cache-dir <dir>] [--cache-size <MiB>] [--no-cache] [--cache-stats]"
+            << std::endl;
+  std::cout << "       " << programName << " --server [--socket <path>] [-j <N>] | --server-stop [--socket <path>]"
+            << std::endl;
+  std::cout << "       " << programName << " --client [--socket <path>] <input_file> [options]" << std::endl;
   std::cout << "  input_file: Path to the source file to compile" << std::endl;
+  std::cout << "  -j <N>: Compile several files on N threads, 1 to 1024 (default: one per core)" << std::endl;
+  std::cout << "  @<response_file>: Compile every file listed in the response file, one per line" << std::endl;
+  std::cout << "  -d <output_dir>: Write <name>.s of every input into output_dir (default: next to each input)"
+            << std::endl;
   std::cout << "  -o <output_file>: Specify output file for generated assembly code" << std::endl;
   std::cout << "                    If not specified, output to standard console" << std::endl;
+  std::cout << "  -O0, -O1, -O2: Optimization level (default -O1, redundant load elimination)" << std::endl;
+  std::cout << "                    -O1 and -O2 also rewrite multiplications by constants into shifts and adds"
+            << std::endl;
+  std::cout << "                    -O2 also schedules instructions to hide load-use latency" << std::endl;
+  std::cout << "  --noreorder: Emit .set noreorder code with filled delay slots" << std::endl;
+  std::cout << "               (run with spim -delayed_branches -delayed_loads)" << std::endl;
+  std::cout << "  --string-runtime <flat|rope>: String representation of the generated program" << std::endl;
+  std::cout << "                    flat (default) copies into buffers, rope builds concat/repeat nodes in O(1)"
+            << std::endl;
+  std::cout << "  --asm-stats: Print instruction mix, memory share and segment sizes of the output to stderr"
+            << std::endl;
+  std::cout << "  --stream: Compile statement by statement, writing assembly as it is generated, so memory is bounded"
+            << std::endl;
+  std::cout << "            by the largest statement (no cache, server or --asm-stats/--stats)" << std::endl;
+  std::cout << "  --one-pass: Type-check and generate code while parsing, without building an AST (same output)"
+            << std::endl;
+  std::cout << "  --pipeline: Lex on a separate thread that feeds the parser through a lock-free token ring"
+            << std::endl;
+  std::cout << "  --incremental: Compile only the statements appended since the last compile, resuming from the"
+            << std::endl;
+  std::cout << "                 checkpoint <input_file>.ckpt (same output)" << std::endl;
+  std::cout << "  -c: Compile each input into an object unit <name>.scpo, in program order, skipping unchanged units"
+            << std::endl;
+  std::cout << "  --link: Link object units, in program order, into one program" << std::endl;
+  std::cout << "  --time-report: Print wall and CPU time of every phase to stderr" << std::endl;
+  std::cout << "  --mem-report: Print allocations, bytes and heap high-water mark of every phase and the peak RSS"
+            << std::endl;
+  std::cout << "  --trace=<file>: Write Chrome trace events of every phase to file (chrome://tracing, Perfetto)"
+            << std::endl;
+  std::cout << "  --stats: Print the sizes of tokens, trees, symbols and output to stderr" << std::endl;
+  std::cout << "  --report-format <text|json>: Format of the reports (default text)" << std::endl;
+  std::cout << "                    Reports measure a full compilation, bypassing the cache and server" << std::endl;
+  std::cout << "  --cache-dir <dir>: Directory of the compilation cache" << std::endl;
+  std::cout << "                    (default $SCP_CACHE_DIR, $XDG_CACHE_HOME/scp or ~/.cache/scp)" << std::endl;
+  std::cout << "  --cache-size <MiB>: Size limit of the cache, least recently used entries are evicted (default 64)"
+            << std::endl;
+  std::cout << "  --no-cache: Always compile, neither reading nor writing the cache" << std::endl;
+  std::cout << "  --cache-stats: Print the hit and miss counts and size of the cache" << std::endl;
+  std::cout << "  --server: Keep a compiler running and answer requests on a Unix domain socket" << std::endl;
+  std::cout << "  --server-stop: Ask the running server to shut down" << std::endl;
+  std::cout << "  --client: Compile through the running server, or in-process if none answers" << std::endl;
+  std::cout << "  --socket <path>: Socket of the server (default $SCP_SERVER_SOCKET, $XDG_RUNTIME_DIR/scp-server.sock"
+            << std::endl;
+  std::cout << "                    or /tmp/scp-<uid>/server.sock)" << std::endl;
 }
 
 /**
- * Read the contents of a file into a string.
- * @param filename The name of the file to read.
- * @return The contents of the file as a string.
+ * Run the compile server until a shutdown request arrives.
+ * @param socket_path The path of the socket.
+ * @param jobs The number of threads.
+ * @param cache The compilation cache, or nullptr.
+ * @return Exit status code.
+ */
+auto RunServer(const std::string &socket_path, size_t jobs, scp::driver::CompilationCache *cache) -> int {
+  scp::driver::CompileServer server(socket_path, jobs, cache);
+  std::string error;
+  if (!server.Start(error)) {
+    std::cerr << "Error: " << error << std::endl;
+    return 1;
+  }
+  std::cout << "Listening on " << socket_path << " with " << jobs << " thread(s)" << std::endl;
+  server.Serve();
+  std::cout << "Served " << server.GetRequestCount() << " request(s)" << std::endl;
+  return 0;
+}
+
+/**
+ * Compile several files concurrently and report the errors of each.
+ * @param inputs The source files.
+ * @param output_dir The output directory, or empty.
+ * @param jobs The number of threads.
+ * @param options The code generator options.
+ * @param cache The compilation cache, or nullptr.
+ * @return Exit status code, non-zero if any file failed.
+ */
+auto CompileBatch(const std::vector<std::string> &inputs, const std::string &output_dir, size_t jobs,
+                  const scp::cgen::CodeGeneratorOptions &options, scp::driver::CompilationCache *cache) -> int {
+  scp::driver::BatchCompiler compiler(options, jobs, cache);
+  auto results = compiler.Compile(inputs, output_dir);
+
+  size_t failed = 0;
+  size_t cached = 0;
+  for (const auto &result : results) {
+    if (!result.success_) {
+      failed++;
+      std::cerr << result.input_ << ": compilation failed" << std::endl << result.diagnostics_;
+      continue;
+    }
+    if (!result.diagnostics_.empty()) {
+      std::cerr << result.input_ << ": " << result.diagnostics_;
+    }
+    if (result.cached_) {
+      cached++;
+    }
+  }
+  std::cout << "Compiled " << results.size() - failed << " of " << results.size() << " file(s)";
+  if (cache != nullptr) {
+    std::cout << ", " << cached << " from cache";
+  }
+  std::cout << std::endl;
+  return failed == 0 ? 0 : 1;
+}
+
+/**
+ * Compile one file statement by statement, writing the assembly as it is generated.
+ * @param filename The source file.
+ * @param output_file The output file, or empty to print to the console.
+ * @param options The code generator options.
+ * @param pipelined Whether to lex on a separate thread.
+ * @return Exit status code.
+ */
+auto CompileStreaming(const std::string &filename, const std::string &output_file,
+                      const scp::cgen::CodeGeneratorOptions &options, bool pipelined) -> int {
+  std::ifstream input(filename, std::ios::binary);
+  if (!input.is_open()) {
+    std::cerr << "Error: Cannot open file: " << filename << std::endl;
+    return 1;
+  }
+  std::string name = fs::path(filename).stem().string();
+  scp::parser::SLRParser parser(name);
+  parser.SetPipelined(pipelined);
+  if (output_file.empty()) {
+    auto result = scp::driver::CompileStream(parser, name, input, std::cout, options);
+    std::cerr << result.diagnostics_;
+    return result.success_ ? 0 : 1;
+  }
+
+  // Write next to the output and rename on success, so a failed compilation leaves no partial file behind
+  std::string partial_file = output_file + ".partial";
+  std::ofstream output(partial_file);
+  if (!output.is_open()) {
+    std::cerr << "Error: Cannot open output file: " << output_file << std::endl;
+    return 1;
+  }
+  auto result = scp::driver::CompileStream(parser, name, input, output, options);
+  output.close();
+  std::cerr << result.diagnostics_;
+  std::error_code error;
+  if (!result.success_ || !output) {
+    fs::remove(partial_file, error);
+    return 1;
+  }
+  fs::rename(partial_file, output_file, error);
+  if (error) {
+    std::cerr << "Error: Cannot write output file: " << output_file << std::endl;
+    return 1;
+  }
+  std::cout << "Assembly code generated successfully to: " << output_file << std::endl;
+  return 0;
+}
+
+/**
+ * Compile source files into object units in program order. A unit is reused when its source, the compiler and the
+ * string runtime are unchanged and the earlier units still declare the variables it relies on, with the same types.
+ * @param inputs The source files, in program order.
+ * @param output_dir The directory of the units, or empty to write <name>.scpo next to each input.
+ * @param output_file The unit file of a single input, or empty.
+ * @param options The code generator options.
+ * @return Exit status code.
  */
-auto ReadFile(const std::string &filename) -> std::string {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
-    throw std::runtime_error("Cannot open file: " + filename);
+auto CompileUnits(const std::vector<std::string> &inputs, const std::string &output_dir,
+                  const std::string &output_file, const scp::cgen::CodeGeneratorOptions &options) -> int {
+  scp::cgen::ObjectUnit::Symbols environment;
+  std::unordered_map<std::string, scp::core::Type> declared = {{"stdin", scp::core::Type::IN_STREAM},
+                                                                {"stdout", scp::core::Type::OUT_STREAM}};
+  scp::parser::SLRParser parser("");
+  if (!output_dir.empty()) {
+    std::error_code error;
+    fs::create_directories(output_dir, error);
+  }
+  for (const auto &input : inputs) {
+    fs::path unit_path = !output_file.empty()  ? fs::path(output_file)
+                         : output_dir.empty() ? fs::path(input).replace_extension(".scpo")
+                                              : fs::path(output_dir) / (fs::path(input).stem().string() + ".scpo");
+    std::string source;
+    try {
+      source = scp::driver::ReadSource(input);
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return 1;
+    }
+    if (source.empty()) {
+      std::cout << input << ": " << scp::driver::EMPTY_INPUT_WARNING << std::endl;
+      continue;
+    }
+
+    scp::cgen::ObjectUnit unit;
+    bool reused = false;
+    std::ifstream existing(unit_path, std::ios::binary);
+    if (existing.is_open()) {
+      std::stringstream bytes;
+      bytes << existing.rdbuf();
+      try {
+        unit = scp::cgen::ObjectUnit::Deserialize(bytes.str());
+        reused = unit.key_ == scp::driver::GetUnitKey(source, options) &&
+                 scp::cgen::Linker::FindConflict(unit, declared).empty();
+      } catch (const std::exception &) {
+        reused = false;  // Written by another version, compile it again
+      }
+    }
+
+    if (reused) {
+      std::cout << "Up to date: " << unit_path.string() << std::endl;
+    } else {
+      auto result =
+          scp::driver::CompileUnit(parser, fs::path(input).stem().string(), source, environment, options, unit);
+      std::cerr << result.diagnostics_;
+      if (!result.success_) {
+        return 1;
+      }
+      std::ofstream output(unit_path, std::ios::binary);
+      output << unit.Serialize();
+      if (!output) {
+        std::cerr << "Error: Cannot write unit file: " << unit_path.string() << std::endl;
+        return 1;
+      }
+      std::cout << "Compiled: " << unit_path.string() << std::endl;
+    }
+    for (const auto &symbol : unit.exports_) {
+      environment.push_back(symbol);
+      declared.insert(symbol);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Link object units into one program.
+ * @param inputs The unit files, in program order.
+ * @param output_file The output file, or empty to print to the console.
+ * @param options The code generator options; the string runtime is taken from the units.
+ * @return Exit status code.
+ */
+auto LinkUnits(const std::vector<std::string> &inputs, const std::string &output_file,
+               scp::cgen::CodeGeneratorOptions options) -> int {
+  std::string code;
+  try {
+    std::vector<scp::cgen::ObjectUnit> units;
+    for (const auto &input : inputs) {
+      std::ifstream file(input, std::ios::binary);
+      if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + input);
+      }
+      std::stringstream bytes;
+      bytes << file.rdbuf();
+      units.push_back(scp::cgen::ObjectUnit::Deserialize(bytes.str()));
+    }
+    if (!units.empty()) {
+      options.string_runtime_ = units.front().string_runtime_;
+    }
+    scp::cgen::Linker linker(options);
+    for (size_t i = 0; i < units.size(); i++) {
+      linker.AddUnit(inputs[i], std::move(units[i]));
+    }
+    code = linker.Link();
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (output_file.empty()) {
+    std::cout << code << std::endl;
+    return 0;
+  }
+  std::ofstream output(output_file);
+  if (!output.is_open()) {
+    std::cerr << "Error: Cannot open output file: " << output_file << std::endl;
+    return 1;
+  }
+  output << code << std::endl;
+  std::cout << "Assembly code generated successfully to: " << output_file << std::endl;
+  return 0;
+}
+
+/**
+ * Compile a file that only grows at its end, compiling only what was appended since the checkpoint of the last
+ * compile, and move the checkpoint forward.
+ * @param filename The source file; its checkpoint is <filename>.ckpt.
+ * @param output_file The output file, or empty to print to the console.
+ * @param options The code generator options.
+ * @param pipelined Whether to lex on a separate thread.
+ * @return Exit status code.
+ */
+auto CompileIncrementally(const std::string &filename, const std::string &output_file,
+                          const scp::cgen::CodeGeneratorOptions &options, bool pipelined) -> int {
+  std::string source;
+  try {
+    source = scp::driver::ReadSource(filename);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  // A missing or unreadable checkpoint only means compiling the whole file
+  std::string checkpoint_file = filename + ".ckpt";
+  scp::driver::Checkpoint checkpoint;
+  std::ifstream existing(checkpoint_file, std::ios::binary);
+  if (existing.is_open()) {
+    std::stringstream bytes;
+    bytes << existing.rdbuf();
+    try {
+      checkpoint = scp::driver::Checkpoint::Deserialize(bytes.str());
+    } catch (const std::exception &) {
+      checkpoint = scp::driver::Checkpoint();
+    }
+  }
+
+  std::string name = fs::path(filename).stem().string();
+  scp::parser::SLRParser parser(name);
+  parser.SetPipelined(pipelined);
+  auto result = scp::driver::CompileIncremental(parser, name, source, options, checkpoint);
+  std::cerr << result.diagnostics_;
+  if (!result.success_) {
+    return 1;
+  }
+
+  // Replace the checkpoint by a rename, so an interrupted write leaves the old one
+  std::string partial_file = checkpoint_file + ".partial";
+  std::ofstream partial(partial_file, std::ios::binary);
+  partial << checkpoint.Serialize();
+  partial.close();
+  std::error_code error;
+  if (partial) {
+    fs::rename(partial_file, checkpoint_file, error);
+  }
+  if (!partial || error) {
+    fs::remove(partial_file, error);
+    std::cerr << "Warning: Cannot write checkpoint file: " << checkpoint_file << std::endl;
+  }
+
+  if (output_file.empty()) {
+    std::cout << result.output_ << std::endl;
+    return 0;
+  }
+  std::ofstream output(output_file);
+  if (!output.is_open()) {
+    std::cerr << "Error: Cannot open output file: " << output_file << std::endl;
+    return 1;
   }
+  output << result.output_ << std::endl;
+  std::cout << "Assembly code generated successfully to: " << output_file << std::endl;
+  return 0;
+}
 
-  std::string content;
-  std::string line;
-  while (std::getline(file, line)) {
-    content += line + "\n";
+/**
+ * Parse a size in MiB into bytes.
+ * @param text The size, decimal digits only.
+ * @return The number of bytes, or std::nullopt if the text is no number or the size does not fit 64 bits.
+ */
+auto ParseMebibytes(const std::string &text) -> std::optional<uint64_t> {
+  if (text.empty() || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+    return std::nullopt;
   }
+  errno = 0;
+  uint64_t mebibytes = std::strtoull(text.c_str(), nullptr, 10);
+  if (errno == ERANGE || mebibytes > (UINT64_MAX >> 20)) {
+    return std::nullopt;
+  }
+  return mebibytes << 20;
+}
+
+/* The largest number of threads -j accepts */
+constexpr size_t MAX_JOBS = 1024;
 
-  file.close();
-  return content;
+/**
+ * Parse a number of threads.
+ * @param text The number, decimal digits only.
+ * @return The number, or std::nullopt if the text is no number or the number is not between 1 and MAX_JOBS.
+ */
+auto ParseJobs(const std::string &text) -> std::optional<size_t> {
+  if (text.empty() || text.size() > 4 ||
+      !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+    return std::nullopt;
+  }
+  size_t jobs = std::strtoul(text.c_str(), nullptr, 10);
+  if (jobs == 0 || jobs > MAX_JOBS) {
+    return std::nullopt;
+  }
+  return jobs;
 }
 
 /**
@@ -49,20 +451,67 @@ auto ReadFile(const std::string &filename) -> std::string {
  */
 auto main(int argc, char *argv[]) -> int {
   // Check command line arguments
-  if (argc < 2 || argc > 4) {
+  if (argc < 2) {
     std::cerr << "Error: Invalid number of arguments." << std::endl;
     PrintUsage(argv[0]);
     return 1;
   }
 
-  std::string filename = argv[1];
+  std::string filename;
+  std::vector<std::string> inputs;
+  std::string output_dir;
+  size_t jobs = 0;
+  bool batch = false;
   std::string output_file;
   bool output_to_file = false;
+  bool asm_stats = false;
+  bool use_cache = true;
+  bool cache_stats = false;
+  bool time_report = false;
+  bool mem_report = false;
+  bool stats = false;
+  bool json_report = false;
+  std::string trace_file;
+  bool server = false;
+  bool server_stop = false;
+  bool client = false;
+  bool stream = false;
+  bool pipelined = false;
+  bool incremental = false;
+  bool compile_units = false;
+  bool link = false;
+  std::string socket_path;
+  std::filesystem::path cache_dir = scp::driver::CompilationCache::GetDefaultDirectory();
+  uint64_t cache_size = scp::driver::CompilationCache::DEFAULT_MAX_BYTES;
+  scp::cgen::CodeGeneratorOptions options;
 
   // Parse command line options
-  for (int i = 2; i < argc; i++) {
+  for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
-    if (arg == "-o") {
+    if (!arg.empty() && arg[0] == '@') {
+      try {
+        auto listed = scp::driver::BatchCompiler::ReadResponseFile(arg.substr(1));
+        inputs.insert(inputs.end(), listed.begin(), listed.end());
+      } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+      }
+      batch = true;
+    } else if (!arg.empty() && arg[0] != '-') {
+      inputs.push_back(arg);
+    } else if (arg == "-j") {
+      auto count = ParseJobs(i + 1 < argc ? argv[++i] : "");
+      if (!count) {
+        std::cerr << "Error: -j expects a number of threads from 1 to " << MAX_JOBS << "." << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      jobs = *count;
+      batch = true;
+    } else if (arg == "-d" && i + 1 < argc) {
+      output_dir = argv[++i];
+      batch = true;
+    } else if (arg == "-o") {
       if (i + 1 < argc) {
         output_file = argv[i + 1];
         output_to_file = true;
@@ -72,6 +521,83 @@ auto main(int argc, char *argv[]) -> int {
         PrintUsage(argv[0]);
         return 1;
       }
+    } else if (arg == "-O0") {
+      options.apply_peephole_rules_ = false;
+      options.eliminate_redundant_loads_ = false;
+      options.schedule_instructions_ = false;
+    } else if (arg == "-O1") {
+      options.apply_peephole_rules_ = true;
+      options.eliminate_redundant_loads_ = true;
+      options.schedule_instructions_ = false;
+    } else if (arg == "-O2") {
+      options.apply_peephole_rules_ = true;
+      options.eliminate_redundant_loads_ = true;
+      options.schedule_instructions_ = true;
+    } else if (arg == "--noreorder") {
+      options.fill_delay_slots_ = true;
+    } else if (arg == "--asm-stats") {
+      asm_stats = true;
+    } else if (arg == "--no-cache") {
+      use_cache = false;
+    } else if (arg == "--cache-stats") {
+      cache_stats = true;
+    } else if (arg == "--time-report") {
+      time_report = true;
+    } else if (arg == "--mem-report") {
+      mem_report = true;
+    } else if (arg == "--stats") {
+      stats = true;
+    } else if (arg == "--report-format") {
+      std::string format = i + 1 < argc ? argv[++i] : "";
+      if (format != "text" && format != "json") {
+        std::cerr << "Error: --report-format expects 'text' or 'json'." << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      json_report = format == "json";
+    } else if (arg.rfind("--trace=", 0) == 0) {
+      trace_file = arg.substr(8);
+    } else if (arg == "--server") {
+      server = true;
+    } else if (arg == "--server-stop") {
+      server_stop = true;
+    } else if (arg == "--client") {
+      client = true;
+    } else if (arg == "--stream") {
+      stream = true;
+    } else if (arg == "--one-pass") {
+      options.one_pass_ = true;
+    } else if (arg == "--pipeline") {
+      pipelined = true;
+    } else if (arg == "--incremental") {
+      incremental = true;
+    } else if (arg == "-c") {
+      compile_units = true;
+    } else if (arg == "--link") {
+      link = true;
+    } else if (arg == "--socket" && i + 1 < argc) {
+      socket_path = argv[++i];
+    } else if (arg == "--cache-dir" && i + 1 < argc) {
+      cache_dir = argv[++i];
+    } else if (arg == "--cache-size") {
+      auto size = ParseMebibytes(i + 1 < argc ? argv[++i] : "");
+      if (!size) {
+        std::cerr << "Error: --cache-size expects a number of MiB." << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      cache_size = *size;
+    } else if (arg == "--string-runtime") {
+      std::string runtime = i + 1 < argc ? argv[++i] : "";
+      if (runtime == "flat") {
+        options.string_runtime_ = scp::cgen::StringRuntime::FLAT;
+      } else if (runtime == "rope") {
+        options.string_runtime_ = scp::cgen::StringRuntime::ROPE;
+      } else {
+        std::cerr << "Error: --string-runtime expects 'flat' or 'rope'." << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+      }
     } else {
       std::cerr << "Error: Unknown option: " << arg << std::endl;
       PrintUsage(argv[0]);
@@ -79,34 +605,236 @@ auto main(int argc, char *argv[]) -> int {
     }
   }
 
-  try {
-    // Read the input file
-    std::string file_content = ReadFile(filename);
+  // Resolving the default socket may create its directory, so only the server modes do it
+  if (socket_path.empty() && (server || server_stop || client)) {
+    socket_path = scp::driver::CompileServer::GetDefaultSocketPath();
+  }
 
-    if (file_content.empty()) {
-      std::cout << "Warning: The input file is empty." << std::endl;
+  std::optional<scp::driver::CompilationCache> cache;
+  if (cache_dir.empty()) {
+    use_cache = false;
+  } else {
+    cache.emplace(cache_dir, cache_size);
+  }
+  if (cache_stats) {
+    auto stats = cache ? cache->GetStats() : scp::driver::CacheStats{};
+    std::cout << "cache directory: " << (cache ? cache_dir.string() : "(none)") << std::endl;
+    std::cout << "hits: " << stats.hits_ << ", misses: " << stats.misses_ << std::endl;
+    std::cout << "entries: " << stats.entries_ << ", bytes: " << stats.bytes_ << std::endl;
+    if (inputs.empty()) {
       return 0;
     }
+  }
+  std::optional<scp::core::TraceSession> trace;
+  if (!trace_file.empty()) {
+#ifdef SCP_ENABLE_TRACING
+    trace.emplace(trace_file);
+#else
+    std::cerr << "Error: --trace needs a build with SCP_ENABLE_TRACING." << std::endl;
+    return 1;
+#endif
+  }
 
-    // Parse the file content
-    fs::path path(filename);
-    scp::parser::SLRParser parser(path.stem().string());
-    parser.SetInput(file_content);
-    auto ast = parser.Parse();
-    if (!ast) {
-      std::cerr << "Error: Failed to parse the input file." << std::endl;
+  if (server_stop) {
+    if (!scp::driver::CompileClient::Shutdown(socket_path)) {
+      std::cerr << "Error: No server is listening on " << socket_path << std::endl;
       return 1;
     }
+    return 0;
+  }
+  if (server) {
+    if (jobs == 0) {
+      jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+    return RunServer(socket_path, jobs, use_cache ? &*cache : nullptr);
+  }
+  if (inputs.empty()) {
+    std::cerr << "Error: No input file." << std::endl;
+    PrintUsage(argv[0]);
+    return 1;
+  }
 
-    // Type check the AST
-    scp::semant::TypeChecker type_checker(ast);
-    auto type_environment = type_checker.CheckType();
+  if (compile_units || link) {
+    if (compile_units && link) {
+      std::cerr << "Error: -c compiles units and --link links them; run them separately." << std::endl;
+      return 1;
+    }
+    if (compile_units && output_to_file && inputs.size() > 1) {
+      std::cerr << "Error: -o takes a single input; use -d for several units." << std::endl;
+      return 1;
+    }
+    return compile_units ? CompileUnits(inputs, output_dir, output_to_file ? output_file : "", options)
+                         : LinkUnits(inputs, output_to_file ? output_file : "", options);
+  }
 
-    // Generate code from the AST
-    scp::cgen::CodeGenerator code_generator(ast, type_environment);
-    std::string generated_code = code_generator.GenerateCode();
+  if (batch || inputs.size() > 1) {
+    if (output_to_file || asm_stats || time_report || mem_report || stats) {
+      std::cerr << "Error: -o, --asm-stats and the reports take a single input;"
+                << " use -d and scp-asm-stats <output_dir> instead." << std::endl;
+      return 1;
+    }
+    if (jobs == 0) {
+      jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+    return CompileBatch(inputs, output_dir, jobs, options, use_cache ? &*cache : nullptr);
+  }
+  filename = inputs.front();
+
+  // Batch, -c and the server skip an empty file the same way, so check before dispatching to the other modes
+  if (std::ifstream probe(filename, std::ios::binary);
+      probe.is_open() && probe.peek() == std::ifstream::traits_type::eof()) {
+    std::cout << scp::driver::EMPTY_INPUT_WARNING << std::endl;
+    return 0;
+  }
+
+  // A report describes a full compilation, so it bypasses the cache and the server
+  scp::driver::CompileReport report;
+  scp::driver::CompileReport *timed = time_report || mem_report ? &report : nullptr;
+  if (stream) {
+    if (client || asm_stats || stats) {
+      std::cerr << "Error: --stream compiles in-process and keeps no output for --asm-stats or --stats." << std::endl;
+      return 1;
+    }
+    // The phases of a streamed compilation interleave, so a report shows them as one
+    scp::driver::PhaseTimer stream_timer(timed, "stream");
+    int status = CompileStreaming(filename, output_to_file ? output_file : "", options, pipelined);
+    stream_timer.Stop();
+    report.peak_rss_bytes_ = scp::driver::MemoryAccounting::GetPeakRss();
+    if (json_report && timed != nullptr) {
+      std::cerr << report.FormatJson(time_report, mem_report, false);
+    } else {
+      std::cerr << (time_report ? report.FormatTimes() : "") << (mem_report ? report.FormatMemory() : "");
+    }
+    return status;
+  }
+  if (incremental) {
+    if (stream || client || asm_stats || stats) {
+      std::cerr << "Error: --incremental compiles in-process and keeps no output for --asm-stats or --stats."
+                << std::endl;
+      return 1;
+    }
+    scp::driver::PhaseTimer incremental_timer(timed, "incremental");
+    int status = CompileIncrementally(filename, output_to_file ? output_file : "", options, pipelined);
+    incremental_timer.Stop();
+    if (json_report && timed != nullptr) {
+      std::cerr << report.FormatJson(time_report, mem_report, false);
+    } else {
+      std::cerr << (time_report ? report.FormatTimes() : "") << (mem_report ? report.FormatMemory() : "");
+    }
+    return status;
+  }
+  if (timed != nullptr || stats) {
+    use_cache = false;
+    client = false;
+  }
+
+  try {
+    // Read the input file
+    scp::driver::PhaseTimer read_timer(timed, "read");
+    std::string file_content = scp::driver::ReadSource(filename);
+    read_timer.Stop();
+
+    // A running server answers with its warm state; without one, compile here
+    std::string generated_code;
+    bool served = false;
+    if (client) {
+      scp::driver::CompileRequest request{fs::path(filename).stem().string(), "", file_content, options};
+      scp::driver::CompileResult result;
+      served = scp::driver::CompileClient::Compile(socket_path, request, result);
+      if (served) {
+        std::cerr << result.diagnostics_;
+        if (!result.success_) {
+          return 1;
+        }
+        generated_code = result.output_;
+      }
+    }
+
+    // A cache hit skips the whole pipeline
+    std::string cache_key;
+    bool cached = served;
+    if (use_cache && !served) {
+      cache_key = scp::driver::CompilationCache::MakeKey(
+          file_content, scp::driver::CompilationCache::GetCompilerIdentity(),
+          scp::driver::CompilationCache::DescribeOptions(options));
+      cached = cache->Lookup(cache_key, generated_code);
+    }
+
+    if (!cached && options.one_pass_) {
+      // Lexing, parsing, type checking and code generation interleave, so a report shows them as one phase
+      scp::driver::PhaseTimer one_pass_timer(timed, "one-pass");
+      scp::parser::SLRParser parser(fs::path(filename).stem().string());
+      parser.SetPipelined(pipelined);
+      parser.SetInput(file_content);
+      scp::cgen::OnePassCompiler one_pass(options);
+      if (!parser.ParseWithActions(one_pass)) {
+        std::cerr << "Error: Failed to parse the input file." << std::endl;
+        return 1;
+      }
+      generated_code = one_pass.Finish();
+      one_pass_timer.Stop();
+      if (stats) {
+        report.stats_.tokens_ = parser.GetTokenCount();
+      }
+      if (use_cache) {
+        cache->Store(cache_key, generated_code);
+      }
+    } else if (!cached) {
+      // Tokenize ahead of parsing when timing or tracing, so the two phases are measured apart, unless the lexer
+      // is to overlap the parser
+      fs::path path(filename);
+      scp::driver::PhaseTimer lex_timer(timed, "lex");
+      scp::parser::SLRParser parser(path.stem().string());
+      parser.SetPipelined(pipelined);
+      parser.SetInput(file_content);
+      if ((timed != nullptr || scp::core::Trace::IsEnabled()) && !pipelined && !parser.Lex()) {
+        std::cerr << "Error: Failed to tokenize the input file." << std::endl;
+        return 1;
+      }
+      lex_timer.Stop();
+
+      // Parse the file content
+      scp::driver::PhaseTimer parse_timer(timed, "parse");
+      auto ast = parser.Parse();
+      if (!ast) {
+        std::cerr << "Error: Failed to parse the input file." << std::endl;
+        return 1;
+      }
+      parse_timer.Stop();
+
+      // Type check the AST
+      scp::driver::PhaseTimer check_timer(timed, "typecheck");
+      scp::semant::TypeChecker type_checker(ast);
+      auto type_environment = type_checker.CheckType();
+      check_timer.Stop();
+
+      // Generate code from the AST
+      scp::driver::PhaseTimer codegen_timer(timed, "codegen");
+      scp::cgen::CodeGenerator code_generator(ast, type_environment, options);
+      generated_code = code_generator.GenerateCode();
+      codegen_timer.Stop();
+
+      if (stats) {
+        report.stats_.tokens_ = parser.GetTokenCount();
+        report.stats_.parse_tree_nodes_ = parser.GetParseTreeNodeCount();
+        report.stats_.symbols_ = type_environment->GetSymbolCount();
+        report.CountAST(*ast);
+      }
+      if (use_cache) {
+        cache->Store(cache_key, generated_code);
+      }
+    }
+    if (asm_stats || stats) {
+      auto collected = scp::cgen::AsmStats::Collect(scp::cgen::InstructionBuffer(generated_code));
+      report.stats_.instructions_ = collected.instruction_count_;
+      report.stats_.data_bytes_ = collected.data_bytes_;
+      if (asm_stats) {
+        std::cerr << collected.Format();
+      }
+    }
 
     // Output the generated assembly code
+    scp::driver::PhaseTimer write_timer(timed, "write");
     if (output_to_file) {
       std::ofstream output(output_file);
       if (!output.is_open()) {
@@ -120,7 +848,15 @@ auto main(int argc, char *argv[]) -> int {
       // Print to standard console
       std::cout << generated_code << std::endl;
     }
+    write_timer.Stop();
 
+    report.peak_rss_bytes_ = scp::driver::MemoryAccounting::GetPeakRss();
+    if (json_report && (timed != nullptr || stats)) {
+      std::cerr << report.FormatJson(time_report, mem_report, stats);
+    } else {
+      std::cerr << (time_report ? report.FormatTimes() : "") << (mem_report ? report.FormatMemory() : "")
+                << (stats ? report.FormatStats() : "");
+    }
     return 0;
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "constant/error_messages.h"
+#include "core/trace.h"
 
 namespace scp::semant {
 
@@ -14,6 +15,7 @@ TypeChecker::TypeChecker(std::shared_ptr<core::AST> ast)
 }
 
 auto TypeChecker::CheckType() -> std::shared_ptr<core::TypeEnvironment> {
+  SCP_TRACE_SCOPE("TypeCheck");
   bool has_bug = false;
   ast_->GetRoot()->TypeCheck(type_environment_, has_bug);
   if (has_bug) {
@@ -22,4 +24,10 @@ auto TypeChecker::CheckType() -> std::shared_ptr<core::TypeEnvironment> {
   return type_environment_;
 }
 
+auto TypeChecker::CheckStatement(const std::shared_ptr<core::AST::ASTNode> &statement) -> bool {
+  bool has_bug = false;
+  statement->TypeCheck(type_environment_, has_bug);
+  return !has_bug;
+}
+
 }  // namespace scp::semant
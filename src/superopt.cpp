@@ -0,0 +1,184 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "cgen/peephole_rules.h"
+#include "cgen/superoptimizer.h"
+
+using scp::cgen::MicroSequence;
+using scp::cgen::Superoptimizer;
+
+/**
+ * Print the usage information for the superopt program.
+ * @param programName The name of the program (usually argv[0]).
+ */
+void PrintUsage(const std::string &programName) {
+  std::cout << "Usage: " << programName << " [--max-length <N>] [--range <lo>:<hi>] [--emit <file>]" << std::endl;
+  std::cout << "       " << programName << " [--max-length <N>] --target \"<sequence>\"" << std::endl;
+  std::cout << "       " << programName << " --check" << std::endl;
+  std::cout << "  Finds the cheapest sequences of li, addiu, add, addu, subu, sll, mul and move computing x * C"
+            << std::endl;
+  std::cout << "  --max-length <N>: Longest sequence enumerated (default 3)" << std::endl;
+  std::cout << "  --range <lo>:<hi>: Multipliers searched (default -64:1024 and 2^k, 2^k +- 1 up to 2^31 - 1)"
+            << std::endl;
+  std::cout << "  --emit <file>: Write the rule table as C++, the source of src/cgen/peephole_rules.cpp" << std::endl;
+  std::cout << "  --target <sequence>: Search a sequence of $in, $out and $tmp instead, e.g." << std::endl;
+  std::cout << "                       \"sll $tmp, $in, 3; add $out, $tmp, $in\"" << std::endl;
+  std::cout << "  --check: Verify every rule of the checked-in table on all inputs" << std::endl;
+}
+
+/**
+ * Get the multipliers searched by default: the small constants programs multiply by and the ones near powers of two.
+ * @return The multipliers, without duplicates.
+ */
+auto DefaultMultipliers() -> std::vector<int32_t> {
+  std::vector<int32_t> multipliers;
+  for (int32_t multiplier = -64; multiplier <= 1024; multiplier++) {
+    multipliers.push_back(multiplier);
+  }
+  for (int shift = 10; shift < 31; shift++) {
+    int64_t power = int64_t{1} << shift;
+    for (int64_t multiplier : {power, power + 1, power * 2 - 1}) {
+      if (multiplier > 1024) {
+        multipliers.push_back(static_cast<int32_t>(multiplier));
+      }
+    }
+  }
+  return multipliers;
+}
+
+/**
+ * Write the rule table as the source checked in as src/cgen/peephole_rules.cpp.
+ * @param output The stream.
+ * @param multipliers The multipliers searched.
+ * @param found The rule found for each multiplier, if any.
+ */
+void EmitRules(std::ostream &output, const std::vector<int32_t> &multipliers,
+               const std::vector<std::optional<MicroSequence>> &found) {
+  output << "// Generated by scp-superopt --emit; do not edit. Every rule is verified on all 2^32 inputs." << std::endl;
+  output << "#include \"cgen/peephole_rules.h\"" << std::endl << std::endl;
+  output << "namespace scp::cgen {" << std::endl << std::endl;
+  output << "auto GetPeepholeRules() -> const std::vector<PeepholeRule> & {" << std::endl;
+  output << "  static const std::vector<PeepholeRule> RULES = {" << std::endl;
+  for (size_t i = 0; i < multipliers.size(); i++) {
+    if (found[i]) {
+      output << "      {" << multipliers[i] << ", \"" << Superoptimizer::ToString(*found[i]) << "\"}," << std::endl;
+    }
+  }
+  output << "  };" << std::endl;
+  output << "  return RULES;" << std::endl;
+  output << "}" << std::endl << std::endl;
+  output << "}  // namespace scp::cgen" << std::endl;
+}
+
+/**
+ * Verify the checked-in rule table.
+ * @return Exit status code, 1 if a rule is wrong.
+ */
+auto CheckRules() -> int {
+  int failures = 0;
+  for (const auto &rule : scp::cgen::GetPeepholeRules()) {
+    auto replacement = Superoptimizer::Parse(rule.replacement_);
+    auto original = Superoptimizer::MultiplyBy(rule.multiplier_);
+    if (!Superoptimizer::Verify(replacement, original)) {
+      std::cerr << "x * " << rule.multiplier_ << ": " << rule.replacement_ << " is not equivalent" << std::endl;
+      failures++;
+    } else if (Superoptimizer::GetCost(replacement) >= Superoptimizer::GetCost(original)) {
+      std::cerr << "x * " << rule.multiplier_ << ": " << rule.replacement_ << " is no cheaper" << std::endl;
+      failures++;
+    }
+  }
+  std::cout << scp::cgen::GetPeepholeRules().size() << " rule(s), " << failures << " failure(s)" << std::endl;
+  return failures == 0 ? 0 : 1;
+}
+
+/**
+ * Main entry point for the superopt program.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return Exit status code.
+ */
+auto main(int argc, char *argv[]) -> int {
+  scp::cgen::SuperoptimizerOptions options;
+  std::vector<int32_t> multipliers = DefaultMultipliers();
+  std::string emit_file;
+  std::string target;
+  bool check = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--max-length" && has_value) {
+      options.max_length_ = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--range" && has_value) {
+      std::string range = argv[++i];
+      auto colon = range.find(':');
+      if (colon == std::string::npos) {
+        std::cerr << "Error: --range expects <lo>:<hi>." << std::endl;
+        return 1;
+      }
+      multipliers.clear();
+      int64_t high = std::strtoll(range.c_str() + colon + 1, nullptr, 10);
+      for (int64_t multiplier = std::strtoll(range.c_str(), nullptr, 10); multiplier <= high; multiplier++) {
+        multipliers.push_back(static_cast<int32_t>(multiplier));
+      }
+    } else if (arg == "--emit" && has_value) {
+      emit_file = argv[++i];
+    } else if (arg == "--target" && has_value) {
+      target = argv[++i];
+    } else if (arg == "--check") {
+      check = true;
+    } else {
+      std::cerr << "Error: Invalid option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (check) {
+    return CheckRules();
+  }
+
+  try {
+    std::vector<MicroSequence> targets;
+    if (!target.empty()) {
+      targets.push_back(Superoptimizer::Parse(target));
+    } else {
+      for (int32_t multiplier : multipliers) {
+        targets.push_back(Superoptimizer::MultiplyBy(multiplier));
+      }
+    }
+
+    Superoptimizer superoptimizer(options);
+    auto found = superoptimizer.Search(targets);
+    std::cerr << superoptimizer.GetEnumeratedCount() << " sequence(s) enumerated, "
+              << superoptimizer.GetRejectedCount() << " candidate(s) rejected by verification" << std::endl;
+
+    if (!emit_file.empty()) {
+      std::ofstream output(emit_file);
+      if (!output.is_open()) {
+        std::cerr << "Error: Cannot open output file: " << emit_file << std::endl;
+        return 1;
+      }
+      EmitRules(output, multipliers, found);
+    }
+    int count = 0;
+    for (size_t i = 0; i < targets.size(); i++) {
+      if (!found[i]) {
+        continue;
+      }
+      std::string name = target.empty() ? "x * " + std::to_string(multipliers[i]) : target;
+      std::cout << name << ": " << Superoptimizer::ToString(*found[i]) << "  (cost "
+                << Superoptimizer::GetCost(targets[i]) << " -> " << Superoptimizer::GetCost(*found[i]) << ")"
+                << std::endl;
+      count++;
+    }
+    std::cerr << count << " of " << targets.size() << " target(s) improved" << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,284 @@
+#include "workload/baseline.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/json.h"
+
+namespace scp::workload {
+
+namespace {
+
+// Mean and unbiased variance of samples
+void Summarize(const std::vector<double> &samples, double &mean, double &variance) {
+  mean = 0;
+  for (double sample : samples) {
+    mean += sample;
+  }
+  mean /= static_cast<double>(samples.size());
+  variance = 0;
+  for (double sample : samples) {
+    variance += (sample - mean) * (sample - mean);
+  }
+  variance = samples.size() > 1 ? variance / static_cast<double>(samples.size() - 1) : 0;
+}
+
+// Continued fraction of the regularized incomplete beta function, evaluated with Lentz's method
+auto BetaContinuedFraction(double a, double b, double x) -> double {
+  constexpr double TINY = 1e-300;
+  double c = 1;
+  double d = 1 - (a + b) * x / (a + 1);
+  d = 1 / (std::fabs(d) < TINY ? TINY : d);
+  double result = d;
+  for (int m = 1; m <= 300; m++) {
+    double numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+    d = 1 + numerator * d;
+    c = 1 + numerator / c;
+    d = 1 / (std::fabs(d) < TINY ? TINY : d);
+    c = std::fabs(c) < TINY ? TINY : c;
+    result *= d * c;
+    numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+    d = 1 + numerator * d;
+    c = 1 + numerator / c;
+    d = 1 / (std::fabs(d) < TINY ? TINY : d);
+    c = std::fabs(c) < TINY ? TINY : c;
+    double delta = d * c;
+    result *= delta;
+    if (std::fabs(delta - 1) < 1e-12) {
+      break;
+    }
+  }
+  return result;
+}
+
+// The regularized incomplete beta function I_x(a, b)
+auto IncompleteBeta(double a, double b, double x) -> double {
+  if (x <= 0) {
+    return 0;
+  }
+  if (x >= 1) {
+    return 1;
+  }
+  double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) +
+                          b * std::log(1 - x));
+  // The continued fraction converges quickly only below the mean of the distribution
+  if (x < (a + 1) / (a + b + 2)) {
+    return front * BetaContinuedFraction(a, b, x) / a;
+  }
+  return 1 - front * BetaContinuedFraction(b, a, 1 - x) / b;
+}
+
+// P(T <= t) for Student's t distribution
+auto StudentTCdf(double t, double degrees_of_freedom) -> double {
+  double tail = 0.5 * IncompleteBeta(degrees_of_freedom / 2, 0.5, degrees_of_freedom / (degrees_of_freedom + t * t));
+  return t >= 0 ? 1 - tail : tail;
+}
+
+/**
+ * Read the --benchmark_out JSON of a Google Benchmark target.
+ * @param root The parsed document.
+ * @return The baseline.
+ */
+auto FromGoogleBenchmark(const core::JsonValue &root) -> BenchmarkBaseline {
+  BenchmarkBaseline baseline;
+  if (const auto *context = root.Find("context")) {
+    if (const auto *revision = context->Find("scp_revision")) {
+      baseline.revision_ = revision->AsString();
+    }
+    if (const auto *executable = context->Find("executable")) {
+      baseline.description_ = "Google Benchmark " + executable->AsString();
+    }
+  }
+  std::unordered_map<std::string, size_t> series_index;
+  for (const auto &benchmark : root.Find("benchmarks")->AsArray()) {
+    const auto *run_type = benchmark.Find("run_type");
+    const auto *error = benchmark.Find("error_occurred");
+    if ((run_type != nullptr && run_type->AsString() != "iteration") || (error != nullptr && error->AsBoolean())) {
+      continue;
+    }
+    const auto *name = benchmark.Find("run_name");
+    name = name != nullptr ? name : benchmark.Find("name");
+    const auto *unit = benchmark.Find("time_unit");
+    if (name == nullptr) {
+      continue;
+    }
+    for (const char *metric : {"real_time", "cpu_time"}) {
+      const auto *value = benchmark.Find(metric);
+      if (value == nullptr) {
+        continue;
+      }
+      std::string series_name = name->AsString() + "/" + metric;
+      auto [it, inserted] = series_index.emplace(series_name, baseline.series_.size());
+      if (inserted) {
+        baseline.series_.push_back({series_name, unit != nullptr ? unit->AsString() : "ns", {}});
+      }
+      baseline.series_[it->second].samples_.push_back(value->AsNumber());
+    }
+  }
+  return baseline;
+}
+
+}  // namespace
+
+auto BenchmarkBaseline::ToJson() const -> std::string {
+  std::ostringstream out;
+  out.precision(12);
+  out << "{\n  \"format\": \"scp-baseline\",\n  \"revision\": " << core::JsonQuote(revision_)
+      << ",\n  \"description\": " << core::JsonQuote(description_) << ",\n  \"series\": [";
+  for (size_t i = 0; i < series_.size(); i++) {
+    const auto &series = series_[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << core::JsonQuote(series.name_)
+        << ", \"unit\": " << core::JsonQuote(series.unit_) << ", \"samples\": [";
+    for (size_t j = 0; j < series.samples_.size(); j++) {
+      out << (j == 0 ? "" : ", ") << series.samples_[j];
+    }
+    out << "]}";
+  }
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+auto BenchmarkBaseline::FromJson(const std::string &text) -> BenchmarkBaseline {
+  auto root = core::JsonValue::Parse(text);
+  if (root.Find("benchmarks") != nullptr) {
+    return FromGoogleBenchmark(root);
+  }
+  const auto *series_list = root.Find("series");
+  if (series_list == nullptr) {
+    throw std::runtime_error("Not a baseline or Google Benchmark result: no \"series\" or \"benchmarks\"");
+  }
+  BenchmarkBaseline baseline;
+  if (const auto *revision = root.Find("revision")) {
+    baseline.revision_ = revision->AsString();
+  }
+  if (const auto *description = root.Find("description")) {
+    baseline.description_ = description->AsString();
+  }
+  for (const auto &entry : series_list->AsArray()) {
+    BenchmarkSeries series;
+    if (const auto *name = entry.Find("name")) {
+      series.name_ = name->AsString();
+    }
+    if (const auto *unit = entry.Find("unit")) {
+      series.unit_ = unit->AsString();
+    }
+    if (const auto *samples = entry.Find("samples")) {
+      for (const auto &sample : samples->AsArray()) {
+        series.samples_.push_back(sample.AsNumber());
+      }
+    }
+    baseline.series_.push_back(std::move(series));
+  }
+  return baseline;
+}
+
+auto BenchmarkBaseline::Find(const std::string &name) const -> const BenchmarkSeries * {
+  for (const auto &series : series_) {
+    if (series.name_ == name) {
+      return &series;
+    }
+  }
+  return nullptr;
+}
+
+auto CompareBaselines(const BenchmarkBaseline &base, const BenchmarkBaseline &candidate, double confidence,
+                      double threshold) -> std::vector<BenchmarkChange> {
+  std::vector<BenchmarkChange> changes;
+  for (const auto &series : candidate.series_) {
+    const auto *base_series = base.Find(series.name_);
+    if (base_series == nullptr || base_series->samples_.empty() || series.samples_.empty()) {
+      continue;
+    }
+    BenchmarkChange change;
+    change.name_ = series.name_;
+    change.unit_ = series.unit_;
+    double base_variance = 0;
+    double candidate_variance = 0;
+    Summarize(base_series->samples_, change.base_mean_, base_variance);
+    Summarize(series.samples_, change.candidate_mean_, candidate_variance);
+
+    double difference = change.candidate_mean_ - change.base_mean_;
+    double scale = change.base_mean_ != 0 ? std::fabs(change.base_mean_) : 1;
+    change.change_ = difference / scale;
+    change.change_low_ = change.change_;
+    change.change_high_ = change.change_;
+    double base_count = static_cast<double>(base_series->samples_.size());
+    double candidate_count = static_cast<double>(series.samples_.size());
+    if (base_count >= 2 && candidate_count >= 2) {
+      double base_error = base_variance / base_count;
+      double candidate_error = candidate_variance / candidate_count;
+      double standard_error = std::sqrt(base_error + candidate_error);
+      if (standard_error > 0) {
+        // Welch-Satterthwaite degrees of freedom of the difference of two means with unequal variances
+        double degrees_of_freedom =
+            (base_error + candidate_error) * (base_error + candidate_error) /
+            (base_error * base_error / (base_count - 1) + candidate_error * candidate_error / (candidate_count - 1));
+        double margin = StudentTQuantile((1 + confidence) / 2, degrees_of_freedom) * standard_error / scale;
+        change.change_low_ = change.change_ - margin;
+        change.change_high_ = change.change_ + margin;
+      }
+      change.significant_ = change.change_low_ > 0 || change.change_high_ < 0;
+    }
+    change.regression_ = change.significant_ && change.change_ >= threshold;
+    change.improvement_ = change.significant_ && change.change_ <= -threshold;
+    changes.push_back(change);
+  }
+  return changes;
+}
+
+auto StudentTQuantile(double probability, double degrees_of_freedom) -> double {
+  if (probability == 0.5) {
+    return 0;
+  }
+  if (probability < 0.5) {
+    return -StudentTQuantile(1 - probability, degrees_of_freedom);
+  }
+  // The CDF is increasing, so bisect between 0 and a bound it exceeds
+  double low = 0;
+  double high = 1;
+  while (StudentTCdf(high, degrees_of_freedom) < probability && high < 1e12) {
+    high *= 2;
+  }
+  for (int i = 0; i < 200 && high - low > 1e-12 * high; i++) {
+    double middle = (low + high) / 2;
+    (StudentTCdf(middle, degrees_of_freedom) < probability ? low : high) = middle;
+  }
+  return (low + high) / 2;
+}
+
+auto GetGitRevision(const std::string &directory) -> std::string {
+  std::string tree = directory.empty() ? SCP_SOURCE_DIR : directory;
+  auto run = [&tree](const std::string &arguments) {
+    std::string output;
+    FILE *pipe = popen(("git -C \"" + tree + "\" " + arguments + " 2>/dev/null").c_str(), "r");
+    if (pipe == nullptr) {
+      return output;
+    }
+    std::array<char, 256> buffer{};
+    size_t read = 0;
+    while ((read = fread(buffer.data(), 1, buffer.size(), pipe)) > 0) {
+      output.append(buffer.data(), read);
+    }
+    if (pclose(pipe) != 0) {
+      output.clear();
+    }
+    return output;
+  };
+  std::string revision = run("rev-parse HEAD");
+  while (!revision.empty() && (revision.back() == '\n' || revision.back() == '\r')) {
+    revision.pop_back();
+  }
+  if (!revision.empty() && !run("status --porcelain --untracked-files=no").empty()) {
+    revision += "-dirty";
+  }
+  return revision;
+}
+
+}  // namespace scp::workload
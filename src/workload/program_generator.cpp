@@ -0,0 +1,216 @@
+#include "workload/program_generator.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace scp::workload {
+
+namespace {
+
+// Numbers stay below this, so no sum or product of two of them overflows 32 bits
+constexpr int64_t MAX_NUMBER = 1 << 30;
+// Strings stay below this length
+constexpr int64_t MAX_STRING_LENGTH = 1024;
+// A string read from stdin is at most the size of the runtime input buffer
+constexpr int64_t MAX_INPUT_LENGTH = 255;
+// Characters of string literals
+constexpr char LITERAL_CHARACTERS[] = "abcdefghijklmnopqrstuvwxyz ";
+
+}  // namespace
+
+auto SetGeneratorOption(GeneratorOptions &options, const std::string &name, const std::string &value) -> bool {
+  try {
+    size_t used = 0;
+    if (name == "seed" || name == "statements" || name == "depth" || name == "chain" || name == "literal-length") {
+      uint64_t number = std::stoull(value, &used);
+      if (name == "seed") {
+        options.seed_ = number;
+      } else if (name == "statements") {
+        options.statements_ = number;
+      } else if (name == "depth") {
+        options.max_depth_ = number;
+      } else if (name == "chain") {
+        options.max_chain_ = number;
+      } else {
+        options.max_literal_length_ = number;
+      }
+    } else if (name == "string-share" || name == "stdin-share" || name == "output-share" ||
+               name == "new-variable-share") {
+      double share = std::stod(value, &used);
+      if (share < 0 || share > 1) {
+        return false;
+      }
+      if (name == "string-share") {
+        options.string_share_ = share;
+      } else if (name == "stdin-share") {
+        options.stdin_share_ = share;
+      } else if (name == "output-share") {
+        options.output_share_ = share;
+      } else {
+        options.new_variable_share_ = share;
+      }
+    } else {
+      return false;
+    }
+    return used == value.size();
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+ProgramGenerator::ProgramGenerator(GeneratorOptions options) : options_(options), state_(options.seed_) {}
+
+auto ProgramGenerator::Generate() -> std::string {
+  std::ostringstream out;
+  Generate(out);
+  return out.str();
+}
+
+void ProgramGenerator::Generate(std::ostream &out) {
+  state_ = options_.seed_;
+  variables_.clear();
+  number_variables_.clear();
+  string_variables_.clear();
+  for (size_t i = 0; i < options_.statements_; ++i) {
+    out << GenerateStatement() << '\n';
+  }
+}
+
+auto ProgramGenerator::Next() -> uint64_t {
+  uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+auto ProgramGenerator::Uniform(uint64_t low, uint64_t high) -> uint64_t {
+  return low + Next() % (high - low + 1);
+}
+
+auto ProgramGenerator::Chance(double probability) -> bool {
+  return static_cast<double>(Next() >> 11) * 0x1.0p-53 < probability;
+}
+
+auto ProgramGenerator::PickVariable(bool is_string) -> Variable * {
+  const auto &indices = is_string ? string_variables_ : number_variables_;
+  if (indices.empty()) {
+    return nullptr;
+  }
+  return &variables_[indices[Uniform(0, indices.size() - 1)]];
+}
+
+auto ProgramGenerator::GenerateStatement() -> std::string {
+  if (Chance(options_.output_share_)) {
+    auto expression = Chance(options_.string_share_) ? GenerateString(options_.max_depth_)
+                                                     : GenerateNumber(options_.max_depth_);
+    return "stdout <- " + expression.text_ + ";";
+  }
+
+  bool is_string = true;
+  Expression expression{"stdin", MAX_INPUT_LENGTH};
+  if (!Chance(options_.stdin_share_)) {
+    is_string = Chance(options_.string_share_);
+    expression = is_string ? GenerateString(options_.max_depth_) : GenerateNumber(options_.max_depth_);
+    // Reassign an existing variable of the same type
+    if (!Chance(options_.new_variable_share_)) {
+      if (auto *variable = PickVariable(is_string); variable != nullptr) {
+        variable->value_ = expression.value_;
+        return variable->name_ + " <- " + expression.text_ + ";";
+      }
+    }
+  }
+
+  std::string name = "v" + std::to_string(variables_.size());
+  (is_string ? string_variables_ : number_variables_).push_back(variables_.size());
+  variables_.push_back({name, is_string, expression.value_});
+  return name + " <- " + expression.text_ + ";";
+}
+
+auto ProgramGenerator::GenerateNumber(size_t depth) -> Expression {
+  // A sum of products; each operand is checked against the bound before it is added
+  size_t operands = Uniform(1, std::max<size_t>(options_.max_chain_, 1));
+  Expression sum{"", 0};
+  Expression product = GenerateNumberFactor(depth);
+  auto close_product = [&sum, &product] {
+    if (sum.value_ + product.value_ > MAX_NUMBER) {
+      product = {"0", 0};
+    }
+    sum.text_ += (sum.text_.empty() ? "" : " + ") + product.text_;
+    sum.value_ += product.value_;
+  };
+  for (size_t i = 1; i < operands; ++i) {
+    if (Chance(0.5)) {
+      auto factor = GenerateNumberFactor(depth);
+      if (factor.value_ != 0 && product.value_ > MAX_NUMBER / factor.value_) {
+        factor = {"1", 1};
+      }
+      product.text_ += " * " + factor.text_;
+      product.value_ *= factor.value_;
+    } else {
+      close_product();
+      product = GenerateNumberFactor(depth);
+    }
+  }
+  close_product();
+  return sum;
+}
+
+auto ProgramGenerator::GenerateNumberFactor(size_t depth) -> Expression {
+  if (depth > 0 && Chance(0.2)) {
+    auto inner = GenerateNumber(depth - 1);
+    return {"(" + inner.text_ + ")", inner.value_};
+  }
+  if (Chance(0.5)) {
+    if (auto *variable = PickVariable(false); variable != nullptr) {
+      return {variable->name_, variable->value_};
+    }
+  }
+  size_t digits = Uniform(1, std::clamp<size_t>(options_.max_literal_length_, 1, 9));
+  std::string text(1, static_cast<char>('0' + Uniform(digits == 1 ? 0 : 1, 9)));
+  for (size_t i = 1; i < digits; ++i) {
+    text += static_cast<char>('0' + Uniform(0, 9));
+  }
+  return {text, std::stoll(text)};
+}
+
+auto ProgramGenerator::GenerateString(size_t depth) -> Expression {
+  size_t operands = Uniform(1, std::max<size_t>(options_.max_chain_, 1));
+  Expression concat{"", 0};
+  for (size_t i = 0; i < operands; ++i) {
+    auto term = GenerateStringFactor(depth);
+    if (Chance(0.2)) {
+      int64_t count = static_cast<int64_t>(Uniform(0, 3));
+      term.text_ += " * " + std::to_string(count);
+      term.value_ *= count;
+    }
+    if (concat.value_ + term.value_ > MAX_STRING_LENGTH) {
+      term = {"\"\"", 0};
+    }
+    concat.text_ += (i == 0 ? "" : " + ") + term.text_;
+    concat.value_ += term.value_;
+  }
+  return concat;
+}
+
+auto ProgramGenerator::GenerateStringFactor(size_t depth) -> Expression {
+  if (depth > 0 && Chance(0.2)) {
+    auto inner = GenerateString(depth - 1);
+    return {"(" + inner.text_ + ")", inner.value_};
+  }
+  if (Chance(0.5)) {
+    if (auto *variable = PickVariable(true); variable != nullptr) {
+      return {variable->name_, variable->value_};
+    }
+  }
+  size_t length = Uniform(0, options_.max_literal_length_);
+  std::string text = "\"";
+  for (size_t i = 0; i < length; ++i) {
+    text += LITERAL_CHARACTERS[Uniform(0, sizeof(LITERAL_CHARACTERS) - 2)];
+  }
+  return {text + "\"", static_cast<int64_t>(length)};
+}
+
+}  // namespace scp::workload
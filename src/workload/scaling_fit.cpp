@@ -0,0 +1,42 @@
+#include "workload/scaling_fit.h"
+
+#include <cmath>
+#include <vector>
+
+namespace scp::workload {
+
+auto FitPowerLaw(const std::vector<double> &sizes, const std::vector<double> &values) -> PowerLaw {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  for (size_t i = 0; i < sizes.size() && i < values.size(); ++i) {
+    if (sizes[i] > 0 && values[i] > 0) {
+      xs.push_back(std::log(sizes[i]));
+      ys.push_back(std::log(values[i]));
+    }
+  }
+  if (xs.size() < 2) {
+    return {};
+  }
+
+  double mean_x = 0;
+  double mean_y = 0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    mean_x += xs[i];
+    mean_y += ys[i];
+  }
+  mean_x /= static_cast<double>(xs.size());
+  mean_y /= static_cast<double>(ys.size());
+  double covariance = 0;
+  double variance = 0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    covariance += (xs[i] - mean_x) * (ys[i] - mean_y);
+    variance += (xs[i] - mean_x) * (xs[i] - mean_x);
+  }
+  if (variance == 0) {
+    return {};
+  }
+  double exponent = covariance / variance;
+  return {exponent, std::exp(mean_y - exponent * mean_x)};
+}
+
+}  // namespace scp::workload
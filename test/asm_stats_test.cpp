@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "cgen/asm_stats.h"
+#include "cgen/instruction_buffer.h"
+
+namespace scp::test {
+
+class AsmStatsTest : public ::testing::Test {
+ protected:
+  // Helper function to collect the statistics of some assembly
+  static auto Collect(const std::string &assembly) -> cgen::AsmStats {
+    return cgen::AsmStats::Collect(cgen::InstructionBuffer(assembly));
+  }
+};
+
+// Instructions are counted once, pseudo-instructions by their machine size
+TEST_F(AsmStatsTest, CountsInstructions) {
+  auto stats = Collect(
+      ".text\nmain:\n    addiu $sp, $sp, -8\n    la $a0, str_0\n    sw $a0, 0($fp)\n    li $t0, 100000\n"
+      "    jal string_concat\n    jal string_concat\n    lw $a0, 4($fp) # reload\n    addiu $sp, $sp, 8\n");
+  EXPECT_EQ(8, stats.instruction_count_);
+  EXPECT_EQ(4 * 10, stats.text_bytes_);
+  EXPECT_EQ(2, stats.memory_count_);
+  EXPECT_DOUBLE_EQ(0.25, stats.GetMemoryShare());
+  EXPECT_EQ(2, stats.stack_adjust_count_);
+  EXPECT_EQ(2, stats.opcode_counts_["addiu"]);
+  EXPECT_EQ(2, stats.call_counts_["string_concat"]);
+}
+
+// Data directives are sized with escapes decoded and words aligned
+TEST_F(AsmStatsTest, SizesDataSection) {
+  auto stats = Collect(".data\nstr_0: .asciiz \"a\\nb\"\nbuffer: .space 5\nnode: .word 0, str_0, 0\n.text\nmain:\n");
+  EXPECT_EQ(4 + 5 + 3 + 12, stats.data_bytes_);
+  EXPECT_EQ(0, stats.instruction_count_);
+}
+
+// Totals accumulate and comparisons show every metric
+TEST_F(AsmStatsTest, AccumulatesAndDiffs) {
+  auto before = Collect("    lw $a0, 0($fp)\n    lw $a0, 0($fp)\n");
+  auto after = Collect("    lw $a0, 0($fp)\n");
+  auto total = before;
+  total += after;
+  EXPECT_EQ(3, total.memory_count_);
+  EXPECT_EQ(3, total.opcode_counts_["lw"]);
+
+  auto diff = cgen::AsmStats::FormatDiff(before, after);
+  EXPECT_NE(std::string::npos, diff.find("instructions"));
+  EXPECT_NE(std::string::npos, diff.find("-50.0%"));
+  EXPECT_NE(std::string::npos, diff.find("op lw"));
+}
+
+}  // namespace scp::test
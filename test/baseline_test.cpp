@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/json.h"
+#include "workload/baseline.h"
+
+namespace scp::test {
+
+// Quantiles match the tables of Student's t distribution
+TEST(BaselineTest, StudentTQuantile) {
+  EXPECT_NEAR(workload::StudentTQuantile(0.975, 1), 12.706, 1e-3);
+  EXPECT_NEAR(workload::StudentTQuantile(0.975, 10), 2.228, 1e-3);
+  EXPECT_NEAR(workload::StudentTQuantile(0.95, 4.5), 2.015 + (2.132 - 2.015) / 2, 0.05);
+  EXPECT_NEAR(workload::StudentTQuantile(0.975, 1e6), 1.960, 1e-3);
+  EXPECT_NEAR(workload::StudentTQuantile(0.025, 10), -2.228, 1e-3);
+  EXPECT_EQ(workload::StudentTQuantile(0.5, 3), 0);
+}
+
+// The reader accepts what the tools write and rejects malformed documents
+TEST(BaselineTest, JsonValueParse) {
+  auto value = core::JsonValue::Parse(R"( {"a": [1, -2.5e1, true, null], "b": {"c": "x\"é\n"}} )");
+  ASSERT_EQ(value.GetKind(), core::JsonValue::Kind::OBJECT);
+  const auto &array = value.Find("a")->AsArray();
+  ASSERT_EQ(array.size(), 4);
+  EXPECT_EQ(array[1].AsNumber(), -25);
+  EXPECT_TRUE(array[2].AsBoolean());
+  EXPECT_EQ(array[3].GetKind(), core::JsonValue::Kind::NULL_VALUE);
+  EXPECT_EQ(value.Find("b")->Find("c")->AsString(), "x\"\xc3\xa9\n");
+  EXPECT_EQ(value.Find("missing"), nullptr);
+
+  for (const char *text : {"", "{", "[1,]", "{\"a\" 1}", "\"open", "tru", "1 2", "[[[[[[[[[[[[[[[["}) {
+    EXPECT_THROW(core::JsonValue::Parse(text), std::runtime_error) << text;
+  }
+  EXPECT_THROW(core::JsonValue::Parse(std::string(1000, '[') + std::string(1000, ']')), std::runtime_error);
+}
+
+// A baseline survives a round trip through JSON
+TEST(BaselineTest, RoundTrip) {
+  workload::BenchmarkBaseline baseline;
+  baseline.revision_ = "0123abc-dirty";
+  baseline.description_ = "test \"quoted\"";
+  baseline.series_.push_back({"prog/codegen/wall_ms", "ms", {1.5, 2.25, 0.125}});
+  baseline.series_.push_back({"prog/instructions", "instructions", {42, 42}});
+
+  auto read = workload::BenchmarkBaseline::FromJson(baseline.ToJson());
+  EXPECT_EQ(read.revision_, baseline.revision_);
+  EXPECT_EQ(read.description_, baseline.description_);
+  ASSERT_EQ(read.series_.size(), 2);
+  EXPECT_EQ(read.series_[0].name_, "prog/codegen/wall_ms");
+  EXPECT_EQ(read.series_[0].unit_, "ms");
+  EXPECT_EQ(read.series_[0].samples_, baseline.series_[0].samples_);
+  EXPECT_EQ(read.Find("prog/instructions")->samples_, baseline.series_[1].samples_);
+  EXPECT_THROW(workload::BenchmarkBaseline::FromJson("{\"other\": 1}"), std::runtime_error);
+}
+
+// Repetitions of a Google Benchmark result become samples, aggregates and failed runs are skipped
+TEST(BaselineTest, ReadsGoogleBenchmark) {
+  auto baseline = workload::BenchmarkBaseline::FromJson(R"({
+    "context": {"executable": "bench/scp_bench", "scp_revision": "abc"},
+    "benchmarks": [
+      {"name": "Lex/corpus", "run_name": "Lex/corpus", "run_type": "iteration", "real_time": 10, "cpu_time": 9,
+       "time_unit": "us"},
+      {"name": "Lex/corpus", "run_name": "Lex/corpus", "run_type": "iteration", "real_time": 12, "cpu_time": 11,
+       "time_unit": "us"},
+      {"name": "Lex/corpus_mean", "run_name": "Lex/corpus", "run_type": "aggregate", "real_time": 11,
+       "cpu_time": 10, "time_unit": "us"},
+      {"name": "Broken", "run_name": "Broken", "run_type": "iteration", "error_occurred": true, "real_time": 0}
+    ]})");
+  EXPECT_EQ(baseline.revision_, "abc");
+  ASSERT_EQ(baseline.series_.size(), 2);
+  EXPECT_EQ(baseline.series_[0].name_, "Lex/corpus/real_time");
+  EXPECT_EQ(baseline.series_[0].unit_, "us");
+  EXPECT_EQ(baseline.series_[0].samples_, (std::vector<double>{10, 12}));
+  EXPECT_EQ(baseline.Find("Lex/corpus/cpu_time")->samples_, (std::vector<double>{9, 11}));
+}
+
+// Noise within the interval is not a change, a clear shift is, and the threshold filters small shifts
+TEST(BaselineTest, CompareFlagsSignificantChanges) {
+  workload::BenchmarkBaseline base;
+  base.series_.push_back({"noise", "ms", {10, 11, 9, 10.5, 9.5}});
+  base.series_.push_back({"slower", "ms", {10, 10.2, 9.8, 10.1, 9.9}});
+  base.series_.push_back({"faster", "ms", {10, 10.2, 9.8, 10.1, 9.9}});
+  base.series_.push_back({"slightly", "ms", {100, 100.1, 99.9, 100, 100}});
+  base.series_.push_back({"instructions", "instructions", {500, 500, 500}});
+  base.series_.push_back({"single", "ms", {10}});
+  base.series_.push_back({"only_base", "ms", {1, 2}});
+
+  workload::BenchmarkBaseline candidate;
+  candidate.series_.push_back({"noise", "ms", {10.2, 9.4, 11.1, 10, 9.8}});
+  candidate.series_.push_back({"slower", "ms", {12, 12.2, 11.8, 12.1, 11.9}});
+  candidate.series_.push_back({"faster", "ms", {8, 8.2, 7.8, 8.1, 7.9}});
+  candidate.series_.push_back({"slightly", "ms", {101, 101.1, 100.9, 101, 101}});
+  candidate.series_.push_back({"instructions", "instructions", {501, 501, 501}});
+  candidate.series_.push_back({"single", "ms", {20}});
+
+  auto changes = workload::CompareBaselines(base, candidate, 0.95, 0.02);
+  ASSERT_EQ(changes.size(), 6);
+  EXPECT_FALSE(changes[0].significant_);
+  EXPECT_TRUE(changes[1].regression_);
+  EXPECT_NEAR(changes[1].change_, 0.2, 1e-9);
+  EXPECT_LT(changes[1].change_low_, 0.2);
+  EXPECT_GT(changes[1].change_low_, 0);
+  EXPECT_TRUE(changes[2].improvement_);
+  EXPECT_FALSE(changes[2].regression_);
+  EXPECT_TRUE(changes[3].significant_);
+  EXPECT_FALSE(changes[3].regression_);
+  EXPECT_TRUE(changes[4].significant_);
+  EXPECT_EQ(changes[4].change_low_, changes[4].change_high_);
+  EXPECT_FALSE(changes[5].significant_);
+
+  // A stricter threshold turns the instruction count change into a regression
+  EXPECT_TRUE(workload::CompareBaselines(base, candidate, 0.95, 0.001)[4].regression_);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "driver/batch_compiler.h"
+#include "driver/compilation_cache.h"
+#include "driver/compile.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+
+namespace scp::test {
+
+class BatchCompilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    std::string base_path = TEST_DATA_DIR;
+#else
+    std::string base_path = "test/data";
+#endif
+    test_data_path_ = base_path + "/code/";
+    output_dir_ = (std::filesystem::temp_directory_path() / "scp_batch_compiler_test").string();
+    std::filesystem::remove_all(output_dir_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(output_dir_); }
+
+  std::string test_data_path_;
+  std::string output_dir_;
+
+  // Helper function to read file content
+  static auto ReadFile(const std::string &filepath) -> std::string {
+    std::ifstream file(filepath);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  // Helper function to compile a file on its own, the way scpc does
+  static auto CompileAlone(const std::string &filepath) -> std::string {
+    parser::SLRParser parser(std::filesystem::path(filepath).stem().string());
+    parser.SetInput(ReadFile(filepath));
+    auto ast = parser.Parse();
+    semant::TypeChecker type_checker(ast);
+    auto type_environment = type_checker.CheckType();
+    cgen::CodeGenerator code_generator(ast, type_environment);
+    return code_generator.GenerateCode() + "\n";
+  }
+};
+
+// Concurrent compilation produces exactly what one compilation per file does
+TEST_F(BatchCompilerTest, MatchesSerialCompilation) {
+  std::vector<std::string> inputs;
+  for (const auto &entry : std::filesystem::directory_iterator(test_data_path_)) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("cgen_", 0) == 0) {
+      inputs.push_back(entry.path().string());
+    }
+  }
+  ASSERT_FALSE(inputs.empty());
+
+  driver::BatchCompiler compiler(cgen::CodeGeneratorOptions{}, 4);
+  auto results = compiler.Compile(inputs, output_dir_);
+  ASSERT_EQ(inputs.size(), results.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_TRUE(results[i].success_) << results[i].diagnostics_;
+    EXPECT_EQ(inputs[i], results[i].input_);
+    EXPECT_EQ(CompileAlone(inputs[i]), ReadFile(results[i].output_)) << inputs[i];
+  }
+}
+
+// A failing file reports its own diagnostics without affecting the others
+TEST_F(BatchCompilerTest, ReportsErrorsPerFile) {
+  std::vector<std::string> inputs = {test_data_path_ + "cgen_basic_number.scpl",
+                                     test_data_path_ + "type_error_add_number_string.scpl",
+                                     test_data_path_ + "missing_file.scpl", test_data_path_ + "cgen_basic_string.scpl"};
+  driver::BatchCompiler compiler(cgen::CodeGeneratorOptions{}, 2);
+  auto results = compiler.Compile(inputs, output_dir_);
+  ASSERT_EQ(4U, results.size());
+  EXPECT_TRUE(results[0].success_);
+  EXPECT_FALSE(results[1].success_);
+  EXPECT_NE(std::string::npos, results[1].diagnostics_.find("Type checker"));
+  EXPECT_FALSE(results[2].success_);
+  EXPECT_NE(std::string::npos, results[2].diagnostics_.find("Cannot open file"));
+  EXPECT_TRUE(results[3].success_);
+  EXPECT_TRUE(results[3].diagnostics_.empty());
+}
+
+// Two inputs with the same name cannot share an output file
+TEST_F(BatchCompilerTest, RejectsCollidingOutputs) {
+  std::string input = test_data_path_ + "cgen_basic_number.scpl";
+  driver::BatchCompiler compiler(cgen::CodeGeneratorOptions{}, 2);
+  auto results = compiler.Compile({input, input}, output_dir_);
+  EXPECT_TRUE(results[0].success_);
+  EXPECT_FALSE(results[1].success_);
+  EXPECT_EQ(output_dir_ + "/cgen_basic_number.s", driver::BatchCompiler::GetOutputPath(input, output_dir_));
+}
+
+// A file compiled in a batch is keyed like the same file compiled alone, even without a final newline
+TEST_F(BatchCompilerTest, SharesCacheKeysWithSingleFileMode) {
+  std::filesystem::create_directories(output_dir_);
+  std::string input = output_dir_ + "/unterminated.scpl";
+  std::ofstream(input) << "a <- 42;\nstdout <- a;";
+  driver::CompilationCache cache(output_dir_ + "/cache");
+  driver::BatchCompiler compiler(cgen::CodeGeneratorOptions{}, 1, &cache);
+  auto results = compiler.Compile({input}, output_dir_);
+  ASSERT_TRUE(results[0].success_) << results[0].diagnostics_;
+
+  std::string key = driver::CompilationCache::MakeKey(driver::ReadSource(input),
+                                                      driver::CompilationCache::GetCompilerIdentity(),
+                                                      driver::CompilationCache::DescribeOptions({}));
+  std::string artifact;
+  EXPECT_TRUE(cache.Lookup(key, artifact));
+}
+
+// An empty file is reported and writes nothing, as in single-file mode, while the other files still compile
+TEST_F(BatchCompilerTest, SkipsEmptyInput) {
+  std::filesystem::create_directories(output_dir_);
+  std::string empty = output_dir_ + "/empty.scpl";
+  std::ofstream{empty};
+  std::string other = test_data_path_ + "cgen_basic_number.scpl";
+  driver::BatchCompiler compiler(cgen::CodeGeneratorOptions{}, 2);
+  auto results = compiler.Compile({empty, other}, output_dir_ + "/out");
+  ASSERT_EQ(2U, results.size());
+  EXPECT_TRUE(results[0].success_);
+  EXPECT_EQ(std::string(driver::EMPTY_INPUT_WARNING) + "\n", results[0].diagnostics_);
+  EXPECT_FALSE(std::filesystem::exists(results[0].output_));
+  EXPECT_TRUE(results[1].success_);
+  EXPECT_TRUE(std::filesystem::exists(results[1].output_));
+}
+
+}  // namespace scp::test
@@ -85,7 +85,7 @@ class CodeGeneratorTest : public ::testing::Test {
   }
 
   // Helper function to test code generation end-to-end
-  void TestCodeGeneration(const std::string &test_name) {
+  void TestCodeGeneration(const std::string &test_name, cgen::CodeGeneratorOptions options = {}) {
     // Read input file
     std::string input_file = test_data_path_ + test_name + ".scpl";
     std::string input_content = ReadFile(input_file);
@@ -107,7 +107,7 @@ class CodeGeneratorTest : public ::testing::Test {
     ASSERT_TRUE(type_environment) << "Type checking failed for: " << input_content;
 
     // Generate code
-    cgen::CodeGenerator code_generator(ast, type_environment);
+    cgen::CodeGenerator code_generator(ast, type_environment, options);
     std::string generated_code = code_generator.GenerateCode();
     ASSERT_FALSE(generated_code.empty()) << "Code generation failed for: " << input_content;
 
@@ -154,6 +154,54 @@ TEST_F(CodeGeneratorTest, ConcatParenThenRepeat) { TestCodeGeneration("cgen_conc
 TEST_F(CodeGeneratorTest, RepeatWithComputedCount) { TestCodeGeneration("cgen_repeat_computed_count"); }
 TEST_F(CodeGeneratorTest, LongChainConcatWithVars) { TestCodeGeneration("cgen_long_chain_concat"); }
 
+// Multiplications by constants, rewritten into shifts and adds and left as they are
+TEST_F(CodeGeneratorTest, MultiplyByConstants) {
+  TestCodeGeneration("cgen_multiply_constants");
+  cgen::CodeGeneratorOptions options;
+  options.apply_peephole_rules_ = false;
+  TestCodeGeneration("cgen_multiply_constants", options);
+}
+
+// Incremental concatenation, run against both string runtimes
+TEST_F(CodeGeneratorTest, IncrementalConcat) { TestCodeGeneration("cgen_rope_incremental_concat"); }
+
+// Rope string runtime
+TEST_F(CodeGeneratorTest, RopeStringConcatenation) {
+  TestCodeGeneration("cgen_string_concat", {cgen::StringRuntime::ROPE});
+}
+TEST_F(CodeGeneratorTest, RopeStringRepetition) {
+  TestCodeGeneration("cgen_string_repeat", {cgen::StringRuntime::ROPE});
+}
+TEST_F(CodeGeneratorTest, RopeMixConcatRepeatPrecedence) {
+  TestCodeGeneration("cgen_mix_concat_repeat_precedence", {cgen::StringRuntime::ROPE});
+}
+TEST_F(CodeGeneratorTest, RopeRepeatWithComputedCount) {
+  TestCodeGeneration("cgen_repeat_computed_count", {cgen::StringRuntime::ROPE});
+}
+TEST_F(CodeGeneratorTest, RopeIncrementalConcat) {
+  TestCodeGeneration("cgen_rope_incremental_concat", {cgen::StringRuntime::ROPE});
+}
+
+// The rope runtime replaces the flat buffers with rope nodes
+TEST_F(CodeGeneratorTest, RopeRuntimeRoutines) {
+  parser_->SetInput(R"(s <- "ab"; s <- s + s * 2; stdout <- s;)");
+  auto ast = parser_->Parse();
+  ASSERT_TRUE(ast);
+
+  semant::TypeChecker type_checker(ast);
+  auto type_environment = type_checker.CheckType();
+
+  cgen::CodeGenerator code_generator(ast, type_environment, {cgen::StringRuntime::ROPE});
+  std::string generated_code = code_generator.GenerateCode();
+
+  EXPECT_NE(generated_code.find("str_0_rope: .word 0, str_0, 0"), std::string::npos);
+  EXPECT_NE(generated_code.find("jal rope_concat"), std::string::npos);
+  EXPECT_NE(generated_code.find("jal rope_repeat"), std::string::npos);
+  EXPECT_NE(generated_code.find("jal rope_print"), std::string::npos);
+  EXPECT_EQ(generated_code.find("string_concat"), std::string::npos);
+  EXPECT_EQ(generated_code.find("concat_buffer"), std::string::npos);
+}
+
 // Test the existing iostream example
 TEST_F(CodeGeneratorTest, InputOutput) {
   // This test requires manual input, so we'll just verify code generation works
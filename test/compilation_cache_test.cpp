@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "driver/compilation_cache.h"
+
+namespace scp::test {
+
+class CompilationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ("scp_cache_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+                  ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  std::filesystem::path directory_;
+};
+
+// Every input of the key changes it
+TEST_F(CompilationCacheTest, KeyCoversInputs) {
+  auto key = driver::CompilationCache::MakeKey("a <- 1;", "1.0.0", "rle=1");
+  EXPECT_EQ("e0135608a57d08cc3fd9e2e1118b6c14d1073648a13efb716dc3f38b10b6eaf2", key);
+  EXPECT_EQ(key, driver::CompilationCache::MakeKey("a <- 1;", "1.0.0", "rle=1"));
+  EXPECT_NE(key, driver::CompilationCache::MakeKey("a <- 2;", "1.0.0", "rle=1"));
+  EXPECT_NE(key, driver::CompilationCache::MakeKey("a <- 1;", "1.0.1", "rle=1"));
+  EXPECT_NE(key, driver::CompilationCache::MakeKey("a <- 1;", "1.0.0", "rle=0"));
+  EXPECT_NE(driver::CompilationCache::MakeKey("ab", "c", ""), driver::CompilationCache::MakeKey("a", "bc", ""));
+  // SHA-256 of the length-prefixed material, for empty fields and across a block boundary
+  EXPECT_EQ("63cab8e921e413242a44bf4e8fdc999d3834c0883aed7afd6199c1ffa98c1948",
+            driver::CompilationCache::MakeKey("", "", ""));
+  EXPECT_EQ("6394d297cf4788727bf51f7d38a232a73ba036d73917dbdd3326fffcdfcad752",
+            driver::CompilationCache::MakeKey(std::string(100, 'x'), "1.0", ""));
+}
+
+// A stored artifact is found again and the lookups are counted
+TEST_F(CompilationCacheTest, StoresAndCounts) {
+  driver::CompilationCache cache(directory_);
+  std::string artifact;
+  EXPECT_FALSE(cache.Lookup("00ff", artifact));
+  cache.Store("00ff", ".text\nmain:\n");
+  EXPECT_TRUE(cache.Lookup("00ff", artifact));
+  EXPECT_EQ(".text\nmain:\n", artifact);
+  EXPECT_EQ(1U, cache.GetStats().hits_);
+
+  cache.Flush();
+  auto stats = driver::CompilationCache(directory_).GetStats();
+  EXPECT_EQ(1U, stats.hits_);
+  EXPECT_EQ(1U, stats.misses_);
+  EXPECT_EQ(1U, stats.entries_);
+  EXPECT_EQ(12U, stats.bytes_);
+}
+
+// The least recently used entries go first once the size limit is exceeded
+TEST_F(CompilationCacheTest, EvictsLeastRecentlyUsed) {
+  driver::CompilationCache cache(directory_, 12);
+  std::string artifact;
+  cache.Store("aa", "12345");
+  std::filesystem::last_write_time(directory_ / "aa" / "aa.s",
+                                   std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+  cache.Store("bb", "12345");
+  std::filesystem::last_write_time(directory_ / "bb" / "bb.s",
+                                   std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+  EXPECT_TRUE(cache.Lookup("aa", artifact));  // now the most recent
+  cache.Store("cc", "12345");
+
+  EXPECT_TRUE(cache.Lookup("aa", artifact));
+  EXPECT_FALSE(cache.Lookup("bb", artifact));
+  EXPECT_TRUE(cache.Lookup("cc", artifact));
+  EXPECT_EQ(2U, cache.GetStats().entries_);
+}
+
+// A store trusts the recorded size of the directory and scans it only once the estimate passes the limit
+TEST_F(CompilationCacheTest, TracksSizeWithoutScanning) {
+  {
+    driver::CompilationCache cache(directory_, 10);
+    cache.Store("aa", "1234");
+  }
+  std::ofstream(directory_ / "aa" / "planted.s") << "an entry the recorded size does not know about";
+  driver::CompilationCache cache(directory_, 10);
+  std::string artifact;
+  cache.Store("bb", "1234");
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "aa" / "planted.s"));
+  cache.Store("cc", "1234");  // 12 recorded bytes pass the limit
+  EXPECT_FALSE(std::filesystem::exists(directory_ / "aa" / "planted.s"));
+  EXPECT_TRUE(cache.Lookup("cc", artifact));
+}
+
+// Storing a key again only counts the difference in size, so it does not push the estimate over the limit
+TEST_F(CompilationCacheTest, ReplacingAnEntryCountsItOnce) {
+  {
+    driver::CompilationCache cache(directory_, 10);
+    cache.Store("aa", "123456");
+  }
+  std::ofstream(directory_ / "aa" / "planted.s") << "an entry the recorded size does not know about";
+  driver::CompilationCache cache(directory_, 10);
+  cache.Store("aa", "123456");
+  cache.Store("aa", "1234567");
+  EXPECT_TRUE(std::filesystem::exists(directory_ / "aa" / "planted.s"));
+  std::string artifact;
+  EXPECT_TRUE(cache.Lookup("aa", artifact));
+  EXPECT_EQ("1234567", artifact);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/json.h"
+#include "driver/compile_report.h"
+#include "driver/memory_accounting.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+
+namespace scp::test {
+
+// Lexing ahead gives the parser the same tokens it would pull from the lexer
+TEST(CompileReportTest, LexAheadMatchesStreaming) {
+  const std::string source = "name <- \"alice\";\nstdout <- \"hello \" + name * 2;\n";
+  parser::SLRParser streaming("streaming");
+  streaming.SetInput(source);
+  auto streamed = streaming.Parse();
+  ASSERT_TRUE(streamed);
+
+  parser::SLRParser lexed("lexed");
+  lexed.SetInput(source);
+  ASSERT_TRUE(lexed.Lex());
+  EXPECT_EQ(lexed.GetTokenCount(), 12U);
+  auto ast = lexed.Parse();
+  ASSERT_TRUE(ast);
+  EXPECT_EQ(lexed.GetTokenCount(), streaming.GetTokenCount());
+  EXPECT_EQ(lexed.GetParseTreeNodeCount(), streaming.GetParseTreeNodeCount());
+
+  driver::CompileReport streamed_report;
+  streamed_report.CountAST(*streamed);
+  driver::CompileReport report;
+  report.CountAST(*ast);
+  EXPECT_EQ(report.stats_.ast_nodes_, streamed_report.stats_.ast_nodes_);
+  EXPECT_EQ(report.stats_.string_literal_bytes_, 11U);
+
+  semant::TypeChecker type_checker(ast);
+  EXPECT_EQ(type_checker.CheckType()->GetSymbolCount(), 3U);  // stdin, stdout and name
+}
+
+// A character that starts no token fails the lexing phase
+TEST(CompileReportTest, LexRejectsUnknownCharacter) {
+  parser::SLRParser parser("bad");
+  parser.SetInput("x <- 1 # 2;");
+  EXPECT_FALSE(parser.Lex());
+}
+
+// Timers record each phase once, in order, and a null report measures nothing
+TEST(CompileReportTest, PhaseTimers) {
+  driver::CompileReport report;
+  {
+    driver::PhaseTimer first(&report, "first");
+    driver::PhaseTimer ignored(nullptr, "ignored");
+    first.Stop();
+    first.Stop();
+    driver::PhaseTimer second(&report, "second");
+  }
+  ASSERT_EQ(report.phases_.size(), 2U);
+  EXPECT_EQ(report.phases_[0].name_, "first");
+  EXPECT_EQ(report.phases_[1].name_, "second");
+  EXPECT_GE(report.phases_[0].wall_seconds_, 0);
+
+  std::string times = report.FormatTimes();
+  EXPECT_NE(times.find("first"), std::string::npos);
+  EXPECT_NE(times.find("total"), std::string::npos);
+}
+
+// Every operator new is counted, and a phase sees its own allocations and the heap high-water mark
+TEST(CompileReportTest, CountsAllocations) {
+  ASSERT_TRUE(driver::MemoryAccounting::IsEnabled());
+  uint64_t count = driver::MemoryAccounting::GetAllocationCount();
+  uint64_t bytes = driver::MemoryAccounting::GetAllocatedBytes();
+  uint64_t live = driver::MemoryAccounting::GetLiveBytes();
+  {
+    auto block = std::make_unique<char[]>(4096);
+    EXPECT_EQ(driver::MemoryAccounting::GetAllocationCount(), count + 1);
+    EXPECT_EQ(driver::MemoryAccounting::GetAllocatedBytes(), bytes + 4096);
+    EXPECT_EQ(driver::MemoryAccounting::GetLiveBytes(), live + 4096);
+  }
+  EXPECT_EQ(driver::MemoryAccounting::GetLiveBytes(), live);
+
+  driver::CompileReport report;
+  {
+    driver::PhaseTimer timer(&report, "allocate");
+    std::vector<std::unique_ptr<int>> values;
+    for (int i = 0; i < 100; ++i) {
+      values.push_back(std::make_unique<int>(i));
+    }
+  }
+  ASSERT_EQ(report.phases_.size(), 1U);
+  EXPECT_GE(report.phases_[0].allocations_, 100U);
+  EXPECT_GE(report.phases_[0].allocated_bytes_, 100 * sizeof(int));
+  EXPECT_GE(report.phases_[0].peak_bytes_, live + 100 * sizeof(int));
+  EXPECT_GT(driver::MemoryAccounting::GetPeakRss(), 0U);
+}
+
+TEST(CompileReportTest, FormatsJson) {
+  driver::CompileReport report;
+  report.AddPhase({"parse", 0.5, 0.25, 3, 96, 128});
+  report.stats_.tokens_ = 7;
+  EXPECT_EQ(report.FormatJson(true, false, false),
+            "{\"phases\": [{\"name\": \"parse\", \"wall_ms\": 500, \"cpu_ms\": 250}]}\n");
+  std::string both = report.FormatJson(true, false, true);
+  EXPECT_NE(both.find("], \"stats\": {\"tokens\": 7, "), std::string::npos);
+  EXPECT_EQ(report.FormatJson(false, false, true).find("phases"), std::string::npos);
+  report.peak_rss_bytes_ = 4096;
+  EXPECT_EQ(report.FormatJson(false, true, false),
+            "{\"phases\": [{\"name\": \"parse\", \"allocations\": 3, \"allocated_bytes\": 96, \"peak_bytes\": 128}]"
+            ", \"peak_rss_bytes\": 4096}\n");
+}
+
+TEST(CompileReportTest, QuotesJsonStrings) {
+  EXPECT_EQ(core::JsonQuote("plain"), "\"plain\"");
+  EXPECT_EQ(core::JsonQuote("a\"b\\c\nd\x01"), "\"a\\\"b\\\\c\\nd\\u0001\"");
+}
+
+}  // namespace scp::test
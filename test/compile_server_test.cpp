@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "driver/compile.h"
+#include "driver/compile_server.h"
+#include "parser/slr_parser.h"
+
+namespace scp::test {
+
+class CompileServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    std::string base_path = TEST_DATA_DIR;
+#else
+    std::string base_path = "test/data";
+#endif
+    test_data_path_ = base_path + "/code/";
+    socket_path_ = (std::filesystem::temp_directory_path() / "scp_compile_server_test.sock").string();
+    std::filesystem::remove(socket_path_);
+  }
+
+  void TearDown() override { std::filesystem::remove(socket_path_); }
+
+  std::string test_data_path_;
+  std::string socket_path_;
+
+  // Helper function to open a socket connected to the test socket, -1 on failure
+  auto ConnectRaw() const -> int {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  // Helper function to read file content
+  static auto ReadFile(const std::string &filepath) -> std::string {
+    std::ifstream file(filepath);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+};
+
+// Results from the server match an in-process compilation, for sources sent as bytes or as a path
+TEST_F(CompileServerTest, MatchesInProcessCompilation) {
+  driver::CompileServer server(socket_path_, 2);
+  std::string error;
+  ASSERT_TRUE(server.Start(error)) << error;
+  std::thread serving([&server] { server.Serve(); });
+
+  for (const char *name : {"cgen_arithmetic", "cgen_string_concat", "cgen_string_repeat"}) {
+    std::string path = test_data_path_ + name + ".scpl";
+    parser::SLRParser parser("");
+    auto expected = driver::CompileSource(parser, name, ReadFile(path), {});
+    ASSERT_TRUE(expected.success_) << expected.diagnostics_;
+
+    driver::CompileResult by_bytes;
+    ASSERT_TRUE(driver::CompileClient::Compile(socket_path_, {name, "", ReadFile(path), {}}, by_bytes));
+    EXPECT_TRUE(by_bytes.success_);
+    EXPECT_EQ(by_bytes.output_, expected.output_) << name;
+
+    driver::CompileResult by_path;
+    ASSERT_TRUE(driver::CompileClient::Compile(socket_path_, {name, path, "", {}}, by_path));
+    EXPECT_EQ(by_path.output_, expected.output_) << name;
+  }
+
+  // Options travel with the request
+  cgen::CodeGeneratorOptions options;
+  options.eliminate_redundant_loads_ = false;
+  options.string_runtime_ = cgen::StringRuntime::ROPE;
+  std::string path = test_data_path_ + "cgen_string_concat.scpl";
+  parser::SLRParser parser("");
+  auto expected = driver::CompileSource(parser, "cgen_string_concat", ReadFile(path), options);
+  driver::CompileResult result;
+  ASSERT_TRUE(
+      driver::CompileClient::Compile(socket_path_, {"cgen_string_concat", "", ReadFile(path), options}, result));
+  EXPECT_EQ(result.output_, expected.output_);
+
+  EXPECT_TRUE(driver::CompileClient::Shutdown(socket_path_));
+  serving.join();
+  EXPECT_EQ(server.GetRequestCount(), 7U);
+}
+
+// Errors come back as diagnostics of that request alone
+TEST_F(CompileServerTest, ReturnsDiagnostics) {
+  driver::CompileServer server(socket_path_, 1);
+  std::string error;
+  ASSERT_TRUE(server.Start(error)) << error;
+  std::thread serving([&server] { server.Serve(); });
+
+  driver::CompileResult result;
+  std::string path = test_data_path_ + "type_error_add_number_string.scpl";
+  ASSERT_TRUE(driver::CompileClient::Compile(socket_path_, {"bad", "", ReadFile(path), {}}, result));
+  EXPECT_FALSE(result.success_);
+  EXPECT_NE(result.diagnostics_.find("Error"), std::string::npos);
+
+  ASSERT_TRUE(driver::CompileClient::Compile(socket_path_, {"missing", test_data_path_ + "missing.scpl", "", {}},
+                                             result));
+  EXPECT_FALSE(result.success_);
+  EXPECT_NE(result.diagnostics_.find("Cannot open file"), std::string::npos);
+
+  server.Stop();
+  serving.join();
+}
+
+// Without a server the client reports failure, so the caller can fall back to compiling in-process
+TEST_F(CompileServerTest, ClientWithoutServer) {
+  driver::CompileResult result;
+  EXPECT_FALSE(driver::CompileClient::Compile(socket_path_, {"none", "", "x = 1;", {}}, result));
+  EXPECT_FALSE(driver::CompileClient::Shutdown(socket_path_));
+}
+
+// Connections that send nothing hold no worker, so requests of other clients are still answered
+TEST_F(CompileServerTest, IdleConnectionsDoNotBlockWorkers) {
+  driver::CompileServer server(socket_path_, 1);
+  std::string error;
+  ASSERT_TRUE(server.Start(error)) << error;
+  std::thread serving([&server] { server.Serve(); });
+
+  std::vector<int> idle;
+  for (int i = 0; i < 4; i++) {
+    idle.push_back(ConnectRaw());
+    ASSERT_GE(idle.back(), 0);
+  }
+  // Half a frame header leaves a connection waiting for the rest
+  ASSERT_EQ(::send(idle[0], "\0\0", 2, MSG_NOSIGNAL), 2);
+
+  driver::CompileResult result;
+  ASSERT_TRUE(driver::CompileClient::Compile(socket_path_, {"x", "", "x <- 1;", {}}, result, 2000));
+  EXPECT_TRUE(result.success_) << result.diagnostics_;
+  EXPECT_TRUE(driver::CompileClient::Shutdown(socket_path_, 2000));
+  serving.join();
+  EXPECT_EQ(server.GetRequestCount(), 1U);
+  for (int fd : idle) {
+    ::close(fd);
+  }
+}
+
+// A server that accepts but never answers times out, so the caller can fall back to compiling in-process
+TEST_F(CompileServerTest, ClientTimesOut) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(listener, 0);
+  ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  ASSERT_EQ(::listen(listener, 4), 0);
+
+  auto start = std::chrono::steady_clock::now();
+  driver::CompileResult result;
+  EXPECT_FALSE(driver::CompileClient::Compile(socket_path_, {"x", "", "x = 1;", {}}, result, 200));
+  EXPECT_FALSE(driver::CompileClient::Shutdown(socket_path_, 200));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ::close(listener);
+}
+
+// A second server on the same socket is refused, and a stale socket file is taken over
+TEST_F(CompileServerTest, OneServerPerSocket) {
+  {
+    driver::CompileServer first(socket_path_, 1);
+    std::string error;
+    ASSERT_TRUE(first.Start(error)) << error;
+
+    driver::CompileServer second(socket_path_, 1);
+    EXPECT_FALSE(second.Start(error));
+    EXPECT_NE(error.find("already"), std::string::npos);
+  }
+  std::ofstream(socket_path_) << "stale";
+  driver::CompileServer server(socket_path_, 1);
+  std::string error;
+  EXPECT_TRUE(server.Start(error)) << error;
+}
+
+// The socket is private to its owner, and the default path avoids the shared /tmp namespace
+TEST_F(CompileServerTest, SocketIsPrivate) {
+  driver::CompileServer server(socket_path_, 1);
+  std::string error;
+  ASSERT_TRUE(server.Start(error)) << error;
+  struct stat info {};
+  ASSERT_EQ(::lstat(socket_path_.c_str(), &info), 0);
+  EXPECT_EQ(info.st_mode & (S_IRWXG | S_IRWXO), 0U);
+
+  std::string runtime = (std::filesystem::temp_directory_path() / "scp_compile_server_runtime").string();
+  const char *socket_env = std::getenv("SCP_SERVER_SOCKET");
+  const char *runtime_env = std::getenv("XDG_RUNTIME_DIR");
+  std::string saved_socket = socket_env != nullptr ? socket_env : "";
+  std::string saved_runtime = runtime_env != nullptr ? runtime_env : "";
+  ::unsetenv("SCP_SERVER_SOCKET");
+  ::setenv("XDG_RUNTIME_DIR", runtime.c_str(), 1);
+  EXPECT_EQ(driver::CompileServer::GetDefaultSocketPath(), runtime + "/scp-server.sock");
+  ::unsetenv("XDG_RUNTIME_DIR");
+  std::string directory = "/tmp/scp-" + std::to_string(::getuid());
+  EXPECT_EQ(driver::CompileServer::GetDefaultSocketPath(), directory + "/server.sock");
+  ASSERT_EQ(::lstat(directory.c_str(), &info), 0);
+  EXPECT_EQ(info.st_mode & (S_IRWXG | S_IRWXO), 0U);
+  if (socket_env != nullptr) {
+    ::setenv("SCP_SERVER_SOCKET", saved_socket.c_str(), 1);
+  }
+  if (runtime_env != nullptr) {
+    ::setenv("XDG_RUNTIME_DIR", saved_runtime.c_str(), 1);
+  }
+}
+
+}  // namespace scp::test
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "driver/compiler.h"
+
+namespace scp::test {
+
+// A session compiles like a fresh pipeline and reports errors in the result
+TEST(CompilerTest, CompileReturnsResult) {
+  scp::Compiler compiler;
+  auto result = compiler.Compile("x <- 1 + 2;\nstdout <- x;\n");
+  EXPECT_TRUE(result.success_);
+  EXPECT_NE(result.output_.find("main:"), std::string::npos);
+  EXPECT_EQ(result.diagnostics_, "");
+
+  auto failed = compiler.Compile("x <- ;");
+  EXPECT_FALSE(failed.success_);
+  EXPECT_NE(failed.diagnostics_.find("Error: Failed to parse"), std::string::npos);
+
+  auto type_error = compiler.Compile("x <- y;");
+  EXPECT_FALSE(type_error.success_);
+  EXPECT_NE(type_error.diagnostics_.find("Error:"), std::string::npos);
+}
+
+// A view into a larger buffer compiles only the viewed bytes
+TEST(CompilerTest, CompilesStringView) {
+  scp::Compiler compiler;
+  std::string buffer = "x <- 1;\nstdout <- x;\n garbage that does not lex: #";
+  auto result = compiler.Compile(std::string_view(buffer).substr(0, buffer.find(" garbage")));
+  EXPECT_TRUE(result.success_) << result.diagnostics_;
+}
+
+// The options reach the code generator
+TEST(CompilerTest, AppliesOptions) {
+  scp::Compiler compiler;
+  scp::Compiler::Options rope;
+  rope.string_runtime_ = cgen::StringRuntime::ROPE;
+  std::string source = "s <- \"a\" + \"b\";\nstdout <- s;\n";
+  EXPECT_NE(compiler.Compile(source).output_, compiler.Compile(source, rope).output_);
+}
+
+// Parsers return to the pool, so sequential compilations reuse one
+TEST(CompilerTest, ReusesParsers) {
+  scp::Compiler compiler;
+  EXPECT_EQ(compiler.GetIdleParserCount(), 0);
+  for (int i = 0; i < 5; i++) {
+    compiler.Compile("x <- " + std::to_string(i) + ";");
+  }
+  EXPECT_EQ(compiler.GetIdleParserCount(), 1);
+}
+
+// Concurrent callers get the same output as a sequential caller and only their own diagnostics
+TEST(CompilerTest, CompilesConcurrently) {
+  std::vector<std::string> sources;
+  for (int i = 0; i < 16; i++) {
+    sources.push_back(i % 4 == 3 ? "x <- y" + std::to_string(i) + ";"
+                                 : "a <- " + std::to_string(i) + " * 2;\nb <- \"v\" * a;\nstdout <- b;\n");
+  }
+  scp::Compiler compiler;
+  std::vector<scp::Compiler::Result> expected;
+  for (const auto &source : sources) {
+    expected.push_back(compiler.Compile(source));
+  }
+
+  constexpr int THREADS = 8;
+  constexpr int ROUNDS = 10;
+  std::vector<std::vector<scp::Compiler::Result>> results(THREADS);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; t++) {
+    threads.emplace_back([&compiler, &sources, &results, t] {
+      for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < sources.size(); i++) {
+          results[t].push_back(compiler.Compile(sources[(i + t) % sources.size()]));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < THREADS; t++) {
+    ASSERT_EQ(results[t].size(), sources.size() * ROUNDS);
+    for (size_t k = 0; k < results[t].size(); k++) {
+      const auto &want = expected[(k % sources.size() + t) % sources.size()];
+      EXPECT_EQ(results[t][k].success_, want.success_);
+      EXPECT_EQ(results[t][k].output_, want.output_);
+      EXPECT_EQ(results[t][k].diagnostics_, want.diagnostics_);
+    }
+  }
+  EXPECT_LE(compiler.GetIdleParserCount(), THREADS + 1);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/flat_hash_map.h"
+
+namespace scp::test {
+
+// Maps keyed by strings take views and literals without building a key
+TEST(FlatHashMapTest, LooksUpStringsByView) {
+  core::FlatHashMap<std::string, int> map = {{"identifier", 1}, {"$", 2}};
+  map["plus"] = 3;
+  EXPECT_EQ(map.size(), 3U);
+  EXPECT_EQ(map.at("$"), 2);
+  EXPECT_EQ(map.find(std::string_view("identifier"))->second, 1);
+  EXPECT_EQ(map.find("times"), map.end());
+  EXPECT_TRUE(map.contains(std::string("plus")));
+  EXPECT_THROW(map.at("times"), std::out_of_range);
+
+  EXPECT_FALSE(map.try_emplace("plus", 4).second);
+  EXPECT_FALSE(map.emplace("plus", 5).second);
+  EXPECT_EQ(map["plus"], 3);
+  EXPECT_EQ(map.erase("plus"), 1U);
+  EXPECT_EQ(map.erase("plus"), 0U);
+  EXPECT_EQ(map.size(), 2U);
+
+  core::FlatHashSet<std::string> set = {"a", "b"};
+  set.insert("a");
+  EXPECT_EQ(set.size(), 2U);
+  EXPECT_EQ(set.count("b"), 1U);
+}
+
+// Random inserts and erases leave the map holding what std::unordered_map holds, through growth and copies
+TEST(FlatHashMapTest, MatchesUnorderedMap) {
+  core::FlatHashMap<int, int> map;
+  std::unordered_map<int, int> expected;
+  std::mt19937 random(3);
+  for (int step = 0; step < 200000; step++) {
+    int key = static_cast<int>(random() % 5000);
+    if (random() % 3 == 0) {
+      ASSERT_EQ(map.erase(key), expected.erase(key)) << key;
+    } else {
+      map[key] += step;
+      expected[key] += step;
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+  core::FlatHashMap<int, int> copy = map;
+  core::FlatHashMap<int, int> moved = std::move(map);
+  for (const auto *table : {&copy, &moved}) {
+    size_t visited = 0;
+    for (const auto &[key, value] : *table) {
+      ASSERT_EQ(value, expected.at(key)) << key;
+      visited++;
+    }
+    EXPECT_EQ(visited, expected.size());
+  }
+}
+
+// Keys that all hash alike still work in the runs probing makes of them
+TEST(FlatHashMapTest, CollidingKeys) {
+  struct SameHash {
+    auto operator()(int) const -> size_t { return 7; }
+  };
+  core::FlatHashMap<int, std::string, SameHash> map;
+  for (int i = 0; i < 200; i++) {
+    map[i] = std::to_string(i);
+  }
+  for (int i = 0; i < 200; i += 2) {
+    map.erase(i);
+  }
+  EXPECT_EQ(map.size(), 100U);
+  for (int i = 0; i < 200; i++) {
+    EXPECT_EQ(map.contains(i), i % 2 == 1) << i;
+  }
+  EXPECT_EQ(map.at(199), "199");
+}
+
+}  // namespace scp::test
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "driver/fuzz_check.h"
+#include "parser/ll1_parser.h"
+#include "parser/slr_parser.h"
+#include "workload/program_generator.h"
+
+namespace fs = std::filesystem;
+
+namespace scp::test {
+
+class FuzzCheckTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    test_data_path_ = TEST_DATA_DIR;
+#else
+    test_data_path_ = "test/data";
+#endif
+  }
+
+  std::string test_data_path_;
+
+  // Helper function to read file content
+  static auto ReadFile(const std::string &filepath) -> std::string {
+    std::ifstream file(filepath, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  // Helper function to list the programs of a directory in name order
+  static auto ListPrograms(const std::string &directory) -> std::vector<std::string> {
+    std::vector<std::string> paths;
+    for (const auto &entry : fs::directory_iterator(directory)) {
+      if (entry.path().extension() == ".scpl") {
+        paths.push_back(entry.path().string());
+      }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+};
+
+// The test corpus and the fuzzer regression corpus replay without a parser mismatch or a slow input
+TEST_F(FuzzCheckTest, CorporaReplayCleanly) {
+  driver::FuzzCheck check;
+  for (const auto *directory : {"/code", "/fuzz"}) {
+    auto paths = ListPrograms(test_data_path_ + directory);
+    ASSERT_FALSE(paths.empty()) << directory;
+    for (const auto &path : paths) {
+      auto result = check.Run(ReadFile(path));
+      EXPECT_EQ(result.mismatch_, "") << path;
+      EXPECT_FALSE(result.slow_) << path << " took " << result.seconds_ << " s";
+    }
+  }
+}
+
+// Each input stops at the stage that rejects it
+TEST_F(FuzzCheckTest, ReportsRejectingStage) {
+  driver::FuzzCheck check;
+  EXPECT_EQ(check.Run("x <- 1 + 2;\nstdout <- x;\n").stage_, driver::FuzzStage::COMPILED);
+  EXPECT_EQ(check.Run("x <- 1 # 2;").stage_, driver::FuzzStage::LEX_ERROR);
+  EXPECT_EQ(check.Run("x <- 1 +;").stage_, driver::FuzzStage::PARSE_ERROR);
+  EXPECT_EQ(check.Run("x <- y;").stage_, driver::FuzzStage::TYPE_ERROR);
+
+  // Both parsers used to disagree on a lone expression
+  auto result = check.Run(ReadFile(test_data_path_ + "/fuzz/lone_number.scpl"));
+  EXPECT_EQ(result.stage_, driver::FuzzStage::PARSE_ERROR);
+  EXPECT_EQ(result.mismatch_, "");
+}
+
+// Deeply nested statements compile, as no pass recurses once per operator or parenthesis
+TEST_F(FuzzCheckTest, CompilesDeeplyNestedStatements) {
+  constexpr int DEPTH = 20000;  // twice the depth the recursive passes overflowed the stack at
+  std::string parentheses = std::string(DEPTH, '(') + "1" + std::string(DEPTH, ')');
+  std::string sum = "1";
+  std::string product = "1";
+  std::string right_nested;
+  for (int i = 0; i < DEPTH; i++) {
+    sum += " + 1";
+    product += " * 2";
+    right_nested += "\"a\" * 3 + (";
+  }
+  right_nested += "\"b\"" + std::string(DEPTH, ')');
+
+  driver::FuzzCheck check;
+  for (const auto &expression : {parentheses, sum, product, right_nested}) {
+    auto result = check.Run("x <- " + expression + ";\nstdout <- x;\n");
+    EXPECT_EQ(result.stage_, driver::FuzzStage::COMPILED) << expression.substr(0, 40);
+    EXPECT_EQ(result.mismatch_, "") << expression.substr(0, 40);
+  }
+}
+
+// Generated programs compile and both parsers build the same AST from them
+TEST_F(FuzzCheckTest, GeneratedProgramsAgree) {
+  driver::FuzzCheck check;
+  std::vector<workload::GeneratorOptions> knobs(3);
+  knobs[1].string_share_ = 1.0;
+  knobs[2].max_depth_ = 6;
+  knobs[2].max_chain_ = 8;
+  for (size_t i = 0; i < knobs.size(); i++) {
+    knobs[i].seed_ = i + 11;
+    knobs[i].statements_ = 500;
+    auto result = check.Run(workload::ProgramGenerator(knobs[i]).Generate());
+    EXPECT_EQ(result.stage_, driver::FuzzStage::COMPILED) << "knob set " << i;
+    EXPECT_EQ(result.mismatch_, "") << "knob set " << i;
+    EXPECT_FALSE(result.slow_) << "knob set " << i << " took " << result.seconds_ << " s";
+  }
+}
+
+// Any input is slow under a zero threshold, unless it is below the minimum size
+TEST_F(FuzzCheckTest, FlagsSlowInputs) {
+  driver::FuzzCheck strict(0, 4);
+  EXPECT_TRUE(strict.Run("x <- 1;").slow_);
+  EXPECT_FALSE(strict.Run("x;").slow_);
+}
+
+// A saved input is named after its contents, so saving it twice gives one file
+TEST_F(FuzzCheckTest, SaveInputIsContentAddressed) {
+  auto directory = (fs::temp_directory_path() / "scp_fuzz_check_test").string();
+  fs::remove_all(directory);
+  auto path = driver::FuzzCheck::SaveInput(directory, "x <- 1;");
+  ASSERT_FALSE(path.empty());
+  EXPECT_EQ(driver::FuzzCheck::SaveInput(directory, "x <- 1;"), path);
+  EXPECT_NE(driver::FuzzCheck::SaveInput(directory, "x <- 2;"), path);
+  EXPECT_EQ(ReadFile(path), "x <- 1;");
+  EXPECT_EQ(std::distance(fs::directory_iterator(directory), fs::directory_iterator()), 2);
+  fs::remove_all(directory);
+}
+
+// Structural equality compares shape, node types and values
+TEST_F(FuzzCheckTest, ASTStructuralEquality) {
+  parser::LL1Parser ll1("equality");
+  parser::SLRParser slr("equality");
+  ll1.SetInput("x <- (1 + 2) * 3;\nstdout <- x;\n");
+  slr.SetInput("x <- (1 + 2) * 3;\nstdout <- x;\n");
+  auto ll1_ast = ll1.Parse();
+  auto slr_ast = slr.Parse();
+  ASSERT_TRUE(ll1_ast && slr_ast);
+  EXPECT_TRUE(ll1_ast->GetRoot()->IsStructurallyEqual(*slr_ast->GetRoot()));
+
+  slr.SetInput("x <- 1 + 2 * 3;\nstdout <- x;\n");
+  auto other_ast = slr.Parse();
+  ASSERT_TRUE(other_ast);
+  EXPECT_FALSE(ll1_ast->GetRoot()->IsStructurallyEqual(*other_ast->GetRoot()));
+}
+
+}  // namespace scp::test
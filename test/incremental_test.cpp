@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "driver/checkpoint.h"
+#include "driver/compile.h"
+#include "parser/slr_parser.h"
+#include "workload/program_generator.h"
+
+namespace scp::test {
+
+class IncrementalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    option_sets_.resize(3);
+    option_sets_[1].schedule_instructions_ = true;
+    option_sets_[1].fill_delay_slots_ = true;
+    option_sets_[2].string_runtime_ = cgen::StringRuntime::ROPE;
+  }
+
+  // Compile incrementally and expect the result of a full compile
+  void ExpectSameAsFull(const std::string &source, const cgen::CodeGeneratorOptions &options,
+                        driver::Checkpoint &checkpoint, size_t reused_bytes) {
+    auto full = driver::CompileSource(parser_, "program", source, options);
+    auto incremental = driver::CompileIncremental(parser_, "program", source, options, checkpoint);
+    EXPECT_EQ(incremental.success_, full.success_) << source;
+    EXPECT_EQ(incremental.output_, full.output_) << source;
+    EXPECT_EQ(incremental.diagnostics_, full.diagnostics_) << source;
+    EXPECT_EQ(incremental.reused_bytes_, reused_bytes) << source;
+  }
+
+  std::vector<cgen::CodeGeneratorOptions> option_sets_;
+  parser::SLRParser parser_{"IncrementalTest"};
+};
+
+// A generated program growing a few lines at a time compiles, through serialized checkpoints, like a full compile
+TEST_F(IncrementalTest, GrowingProgramMatchesFullCompile) {
+  workload::GeneratorOptions knobs;
+  knobs.statements_ = 90;
+  knobs.stdin_share_ = 0.1;
+  std::string program = workload::ProgramGenerator(knobs).Generate();
+  for (const auto &options : option_sets_) {
+    driver::Checkpoint checkpoint;
+    size_t compiled = 0;
+    for (size_t end = 0, lines = 0; end < program.size(); end++) {
+      if (program[end] == '\n' && ++lines % 20 == 0) {
+        ExpectSameAsFull(program.substr(0, end + 1), options, checkpoint, compiled);
+        checkpoint = driver::Checkpoint::Deserialize(checkpoint.Serialize());
+        EXPECT_EQ(checkpoint.offset_, end + 1);
+        compiled = end + 1;
+      }
+    }
+    ExpectSameAsFull(program, options, checkpoint, compiled);
+  }
+}
+
+// Errors in the appended statements name the lines of the whole source, and leave the checkpoint where it was
+TEST_F(IncrementalTest, ErrorsMatchFullCompile) {
+  driver::Checkpoint checkpoint;
+  ExpectSameAsFull("a <- 1;\n\nb <- \"x\";\n", {}, checkpoint, 0);
+  for (const auto *appended : {"c <- a # 2;\n", "c <- a +;\n", "c <- a + b;\n", "c <- q;\nd <- c * 2;\n"}) {
+    ExpectSameAsFull(std::string("a <- 1;\n\nb <- \"x\";\n") + appended, {}, checkpoint, 19);
+    EXPECT_EQ(checkpoint.offset_, 19);
+    EXPECT_EQ(checkpoint.line_, 4);
+  }
+}
+
+// A changed prefix or string runtime compiles everything again, and an unfinished last line is compiled again
+TEST_F(IncrementalTest, RecompilesWhatTheCheckpointDoesNotCover) {
+  driver::Checkpoint checkpoint;
+  ExpectSameAsFull("a <- \"x\";\nb <- a + a;\n", {}, checkpoint, 0);
+  ExpectSameAsFull("a <- \"y\";\nb <- a + a;\nstdout <- b;\n", {}, checkpoint, 0);
+  ExpectSameAsFull("a <- \"y\";\nb <- a + a;\nstdout <- b;\nc <- stdin;", {}, checkpoint, 35);
+  EXPECT_EQ(checkpoint.offset_, 35);
+  ExpectSameAsFull("a <- \"y\";\nb <- a + a;\nstdout <- b;\nc <- stdin;\nstdout <- c;\n", {}, checkpoint, 35);
+  ExpectSameAsFull("a <- \"y\";\nb <- a + a;\nstdout <- b;\nc <- stdin;\nstdout <- c;\n", option_sets_[2],
+                   checkpoint, 0);
+  ExpectSameAsFull("a <- \"y\";\n", option_sets_[2], checkpoint, 0);
+  EXPECT_THROW(driver::Checkpoint::Deserialize("SCPCHECKPOINT 0\n"), std::runtime_error);
+}
+
+}  // namespace scp::test
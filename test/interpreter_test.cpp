@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/diagnostics.h"
+#include "interp/interpreter.h"
+
+namespace scp::test {
+
+class InterpreterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    std::string base_path = TEST_DATA_DIR;
+#else
+    std::string base_path = "test/data";
+#endif
+    test_data_path_ = base_path + "/code/";
+    output_data_path_ = base_path + "/output/";
+  }
+
+  static auto ReadFile(const std::string &filename) -> std::string {
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  // The expected outputs end with a newline the programs do not print
+  static auto TrimEnd(std::string text) -> std::string {
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == ' ')) {
+      text.pop_back();
+    }
+    return text;
+  }
+
+  std::string test_data_path_;
+  std::string output_data_path_;
+  std::istringstream input_;
+  std::ostringstream output_;
+  std::ostringstream diagnostics_;
+  core::DiagnosticCapture capture_{diagnostics_};
+};
+
+// Every program with an expected SPIM output prints the same when interpreted
+TEST_F(InterpreterTest, MatchesExpectedOutputs) {
+  for (const auto &entry : std::filesystem::directory_iterator(output_data_path_)) {
+    std::string name = entry.path().stem().string();
+    std::istringstream input;
+    std::ostringstream output;
+    interp::Interpreter interpreter(input, output);
+    EXPECT_TRUE(interpreter.Execute(ReadFile(test_data_path_ + name + ".scpl"))) << name;
+    EXPECT_EQ(TrimEnd(output.str()), TrimEnd(ReadFile(entry.path().string()))) << name;
+  }
+}
+
+// Variables persist across calls, and repetition takes the count on either side
+TEST_F(InterpreterTest, VariablesPersistAcrossCalls) {
+  interp::Interpreter interpreter(input_, output_);
+  ASSERT_TRUE(interpreter.Execute("a <- 6;\ns <- \"ab\";\n"));
+  ASSERT_TRUE(interpreter.Execute("stdout <- a * 7;\nstdout <- \"\\n\" + 2 * s + s * 0 + \"|\\t\\\"\";\n"));
+  EXPECT_EQ(output_.str(), "42\nabab|\t\"");
+
+  auto variables = interpreter.GetVariables();
+  ASSERT_EQ(variables.size(), 2U);
+  EXPECT_EQ(variables[0].first, "a");
+  EXPECT_EQ(variables[0].second.number_, 6);
+  EXPECT_EQ(variables[1].first, "s");
+  EXPECT_EQ(variables[1].second.type_, core::Type::STRING);
+  EXPECT_EQ(variables[1].second.string_, "ab");
+}
+
+// String reads take a line without its break and at most 255 characters; `stdout <- stdin` echoes a number
+TEST_F(InterpreterTest, ReadsLikeTheSyscalls) {
+  input_.str("  -17 \nline\r\n" + std::string(300, 'x') + "\n");
+  interp::Interpreter interpreter(input_, output_);
+  ASSERT_TRUE(interpreter.Execute("stdout <- stdin;\nl <- stdin;\nlong <- stdin;\nstdout <- \"[\" + l + \"]\";\n"));
+  EXPECT_EQ(output_.str(), "-17[line]");
+  EXPECT_EQ(interpreter.GetVariables()[1].second.string_, std::string(interp::Interpreter::MAX_INPUT_LENGTH, 'x'));
+}
+
+// Errors stop the input they occur in without losing the session, and lexer errors name session lines
+TEST_F(InterpreterTest, ErrorsLeaveTheSessionUsable) {
+  interp::Interpreter interpreter(input_, output_);
+  ASSERT_TRUE(interpreter.Execute("big <- 2147483647;\nn <- big * 2;\n"));
+  EXPECT_FALSE(interpreter.Execute("x <- big + 1;\n"));
+  EXPECT_NE(diagnostics_.str().find("Arithmetic overflow"), std::string::npos);
+  EXPECT_FALSE(interpreter.Execute("y <- \"a\" + 1;\n"));
+  EXPECT_FALSE(interpreter.Execute("\nz <- #;\n"));
+  EXPECT_NE(diagnostics_.str().find("line 6"), std::string::npos) << diagnostics_.str();
+
+  std::vector<interp::StatementTiming> timings;
+  ASSERT_TRUE(interpreter.Execute("stdout <- n;\nstdout <- big;\n", &timings));
+  EXPECT_EQ(timings.size(), 2U);
+  EXPECT_EQ(output_.str(), "-22147483647");
+}
+
+// Expressions nested far deeper than a recursive evaluator's stack allows evaluate without recursing
+TEST_F(InterpreterTest, EvaluatesDeeplyNestedExpressions) {
+  constexpr int DEPTH = 20000;
+  std::string sum = "x <- 1";
+  std::string nested;
+  for (int i = 0; i < DEPTH; i++) {
+    sum += " + 1";
+    nested += "\"a\" + (";
+  }
+  interp::Interpreter interpreter(input_, output_);
+  ASSERT_TRUE(interpreter.Execute(sum + ";\nstdout <- x;\n"));
+  ASSERT_TRUE(interpreter.Execute("s <- " + nested + "\"b\"" + std::string(DEPTH, ')') + ";\nstdout <- s;\n"));
+  EXPECT_EQ(output_.str(), std::to_string(DEPTH + 1) + std::string(DEPTH, 'a') + "b");
+}
+
+}  // namespace scp::test
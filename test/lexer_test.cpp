@@ -326,4 +326,41 @@ TEST_F(LexerTest, BoundaryConditions) {
   VerifyToken(tokens[0], core::TokenType::NUMBER, long_num);
 }
 
+// Tokens directly followed by the next token still give it the column where it starts
+TEST_F(LexerTest, TokenPositions) {
+  auto tokens = TokenizeInput("ab<-\"x\\ny\"*12;\n  c<-ab;");
+  std::vector<std::pair<int, int>> expected = {{1, 1}, {1, 3}, {1, 5}, {1, 11}, {1, 12}, {1, 14},
+                                               {2, 3}, {2, 4}, {2, 6},  {2, 8}};
+  ASSERT_EQ(tokens.size(), expected.size());
+  for (size_t i = 0; i < tokens.size(); i++) {
+    EXPECT_EQ(tokens[i].GetPosition(), expected[i]) << i;
+  }
+}
+
+// A streamed input gives the tokens and positions of the same input set at once, across chunk boundaries
+TEST_F(LexerTest, InputStream) {
+  std::string input;
+  for (int i = 0; input.size() < 3 * lexer::Lexer::STREAM_CHUNK_SIZE; i++) {
+    input += "name_" + std::to_string(i) + " <- \"a b\" * (" + std::to_string(i) + " + 1);\n  \t";
+  }
+  input += std::string(lexer::Lexer::STREAM_CHUNK_SIZE, ' ');
+  auto expected = TokenizeInput(input);
+
+  std::istringstream stream(input);
+  lexer_->SetInputStream(stream);
+  std::vector<core::Token> tokens;
+  while (lexer_->HasNext()) {
+    auto token = lexer_->Next();
+    ASSERT_TRUE(token.has_value());
+    tokens.push_back(*token);
+  }
+  ASSERT_EQ(tokens.size(), expected.size());
+  for (size_t i = 0; i < tokens.size(); i++) {
+    EXPECT_EQ(tokens[i].GetType(), expected[i].GetType()) << i;
+    EXPECT_EQ(tokens[i].GetValue(), expected[i].GetValue()) << i;
+    EXPECT_EQ(tokens[i].GetLine(), expected[i].GetLine()) << i;
+    EXPECT_EQ(tokens[i].GetColumn(), expected[i].GetColumn()) << i;
+  }
+}
+
 }  // namespace scp::test
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cgen/linker.h"
+#include "cgen/object_unit.h"
+#include "driver/compile.h"
+#include "parser/slr_parser.h"
+#include "workload/program_generator.h"
+
+namespace scp::test {
+
+class LinkerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    option_sets_.resize(4);
+    option_sets_[0].eliminate_redundant_loads_ = false;
+    option_sets_[2].schedule_instructions_ = true;
+    option_sets_[2].fill_delay_slots_ = true;
+    option_sets_[3].string_runtime_ = cgen::StringRuntime::ROPE;
+  }
+
+  // Compile each part as a unit seeing the variables of the parts before it
+  auto CompileUnits(const std::vector<std::string> &parts, const cgen::CodeGeneratorOptions &options)
+      -> std::vector<cgen::ObjectUnit> {
+    std::vector<cgen::ObjectUnit> units;
+    cgen::ObjectUnit::Symbols environment;
+    for (const auto &part : parts) {
+      cgen::ObjectUnit unit;
+      auto result = driver::CompileUnit(parser_, "unit", part, environment, options, unit);
+      EXPECT_TRUE(result.success_) << result.diagnostics_;
+      environment.insert(environment.end(), unit.exports_.begin(), unit.exports_.end());
+      units.push_back(std::move(unit));
+    }
+    return units;
+  }
+
+  // Link the parts compiled as units, through their files, and expect the assembly of the whole source
+  void ExpectSameAsWholeProgram(const std::vector<std::string> &parts) {
+    std::string source;
+    for (const auto &part : parts) {
+      source += part;
+    }
+    for (const auto &options : option_sets_) {
+      auto whole = driver::CompileSource(parser_, "program", source, options);
+      ASSERT_TRUE(whole.success_) << whole.diagnostics_;
+      cgen::Linker linker(options);
+      for (const auto &unit : CompileUnits(parts, options)) {
+        linker.AddUnit("unit", cgen::ObjectUnit::Deserialize(unit.Serialize()));
+      }
+      EXPECT_EQ(linker.Link(), whole.output_) << source;
+    }
+  }
+
+  std::vector<cgen::CodeGeneratorOptions> option_sets_;
+  parser::SLRParser parser_{"LinkerTest"};
+};
+
+// Units sharing variables, string literals and reads link to the assembly of one compilation
+TEST_F(LinkerTest, LinkedUnitsMatchWholeProgram) {
+  ExpectSameAsWholeProgram({"a <- \"hi\";\nb <- 3;\nstdout <- a;\n",
+                            "c <- a + \"hi\";\nd <- stdin;\nstdout <- c * b;\n",
+                            "stdout <- d + \"there\";\ne <- stdin;\nstdout <- stdin;\nstdout <- e;\n"});
+}
+
+// Generated programs cut into units link to the assembly of one compilation
+TEST_F(LinkerTest, GeneratedProgramsMatchWholeProgram) {
+  workload::GeneratorOptions knobs;
+  knobs.statements_ = 120;
+  knobs.stdin_share_ = 0.1;
+  for (uint64_t seed = 1; seed <= 3; seed++) {
+    knobs.seed_ = seed;
+    std::string program = workload::ProgramGenerator(knobs).Generate();
+    std::vector<std::string> parts(3);
+    size_t line = 0;
+    for (size_t begin = 0, end; begin < program.size(); begin = end + 1, line++) {
+      end = program.find('\n', begin);
+      end = end == std::string::npos ? program.size() - 1 : end;
+      parts[line * parts.size() / knobs.statements_ % parts.size()] += program.substr(begin, end - begin + 1);
+    }
+    ExpectSameAsWholeProgram(parts);
+  }
+}
+
+// A unit keeps its interface through serialization, and malformed bytes are rejected
+TEST_F(LinkerTest, SerializationRoundTrip) {
+  auto units = CompileUnits({"a <- \"x\\n y\";\n", "b <- a + \"\";\nstdout <- b;\n"}, {});
+  units[1].key_ = "key";
+  auto copy = cgen::ObjectUnit::Deserialize(units[1].Serialize());
+  EXPECT_EQ(copy.key_, "key");
+  EXPECT_EQ(copy.imports_, units[1].imports_);
+  EXPECT_EQ(copy.exports_, units[1].exports_);
+  EXPECT_EQ(copy.strings_, units[1].strings_);
+  EXPECT_EQ(copy.text_, units[1].text_);
+  EXPECT_EQ(copy.imports_.size(), 1);
+  EXPECT_EQ(copy.exports_.size(), 1);
+  EXPECT_THROW(cgen::ObjectUnit::Deserialize("SCPUNIT 0\n"), std::runtime_error);
+  EXPECT_THROW(cgen::ObjectUnit::Deserialize(units[1].Serialize().substr(0, 40)), std::runtime_error);
+}
+
+// A unit no longer fitting the units before it is reported, and reuse depends on its source and options
+TEST_F(LinkerTest, DetectsStaleUnits) {
+  auto units = CompileUnits({"a <- \"x\";\n", "b <- a;\n"}, {});
+  std::unordered_map<std::string, core::Type> declared = {{"stdin", core::Type::IN_STREAM},
+                                                          {"stdout", core::Type::OUT_STREAM}};
+  EXPECT_NE(cgen::Linker::FindConflict(units[1], declared), "");
+  declared.emplace("a", core::Type::NUMBER);
+  EXPECT_NE(cgen::Linker::FindConflict(units[1], declared), "");
+  declared["a"] = core::Type::STRING;
+  EXPECT_EQ(cgen::Linker::FindConflict(units[1], declared), "");
+  declared.emplace("b", core::Type::STRING);
+  EXPECT_NE(cgen::Linker::FindConflict(units[1], declared), "");
+
+  cgen::Linker linker;
+  EXPECT_THROW(linker.AddUnit("second", units[1]), std::runtime_error);
+  cgen::CodeGeneratorOptions rope;
+  rope.string_runtime_ = cgen::StringRuntime::ROPE;
+  EXPECT_THROW(cgen::Linker(rope).AddUnit("first", units[0]), std::runtime_error);
+
+  EXPECT_EQ(driver::GetUnitKey("a <- 1;\n", {}), driver::GetUnitKey("a <- 1;\n", {}));
+  EXPECT_NE(driver::GetUnitKey("a <- 1;\n", {}), driver::GetUnitKey("a <- 2;\n", {}));
+  EXPECT_NE(driver::GetUnitKey("a <- 1;\n", {}), driver::GetUnitKey("a <- 1;\n", rope));
+}
+
+#ifdef SCPC_PATH
+// scpc -c creates its -d directory, and the units it writes there link like the whole program
+TEST_F(LinkerTest, ScpcCompilesUnitsIntoFreshDirectory) {
+  auto base = std::filesystem::temp_directory_path() / "scp_linker_test";
+  std::filesystem::remove_all(base);
+  std::filesystem::create_directories(base);
+  std::ofstream(base / "first.scpl") << "x <- 1 + 2;\n";
+  std::ofstream(base / "second.scpl") << "stdout <- x * 3;\n";
+  auto units = base / "fresh" / "units";
+  std::string compile = std::string(SCPC_PATH) + " -c " + (base / "first.scpl").string() + " " +
+                        (base / "second.scpl").string() + " -d " + units.string() + " > /dev/null";
+  ASSERT_EQ(std::system(compile.c_str()), 0);
+  EXPECT_TRUE(std::filesystem::exists(units / "first.scpo"));
+  EXPECT_TRUE(std::filesystem::exists(units / "second.scpo"));
+
+  std::string link = std::string(SCPC_PATH) + " --link " + (units / "first.scpo").string() + " " +
+                     (units / "second.scpo").string() + " -o " + (base / "linked.s").string() + " > /dev/null";
+  ASSERT_EQ(std::system(link.c_str()), 0);
+  auto whole = driver::CompileSource(parser_, "program", "x <- 1 + 2;\nstdout <- x * 3;\n", {});
+  ASSERT_TRUE(whole.success_) << whole.diagnostics_;
+  std::ifstream linked(base / "linked.s");
+  std::stringstream content;
+  content << linked.rdbuf();
+  EXPECT_EQ(content.str(), whole.output_ + "\n");
+  std::filesystem::remove_all(base);
+}
+#endif
+
+}  // namespace scp::test
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/json.h"
+#include "lsp/document.h"
+#include "lsp/language_server.h"
+#include "workload/program_generator.h"
+
+namespace scp::test {
+
+class DocumentTest : public ::testing::Test {
+ protected:
+  // Expect an updated document to hold the model of a document built from its text
+  static void ExpectSameAsFresh(const lsp::Document &document) {
+    lsp::Document fresh(document.GetText());
+    ASSERT_EQ(document.GetStatementCount(), fresh.GetStatementCount()) << document.GetText();
+    auto diagnostics = document.GetDiagnostics();
+    auto expected = fresh.GetDiagnostics();
+    ASSERT_EQ(diagnostics.size(), expected.size()) << document.GetText();
+    for (size_t i = 0; i < diagnostics.size(); i++) {
+      EXPECT_EQ(diagnostics[i].message_, expected[i].message_);
+      EXPECT_EQ(diagnostics[i].line_, expected[i].line_) << diagnostics[i].message_;
+      EXPECT_EQ(diagnostics[i].column_, expected[i].column_) << diagnostics[i].message_;
+      EXPECT_EQ(diagnostics[i].end_line_, expected[i].end_line_) << diagnostics[i].message_;
+      EXPECT_EQ(diagnostics[i].end_column_, expected[i].end_column_) << diagnostics[i].message_;
+    }
+
+    int line = 1;
+    int column = 1;
+    for (char c : document.GetText()) {
+      auto symbol = document.GetSymbol(line, column);
+      auto expected_symbol = fresh.GetSymbol(line, column);
+      ASSERT_EQ(symbol.has_value(), expected_symbol.has_value()) << line << ":" << column;
+      if (symbol) {
+        EXPECT_EQ(symbol->token_.GetValue(), expected_symbol->token_.GetValue());
+        EXPECT_EQ(symbol->token_.GetPosition(), expected_symbol->token_.GetPosition());
+        ASSERT_EQ(symbol->type_, expected_symbol->type_) << symbol->token_.GetValue() << "\n" << document.GetText();
+      }
+      auto definition = document.GetDefinition(line, column);
+      auto expected_definition = fresh.GetDefinition(line, column);
+      ASSERT_EQ(definition.has_value(), expected_definition.has_value()) << line << ":" << column;
+      if (definition) {
+        EXPECT_EQ(definition->GetPosition(), expected_definition->GetPosition());
+      }
+      if (c == '\n') {
+        line++;
+        column = 1;
+      } else {
+        column++;
+      }
+    }
+  }
+};
+
+// Tokens know their types and variables their declarations
+TEST_F(DocumentTest, HoverAndDefinition) {
+  lsp::Document document("a <- 1;\ns <- \"x\" * a;\n  a <- a + 2; stdout <- s;\nb <- c;");
+  auto symbol = document.GetSymbol(2, 1);
+  ASSERT_TRUE(symbol.has_value());
+  EXPECT_EQ(symbol->token_.GetValue(), "s");
+  EXPECT_EQ(symbol->type_, core::Type::STRING);
+  EXPECT_EQ(document.GetSymbol(2, 7)->type_, core::Type::STRING);
+  EXPECT_EQ(document.GetSymbol(3, 8)->type_, core::Type::NUMBER);
+  EXPECT_EQ(document.GetSymbol(3, 25)->token_.GetPosition(), std::make_pair(3, 25));
+  EXPECT_FALSE(document.GetSymbol(3, 1).has_value());
+
+  auto definition = document.GetDefinition(3, 8);
+  ASSERT_TRUE(definition.has_value());
+  EXPECT_EQ(definition->GetPosition(), std::make_pair(1, 1));
+  EXPECT_EQ(document.GetDefinition(3, 25)->GetPosition(), std::make_pair(2, 1));
+  EXPECT_EQ(document.GetDefinition(2, 1)->GetPosition(), std::make_pair(2, 1));
+  EXPECT_FALSE(document.GetDefinition(4, 6).has_value());
+
+  auto diagnostics = document.GetDiagnostics();
+  ASSERT_EQ(diagnostics.size(), 1U);
+  EXPECT_EQ(diagnostics[0].line_, 4);
+  EXPECT_NE(diagnostics[0].message_.find("c"), std::string::npos);
+}
+
+// An edit parses only the statements it touches and checks only the statements its declarations reach
+TEST_F(DocumentTest, EditsStayLocal) {
+  std::string text;
+  for (int i = 0; i < 1000; i++) {
+    text += "v" + std::to_string(i) + " <- " + std::to_string(i) + ";\n";
+  }
+  text += "w <- v500 + v10;\n";
+  lsp::Document document(text);
+
+  // A new literal of the same type changes no declaration
+  document.Replace(text.find("<- 700;") + 3, 3, "7");
+  EXPECT_EQ(document.GetParsedCount(), 1U);
+  EXPECT_EQ(document.GetCheckedCount(), 1U);
+
+  // A declaration turned into a string reaches the statement reading it
+  size_t offset = document.GetText().find("<- 500;") + 3;
+  document.Replace(offset, 3, "\"five\"");
+  EXPECT_EQ(document.GetParsedCount(), 1U);
+  EXPECT_EQ(document.GetCheckedCount(), 2U);
+  EXPECT_EQ(document.GetDiagnostics().size(), 1U);
+  document.Replace(offset, 6, "5");
+  EXPECT_TRUE(document.GetDiagnostics().empty());
+
+  // A string opened by an edit runs on to the end
+  document.Replace(document.GetText().find("v3 <-"), 0, "\"");
+  EXPECT_EQ(document.GetStatementCount(), 4U);
+  ExpectSameAsFresh(document);
+}
+
+// Random edits leave the model a fresh parse and check of the text would build
+TEST_F(DocumentTest, RandomEditsMatchFreshDocument) {
+  workload::GeneratorOptions knobs;
+  knobs.statements_ = 60;
+  knobs.stdin_share_ = 0.1;
+  lsp::Document document(workload::ProgramGenerator(knobs).Generate());
+  static const std::vector<std::string> PIECES = {";", "\"", "<-", "+", "*", "(", ")", "\n", " ", "x", "a1",
+                                                  "7", "\"s\"", "#", "stdout <- x;", "x <- 1;\n", "\\"};
+  std::mt19937 random(7);
+  for (int edit = 0; edit < 300; edit++) {
+    size_t size = document.GetText().size();
+    size_t offset = random() % (size + 1);
+    size_t length = random() % 3 == 0 ? random() % std::min<size_t>(size - offset + 1, 12) : 0;
+    document.Replace(offset, length, PIECES[random() % PIECES.size()]);
+    ExpectSameAsFresh(document);
+    if (HasFatalFailure()) {
+      return;
+    }
+  }
+}
+
+// The server answers a session over Content-Length framed JSON-RPC
+TEST(LanguageServerTest, Session) {
+  auto frame = [](const std::string &content) {
+    return "Content-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content;
+  };
+  std::string uri = "file:///a.scpl";
+  std::string input =
+      frame(R"({"jsonrpc": "2.0", "id": 1, "method": "initialize", "params": {}})") +
+      frame(R"({"jsonrpc": "2.0", "method": "initialized", "params": {}})") +
+      frame(R"({"jsonrpc": "2.0", "method": "textDocument/didOpen", "params": {"textDocument": {"uri": ")" + uri +
+            R"(", "text": "a <- 1;\nb <- a + \"x\";\n"}}})") +
+      frame(R"({"jsonrpc": "2.0", "method": "textDocument/didChange", "params": {"textDocument": {"uri": ")" + uri +
+            R"("}, "contentChanges": [{"range": {"start": {"line": 1, "character": 9}, "end": {"line": 1, )"
+            R"("character": 12}}, "text": "2"}]}})") +
+      frame(R"({"jsonrpc": "2.0", "id": "h", "method": "textDocument/hover", "params": {"textDocument": {"uri": ")" +
+            uri + R"("}, "position": {"line": 1, "character": 0}}})") +
+      frame(R"({"jsonrpc": "2.0", "id": 3, "method": "textDocument/definition", "params": {"textDocument": )"
+            R"({"uri": ")" +
+            uri + R"("}, "position": {"line": 1, "character": 5}}})") +
+      frame(R"({"jsonrpc": "2.0", "id": 4, "method": "workspace/symbol", "params": {}})") +
+      frame(R"({"jsonrpc": "2.0", "id": 5, "method": "shutdown"})") + frame(R"({"jsonrpc": "2.0", "method": "exit"})");
+  std::istringstream in(input);
+  std::ostringstream out;
+  lsp::LanguageServer server(in, out);
+  EXPECT_EQ(server.Serve(), 0);
+
+  std::vector<core::JsonValue> messages;
+  std::string output = out.str();
+  for (size_t position = 0; position < output.size();) {
+    size_t header_end = output.find("\r\n\r\n", position);
+    ASSERT_NE(header_end, std::string::npos);
+    size_t length = std::stoul(output.substr(position + 16, header_end - position - 16));
+    messages.push_back(core::JsonValue::Parse(output.substr(header_end + 4, length)));
+    position = header_end + 4 + length;
+  }
+  ASSERT_EQ(messages.size(), 7U);
+  EXPECT_NE(messages[0].Find("result")->Find("capabilities")->Find("hoverProvider"), nullptr);
+  // didOpen reports the type error, which the change fixes
+  EXPECT_EQ(messages[1].Find("params")->Find("diagnostics")->AsArray().size(), 1U);
+  EXPECT_TRUE(messages[2].Find("params")->Find("diagnostics")->AsArray().empty());
+  EXPECT_EQ(messages[3].Find("id")->AsString(), "h");
+  EXPECT_EQ(messages[3].Find("result")->Find("contents")->Find("value")->AsString(), "b: number");
+  const auto *range = messages[4].Find("result")->Find("range");
+  EXPECT_EQ(range->Find("start")->Find("line")->AsNumber(), 0);
+  EXPECT_EQ(range->Find("start")->Find("character")->AsNumber(), 0);
+  EXPECT_NE(messages[5].Find("error"), nullptr);
+  EXPECT_EQ(messages[6].Find("result")->GetKind(), core::JsonValue::Kind::NULL_VALUE);
+}
+
+// A malformed Content-Length header is answered with a parse error and the server reads on
+TEST(LanguageServerTest, MalformedContentLength) {
+  auto frame = [](const std::string &content) {
+    return "Content-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content;
+  };
+  std::string shutdown = R"({"jsonrpc": "2.0", "id": 5, "method": "shutdown"})";
+  std::string input = "Content-Length: abc\r\n\r\n" + shutdown + "Content-Length: 99999999999999999999999\r\n\r\n" +
+                      shutdown + frame(shutdown) + frame(R"({"jsonrpc": "2.0", "method": "exit"})");
+  std::istringstream in(input);
+  std::ostringstream out;
+  lsp::LanguageServer server(in, out);
+  EXPECT_EQ(server.Serve(), 0);
+
+  std::string output = out.str();
+  EXPECT_NE(output.find("Malformed Content-Length header: Content-Length: abc"), std::string::npos);
+  EXPECT_NE(output.find("Malformed Content-Length header: Content-Length: 99999999999999999999999"),
+            std::string::npos);
+  EXPECT_NE(output.find(R"("id": 5, "result": null)"), std::string::npos);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgen/one_pass_compiler.h"
+#include "driver/compile.h"
+#include "parser/slr_parser.h"
+#include "workload/program_generator.h"
+
+namespace scp::test {
+
+class OnePassTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    test_data_path_ = TEST_DATA_DIR;
+#else
+    test_data_path_ = "test/data";
+#endif
+    option_sets_.resize(5);
+    option_sets_[0].eliminate_redundant_loads_ = false;
+    option_sets_[2].schedule_instructions_ = true;
+    option_sets_[3].schedule_instructions_ = true;
+    option_sets_[3].fill_delay_slots_ = true;
+    option_sets_[4].string_runtime_ = cgen::StringRuntime::ROPE;
+  }
+
+  // Compile a source with both pipelines under every option set and expect identical results
+  void ExpectSameAsMultiPass(const std::string &source) {
+    for (auto options : option_sets_) {
+      auto multi_pass = driver::CompileSource(parser_, "program", source, options);
+      options.one_pass_ = true;
+      auto one_pass = driver::CompileSource(parser_, "program", source, options);
+      EXPECT_EQ(one_pass.success_, multi_pass.success_) << source;
+      EXPECT_EQ(one_pass.output_, multi_pass.output_) << source;
+      EXPECT_EQ(one_pass.diagnostics_, multi_pass.diagnostics_) << source;
+    }
+  }
+
+  std::string test_data_path_;
+  std::vector<cgen::CodeGeneratorOptions> option_sets_;
+  parser::SLRParser parser_{"OnePassTest"};
+};
+
+// Every program of the test corpus compiles to the same assembly or the same errors
+TEST_F(OnePassTest, CorpusMatchesMultiPass) {
+  size_t programs = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(test_data_path_ + "/code")) {
+    std::ifstream file(entry.path());
+    std::stringstream content;
+    content << file.rdbuf();
+    ExpectSameAsMultiPass(content.str());
+    programs++;
+  }
+  EXPECT_GT(programs, 0);
+}
+
+// Generated programs with reads, prints, strings and deep expressions compile to the same assembly
+TEST_F(OnePassTest, GeneratedProgramsMatchMultiPass) {
+  workload::GeneratorOptions knobs;
+  knobs.statements_ = 300;
+  knobs.stdin_share_ = 0.1;
+  for (uint64_t seed = 1; seed <= 4; seed++) {
+    knobs.seed_ = seed;
+    ExpectSameAsMultiPass(workload::ProgramGenerator(knobs).Generate());
+  }
+}
+
+// Type errors, parse errors and the panics of malformed ASTs report what the multi-pass pipeline reports
+TEST_F(OnePassTest, ErrorsMatchMultiPass) {
+  for (const auto *source : {
+           "x <- y;\nz <- 1 + \"a\";\nw <- 2 * z;\n",
+           "stdin <- 1;\nx <- stdout;\nx <- 1;\ns <- \"a\";\ns <- 3;\n",
+           "x <- 1;\ny <- x + \"a\";\nz <- q;\n",
+           "x <- 1 # 2;",
+           "x <- q;\ny <- 1 +;",
+           "x <- (1 + 2) * \"ab\";\nstdout <- x;\nstdout <- stdin;\ny <- stdin;\nz <- (stdin);\n",
+           "a <- q;\nx <- _y;\nz <- r;\n",
+           "a <- q;\nx <- r + (s + _y);\nz <- t;\n",
+           "x <- (u + _y) + _z;\n",
+           "x <- (u + v) * (_a);\n",
+           "_x <- 1;\nstdout <- _x;\n",
+       }) {
+    ExpectSameAsMultiPass(source);
+  }
+}
+
+// The semantic actions see every token and every reduction, and no tree is built
+TEST_F(OnePassTest, ParseWithActionsBuildsNoTree) {
+  parser::SLRParser parser("OnePassTest");
+  parser.SetInput("x <- 1 + 2 * 3;\nstdout <- x;\n");
+  cgen::OnePassCompiler one_pass;
+  ASSERT_TRUE(parser.ParseWithActions(one_pass));
+  EXPECT_EQ(parser.GetTokenCount(), 12);
+  EXPECT_EQ(parser.GetParseTreeNodeCount(), 0);
+  EXPECT_NE(one_pass.Finish().find("sll $a0, $t1, 1 # x * 3"), std::string::npos);
+}
+
+// Deeply nested expressions compile to the same assembly, with the code of an expression emitted in order
+TEST_F(OnePassTest, DeepExpressionsMatchMultiPass) {
+  constexpr int DEPTH = 5000;
+  std::string chain = "x <- 1";
+  std::string nested;
+  for (int i = 0; i < DEPTH; i++) {
+    chain += " * 2 + 1";
+    nested += "\"a\" + (";
+  }
+  ExpectSameAsMultiPass(chain + ";\ns <- " + nested + "\"b\"" + std::string(DEPTH, ')') + ";\nstdout <- s;\n");
+}
+
+}  // namespace scp::test
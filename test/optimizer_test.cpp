@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "cgen/instruction_buffer.h"
+#include "cgen/instruction_scheduler.h"
+#include "cgen/peephole_optimizer.h"
+#include "cgen/redundant_load_eliminator.h"
+
+namespace scp::test {
+
+class OptimizerTest : public ::testing::Test {
+ protected:
+  // Helper function to collect the instruction lines of a buffer, without blanks
+  static auto Lines(const cgen::InstructionBuffer &buffer) -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    for (const auto &instruction : buffer.GetInstructions()) {
+      if (instruction.kind_ != cgen::Instruction::Kind::BLANK) {
+        lines.push_back(instruction.text_);
+      }
+    }
+    return lines;
+  }
+
+  // Helper function to run redundant load elimination over some assembly
+  static auto EliminateLoads(const std::string &assembly) -> std::vector<std::string> {
+    cgen::InstructionBuffer buffer(assembly);
+    cgen::RedundantLoadEliminator().Run(buffer);
+    return Lines(buffer);
+  }
+
+  // Helper function to run the peephole rules over some assembly
+  static auto RewriteMultiplications(const std::string &assembly) -> std::vector<std::string> {
+    cgen::InstructionBuffer buffer(assembly);
+    cgen::PeepholeOptimizer().Run(buffer);
+    return Lines(buffer);
+  }
+
+  // Helper function to run the instruction scheduler over some assembly
+  static auto Schedule(const std::string &assembly, bool fill_delay_slots = false) -> std::vector<std::string> {
+    cgen::InstructionBuffer buffer(assembly);
+    cgen::InstructionScheduler(fill_delay_slots).Run(buffer);
+    return Lines(buffer);
+  }
+};
+
+// Untouched code is emitted byte for byte
+TEST_F(OptimizerTest, BufferRoundTrip) {
+  std::string assembly =
+      ".data\nstr_0: .asciiz \"a, b # c\"\n\n.text\nmain:\n    lw $a0, 4($fp)   # load\n    jal rope_print\n";
+  cgen::InstructionBuffer buffer(assembly);
+  EXPECT_EQ(assembly, buffer.ToString());
+}
+
+// Lines are classified and operands split outside of string literals and comments
+TEST_F(OptimizerTest, BufferDecodesLines) {
+  cgen::InstructionBuffer buffer("str_0: .asciiz \"x\"\nloop:\n    add $a0, $t1, $a0 # sum\n    sw $a0, 0($sp)");
+  const auto &lines = buffer.GetInstructions();
+  ASSERT_EQ(4U, lines.size());
+  EXPECT_EQ(cgen::Instruction::Kind::DIRECTIVE, lines[0].kind_);
+  EXPECT_EQ(cgen::Instruction::Kind::LABEL, lines[1].kind_);
+  EXPECT_EQ("loop", lines[1].label_);
+  EXPECT_EQ("add", lines[2].opcode_);
+  EXPECT_EQ((std::vector<std::string>{"$a0", "$t1", "$a0"}), lines[2].operands_);
+  EXPECT_EQ((std::vector<std::string>{"$a0"}), lines[2].GetDefinedRegisters());
+  EXPECT_EQ((std::vector<std::string>{"$t1", "$a0"}), lines[2].GetUsedRegisters());
+  EXPECT_TRUE(lines[3].IsStore());
+  EXPECT_EQ((std::vector<std::string>{"$a0", "$sp"}), lines[3].GetUsedRegisters());
+}
+
+// A reload right after the store of the same register is dropped
+TEST_F(OptimizerTest, DropsReloadAfterStore) {
+  auto lines = EliminateLoads("    sw $a0, 4($fp)\n    lw $a0, 4($fp)\n    li $v0, 1\n    syscall");
+  EXPECT_EQ((std::vector<std::string>{"    sw $a0, 4($fp)", "    li $v0, 1", "    syscall"}), lines);
+}
+
+// A reload into another register becomes a move
+TEST_F(OptimizerTest, ReplacesReloadWithMove) {
+  auto lines = EliminateLoads("    lw $a0, 8($fp)\n    lw $t1, 8($fp)");
+  EXPECT_EQ((std::vector<std::string>{"    lw $a0, 8($fp)", "    move $t1, $a0"}), lines);
+}
+
+// Redefining the register, calls and labels all invalidate what is known
+TEST_F(OptimizerTest, KeepsReloadAfterInvalidation) {
+  auto lines = EliminateLoads("    sw $a0, 0($fp)\n    li $a0, 3\n    lw $a0, 0($fp)");
+  EXPECT_EQ(3U, lines.size());
+
+  lines = EliminateLoads("    sw $a0, 0($fp)\n    jal string_concat\n    lw $a0, 0($fp)");
+  EXPECT_EQ(3U, lines.size());
+
+  lines = EliminateLoads("    sw $s0, 0($fp)\n    jal string_concat\n    lw $s0, 0($fp)");
+  EXPECT_EQ(2U, lines.size());
+
+  lines = EliminateLoads("    sw $a0, 0($fp)\nloop:\n    lw $a0, 0($fp)");
+  EXPECT_EQ(3U, lines.size());
+
+  lines = EliminateLoads("    sw $a0, 0($fp)\n    sw $t1, 0($fp)\n    lw $a0, 0($fp)");
+  EXPECT_EQ((std::vector<std::string>{"    sw $a0, 0($fp)", "    sw $t1, 0($fp)", "    move $a0, $t1"}), lines);
+}
+
+// An independent instruction moves between a load and its use
+TEST_F(OptimizerTest, SchedulesAroundLoadUse) {
+  auto lines = Schedule("    lw $a0, 4($fp)\n    add $a0, $a0, $a0\n    li $t1, 7");
+  EXPECT_EQ((std::vector<std::string>{"    lw $a0, 4($fp)", "    li $t1, 7", "    add $a0, $a0, $a0"}), lines);
+}
+
+// Stores and loads of the same slot keep their order, branches stay at the end of their block
+TEST_F(OptimizerTest, SchedulerKeepsDependences) {
+  auto lines = Schedule("    sw $a0, 0($fp)\n    lw $t1, 0($fp)\n    li $a0, 1\n    beq $t1, $zero, done\ndone:");
+  EXPECT_EQ((std::vector<std::string>{"    sw $a0, 0($fp)", "    lw $t1, 0($fp)", "    li $a0, 1",
+                                      "    beq $t1, $zero, done", "done:"}),
+            lines);
+}
+
+// No-reorder mode fills delay slots with independent work, or a nop when there is none
+TEST_F(OptimizerTest, FillsDelaySlots) {
+  cgen::InstructionBuffer buffer("    li $t1, 2\n    lw $a0, 0($fp)\n    j done\n    jal rope_print\ndone:");
+  cgen::InstructionScheduler scheduler(true);
+  scheduler.Run(buffer);
+  EXPECT_EQ((std::vector<std::string>{".set noreorder", "    lw $a0, 0($fp)", "    j done", "    li $t1, 2",
+                                      "    jal rope_print", "    nop", "done:"}),
+            Lines(buffer));
+  EXPECT_EQ(1, scheduler.GetFilledDelaySlotCount());
+  EXPECT_EQ(1, scheduler.GetNopCount());
+}
+
+// No-reorder mode never lets a use follow its load directly
+TEST_F(OptimizerTest, SeparatesLoadFromUse) {
+  auto lines = Schedule("    lw $a0, 0($fp)\n    beq $a0, $zero, done\ndone:", true);
+  EXPECT_EQ((std::vector<std::string>{".set noreorder", "    lw $a0, 0($fp)", "    nop", "    beq $a0, $zero, done",
+                                      "    nop", "done:"}),
+            lines);
+
+  lines = Schedule("    lw $a0, 0($fp)\nnext:\n    move $t1, $a0", true);
+  EXPECT_EQ((std::vector<std::string>{".set noreorder", "    lw $a0, 0($fp)", "    nop", "next:", "    move $t1, $a0"}),
+            lines);
+}
+
+// A multiplication by a constant becomes the shifts and adds of its rule, with the other factor popped in between
+TEST_F(OptimizerTest, RewritesMultiplicationByConstant) {
+  auto lines = RewriteMultiplications("    li $a0, 9\n    lw $t1, 0($sp)\n    mul $a0, $t1, $a0\n    li $v0, 1");
+  EXPECT_EQ((std::vector<std::string>{"    lw $t1, 0($sp)", "    sll $a0, $t1, 3 # x * 9", "    addu $a0, $t1, $a0",
+                                      "    li $v0, 1"}),
+            lines);
+
+  // Constants past 31 bits load as their 32-bit word, so 4294967295 multiplies by -1
+  lines = RewriteMultiplications("    li $a0, 4294967295\n    mul $a0, $a0, $t1");
+  EXPECT_EQ((std::vector<std::string>{"    subu $a0, $zero, $t1 # x * 4294967295"}), lines);
+
+  // Constants without a cheaper rule keep the mul
+  lines = RewriteMultiplications("    li $a0, 100\n    mul $a0, $t1, $a0");
+  EXPECT_EQ((std::vector<std::string>{"    li $a0, 100", "    mul $a0, $t1, $a0"}), lines);
+}
+
+// Rules using the scratch register apply only where $t2 is dead after the mul
+TEST_F(OptimizerTest, RewritesOnlyWhereScratchIsDead) {
+  auto lines = RewriteMultiplications("    li $a0, 10\n    mul $a0, $t1, $a0\n    li $v0, 10\n    syscall");
+  EXPECT_EQ((std::vector<std::string>{"    sll $a0, $t1, 1 # x * 10", "    sll $t2, $t1, 3", "    addu $a0, $a0, $t2",
+                                      "    li $v0, 10", "    syscall"}),
+            lines);
+  lines = RewriteMultiplications("    li $a0, 10\n    mul $a0, $t1, $a0\n    jal string_concat");
+  EXPECT_EQ(4U, lines.size());
+
+  // A read of $t2, a join point or the end of the code keeps it live
+  for (const auto *after : {"    move $a1, $t2\n", "next:\n    li $t2, 0\n", ""}) {
+    std::string assembly = std::string("    li $a0, 10\n    mul $a0, $t1, $a0\n") + after;
+    lines = RewriteMultiplications(assembly);
+    EXPECT_EQ("    li $a0, 10", lines[0]) << after;
+  }
+}
+
+// The constant must reach the mul untouched, and the mul must multiply it with another register
+TEST_F(OptimizerTest, KeepsMultiplicationWhenConstantChanges) {
+  for (const auto *assembly : {"    li $a0, 8\n    addiu $a0, $a0, 1\n    mul $a0, $t1, $a0",
+                               "    li $a0, 8\n    sw $a0, 0($sp)\n    mul $a0, $t1, $a0",
+                               "    li $a0, 8\nloop:\n    mul $a0, $t1, $a0", "    li $a0, 8\n    mul $a0, $a0, $a0",
+                               "    li $a0, 8\n    mul $t1, $t1, $a0"}) {
+    auto lines = RewriteMultiplications(assembly);
+    EXPECT_EQ("    li $a0, 8", lines[0]) << assembly;
+    EXPECT_NE(std::string::npos, lines.back().find("mul")) << assembly;
+  }
+}
+
+}  // namespace scp::test
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cgen/code_generator.h"
+#include "parser/ll1_parser.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+#include "workload/program_generator.h"
+#include "workload/scaling_fit.h"
+
+namespace scp::test {
+
+// Equal options give the same program, another seed a different one
+TEST(ProgramGeneratorTest, SeedDeterminesProgram) {
+  workload::GeneratorOptions options;
+  options.statements_ = 200;
+  auto program = workload::ProgramGenerator(options).Generate();
+  workload::ProgramGenerator generator(options);
+  EXPECT_EQ(generator.Generate(), program);
+  EXPECT_EQ(generator.Generate(), program);
+
+  options.seed_ = 2;
+  EXPECT_NE(workload::ProgramGenerator(options).Generate(), program);
+}
+
+// Every program passes the whole pipeline, whatever the knobs
+TEST(ProgramGeneratorTest, ProgramsCompile) {
+  std::vector<workload::GeneratorOptions> knobs(5);
+  knobs[1].string_share_ = 1.0;
+  knobs[1].max_literal_length_ = 40;
+  knobs[2].string_share_ = 0.0;
+  knobs[2].max_depth_ = 8;
+  knobs[2].max_chain_ = 12;
+  knobs[3].stdin_share_ = 0.2;
+  knobs[3].output_share_ = 0.5;
+  knobs[4].new_variable_share_ = 0.0;
+  knobs[4].max_literal_length_ = 0;
+
+  for (size_t i = 0; i < knobs.size(); i++) {
+    knobs[i].seed_ = i + 7;
+    knobs[i].statements_ = 300;
+    auto program = workload::ProgramGenerator(knobs[i]).Generate();
+    EXPECT_EQ(std::count(program.begin(), program.end(), '\n'), 300) << "knob set " << i;
+
+    parser::SLRParser parser("generated");
+    parser.SetInput(program);
+    auto ast = parser.Parse();
+    ASSERT_TRUE(ast) << "knob set " << i;
+    semant::TypeChecker type_checker(ast);
+    std::shared_ptr<core::TypeEnvironment> environment;
+    ASSERT_NO_THROW(environment = type_checker.CheckType()) << "knob set " << i;
+    cgen::CodeGenerator code_generator(ast, environment);
+    EXPECT_NE(code_generator.GenerateCode().find("main:"), std::string::npos) << "knob set " << i;
+  }
+}
+
+// Both parsers accept long programs, whose statement lists nest once per statement
+TEST(ProgramGeneratorTest, LongProgramsParse) {
+  workload::GeneratorOptions options;
+  options.statements_ = 5000;
+  options.output_share_ = 0.0;
+  auto program = workload::ProgramGenerator(options).Generate();
+
+  parser::SLRParser slr("generated");
+  slr.SetInput(program);
+  auto slr_ast = slr.Parse();
+  ASSERT_TRUE(slr_ast);
+  parser::LL1Parser ll1("generated");
+  ll1.SetInput(program);
+  auto ll1_ast = ll1.Parse();
+  ASSERT_TRUE(ll1_ast);
+  EXPECT_EQ(slr_ast->GetRoot()->GetChildren().size(), 5000U);
+  EXPECT_EQ(ll1_ast->GetRoot()->GetChildren().size(), 5000U);
+}
+
+TEST(ProgramGeneratorTest, SetOptionFromCommandLine) {
+  workload::GeneratorOptions options;
+  EXPECT_TRUE(workload::SetGeneratorOption(options, "statements", "42"));
+  EXPECT_TRUE(workload::SetGeneratorOption(options, "string-share", "0.75"));
+  EXPECT_EQ(options.statements_, 42U);
+  EXPECT_DOUBLE_EQ(options.string_share_, 0.75);
+  EXPECT_FALSE(workload::SetGeneratorOption(options, "string-share", "1.5"));
+  EXPECT_FALSE(workload::SetGeneratorOption(options, "depth", "3x"));
+  EXPECT_FALSE(workload::SetGeneratorOption(options, "colour", "1"));
+}
+
+// The fit recovers the exponent and coefficient of exact power laws
+TEST(ScalingFitTest, RecoversExponent) {
+  std::vector<double> sizes = {1e3, 1e4, 1e5, 1e6};
+  for (double exponent : {0.5, 1.0, 2.0}) {
+    std::vector<double> values;
+    for (double n : sizes) {
+      values.push_back(3.0 * std::pow(n, exponent));
+    }
+    auto law = workload::FitPowerLaw(sizes, values);
+    EXPECT_NEAR(law.exponent_, exponent, 1e-9);
+    EXPECT_NEAR(law.coefficient_, 3.0, 1e-6);
+  }
+  EXPECT_EQ(workload::FitPowerLaw({10, 10}, {1, 2}).exponent_, 0);
+  EXPECT_NEAR(workload::FitPowerLaw({0, 10, 100}, {5, 10, 100}).exponent_, 1.0, 1e-9);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "runtime/scprt.h"
+
+namespace scp::test {
+
+class RuntimeTest : public ::testing::Test {
+ protected:
+  void TearDown() override { scprt_set_isa(scprt_detect_isa()); }
+
+  // The instruction sets this CPU runs
+  static auto SupportedIsas() -> std::vector<scprt_isa> {
+    std::vector<scprt_isa> isas;
+    for (auto isa : {SCPRT_ISA_SCALAR, SCPRT_ISA_SSE2, SCPRT_ISA_AVX2}) {
+      if (isa <= scprt_detect_isa()) {
+        isas.push_back(isa);
+      }
+    }
+    return isas;
+  }
+
+  // A pipe holding the input, read back through the returned file descriptor
+  static auto PipeFrom(const std::string &input) -> int {
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    EXPECT_EQ(write(fds[1], input.data(), input.size()), static_cast<ssize_t>(input.size()));
+    close(fds[1]);
+    return fds[0];
+  }
+};
+
+// Every instruction set finds and copies the same bytes as a byte loop, at every length and alignment
+TEST_F(RuntimeTest, KernelsMatchByteLoops) {
+  std::vector<char> text(512 + 64);
+  std::vector<char> copy(text.size() + 64);
+  std::mt19937 random(5);
+  for (auto &c : text) {
+    c = static_cast<char>('a' + random() % 4);
+  }
+  for (auto isa : SupportedIsas()) {
+    ASSERT_EQ(scprt_set_isa(isa), 1);
+    EXPECT_EQ(scprt_get_isa(), isa);
+    for (size_t offset = 0; offset < 64; offset++) {
+      for (size_t length = 0; length < 512; length++) {
+        char *s = text.data() + offset;
+        char saved = s[length];
+        s[length] = '\0';
+        ASSERT_EQ(scprt_strlen(s), length) << isa << " " << offset;
+        s[length] = saved;
+
+        const void *found = scprt_memchr(s, 'd', length);
+        ASSERT_EQ(found, std::memchr(s, 'd', length)) << isa << " " << offset << " " << length;
+        ASSERT_EQ(scprt_memchr(s, 'z', length), nullptr);
+
+        std::fill(copy.begin(), copy.end(), '#');
+        ASSERT_EQ(scprt_memcpy(copy.data() + (offset + 3) % 64, s, length), copy.data() + (offset + 3) % 64);
+        ASSERT_EQ(std::memcmp(copy.data() + (offset + 3) % 64, s, length), 0);
+        ASSERT_EQ(std::count(copy.begin(), copy.end(), '#'), static_cast<ptrdiff_t>(copy.size() - length));
+      }
+    }
+  }
+}
+
+// The loops read no byte past the end of a string or buffer that ends where the memory does
+TEST_F(RuntimeTest, KernelsStayInsideTheLastPage) {
+  auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto *memory =
+      static_cast<char *>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(memory, MAP_FAILED);
+  ASSERT_EQ(mprotect(memory + page, page, PROT_NONE), 0);
+  std::memset(memory, 'x', page);
+  memory[page - 1] = '\0';
+  char copy[128];
+  for (auto isa : SupportedIsas()) {
+    scprt_set_isa(isa);
+    for (size_t length = 0; length < 100; length++) {
+      const char *s = memory + page - 1 - length;
+      EXPECT_EQ(scprt_strlen(s), length);
+      EXPECT_EQ(scprt_memchr(s, 'y', length + 1), nullptr);
+      EXPECT_EQ(scprt_memchr(s, '\0', length + 1), s + length);
+      scprt_memcpy(copy, s, length + 1);
+      EXPECT_EQ(std::strlen(copy), length);
+    }
+  }
+  munmap(memory, 2 * page);
+}
+
+// Concatenation and repetition behave like string_concat and string_repeat and stop at the end of the buffer
+TEST_F(RuntimeTest, ConcatAndRepeat) {
+  char out[16];
+  EXPECT_EQ(scprt_concat(out, sizeof(out), "ab", "cd"), 4U);
+  EXPECT_STREQ(out, "abcd");
+  EXPECT_EQ(scprt_concat(out, sizeof(out), out, "ef"), 6U);
+  EXPECT_STREQ(out, "abcdef");
+  EXPECT_EQ(scprt_concat(out, sizeof(out), "0123456789", "abcdefghij"), 15U);
+  EXPECT_STREQ(out, "0123456789abcde");
+  EXPECT_EQ(scprt_concat(out, 1, "a", "b"), 0U);
+  EXPECT_STREQ(out, "");
+
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), "abc", 3), 9U);
+  EXPECT_STREQ(out, "abcabcabc");
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), "xy", 100), 15U);
+  EXPECT_STREQ(out, "xyxyxyxyxyxyxyx");
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), "abc", 0), 0U);
+  EXPECT_STREQ(out, "");
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), "abc", -2), 0U);
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), "", 5), 0U);
+  std::strcpy(out, "ab");
+  EXPECT_EQ(scprt_repeat(out, sizeof(out), out, 2), 4U);
+  EXPECT_STREQ(out, "abab");
+
+  std::vector<char> large(1 << 20);
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    expected += "pattern";
+  }
+  EXPECT_EQ(scprt_repeat(large.data(), large.size(), "pattern", 1000), expected.size());
+  EXPECT_EQ(std::string(large.data()), expected);
+}
+
+// Numbers parse like the read integer syscall and format like the print integer syscall
+TEST_F(RuntimeTest, Numbers) {
+  auto parse = [](const std::string &text) { return scprt_parse_int(text.data(), text.size()); };
+  EXPECT_EQ(parse("42"), 42);
+  EXPECT_EQ(parse(" \t-17xyz"), -17);
+  EXPECT_EQ(parse("+8"), 8);
+  EXPECT_EQ(parse(""), 0);
+  EXPECT_EQ(parse("abc"), 0);
+  EXPECT_EQ(parse("- 5"), 0);
+  EXPECT_EQ(parse("2147483648"), INT32_MIN);
+  EXPECT_EQ(parse("4294967297"), 1);
+
+  char out[SCPRT_INT_CHARS];
+  for (int32_t value : {0, 7, 10, 99, 100, -1, -10, 123456789, INT32_MAX, INT32_MIN}) {
+    EXPECT_EQ(scprt_format_int(value, out), std::to_string(value).size());
+    EXPECT_EQ(std::string(out), std::to_string(value));
+  }
+}
+
+// Lines come back like the read string syscall followed by string_trim_newline, also across refills of the buffer
+TEST_F(RuntimeTest, ReadLines) {
+  std::string long_line(SCPRT_BUFFER_SIZE + 100, 'q');
+  int fd = PipeFrom("first\r\nsecond\n" + long_line + "\n  -25 apples\n" + std::string(5000, ' ') + "12\nlast");
+  scprt_reader reader;
+  scprt_reader_init(&reader, fd);
+  char line[256];
+  EXPECT_EQ(scprt_read_line(&reader, line, sizeof(line)), 5U);
+  EXPECT_STREQ(line, "first");
+  EXPECT_EQ(scprt_read_line(&reader, line, sizeof(line)), 6U);
+  EXPECT_STREQ(line, "second");
+
+  // A line longer than the buffer leaves its rest for the next read, which takes the newline along
+  std::string read;
+  while (read.size() < long_line.size()) {
+    size_t length = scprt_read_line(&reader, line, sizeof(line));
+    ASSERT_GT(length, 0U);
+    read += line;
+  }
+  EXPECT_EQ(read, long_line);
+
+  EXPECT_EQ(scprt_read_int(&reader), -25);
+  EXPECT_EQ(scprt_read_int(&reader), 12);
+  EXPECT_EQ(scprt_read_line(&reader, line, sizeof(line)), 4U);
+  EXPECT_STREQ(line, "last");
+  EXPECT_EQ(scprt_read_line(&reader, line, sizeof(line)), 0U);
+  EXPECT_EQ(scprt_read_int(&reader), 0);
+  close(fd);
+}
+
+// Buffered writes reach the file descriptor in order, small and large alike
+TEST_F(RuntimeTest, WriteBuffered) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  scprt_writer writer;
+  scprt_writer_init(&writer, fds[1]);
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    scprt_write_int(&writer, i - 500);
+    scprt_write_str(&writer, "\n");
+    expected += std::to_string(i - 500) + "\n";
+  }
+  std::string large(3 * SCPRT_BUFFER_SIZE, 'L');
+  scprt_write(&writer, large.data(), large.size());
+  expected += large;
+  EXPECT_EQ(scprt_flush(&writer), 0);
+  close(fds[1]);
+
+  std::string output;
+  char chunk[4096];
+  ssize_t count;
+  while ((count = read(fds[0], chunk, sizeof(chunk))) > 0) {
+    output.append(chunk, static_cast<size_t>(count));
+  }
+  close(fds[0]);
+  EXPECT_EQ(output, expected);
+
+  scprt_writer_init(&writer, -1);
+  scprt_write_str(&writer, "lost");
+  EXPECT_EQ(scprt_flush(&writer), -1);
+}
+
+}  // namespace scp::test
@@ -2,10 +2,13 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "core/ast.h"
+#include "core/diagnostics.h"
 #include "parser/slr_parser.h"
 
 namespace scp::test {
@@ -414,4 +417,55 @@ TEST_F(SLRParserTest, PerformanceTest) {
   std::cout << "SLR Parser Performance: Parsed heavy_test.scpl in " << duration.count() << " milliseconds" << std::endl;
 }
 
+// A pipelined parse builds the same AST and reports the same errors as an inline one
+TEST_F(SLRParserTest, PipelinedParseMatchesInline) {
+  std::string program;
+  for (int i = 0; i < 3000; i++) {
+    program += "x" + std::to_string(i % 7) + " <- (\"a\" + s) * " + std::to_string(i) + ";\n";
+  }
+  for (const auto &input : {ReadTestFile("real_code.scpl"), program, std::string(), program + "y <- 1 # 2;\n",
+                            program + "y <- 1 +;\n" + program, "y <- ;\n" + program}) {
+    parser_->SetPipelined(false);
+    parser_->SetInput(input);
+    std::ostringstream inline_diagnostics;
+    std::shared_ptr<core::AST> expected;
+    {
+      core::DiagnosticCapture capture(inline_diagnostics);
+      expected = parser_->Parse();
+    }
+
+    parser_->SetPipelined(true);
+    parser_->SetInput(input);
+    std::ostringstream pipelined_diagnostics;
+    std::shared_ptr<core::AST> ast;
+    {
+      core::DiagnosticCapture capture(pipelined_diagnostics);
+      ast = parser_->Parse();
+    }
+    EXPECT_EQ(pipelined_diagnostics.str(), inline_diagnostics.str());
+    ASSERT_EQ(ast != nullptr, expected != nullptr);
+    if (ast) {
+      EXPECT_TRUE(ast->GetRoot()->IsStructurallyEqual(*expected->GetRoot()));
+    }
+  }
+}
+
+// A pipelined parse that throws stops its lexer thread, so the parser can parse again and be destroyed
+TEST_F(SLRParserTest, PipelinedParseSurvivesThrowingCallback) {
+  std::string program;
+  for (int i = 0; i < 3000; i++) {
+    program += "x <- " + std::to_string(i) + ";\n";
+  }
+  parser_->SetPipelined(true);
+  std::istringstream input(program);
+  EXPECT_THROW(parser_->ParseStatements(input,
+                                        [](const std::shared_ptr<core::AST::ASTNode> & /*statement*/) -> bool {
+                                          throw std::runtime_error("callback failed");
+                                        }),
+               std::runtime_error);
+
+  parser_->SetInput(program);
+  EXPECT_NE(parser_->Parse(), nullptr);
+}
+
 }  // namespace scp::test
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgen/streaming_code_generator.h"
+#include "driver/compile.h"
+#include "driver/memory_accounting.h"
+#include "parser/slr_parser.h"
+#include "semant/type_checker.h"
+#include "workload/program_generator.h"
+
+namespace scp::test {
+
+class StreamCompileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#ifdef TEST_DATA_DIR
+    test_data_path_ = TEST_DATA_DIR;
+#else
+    test_data_path_ = "test/data";
+#endif
+    temp_asm_file_ = (std::filesystem::temp_directory_path() / "scp_stream_compile_test.s").string();
+  }
+
+  void TearDown() override { std::filesystem::remove(temp_asm_file_); }
+
+  std::string test_data_path_;
+  std::string temp_asm_file_;
+
+  // Helper function to read file content without trailing whitespace
+  static auto ReadFile(const std::string &filepath) -> std::string {
+    std::ifstream file(filepath);
+    std::stringstream content;
+    content << file.rdbuf();
+    return TrimTrailing(content.str());
+  }
+
+  static auto TrimTrailing(std::string text) -> std::string {
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == ' ')) {
+      text.pop_back();
+    }
+    return text;
+  }
+
+  // Helper function to run an assembly file with SPIM and capture its output
+  static auto ExecuteSpim(const std::string &asm_file, bool delayed) -> std::string {
+    std::string command =
+        std::string("spim -quiet ") + (delayed ? "-delayed_branches -delayed_loads " : "") + asm_file + " 2>&1";
+    FILE *pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+      return "";
+    }
+    std::string result;
+    char buffer[128];
+    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+      result += buffer;
+    }
+    pclose(pipe);
+    return TrimTrailing(result);
+  }
+};
+
+// Streamed programs behave like the expected output under every optimization level and string runtime
+TEST_F(StreamCompileTest, ProgramsRunUnderSpim) {
+  std::vector<cgen::CodeGeneratorOptions> option_sets(4);
+  option_sets[0].eliminate_redundant_loads_ = false;
+  option_sets[2].schedule_instructions_ = true;
+  option_sets[2].fill_delay_slots_ = true;
+  option_sets[3].string_runtime_ = cgen::StringRuntime::ROPE;
+  parser::SLRParser parser("StreamCompileTest");
+  for (const auto *name : {"cgen_arithmetic", "cgen_string_concat", "cgen_string_repeat", "cgen_multiple_vars",
+                           "cgen_operator_precedence2", "cgen_repeat_computed_count", "cgen_long_chain_concat"}) {
+    std::string expected = ReadFile(test_data_path_ + "/output/" + name + ".txt");
+    for (size_t i = 0; i < option_sets.size(); i++) {
+      std::ifstream input(test_data_path_ + "/code/" + name + ".scpl");
+      std::ofstream output(temp_asm_file_);
+      auto result = driver::CompileStream(parser, name, input, output, option_sets[i]);
+      output.close();
+      ASSERT_TRUE(result.success_) << name << ": " << result.diagnostics_;
+      EXPECT_EQ(result.output_, "");
+      EXPECT_EQ(ExecuteSpim(temp_asm_file_, option_sets[i].fill_delay_slots_), expected)
+          << name << " with option set " << i;
+    }
+  }
+}
+
+// Statements reach the callback in source order and equal those of a whole-program parse
+TEST_F(StreamCompileTest, ParseStatementsMatchesParse) {
+  std::string source = "x <- (1 + 2) * 3;\ny <- \"a\" + \"b\";\n\nstdout <- y * x;\n";
+  parser::SLRParser parser("StreamCompileTest");
+  parser.SetInput(source);
+  auto ast = parser.Parse();
+  ASSERT_TRUE(ast);
+
+  std::vector<std::shared_ptr<core::AST::ASTNode>> statements;
+  std::istringstream input(source);
+  EXPECT_TRUE(parser.ParseStatements(input, [&statements](const std::shared_ptr<core::AST::ASTNode> &statement) {
+    statements.push_back(statement);
+    return true;
+  }));
+  const auto &expected = ast->GetRoot()->GetChildren();
+  ASSERT_EQ(statements.size(), expected.size());
+  auto it = expected.begin();
+  for (const auto &statement : statements) {
+    EXPECT_TRUE(statement->IsStructurallyEqual(**it++));
+  }
+
+  // A callback returning false stops the parse after its statement
+  size_t seen = 0;
+  std::istringstream again(source);
+  EXPECT_FALSE(parser.ParseStatements(again, [&seen](const std::shared_ptr<core::AST::ASTNode> &) {
+    return ++seen < 2;
+  }));
+  EXPECT_EQ(seen, 2);
+}
+
+// Lexer, parser and type errors fail the compilation with the diagnostics of a batch compilation
+TEST_F(StreamCompileTest, ReportsErrors) {
+  parser::SLRParser parser("StreamCompileTest");
+  for (const auto *source : {"x <- 1 # 2;", "x <- 1 +;", "x <- 1;\ny <- x + \"a\";\nz <- q;\n"}) {
+    std::istringstream input(source);
+    std::ostringstream output;
+    auto streamed = driver::CompileStream(parser, "errors", input, output, {});
+    auto batch = driver::CompileSource(parser, "errors", source, {});
+    EXPECT_FALSE(streamed.success_) << source;
+    EXPECT_EQ(streamed.diagnostics_, batch.diagnostics_) << source;
+  }
+}
+
+// The generated code held at once and the heap peak do not grow with the length of the program
+TEST_F(StreamCompileTest, MemoryIsBoundedPerStatement) {
+  workload::GeneratorOptions knobs;
+  knobs.new_variable_share_ = 0.01;
+  knobs.max_literal_length_ = 2;
+  std::vector<uint64_t> heap_peaks;
+  for (size_t statements : {1000, 10000}) {
+    knobs.statements_ = statements;
+    std::istringstream input(workload::ProgramGenerator(knobs).Generate());
+    parser::SLRParser parser("StreamCompileTest");
+    std::ofstream output(temp_asm_file_);
+
+    uint64_t live = driver::MemoryAccounting::GetLiveBytes();
+    driver::MemoryAccounting::ResetPeak();
+    semant::TypeChecker type_checker;
+    cgen::StreamingCodeGenerator code_generator(output, {});
+    ASSERT_TRUE(parser.ParseStatements(input, [&](const std::shared_ptr<core::AST::ASTNode> &statement) {
+      EXPECT_TRUE(type_checker.CheckStatement(statement));
+      code_generator.AddStatement(statement, type_checker.GetTypeEnvironment());
+      return true;
+    }));
+    code_generator.Finish();
+    heap_peaks.push_back(driver::MemoryAccounting::GetPeakBytes() - live);
+    // One chunk, plus the statement or the runtime that fills it past the flush size
+    EXPECT_LT(code_generator.GetPeakPendingBytes(), 2 * cgen::StreamingCodeGenerator::FLUSH_BYTES);
+  }
+  EXPECT_LT(heap_peaks[1], heap_peaks[0] * 3 / 2) << heap_peaks[0] << " then " << heap_peaks[1];
+}
+
+}  // namespace scp::test
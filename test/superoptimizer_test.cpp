@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cgen/peephole_rules.h"
+#include "cgen/superoptimizer.h"
+
+namespace scp::test {
+
+using cgen::Superoptimizer;
+
+// Sequences read back the way they are written and run with the wrap-around and trap semantics of MIPS
+TEST(SuperoptimizerTest, ParsesAndEvaluates) {
+  auto sequence = Superoptimizer::Parse("sll $out, $in, 2\naddu $out, $out, $in");
+  EXPECT_EQ("sll $out, $in, 2; addu $out, $out, $in", Superoptimizer::ToString(sequence));
+  EXPECT_EQ(15U, Superoptimizer::Evaluate(sequence, 3));
+  EXPECT_EQ(2, Superoptimizer::GetCost(sequence));
+  EXPECT_EQ(0xfffffffbU, Superoptimizer::Evaluate(sequence, 0xffffffffU));
+
+  auto multiply = Superoptimizer::MultiplyBy(100000);
+  EXPECT_EQ("li $out, 100000; mul $out, $in, $out", Superoptimizer::ToString(multiply));
+  EXPECT_EQ(5, Superoptimizer::GetCost(multiply));
+  EXPECT_EQ(4, Superoptimizer::GetCost(Superoptimizer::MultiplyBy(-5)));
+
+  auto add = Superoptimizer::Parse("add $out, $in, $in");
+  EXPECT_EQ(2U, Superoptimizer::Evaluate(add, 1));
+  EXPECT_EQ(std::nullopt, Superoptimizer::Evaluate(add, 0x40000000U));
+  EXPECT_EQ(0x80000000U, Superoptimizer::Evaluate(Superoptimizer::Parse("addu $out, $in, $in"), 0x40000000U));
+
+  for (const auto *text : {"lw $out, 0($in)", "move $out, $t0", "sll $out, $in, 32", "move $in, $out", "li $out",
+                           "addiu $out, $in, x"}) {
+    EXPECT_THROW(Superoptimizer::Parse(text), std::runtime_error) << text;
+  }
+}
+
+// Verification proves equivalence without a solver, and rejects sequences that trap or read registers unset
+TEST(SuperoptimizerTest, Verifies) {
+  EXPECT_TRUE(Superoptimizer::Verify(Superoptimizer::Parse("sll $out, $in, 3"), Superoptimizer::MultiplyBy(8)));
+  EXPECT_TRUE(Superoptimizer::Verify(Superoptimizer::Parse("sll $tmp, $in, 31; subu $out, $zero, $tmp"),
+                                     Superoptimizer::MultiplyBy(INT32_MIN)));
+  EXPECT_FALSE(Superoptimizer::Verify(Superoptimizer::Parse("sll $out, $in, 1"), Superoptimizer::MultiplyBy(3)));
+
+  // x * x and x agree at 0 and 1, which the degree of x * x rules out as a proof
+  EXPECT_FALSE(Superoptimizer::Verify(Superoptimizer::Parse("mul $out, $in, $in"), Superoptimizer::MultiplyBy(1)));
+
+  // add overflows where the multiplication wraps around
+  EXPECT_FALSE(Superoptimizer::Verify(Superoptimizer::Parse("add $out, $in, $in"), Superoptimizer::MultiplyBy(2)));
+  EXPECT_FALSE(Superoptimizer::Verify(Superoptimizer::Parse("addu $out, $out, $in"),
+                                      Superoptimizer::Parse("move $out, $in")));
+  EXPECT_FALSE(
+      Superoptimizer::Verify(Superoptimizer::Parse("move $tmp, $in"), Superoptimizer::Parse("move $out, $in")));
+}
+
+// The search finds the cheapest sequences, and nothing where the target is already cheapest
+TEST(SuperoptimizerTest, Searches) {
+  cgen::SuperoptimizerOptions options;
+  options.max_length_ = 2;
+  Superoptimizer superoptimizer(options);
+  auto found = superoptimizer.Search({Superoptimizer::MultiplyBy(9), Superoptimizer::MultiplyBy(-1),
+                                      Superoptimizer::MultiplyBy(10), Superoptimizer::Parse("sll $out, $in, 1")});
+  ASSERT_EQ(4U, found.size());
+  ASSERT_TRUE(found[0]);
+  EXPECT_EQ(2, Superoptimizer::GetCost(*found[0]));
+  EXPECT_TRUE(Superoptimizer::Verify(*found[0], Superoptimizer::MultiplyBy(9)));
+  ASSERT_TRUE(found[1]);
+  EXPECT_EQ("subu $out, $zero, $in", Superoptimizer::ToString(*found[1]));
+  EXPECT_FALSE(found[2]);
+  EXPECT_FALSE(found[3]);
+  EXPECT_GT(superoptimizer.GetEnumeratedCount(), 0U);
+}
+
+// Every rule of the checked-in table is equivalent to its multiplication and cheaper
+TEST(SuperoptimizerTest, RuleTableIsVerified) {
+  const auto &rules = cgen::GetPeepholeRules();
+  ASSERT_FALSE(rules.empty());
+  for (const auto &rule : rules) {
+    auto replacement = Superoptimizer::Parse(rule.replacement_);
+    auto original = Superoptimizer::MultiplyBy(rule.multiplier_);
+    EXPECT_TRUE(Superoptimizer::Verify(replacement, original)) << rule.multiplier_;
+    EXPECT_LT(Superoptimizer::GetCost(replacement), Superoptimizer::GetCost(original)) << rule.multiplier_;
+  }
+}
+
+}  // namespace scp::test
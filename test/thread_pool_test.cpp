@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "driver/thread_pool.h"
+
+namespace scp::test {
+
+// Every task runs exactly once, on a valid worker
+TEST(ThreadPoolTest, RunsEveryTask) {
+  driver::ThreadPool pool(4);
+  std::vector<std::atomic<int>> runs(1000);
+  std::atomic<bool> bad_worker{false};
+  for (size_t i = 0; i < runs.size(); ++i) {
+    pool.Submit([&runs, &bad_worker, &pool, i](size_t worker) {
+      runs[i]++;
+      if (worker >= pool.GetThreadCount()) {
+        bad_worker = true;
+      }
+    });
+  }
+  pool.Wait();
+  for (const auto &count : runs) {
+    EXPECT_EQ(1, count.load());
+  }
+  EXPECT_FALSE(bad_worker.load());
+}
+
+// Tasks may submit more tasks, and Wait covers them too
+TEST(ThreadPoolTest, WaitsForNestedTasks) {
+  driver::ThreadPool pool(3);
+  std::atomic<int> leaves{0};
+  for (int i = 0; i < 10; ++i) {
+    pool.Submit([&pool, &leaves](size_t) {
+      for (int j = 0; j < 10; ++j) {
+        pool.Submit([&leaves](size_t) { leaves++; });
+      }
+    });
+  }
+  pool.Wait();
+  EXPECT_EQ(100, leaves.load());
+
+  // The pool stays usable after a wait
+  pool.Submit([&leaves](size_t) { leaves++; });
+  pool.Wait();
+  EXPECT_EQ(101, leaves.load());
+}
+
+}  // namespace scp::test
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+#include "core/token.h"
+#include "lexer/token_ring.h"
+
+namespace scp::test {
+
+// Tokens cross the ring in order, many times around it, and the end marker stays at the front
+TEST(TokenRingTest, DeliversTokensInOrder) {
+  constexpr size_t TOKENS = 10 * lexer::TokenRing::CAPACITY + 3;
+  lexer::TokenRing ring;
+  std::thread producer([&ring] {
+    for (size_t i = 0; i < TOKENS; i++) {
+      ASSERT_TRUE(ring.Push(core::Token(core::TokenType::NUMBER, std::to_string(i), 1, static_cast<int>(i))));
+    }
+    ring.Close("");
+  });
+  for (size_t i = 0; i < TOKENS; i++) {
+    ASSERT_TRUE(ring.Front().has_value());
+    auto token = ring.Pop();
+    ASSERT_TRUE(token.has_value());
+    ASSERT_EQ(token->GetValue(), std::to_string(i));
+  }
+  producer.join();
+  EXPECT_FALSE(ring.Front().has_value());
+  EXPECT_FALSE(ring.Pop().has_value());
+  EXPECT_FALSE(ring.Pop().has_value());
+  EXPECT_EQ(ring.GetDiagnostics(), "");
+}
+
+// The end marker of a failed lexer carries its diagnostics
+TEST(TokenRingTest, CloseCarriesDiagnostics) {
+  lexer::TokenRing ring;
+  ASSERT_TRUE(ring.Push(core::Token(core::TokenType::IDENTIFIER, "x", 1, 1)));
+  ring.Close("Lexer: bad character\n");
+  EXPECT_EQ(ring.Pop()->GetValue(), "x");
+  EXPECT_FALSE(ring.Pop().has_value());
+  EXPECT_EQ(ring.GetDiagnostics(), "Lexer: bad character\n");
+
+  // Reset empties the ring for the next producer
+  ring.Reset();
+  ring.Close("");
+  EXPECT_FALSE(ring.Front().has_value());
+  EXPECT_EQ(ring.GetDiagnostics(), "");
+}
+
+// Cancelling releases a producer waiting on a full ring
+TEST(TokenRingTest, CancelStopsProducer) {
+  lexer::TokenRing ring;
+  bool stopped = false;
+  std::thread producer([&ring, &stopped] {
+    for (size_t i = 0;; i++) {
+      if (!ring.Push(core::Token(core::TokenType::SEMICOLON, ";", 1, static_cast<int>(i)))) {
+        stopped = true;
+        return;
+      }
+    }
+  });
+  EXPECT_EQ(ring.Pop()->GetValue(), ";");
+  ring.Cancel();
+  producer.join();
+  EXPECT_TRUE(stopped);
+}
+
+}  // namespace scp::test
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+#include "core/trace.h"
+#include "parser/slr_parser.h"
+
+namespace scp::test {
+
+// Count the occurrences of a string
+static auto Count(const std::string &text, const std::string &part) -> size_t {
+  size_t count = 0;
+  for (size_t pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+// Scopes record complete events only while a trace is recorded
+TEST(TraceTest, RecordsScopesWhileEnabled) {
+  core::Trace::Start();
+  {
+    core::TraceScope outer("outer");
+    core::TraceScope inner("inner", "a \"detail\"");
+  }
+  core::Trace::Stop();
+  { core::TraceScope ignored("ignored"); }
+
+  std::string json = core::Trace::ToJson();
+  EXPECT_EQ(Count(json, "\"ph\": \"X\""), 2U);
+  EXPECT_NE(json.find("\"name\": \"outer\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\": {\"detail\": \"a \\\"detail\\\"\"}"), std::string::npos);
+  EXPECT_EQ(json.find("ignored"), std::string::npos);
+
+  // Starting again discards the earlier events
+  core::Trace::Start();
+  core::Trace::Stop();
+  EXPECT_EQ(Count(core::Trace::ToJson(), "\"ph\""), 0U);
+}
+
+// Events of different threads carry different thread ids
+TEST(TraceTest, SeparatesThreads) {
+  core::Trace::Start();
+  { core::TraceScope main_scope("main"); }
+  std::thread worker([] { core::TraceScope worker_scope("worker"); });
+  worker.join();
+  core::Trace::Stop();
+
+  std::string json = core::Trace::ToJson();
+  auto tid = [&json](const std::string &name) {
+    auto event = json.find("\"name\": \"" + name + "\"");
+    auto field = json.find("\"tid\": ", event);
+    return std::stoi(json.substr(field + 7));
+  };
+  EXPECT_NE(tid("main"), tid("worker"));
+}
+
+#ifdef SCP_ENABLE_TRACING
+// The compiler phases are instrumented
+TEST(TraceTest, TracesParserPhases) {
+  core::Trace::Start();
+  parser::SLRParser parser("traced");
+  parser.SetInput("x <- 1;");
+  ASSERT_TRUE(parser.Lex());
+  ASSERT_TRUE(parser.Parse());
+  core::Trace::Stop();
+
+  std::string json = core::Trace::ToJson();
+  EXPECT_EQ(Count(json, "\"name\": \"Lex\""), 1U);
+  EXPECT_EQ(Count(json, "\"name\": \"SLRParser::Parse\""), 1U);
+  EXPECT_EQ(Count(json, "\"name\": \"BuildAST\""), 1U);
+}
+#endif
+
+}  // namespace scp::test